@@ -0,0 +1,522 @@
+/*
+ * Description: Measures the time of loading, building and drawing DIALOGs,
+ *              writing the results as JSON so different builds may be
+ *              compared.
+ *
+ * Author: Rodrigo Freitas
+ * Created at: Mon Oct 19 20:21:09 2026
+ * Project: libgrc benchmarks
+ *
+ * Copyright (c) 2014 Rodrigo Freitas
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301
+ * USA
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <time.h>
+
+#include "bench.h"
+
+#define DEFAULT_OBJECTS             20
+#define DEFAULT_ITERATIONS          100
+
+struct bench_result {
+    const char      *name;
+    const char      *object_type;   /** Only when measuring a single type */
+    int             color_depth;    /** Only when measuring a single depth */
+    unsigned int    ops;            /** Measured operations */
+    double          usec;           /** Total time, in microseconds */
+};
+
+static FILE *__out;
+static unsigned int __results = 0;
+static unsigned int __objects = DEFAULT_OBJECTS;
+static unsigned int __iterations = DEFAULT_ITERATIONS;
+
+static const int __depths[] = {
+    GRC_COLOR_8,
+    GRC_COLOR_15,
+    GRC_COLOR_16,
+    GRC_COLOR_24,
+    GRC_COLOR_32
+};
+
+#define MAX_DEPTHS                  \
+    (sizeof(__depths) / sizeof(__depths[0]))
+
+static const char *__colors[] = {
+    GRC_BLACK,
+    GRC_WHITE,
+    GRC_YELLOW,
+    GRC_SILVER,
+    GRC_PURPLE,
+    "not_a_color"
+};
+
+#define MAX_COLORS                  \
+    (sizeof(__colors) / sizeof(__colors[0]))
+
+static const char *__keys[] = {
+    "KEY_A",
+    "KEY_Z",
+    "KEY_0",
+    "KEY_ESC",
+    "KEY_ENTER",
+    "KEY_F1",
+    "KEY_F12",
+    "KEY_NOT_A_KEY"
+};
+
+#define MAX_KEYS                    \
+    (sizeof(__keys) / sizeof(__keys[0]))
+
+static void clock_start(struct timespec *t)
+{
+    clock_gettime(CLOCK_MONOTONIC, t);
+}
+
+static double clock_usec(const struct timespec *t)
+{
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
+    return (now.tv_sec - t->tv_sec) * 1e6 + (now.tv_nsec - t->tv_nsec) / 1e3;
+}
+
+static void report(const struct bench_result *r)
+{
+    fprintf(__out, "%s\n    { \"name\": \"%s\"", (__results > 0) ? "," : "",
+            r->name);
+
+    if (r->object_type != NULL)
+        fprintf(__out, ", \"type\": \"%s\"", r->object_type);
+
+    if (r->color_depth > 0)
+        fprintf(__out, ", \"color_depth\": %d", r->color_depth);
+
+    fprintf(__out, ", \"ops\": %u, \"total_usec\": %.3f, "
+                   "\"usec_per_op\": %.6f }",
+            r->ops, r->usec, (r->ops > 0) ? r->usec / r->ops : 0);
+
+    __results++;
+}
+
+static unsigned int count_objects(struct grc_s *grc)
+{
+    return cl_dll_size(grc->ui_objects);
+}
+
+/* Everything grc_init does before the objects are parsed */
+static struct grc_s *load_until_objects(const char *data)
+{
+    struct grc_s *grc;
+
+    grc = new_grc();
+
+    if (NULL == grc)
+        return NULL;
+
+    if ((parse_mem(grc, data) < 0) ||
+        (info_set_value(grc->info, INFO_USE_GFX, true, NULL) < 0) ||
+        (info_parse(grc) < 0) || (gui_init(grc) < 0) ||
+        (color_parse(grc) < 0) || (font_parse(grc) < 0))
+    {
+        destroy_grc(grc);
+        return NULL;
+    }
+
+    return grc;
+}
+
+static int bench_parse_objects(const char *data)
+{
+    struct bench_result r = { "parse_objects", NULL, 0, 0, 0 };
+    struct timespec t;
+    struct grc_s *grc;
+    unsigned int i;
+    int ret;
+
+    for (i = 0; i < __iterations; i++) {
+        grc = load_until_objects(data);
+
+        if (NULL == grc)
+            return -1;
+
+        clock_start(&t);
+        ret = parse_objects(grc);
+        r.usec += clock_usec(&t);
+        r.ops++;
+        destroy_grc(grc);
+
+        if (ret < 0)
+            return -1;
+    }
+
+    report(&r);
+
+    return 0;
+}
+
+static void bench_lookup(struct grc_s *grc)
+{
+    struct bench_result r = { "grc_get_DIALOG_from_tag", NULL, 0, 0, 0 };
+    struct grc_object_s *p;
+    struct timespec t;
+    unsigned int i;
+
+    clock_start(&t);
+
+    for (i = 0; i < __iterations; i++)
+        for (p = grc->ui_objects; p; p = p->next) {
+            grc_get_DIALOG_from_tag(grc, p->tag);
+            r.ops++;
+        }
+
+    r.usec = clock_usec(&t);
+    report(&r);
+}
+
+static int bench_dialog_create(struct grc_s *grc)
+{
+    struct bench_result r = { "DIALOG_create", NULL, 0, 0, 0 };
+    struct timespec t;
+    unsigned int i;
+    DIALOG *previous;
+
+    /*
+     * The objects are copied from the previous DIALOG, so it's only released
+     * once the new one is created.
+     */
+    for (i = 0; i < __iterations; i++) {
+        previous = grc->dlg;
+        clock_start(&t);
+
+        if (DIALOG_create(grc) < 0)
+            return -1;
+
+        r.usec += clock_usec(&t);
+        r.ops++;
+        free(previous);
+    }
+
+    report(&r);
+
+    return 0;
+}
+
+static void bench_colors(void)
+{
+    struct bench_result r = { "color_grc_to_al", NULL, 0, 0, 0 };
+    struct timespec t;
+    unsigned int i, d, c;
+
+    for (d = 0; d < MAX_DEPTHS; d++) {
+        r.color_depth = __depths[d];
+        r.ops = 0;
+        clock_start(&t);
+
+        for (i = 0; i < __iterations; i++)
+            for (c = 0; c < MAX_COLORS; c++) {
+                color_grc_to_al(__depths[d], __colors[c]);
+                r.ops++;
+            }
+
+        r.usec = clock_usec(&t);
+        report(&r);
+    }
+}
+
+static void bench_keys(void)
+{
+    struct bench_result r = { "tr_str_key_to_al_key", NULL, 0, 0, 0 };
+    struct timespec t;
+    unsigned int i, k;
+
+    clock_start(&t);
+
+    for (i = 0; i < __iterations; i++)
+        for (k = 0; k < MAX_KEYS; k++) {
+            tr_str_key_to_al_key(__keys[k]);
+            r.ops++;
+        }
+
+    r.usec = clock_usec(&t);
+    report(&r);
+}
+
+static grc_t *load_dialog(unsigned int count, const char *type,
+    enum grc_color_depth color_depth)
+{
+    grc_t *grc;
+    char *data;
+
+    data = bench_generate_grc(count, type, color_depth);
+
+    if (NULL == data)
+        return NULL;
+
+    grc = grc_init_from_mem(data, true);
+    free(data);
+
+    if (NULL == grc)
+        return NULL;
+
+    if (grc_prepare_dialog(grc) < 0) {
+        grc_uninit(grc);
+        return NULL;
+    }
+
+    return grc;
+}
+
+/* Messages written to a 'messages_log_box', each one drawn at once */
+static int bench_log(void)
+{
+    struct bench_result r = { "grc_log", NULL, 0, 0, 0 };
+    struct timespec t;
+    char tag[128], msg[64];
+    unsigned int i;
+    grc_t *grc;
+
+    grc = load_dialog(1, DLG_OBJ_MESSAGES_LOG_BOX, GRC_COLOR_32);
+
+    if (NULL == grc)
+        return -1;
+
+    snprintf(tag, sizeof(tag), "%s_0", DLG_OBJ_MESSAGES_LOG_BOX);
+    clock_start(&t);
+
+    for (i = 0; i < __iterations * 10; i++) {
+        snprintf(msg, sizeof(msg), "Log message number %u", i);
+        grc_log(grc, tag, msg, NULL);
+        r.ops++;
+    }
+
+    r.usec = clock_usec(&t);
+    report(&r);
+    grc_uninit(grc);
+
+    return 0;
+}
+
+/*
+ * Messages which draw nothing, as the ones sent to every object in each
+ * frame. Comparing it between a build with 'PROFILE=1' and one without it
+ * gives the cost of profiling an object.
+ */
+static int bench_messages(void)
+{
+    struct bench_result r = { "message", NULL, 0, 0, 0 };
+    struct grc_object_s *p;
+    struct timespec t;
+    struct grc_s *grc;
+    unsigned int i;
+
+    grc = load_dialog(__objects, NULL, GRC_COLOR_32);
+
+    if (NULL == grc)
+        return -1;
+
+    clock_start(&t);
+
+    for (i = 0; i < __iterations * 100; i++)
+        for (p = grc->ui_objects; p; p = p->next) {
+            object_message(p->rdlg, MSG_IDLE, 0);
+            r.ops++;
+        }
+
+    r.usec = clock_usec(&t);
+    grc_uninit(grc);
+    report(&r);
+
+    return 0;
+}
+
+/*
+ * Draws every object of a single type into a memory bitmap of its own, so
+ * only the drawing itself is measured.
+ */
+static int bench_render(const char *type, enum grc_color_depth color_depth)
+{
+    struct bench_result r = { "render", type, color_depth, 0, 0 };
+    struct grc_object_s *p;
+    struct timespec t;
+    BITMAP *bmp;
+    struct grc_s *grc;
+    unsigned int i;
+
+    grc = load_dialog(__objects, type, color_depth);
+
+    if (NULL == grc)
+        return -1;
+
+    bmp = create_bitmap_ex(color_depth, BENCH_WIDTH, BENCH_HEIGHT);
+
+    if (NULL == bmp) {
+        grc_uninit(grc);
+        return -1;
+    }
+
+    gui_set_screen(bmp);
+    clock_start(&t);
+
+    for (i = 0; i < __iterations; i++)
+        for (p = grc->ui_objects; p; p = p->next) {
+            object_message(p->rdlg, MSG_DRAW, 0);
+            r.ops++;
+        }
+
+    r.usec = clock_usec(&t);
+    gui_set_screen(NULL);
+    destroy_bitmap(bmp);
+    grc_uninit(grc);
+    report(&r);
+
+    return 0;
+}
+
+static int run(void)
+{
+    struct grc_s *grc;
+    const char *type;
+    char *data;
+    unsigned int k, d;
+    bool started = false;
+    int ret = -1;
+
+    data = bench_generate_grc(__objects, NULL, GRC_COLOR_32);
+
+    if (NULL == data)
+        return -1;
+
+    grc = load_dialog(__objects, NULL, GRC_COLOR_32);
+
+    if (NULL == grc)
+        goto end_block;
+
+    fprintf(__out, "{\n  \"version\": \"%d.%d.%d\",\n"
+                   "  \"objects\": %u,\n  \"iterations\": %u,\n"
+                   "  \"results\": [", MAJOR_VERSION, MINOR_VERSION, BUILD,
+            count_objects(grc), __iterations);
+
+    started = true;
+    bench_lookup(grc);
+    ret = bench_dialog_create(grc);
+    grc_uninit(grc);
+
+    if ((ret < 0) || (bench_parse_objects(data) < 0)) {
+        ret = -1;
+        goto end_block;
+    }
+
+    ret = -1;
+    bench_colors();
+    bench_keys();
+
+    if ((bench_log() < 0) || (bench_messages() < 0))
+        goto end_block;
+
+    for (d = 0; d < MAX_DEPTHS; d++)
+        for (k = 0; (type = str_dlg_object(k)) != NULL; k++) {
+            if (bench_object_supported(type) == false)
+                continue;
+
+            if (bench_render(type, __depths[d]) < 0)
+                goto end_block;
+        }
+
+    ret = 0;
+
+end_block:
+    /* Results of a failed run are still valid JSON, marked as incomplete */
+    if (started == true)
+        fprintf(__out, "\n  ],\n  \"complete\": %s\n}\n",
+                (ret == 0) ? "true" : "false");
+
+    free(data);
+
+    return ret;
+}
+
+static void usage(const char *name)
+{
+    fprintf(stderr, "Usage: %s [-n objects] [-i iterations] [-o file]\n",
+            name);
+}
+
+int main(int argc, char **argv)
+{
+    const char *opt = "n:i:o:h\0";
+    int option, ret;
+    char *output = NULL;
+
+    do {
+        option = getopt(argc, argv, opt);
+
+        switch (option) {
+            case 'n':
+                __objects = atoi(optarg);
+                break;
+
+            case 'i':
+                __iterations = atoi(optarg);
+                break;
+
+            case 'o':
+                output = strdup(optarg);
+                break;
+
+            case 'h':
+                usage(argv[0]);
+                return 1;
+
+            case '?':
+                return -1;
+        }
+    } while (option != -1);
+
+    if ((__objects == 0) || (__iterations == 0)) {
+        usage(argv[0]);
+        return 1;
+    }
+
+    __out = (output != NULL) ? fopen(output, "w") : stdout;
+
+    if (NULL == __out) {
+        perror(output);
+        free(output);
+        return 1;
+    }
+
+    /* Allegro is kept between every loaded DIALOG */
+    grc_session_begin();
+    ret = run();
+    grc_session_end();
+
+    if (ret < 0)
+        fprintf(stderr, "Error: %s\n", grc_strerror(grc_get_last_error()));
+
+    if (output != NULL) {
+        fclose(__out);
+        free(output);
+    }
+
+    return (ret < 0) ? 1 : 0;
+}
@@ -1,10 +1,9 @@
-
 /*
- * Description: Functions to manipulate a 'struct grc_generic_data' structure.
+ * Description: Internal definitions of the libgrc benchmarks.
  *
  * Author: Rodrigo Freitas
- * Created at: Thu Jul 28 09:22:12 2016
- * Project: libgrc
+ * Created at: Mon Oct 19 20:02:17 2026
+ * Project: libgrc benchmarks
  *
  * Copyright (c) 2014 Rodrigo Freitas
  *
@@ -24,29 +23,22 @@
  * USA
  */
 
-#include <stdlib.h>
+#ifndef _GRC_BENCH_H
+#define _GRC_BENCH_H        1
 
+/*
+ * The benchmarks are linked against the library objects, not the shared
+ * library, so they may measure its internal functions too.
+ */
 #include "libgrc.h"
 
-struct grc_generic_data *new_grc_generic_data(void)
-{
-    struct grc_generic_data *d = NULL;
-
-    d = calloc(1, sizeof(struct grc_generic_data));
-
-    if (NULL == d)
-        return NULL;
-
-    return d;
-}
-
-void destroy_grc_generic_data(void *a)
-{
-    struct grc_generic_data *p = (struct grc_generic_data *)a;
-
-    if (NULL == a)
-        return;
+/* Size of the generated DIALOGs */
+#define BENCH_WIDTH                 640
+#define BENCH_HEIGHT                480
 
-    free(p);
-}
+/* generator.c */
+bool bench_object_supported(const char *type);
+char *bench_generate_grc(unsigned int count, const char *type,
+                         enum grc_color_depth color_depth);
 
+#endif
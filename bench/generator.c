@@ -0,0 +1,211 @@
+/*
+ * Description: Generates GRCs with many objects of every supported type,
+ *              to be loaded by the benchmarks.
+ *
+ * Author: Rodrigo Freitas
+ * Created at: Mon Oct 19 20:05:41 2026
+ * Project: libgrc benchmarks
+ *
+ * Copyright (c) 2014 Rodrigo Freitas
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301
+ * USA
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "bench.h"
+
+/* Every generated object has the same size */
+#define OBJECT_WIDTH                80
+#define OBJECT_HEIGHT               20
+
+/*
+ * Objects which can't be created only from a GRC. Keys are written in
+ * their own block and 'custom' objects need a procedure given at runtime.
+ */
+bool bench_object_supported(const char *type)
+{
+    switch (tr_str_type_to_grc_type(type)) {
+        case GRC_OBJECT_KEY:
+        case GRC_OBJECT_CUSTOM:
+        case GRC_OBJECT_LIVE_IMAGE:
+        case GRC_OBJECT_MULTLIVE_IMAGE:
+            return false;
+
+        default:
+            break;
+    }
+
+    return true;
+}
+
+/* Properties some objects can't be loaded without */
+static void set_type_properties(grc_t *grc, enum grc_object type,
+    unsigned int index)
+{
+    char text[64];
+
+    switch (type) {
+        case GRC_OBJECT_FIXED_TEXT:
+        case GRC_OBJECT_BUTTON:
+        case GRC_OBJECT_CHECK:
+        case GRC_OBJECT_RADIO:
+            snprintf(text, sizeof(text), "Object %u", index);
+            grc_GRC_set_object_property(grc, GRC_PROPERTY_TEXT, text);
+            break;
+
+        case GRC_OBJECT_EDIT:
+        case GRC_OBJECT_SLIDER:
+            grc_GRC_set_object_property(grc, GRC_PROPERTY_INPUT_LENGTH, 32);
+            break;
+
+        case GRC_OBJECT_TABLE:
+            grc_GRC_set_object_property(grc, GRC_PROPERTY_COLUMNS,
+                                        "Name:40,Value:40:right");
+
+            break;
+
+        default:
+            break;
+    }
+}
+
+static void create_object(grc_t *grc, const char *type, unsigned int index)
+{
+    char tag[128];
+    int t;
+
+    t = tr_str_type_to_grc_type(type);
+    snprintf(tag, sizeof(tag), "%s_%u", type, index);
+
+    grc_GRC_create_object(grc);
+    grc_GRC_set_object_property(grc, GRC_PROPERTY_TYPE, t);
+    grc_GRC_set_object_property(grc, GRC_PROPERTY_TAG, tag);
+    grc_GRC_set_object_property(grc, GRC_PROPERTY_POS_X,
+                                (index * 37) % (BENCH_WIDTH - OBJECT_WIDTH));
+
+    grc_GRC_set_object_property(grc, GRC_PROPERTY_POS_Y,
+                                (index * 23) % (BENCH_HEIGHT - OBJECT_HEIGHT));
+
+    grc_GRC_set_object_property(grc, GRC_PROPERTY_WIDTH, OBJECT_WIDTH);
+    grc_GRC_set_object_property(grc, GRC_PROPERTY_HEIGHT, OBJECT_HEIGHT);
+    set_type_properties(grc, t, index);
+    grc_GRC_finish_object(grc);
+}
+
+static void create_keys(grc_t *grc, unsigned int count)
+{
+    char key[16], name[16];
+    unsigned int i;
+
+    grc_GRC_keys_start(grc);
+
+    for (i = 0; (i < count) && (i < 26); i++) {
+        snprintf(key, sizeof(key), "KEY_%c", 'A' + i);
+        snprintf(name, sizeof(name), "key_%u", i);
+        grc_GRC_add_key(grc, key, name);
+    }
+
+    grc_GRC_keys_finish(grc);
+}
+
+/*
+ * The GRC writer has no way to choose the backend, so it is added as the
+ * first member of the info block.
+ */
+static char *set_memory_backend(const char *data, unsigned int size)
+{
+    const char *info, *backend = "\"" OBJ_BACKEND "\": \"memory\", ";
+    unsigned int n;
+    char *p;
+
+    info = strstr(data, "\"" OBJ_INFO "\"");
+    info = (info != NULL) ? strchr(info, '{') : NULL;
+
+    if (NULL == info)
+        return NULL;
+
+    n = info - data + 1;
+    p = malloc(size + strlen(backend) + 1);
+
+    if (NULL == p)
+        return NULL;
+
+    memcpy(p, data, n);
+    strcpy(p + n, backend);
+    strncat(p, data + n, size - n);
+
+    return p;
+}
+
+/*
+ * Writes a GRC with @count objects of @type, or of every supported type if
+ * it is NULL, drawn by the memory backend. Returns the GRC, which must be
+ * freed by the caller, or NULL on error.
+ */
+char *bench_generate_grc(unsigned int count, const char *type,
+    enum grc_color_depth color_depth)
+{
+    grc_t *grc;
+    const char *name, *data;
+    char *ret = NULL;
+    unsigned int i, k;
+
+    grc = grc_create();
+
+    if (NULL == grc)
+        return NULL;
+
+    if (grc_GRC_stream_to_buffer(grc) < 0)
+        goto end_block;
+
+    grc_GRC_create_info(grc, BENCH_WIDTH, BENCH_HEIGHT, color_depth, false,
+                        false, false);
+
+    grc_GRC_create_colors(grc, GRC_BLACK, GRC_WHITE);
+    grc_GRC_objects_start(grc);
+
+    for (k = 0; (name = str_dlg_object(k)) != NULL; k++) {
+        if ((bench_object_supported(name) == false) ||
+            ((type != NULL) && strcmp(type, name)))
+        {
+            continue;
+        }
+
+        for (i = 0; i < count; i++)
+            create_object(grc, name, i);
+    }
+
+    grc_GRC_objects_finish(grc);
+
+    if (NULL == type)
+        create_keys(grc, count);
+
+    if (grc_GRC_stream_finish(grc) < 0)
+        goto end_block;
+
+    data = grc_GRC_stream_buffer(grc, &i);
+
+    if (data != NULL)
+        ret = set_memory_backend(data, i);
+
+end_block:
+    grc_uninit(grc);
+
+    return ret;
+}
@@ -0,0 +1,93 @@
+/*
+ * Description: Runs a DIALOG without a display, typing into it through the
+ *              injection API and saving what was drawn to a file.
+ *
+ * Author: Rodrigo Freitas
+ * Created at: Mon Oct 19 21:10:52 2026
+ * Project: headless example
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "libgrc.h"
+
+static void type_text(grc_t *grc, const char *text)
+{
+    const char *p;
+
+    for (p = text; *p != '\0'; p++)
+        grc_inject_key(grc, *p, 0);
+}
+
+int main(int argc, char **argv)
+{
+    const char *opt = "f:o:t:\0";
+    int option;
+    char *filename = NULL, *output = NULL, *text = NULL;
+    grc_t *grc = NULL;
+
+    do {
+        option = getopt(argc, argv, opt);
+
+        switch (option) {
+            case 'f':
+                filename = strdup(optarg);
+                break;
+
+            case 'o':
+                output = strdup(optarg);
+                break;
+
+            case 't':
+                text = strdup(optarg);
+                break;
+
+            case '?':
+                return -1;
+        }
+    } while (option != -1);
+
+    grc = grc_init_from_file((filename != NULL) ? filename : "headless.grc",
+                             true);
+
+    if (NULL == grc) {
+        fprintf(stderr, "Error: %s\n", grc_strerror(grc_get_last_error()));
+        goto end_block;
+    }
+
+    grc_prepare_dialog(grc);
+
+    /*
+     * Everything is typed before the DIALOG runs. The ENTER at the end
+     * closes it, since 'edit' objects exit the DIALOG.
+     */
+    type_text(grc, (text != NULL) ? text : "headless");
+    grc_inject_key(grc, '\r', KEY_ENTER);
+
+    if (grc_do_dialog(grc) < 0) {
+        fprintf(stderr, "Error: %s\n", grc_strerror(grc_get_last_error()));
+        goto end_block;
+    }
+
+    printf("Typed: %s\n", grc_edit_get_data(grc, "name"));
+    save_bitmap((output != NULL) ? output : "headless.bmp",
+                grc_get_framebuffer(grc), NULL);
+
+end_block:
+    if (grc != NULL)
+        grc_uninit(grc);
+
+    if (text != NULL)
+        free(text);
+
+    if (output != NULL)
+        free(output);
+
+    if (filename != NULL)
+        free(filename);
+
+    return 0;
+}
@@ -0,0 +1,328 @@
+/*
+ * Description: Reference viewer of a DIALOG streamed by grc_remote_start. It
+ *              rebuilds the screen, may record the stream to play it back
+ *              later, and saves the last screen as a PPM image.
+ *
+ * Author: Rodrigo Freitas
+ * Created at: Mon Oct 19 23:37:40 2026
+ * Project: remote_viewer example
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <stdbool.h>
+#include <unistd.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+
+#define HEADER_SIZE             20
+#define FRAME_HEADER_SIZE       7
+#define RECT_HEADER_SIZE        12
+
+struct viewer {
+    int             fd;
+    int             record_fd;
+    unsigned int    width;
+    unsigned int    height;
+    unsigned int    depth;
+    unsigned int    bpp;
+    unsigned char   *screen;
+    unsigned char   *rect;
+};
+
+static unsigned int get_u16(const unsigned char *p)
+{
+    return p[0] | (p[1] << 8);
+}
+
+static unsigned int get_u32(const unsigned char *p)
+{
+    return p[0] | (p[1] << 8) | (p[2] << 16) | ((unsigned int)p[3] << 24);
+}
+
+/* Reads exactly @n bytes, also writing them to the recording */
+static int read_all(struct viewer *v, void *data, unsigned int n)
+{
+    unsigned char *p = data;
+    unsigned int left = n;
+    ssize_t r;
+
+    while (left > 0) {
+        r = read(v->fd, p, left);
+
+        if (r < 0) {
+            if (errno == EINTR)
+                continue;
+
+            return -1;
+        }
+
+        if (r == 0)
+            return -1;
+
+        p += r;
+        left -= r;
+    }
+
+    if ((v->record_fd >= 0) && (write(v->record_fd, data, n) != (ssize_t)n))
+        return -1;
+
+    return 0;
+}
+
+static int connect_socket(const char *path)
+{
+    struct sockaddr_un addr;
+    int fd;
+
+    fd = socket(AF_UNIX, SOCK_STREAM, 0);
+
+    if (fd < 0)
+        return -1;
+
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    strncpy(addr.sun_path, path, sizeof(addr.sun_path) - 1);
+
+    if (connect(fd, (struct sockaddr *)&addr, sizeof(addr)) < 0) {
+        close(fd);
+        return -1;
+    }
+
+    return fd;
+}
+
+static int read_header(struct viewer *v)
+{
+    unsigned char h[HEADER_SIZE];
+
+    if ((read_all(v, h, sizeof(h)) < 0) || memcmp(h, "GRCR", 4) ||
+        (get_u32(h + 4) != 1))
+    {
+        return -1;
+    }
+
+    v->width = get_u32(h + 8);
+    v->height = get_u32(h + 12);
+    v->depth = get_u32(h + 16);
+    v->bpp = (v->depth + 7) / 8;
+    v->screen = calloc(v->width * v->height, v->bpp);
+
+    return (NULL == v->screen) ? -1 : 0;
+}
+
+/* Copies the runs of a rectangle into the screen */
+static int draw_rect(struct viewer *v, const unsigned char *header)
+{
+    unsigned int x, y, w, h, size, i, px = 0, count;
+    unsigned char *p;
+
+    x = get_u16(header);
+    y = get_u16(header + 2);
+    w = get_u16(header + 4);
+    h = get_u16(header + 6);
+    size = get_u32(header + 8);
+
+    if ((x + w > v->width) || (y + h > v->height))
+        return -1;
+
+    p = realloc(v->rect, size);
+
+    if ((NULL == p) && (size > 0))
+        return -1;
+
+    v->rect = p;
+
+    if (read_all(v, v->rect, size) < 0)
+        return -1;
+
+    for (i = 0; i + 1 + v->bpp <= size; i += 1 + v->bpp) {
+        for (count = v->rect[i]; (count > 0) && (px < w * h); count--, px++)
+            memcpy(v->screen + ((y + px / w) * v->width + x + px % w) * v->bpp,
+                   v->rect + i + 1, v->bpp);
+    }
+
+    return 0;
+}
+
+static void pixel_rgb(const struct viewer *v, const unsigned char *p,
+    unsigned char *rgb)
+{
+    unsigned int c;
+
+    switch (v->depth) {
+        case 15:
+            c = p[0] | (p[1] << 8);
+            rgb[0] = ((c >> 10) & 0x1f) << 3;
+            rgb[1] = ((c >> 5) & 0x1f) << 3;
+            rgb[2] = (c & 0x1f) << 3;
+            break;
+
+        case 16:
+            c = p[0] | (p[1] << 8);
+            rgb[0] = ((c >> 11) & 0x1f) << 3;
+            rgb[1] = ((c >> 5) & 0x3f) << 2;
+            rgb[2] = (c & 0x1f) << 3;
+            break;
+
+        case 24:
+        case 32:
+            rgb[0] = p[2];
+            rgb[1] = p[1];
+            rgb[2] = p[0];
+            break;
+
+        default:
+            /* The palette is not streamed */
+            rgb[0] = rgb[1] = rgb[2] = p[0];
+            break;
+    }
+}
+
+static int save_ppm(const struct viewer *v, const char *path)
+{
+    FILE *f;
+    unsigned int i;
+    unsigned char rgb[3];
+
+    f = fopen(path, "wb");
+
+    if (NULL == f)
+        return -1;
+
+    fprintf(f, "P6\n%u %u\n255\n", v->width, v->height);
+
+    for (i = 0; i < v->width * v->height; i++) {
+        pixel_rgb(v, v->screen + i * v->bpp, rgb);
+        fwrite(rgb, 1, sizeof(rgb), f);
+    }
+
+    fclose(f);
+
+    return 0;
+}
+
+static int read_frame(struct viewer *v, bool verbose)
+{
+    unsigned char f[FRAME_HEADER_SIZE], h[RECT_HEADER_SIZE];
+    unsigned int i, rects;
+
+    if (read_all(v, f, sizeof(f)) < 0)
+        return -1;
+
+    rects = get_u16(f + 5);
+
+    for (i = 0; i < rects; i++)
+        if ((read_all(v, h, sizeof(h)) < 0) || (draw_rect(v, h) < 0))
+            return -1;
+
+    if (verbose) {
+        printf("frame %u: %s, %u rectangles\n", get_u32(f + 1),
+               (f[0] == 1) ? "keyframe" : "delta", rects);
+    }
+
+    return 0;
+}
+
+static void usage(const char *name)
+{
+    fprintf(stderr, "Usage: %s <-s socket | -f recording> [-r recording] "
+                    "[-o image.ppm] [-v]\n", name);
+}
+
+int main(int argc, char **argv)
+{
+    const char *opt = "s:f:r:o:vh\0";
+    int option;
+    char *socket_path = NULL, *input = NULL, *record = NULL, *output = NULL;
+    bool verbose = false;
+    unsigned int frames = 0;
+    struct viewer v;
+
+    memset(&v, 0, sizeof(v));
+    v.fd = -1;
+    v.record_fd = -1;
+
+    do {
+        option = getopt(argc, argv, opt);
+
+        switch (option) {
+            case 's':
+                socket_path = optarg;
+                break;
+
+            case 'f':
+                input = optarg;
+                break;
+
+            case 'r':
+                record = optarg;
+                break;
+
+            case 'o':
+                output = optarg;
+                break;
+
+            case 'v':
+                verbose = true;
+                break;
+
+            case 'h':
+            case '?':
+                usage(argv[0]);
+                return 1;
+        }
+    } while (option != -1);
+
+    if (socket_path != NULL)
+        v.fd = connect_socket(socket_path);
+    else if (input != NULL)
+        v.fd = open(input, O_RDONLY);
+    else {
+        usage(argv[0]);
+        return 1;
+    }
+
+    if (v.fd < 0) {
+        perror((socket_path != NULL) ? socket_path : input);
+        return 1;
+    }
+
+    if (record != NULL) {
+        v.record_fd = open(record, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+
+        if (v.record_fd < 0) {
+            perror(record);
+            return 1;
+        }
+    }
+
+    if (read_header(&v) < 0) {
+        fprintf(stderr, "Error: not a libgrc stream\n");
+        return 1;
+    }
+
+    printf("%ux%u, %u bits\n", v.width, v.height, v.depth);
+
+    /* Until the DIALOG stops streaming or the recording ends */
+    while (read_frame(&v, verbose) == 0)
+        frames++;
+
+    printf("%u frames received\n", frames);
+
+    /* The screen as the last frame left it */
+    if ((output != NULL) && (save_ppm(&v, output) < 0))
+        perror(output);
+
+    if (v.record_fd >= 0)
+        close(v.record_fd);
+
+    close(v.fd);
+    free(v.rect);
+    free(v.screen);
+
+    return 0;
+}
@@ -0,0 +1,76 @@
+/*
+ * Description: Renders the previews of many GRC files at once.
+ *
+ * Author: Rodrigo Freitas
+ * Created at: Mon Oct 19 22:31:05 2026
+ * Project: render_batch example
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <time.h>
+
+#include "libgrc.h"
+
+static void usage(const char *name)
+{
+    fprintf(stderr, "Usage: %s [-o out_dir] [-t threads] file.grc...\n",
+            name);
+}
+
+int main(int argc, char **argv)
+{
+    const char *opt = "o:t:h\0";
+    int option, failed;
+    char *out_dir = NULL;
+    unsigned int threads = 0, n;
+    struct timespec start, end;
+
+    do {
+        option = getopt(argc, argv, opt);
+
+        switch (option) {
+            case 'o':
+                out_dir = strdup(optarg);
+                break;
+
+            case 't':
+                threads = atoi(optarg);
+                break;
+
+            case 'h':
+            case '?':
+                usage(argv[0]);
+                return 1;
+        }
+    } while (option != -1);
+
+    if (optind >= argc) {
+        usage(argv[0]);
+        return 1;
+    }
+
+    n = argc - optind;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+
+    /* 0 threads uses every processor */
+    failed = grc_render_batch((const char **)argv + optind, n,
+                              (out_dir != NULL) ? out_dir : ".", threads);
+
+    clock_gettime(CLOCK_MONOTONIC, &end);
+
+    if (failed < 0)
+        fprintf(stderr, "Error: %s\n", grc_strerror(grc_get_last_error()));
+    else {
+        printf("%u GRCs rendered, %d failed, in %.3f s\n", n - failed, failed,
+               (end.tv_sec - start.tv_sec) +
+               (end.tv_nsec - start.tv_nsec) / 1e9);
+    }
+
+    if (out_dir != NULL)
+        free(out_dir);
+
+    return (failed != 0) ? 1 : 0;
+}
@@ -0,0 +1,108 @@
+/*
+ * Description: Opens several DIALOGs in a row, with and without a session,
+ *              printing the time each one takes to draw its first frame.
+ *
+ * Author: Rodrigo Freitas
+ * Created at: Mon Oct 19 16:10:44 2026
+ * Project: session example
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <time.h>
+
+#include "libgrc.h"
+
+#define DIALOGS             5
+
+static double elapsed(struct timespec *start)
+{
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
+    return (now.tv_sec - start->tv_sec) +
+           (now.tv_nsec - start->tv_nsec) / 1e9;
+}
+
+/*
+ * Loads a DIALOG and draws its objects once, without a DIALOG player, so
+ * only the time until the first frame is measured.
+ */
+static int first_frame(const char *filename, double *t)
+{
+    struct timespec start;
+    grc_t *grc;
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    grc = grc_init_from_file(filename, true);
+
+    if (NULL == grc)
+        return -1;
+
+    grc_prepare_dialog(grc);
+    grc_object_send_message(grc, "background", MSG_DRAW, 0);
+    grc_object_send_message(grc, "title", MSG_DRAW, 0);
+    *t = elapsed(&start);
+    grc_uninit(grc);
+
+    return 0;
+}
+
+static int run(const char *name, const char *filename, bool session)
+{
+    double t;
+    int i;
+
+    if (session == true)
+        grc_session_begin();
+
+    for (i = 0; i < DIALOGS; i++) {
+        if (first_frame(filename, &t) < 0) {
+            fprintf(stderr, "Error: %s\n",
+                    grc_strerror(grc_get_last_error()));
+
+            break;
+        }
+
+        printf("%-10s dialog %d %10.3f ms\n", name, i + 1, t * 1000);
+    }
+
+    if (session == true)
+        grc_session_end();
+
+    return (i == DIALOGS) ? 0 : -1;
+}
+
+int main(int argc, char **argv)
+{
+    const char *opt = "f:\0";
+    int option;
+    char *filename = NULL;
+
+    do {
+        option = getopt(argc, argv, opt);
+
+        switch (option) {
+            case 'f':
+                filename = strdup(optarg);
+                break;
+
+            case '?':
+                return -1;
+        }
+    } while (option != -1);
+
+    if (run("alone", (filename != NULL) ? filename : "session.grc",
+            false) == 0)
+    {
+        run("session", (filename != NULL) ? filename : "session.grc", true);
+    }
+
+    if (filename != NULL)
+        free(filename);
+
+    return 0;
+}
@@ -0,0 +1,143 @@
+/*
+ * Description: Watches the statistics a DIALOG publishes with
+ *              grc_stats_publish, printing them every second. It doesn't
+ *              need the library, only its grc/grc_stats.h header.
+ *
+ * Author: Rodrigo Freitas
+ * Created at: Tue Oct 20 01:12:09 2026
+ * Project: stats_monitor example
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "grc/grc_stats.h"
+
+static const struct grc_stats *map_stats(const char *name)
+{
+    struct grc_stats *page;
+    struct stat st;
+    int fd;
+
+    fd = shm_open(name, O_RDONLY, 0);
+
+    if (fd < 0) {
+        perror(name);
+        return NULL;
+    }
+
+    if ((fstat(fd, &st) < 0) || (st.st_size < (off_t)sizeof(*page))) {
+        fprintf(stderr, "Error: %s is not a libgrc statistics page\n", name);
+        close(fd);
+        return NULL;
+    }
+
+    page = mmap(NULL, sizeof(*page), PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+
+    if (MAP_FAILED == page) {
+        perror("mmap");
+        return NULL;
+    }
+
+    if ((page->magic != GRC_STATS_MAGIC) ||
+        (page->version < GRC_STATS_VERSION))
+    {
+        fprintf(stderr, "Error: unsupported statistics page\n");
+        munmap(page, sizeof(*page));
+        return NULL;
+    }
+
+    return page;
+}
+
+/* Copies the page while it's not being written */
+static void read_stats(const struct grc_stats *page, struct grc_stats *copy)
+{
+    uint32_t seq;
+
+    do {
+        seq = __atomic_load_n(&page->sequence, __ATOMIC_ACQUIRE);
+        memcpy(copy, page, sizeof(*copy));
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+    } while ((seq & 1) ||
+             (seq != __atomic_load_n(&page->sequence, __ATOMIC_RELAXED)));
+}
+
+static void usage(const char *name)
+{
+    fprintf(stderr, "Usage: %s <-n name> [-c count]\n", name);
+}
+
+int main(int argc, char **argv)
+{
+    const char *opt = "n:c:h\0";
+    int option, count = -1;
+    char *name = NULL;
+    const struct grc_stats *page;
+    struct grc_stats s, last;
+
+    do {
+        option = getopt(argc, argv, opt);
+
+        switch (option) {
+            case 'n':
+                name = optarg;
+                break;
+
+            case 'c':
+                count = atoi(optarg);
+                break;
+
+            case 'h':
+            case '?':
+                usage(argv[0]);
+                return 1;
+        }
+    } while (option != -1);
+
+    if (NULL == name) {
+        usage(argv[0]);
+        return 1;
+    }
+
+    page = map_stats(name);
+
+    if (NULL == page)
+        return 1;
+
+    read_stats(page, &last);
+    printf("pid %d, %u objects\n", last.pid, last.objects);
+
+    while (count != 0) {
+        sleep(1);
+        read_stats(page, &s);
+
+        printf("%llu frames/s, avg %llu us, max %llu us, %llu pixels, "
+               "%llu callbacks, %llu/%llu log lines, %llu KB\n",
+               (unsigned long long)(s.frames - last.frames),
+               (unsigned long long)s.avg_frame_time,
+               (unsigned long long)s.max_frame_time,
+               (unsigned long long)(s.redraw_area - last.redraw_area),
+               (unsigned long long)(s.callbacks - last.callbacks),
+               (unsigned long long)(s.log_lines_dropped -
+                                    last.log_lines_dropped),
+               (unsigned long long)(s.log_lines_queued -
+                                    last.log_lines_queued),
+               (unsigned long long)s.arena_memory / 1024);
+
+        last = s;
+
+        if (count > 0)
+            count--;
+    }
+
+    munmap((void *)page, sizeof(*page));
+
+    return 0;
+}
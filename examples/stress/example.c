@@ -0,0 +1,195 @@
+/*
+ * Description: Loads, draws and frees many DIALOGs at the same time, from
+ *              several threads, to find races inside the library.
+ *
+ * Author: Rodrigo Freitas
+ * Created at: Mon Oct 19 21:46:18 2026
+ * Project: stress example
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <pthread.h>
+
+#include "libgrc.h"
+
+#define DEFAULT_THREADS         8
+#define DEFAULT_ITERATIONS      50
+
+struct worker {
+    pthread_t       thread;
+    unsigned int    id;
+    unsigned int    iterations;
+    const char      *data;
+
+    /* Results */
+    unsigned int    errors;
+    int             last_error;
+};
+
+static char *load_file(const char *filename)
+{
+    FILE *f;
+    long size;
+    char *data = NULL;
+
+    f = fopen(filename, "r");
+
+    if (NULL == f)
+        return NULL;
+
+    fseek(f, 0, SEEK_END);
+    size = ftell(f);
+    fseek(f, 0, SEEK_SET);
+    data = calloc(size + 1, sizeof(char));
+
+    if ((data != NULL) && (fread(data, 1, size, f) != (size_t)size)) {
+        free(data);
+        data = NULL;
+    }
+
+    fclose(f);
+
+    return data;
+}
+
+static void worker_error(struct worker *w)
+{
+    w->errors++;
+    w->last_error = grc_get_last_error();
+}
+
+static int run_once(struct worker *w, unsigned int iteration)
+{
+    grc_t *grc;
+    char msg[128];
+    int ret = -1;
+
+    grc = grc_init_from_mem(w->data, true);
+
+    if (NULL == grc)
+        return -1;
+
+    if (grc_prepare_dialog(grc) < 0)
+        goto end_block;
+
+    snprintf(msg, sizeof(msg), "Thread %u, iteration %u", w->id, iteration);
+
+    if ((grc_log(grc, "log", msg, NULL) < 0) ||
+        (grc_inject_mouse(grc, w->id, iteration, 0, 0) < 0) ||
+        (grc_render(grc) < 0) || (grc_get_framebuffer(grc) == NULL))
+    {
+        goto end_block;
+    }
+
+    /* Errors belong to the thread which caused them */
+    if ((grc_log(grc, "not_an_object", msg, NULL) == 0) ||
+        (grc_get_last_error() == 0))
+    {
+        goto end_block;
+    }
+
+    ret = 0;
+
+end_block:
+    grc_uninit(grc);
+
+    return ret;
+}
+
+static void *worker(void *arg)
+{
+    struct worker *w = (struct worker *)arg;
+    unsigned int i;
+
+    for (i = 0; i < w->iterations; i++)
+        if (run_once(w, i) < 0)
+            worker_error(w);
+
+    return NULL;
+}
+
+int main(int argc, char **argv)
+{
+    const char *opt = "f:t:n:\0";
+    int option, ret = 1;
+    char *filename = NULL, *data = NULL;
+    unsigned int i, n_threads = DEFAULT_THREADS, errors = 0,
+                 iterations = DEFAULT_ITERATIONS;
+    struct worker *workers = NULL;
+
+    do {
+        option = getopt(argc, argv, opt);
+
+        switch (option) {
+            case 'f':
+                filename = strdup(optarg);
+                break;
+
+            case 't':
+                n_threads = atoi(optarg);
+                break;
+
+            case 'n':
+                iterations = atoi(optarg);
+                break;
+
+            case '?':
+                return -1;
+        }
+    } while (option != -1);
+
+    data = load_file((filename != NULL) ? filename : "stress.grc");
+
+    if (NULL == data) {
+        fprintf(stderr, "Error: could not read the GRC\n");
+        goto end_block;
+    }
+
+    workers = calloc(n_threads, sizeof(struct worker));
+
+    if (NULL == workers)
+        goto end_block;
+
+    /* Allegro stays installed while the threads load their DIALOGs */
+    grc_session_begin();
+
+    for (i = 0; i < n_threads; i++) {
+        workers[i].id = i;
+        workers[i].iterations = iterations;
+        workers[i].data = data;
+        pthread_create(&workers[i].thread, NULL, worker, &workers[i]);
+    }
+
+    for (i = 0; i < n_threads; i++) {
+        pthread_join(workers[i].thread, NULL);
+
+        if (workers[i].errors > 0) {
+            printf("Thread %u: %u errors, last one: %s\n", i,
+                   workers[i].errors, grc_strerror(workers[i].last_error));
+        }
+
+        errors += workers[i].errors;
+    }
+
+    grc_session_end();
+    printf("%u threads, %u DIALOGs each, %u errors\n", n_threads, iterations,
+           errors);
+
+    ret = (errors > 0) ? 1 : 0;
+
+end_block:
+    if (workers != NULL)
+        free(workers);
+
+    if (data != NULL)
+        free(data);
+
+    if (filename != NULL)
+        free(filename);
+
+    return ret;
+}
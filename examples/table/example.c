@@ -0,0 +1,138 @@
+/*
+ * Description: Scrolls through a table with 100k rows and 20 columns and
+ *              updates some of its cells, printing how long it took.
+ *
+ * Author: Rodrigo Freitas
+ * Created at: Mon Oct 19 11:58:09 2026
+ * Project: table example
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <time.h>
+
+#include "libgrc.h"
+
+#define TOTAL_ROWS          100000
+#define TOTAL_COLUMNS       20
+#define UPDATES             100000
+
+static int rows_count(void *arg __attribute__((unused)))
+{
+    return TOTAL_ROWS;
+}
+
+static int cell_content(void *arg, int row, int column, char *buf, int size)
+{
+    unsigned int *version = arg;
+
+    snprintf(buf, size, "%d.%d.%u", row, column, *version);
+
+    return 0;
+}
+
+static double elapsed(struct timespec *start)
+{
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
+    return (now.tv_sec - start->tv_sec) +
+           (now.tv_nsec - start->tv_nsec) / 1e9;
+}
+
+static void scroll(grc_t *grc, const char *name, int key, int n)
+{
+    struct timespec start;
+    int i;
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+
+    for (i = 0; i < n; i++)
+        grc_object_send_message(grc, "book", MSG_CHAR, key << 8);
+
+    printf("%-10s %8d steps %10.3f s\n", name, n, elapsed(&start));
+}
+
+/* Changes a single visible cell at a time, like an order book does */
+static void update_cells(grc_t *grc, unsigned int *version)
+{
+    struct timespec start;
+    int i;
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+
+    for (i = 0; i < UPDATES; i++) {
+        (*version)++;
+        grc_table_update_cell(grc, "book", i % 10, 2 + (i % 3));
+        grc_object_send_message(grc, "book", MSG_IDLE, 0);
+    }
+
+    printf("%-10s %8d cells %10.3f s\n", "update", UPDATES,
+           elapsed(&start));
+}
+
+int main(int argc, char **argv)
+{
+    const char *opt = "f:\0";
+    int option;
+    char *filename = NULL;
+    struct al_grc *grc = NULL;
+    unsigned int version = 0;
+    struct grc_table_source source = {
+        .count = rows_count,
+        .cell = cell_content,
+        .arg = &version,
+    };
+
+    do {
+        option = getopt(argc, argv, opt);
+
+        switch (option) {
+            case 'f':
+                filename = strdup(optarg);
+                break;
+
+            case '?':
+                return -1;
+        }
+    } while (option != -1);
+
+    grc = grc_init_from_file((filename != NULL) ? filename : "table.grc",
+                             true);
+
+    if (NULL == grc) {
+        fprintf(stderr, "Error: %s\n", grc_strerror(grc_get_last_error()));
+        goto end_block;
+    }
+
+    grc_prepare_dialog(grc);
+
+    if (grc_table_set_source(grc, "book", &source) < 0) {
+        fprintf(stderr, "Error: %s\n", grc_strerror(grc_get_last_error()));
+        goto end_block;
+    }
+
+    /* Runs the table without a DIALOG player, so only it is measured */
+    grc_object_send_message(grc, "book", MSG_START, 0);
+    grc_object_send_message(grc, "book", MSG_DRAW, 0);
+
+    scroll(grc, "KEY_DOWN", KEY_DOWN, TOTAL_ROWS);
+    scroll(grc, "KEY_PGUP", KEY_PGUP, TOTAL_ROWS / 10);
+    scroll(grc, "KEY_RIGHT", KEY_RIGHT, TOTAL_COLUMNS);
+    scroll(grc, "KEY_LEFT", KEY_LEFT, TOTAL_COLUMNS);
+    update_cells(grc, &version);
+
+    grc_object_send_message(grc, "book", MSG_END, 0);
+
+end_block:
+    if (grc != NULL)
+        grc_uninit(grc);
+
+    if (filename != NULL)
+        free(filename);
+
+    return 0;
+}
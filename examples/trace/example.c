@@ -0,0 +1,102 @@
+/*
+ * Description: Records the input given to a DIALOG into a trace file, or
+ *              replays one printing the time of each frame.
+ *
+ * Author: Rodrigo Freitas
+ * Created at: Mon Oct 19 19:40:06 2026
+ * Project: trace example
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+
+#include "libgrc.h"
+
+static int ok_callback(grc_callback_data_t *acd __attribute__((unused)))
+{
+    return D_CLOSE;
+}
+
+static void usage(const char *name)
+{
+    fprintf(stderr, "Usage: %s [-f file.grc] -r trace | -p trace\n", name);
+}
+
+int main(int argc, char **argv)
+{
+    const char *opt = "f:r:p:\0";
+    int option, fd, ret = -1;
+    char *filename = NULL, *trace = NULL;
+    bool replay = false;
+    grc_t *grc = NULL;
+
+    do {
+        option = getopt(argc, argv, opt);
+
+        switch (option) {
+            case 'f':
+                filename = strdup(optarg);
+                break;
+
+            case 'r':
+            case 'p':
+                trace = strdup(optarg);
+                replay = (option == 'p');
+                break;
+
+            case '?':
+                return -1;
+        }
+    } while (option != -1);
+
+    if (NULL == trace) {
+        usage(argv[0]);
+        goto end_block;
+    }
+
+    if (replay == true)
+        fd = open(trace, O_RDONLY);
+    else
+        fd = open(trace, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+
+    if (fd < 0) {
+        perror(trace);
+        goto end_block;
+    }
+
+    grc = grc_init_from_file((filename != NULL) ? filename : "trace.grc",
+                             true);
+
+    if (NULL == grc) {
+        fprintf(stderr, "Error: %s\n", grc_strerror(grc_get_last_error()));
+        close(fd);
+        goto end_block;
+    }
+
+    grc_set_callback(grc, "ok", ok_callback, NULL);
+    grc_prepare_dialog(grc);
+
+    if (replay == true)
+        ret = grc_trace_replay(grc, fd, STDOUT_FILENO);
+    else
+        ret = grc_trace_record(grc, fd);
+
+    if (ret < 0)
+        fprintf(stderr, "Error: %s\n", grc_strerror(grc_get_last_error()));
+
+    close(fd);
+    grc_uninit(grc);
+
+end_block:
+    if (trace != NULL)
+        free(trace);
+
+    if (filename != NULL)
+        free(filename);
+
+    /* A replay fails when any frame diverged */
+    return (ret == 0) ? 0 : 1;
+}
@@ -0,0 +1,117 @@
+/*
+ * Description: Scrolls through a virtual list with one million rows and
+ *              prints how long it took.
+ *
+ * Author: Rodrigo Freitas
+ * Created at: Mon Oct 19 10:52:31 2026
+ * Project: virtual_list example
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <time.h>
+
+#include "libgrc.h"
+
+#define TOTAL_ROWS          1000000
+
+static int rows_count(void *arg __attribute__((unused)))
+{
+    return TOTAL_ROWS;
+}
+
+static int rows_fetch(void *arg __attribute__((unused)), int first, int n,
+    char **rows, int row_size)
+{
+    int i;
+
+    for (i = 0; i < n; i++)
+        snprintf(rows[i], row_size, "Row %d", first + i);
+
+    return n;
+}
+
+static double elapsed(struct timespec *start)
+{
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
+    return (now.tv_sec - start->tv_sec) +
+           (now.tv_nsec - start->tv_nsec) / 1e9;
+}
+
+static void scroll(grc_t *grc, const char *name, int key, int n)
+{
+    struct timespec start;
+    int i;
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+
+    for (i = 0; i < n; i++)
+        grc_object_send_message(grc, "rows", MSG_CHAR, key << 8);
+
+    printf("%-10s %8d steps %10.3f s\n", name, n, elapsed(&start));
+}
+
+int main(int argc, char **argv)
+{
+    const char *opt = "f:\0";
+    int option;
+    char *filename = NULL;
+    struct al_grc *grc = NULL;
+    struct grc_list_source source = {
+        .count = rows_count,
+        .fetch = rows_fetch,
+        .arg = NULL,
+    };
+
+    do {
+        option = getopt(argc, argv, opt);
+
+        switch (option) {
+            case 'f':
+                filename = strdup(optarg);
+                break;
+
+            case '?':
+                return -1;
+        }
+    } while (option != -1);
+
+    grc = grc_init_from_file((filename != NULL) ? filename : "list.grc",
+                             true);
+
+    if (NULL == grc) {
+        fprintf(stderr, "Error: %s\n", grc_strerror(grc_get_last_error()));
+        goto end_block;
+    }
+
+    grc_prepare_dialog(grc);
+
+    if (grc_list_set_source(grc, "rows", &source) < 0) {
+        fprintf(stderr, "Error: %s\n", grc_strerror(grc_get_last_error()));
+        goto end_block;
+    }
+
+    /* Runs the list without a DIALOG player, so only the list is measured */
+    grc_object_send_message(grc, "rows", MSG_START, 0);
+    grc_object_send_message(grc, "rows", MSG_DRAW, 0);
+
+    scroll(grc, "KEY_DOWN", KEY_DOWN, 100000);
+    scroll(grc, "KEY_PGDN", KEY_PGDN, TOTAL_ROWS / 10);
+    scroll(grc, "KEY_PGUP", KEY_PGUP, TOTAL_ROWS / 10);
+
+    grc_object_send_message(grc, "rows", MSG_END, 0);
+
+end_block:
+    if (grc != NULL)
+        grc_uninit(grc);
+
+    if (filename != NULL)
+        free(filename);
+
+    return 0;
+}
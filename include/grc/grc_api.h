@@ -70,6 +70,42 @@ grc_t *grc_init_from_file(const char *grc_file, bool gfx);
  */
 grc_t *grc_init_from_mem(const char *data, bool gfx);
 
+/**
+ * @name grc_init_from_file_flags
+ * @brief Initialize library environment and Allegro, with options.
+ *
+ * It's like grc_init_from_file, with options from 'enum grc_init_flag'.
+ * With GRC_INIT_RELEASE_JSON the strings of the objects are copied into a
+ * single table and the GRC JSON is released once it is parsed, which
+ * saves memory with large GRCs. The grc_GRC_ functions can't be used with
+ * it then.
+ *
+ * @param [in] grc_file: Complete path of the GRC file which will be loaded.
+ * @param [in] gfx: Flag to initialize internal Allegro gfx routines.
+ * @param [in] flags: Options, combined with '|'.
+ *
+ * @return Returns a 'grc_t' to handle UI calls on success or NULL
+ *         otherwise.
+ */
+grc_t *grc_init_from_file_flags(const char *grc_file, bool gfx,
+                                unsigned int flags);
+
+/**
+ * @name grc_init_from_mem_flags
+ * @brief Initialize library environment and Allegro, with options.
+ *
+ * It's like grc_init_from_mem, with the options of grc_init_from_file_flags.
+ *
+ * @param [in] data: The buffer containing a previously loaded GRC file.
+ * @param [in] gfx: Flag to initialize internal Allegro gfx routines.
+ * @param [in] flags: Options, combined with '|'.
+ *
+ * @return Returns a 'grc_t' to handle UI calls on success or NULL
+ *         otherwise.
+ */
+grc_t *grc_init_from_mem_flags(const char *data, bool gfx,
+                               unsigned int flags);
+
 /**
  * @name grc_create
  * @brief Initialize library environment to create UI in runtime.
@@ -113,6 +149,11 @@ int grc_uninit(grc_t *grc);
  * use the DIALOG defined in a previously loaded GRC file. All custom
  * adjustments required by the user must happen before a call to it.
  *
+ * The screen is shared by every DIALOG, so it fails with
+ * GRC_ERROR_GFX_MODE_IN_USE while another prepared one, not released yet,
+ * uses a different resolution or color depth. DIALOGs of the memory
+ * backend have their own framebuffers and may differ.
+ *
  * @param [in] grc: Previously created UI structure.
  *
  * @return On success returns 0 or -1 otherwise.
@@ -232,6 +273,10 @@ int grc_object_set_proc(grc_t *grc, const char *object_name,
  * @name grc_object_send_message
  * @brief Send a message to an object.
  *
+ * The message is sent at once, so it fails if another thread is using
+ * Allegro, as when the DIALOG is running in it. A callback of the DIALOG
+ * may always send it.
+ *
  * @param [in] grc: Previously created UI structure.
  * @param [in] object_name: The object name.
  * @param [in] msg: Sended message.
@@ -247,6 +292,10 @@ int grc_object_send_message(grc_t *grc, const char *object_name,
  * @name grc_object_get_data
  * @brief Get current value from specific objects.
  *
+ * The text of an object can't be read while another thread is using
+ * Allegro, as when the DIALOG is running in it, and it fails with
+ * GRC_ERROR_GUI_BUSY. A callback of the DIALOG may always read it.
+ *
  * @param [in] grc: Previously created UI structure.
  * @param [in] object_name: The object name.
  * @param [in] member: Object data type which will be initialized.
@@ -342,5 +391,801 @@ int grc_radio_get_status(grc_t *grc, const char *object_name);
  */
 char *grc_edit_get_data(grc_t *grc, const char *object_name);
 
-#endif
+/*
+ * Data source of a 'list' object in virtual mode.
+ *
+ * @count must return the total number of rows. It is only called when the
+ * object starts and by grc_list_refresh.
+ *
+ * @fetch must copy @n rows, starting at @first, to @rows, whose entries
+ * have @row_size bytes each, and return the number of copied rows. If the
+ * rows are not available yet it may return 0 and deliver them later with
+ * grc_list_set_rows. Until then they are displayed as placeholders.
+ */
+struct grc_list_source {
+    int     (*count)(void *arg);
+    int     (*fetch)(void *arg, int first, int n, char **rows,
+                     int row_size);
+
+    void    *arg;
+};
+
+/*
+ * Data source of a 'table' object.
+ *
+ * @count must return the total number of rows. It is only called when the
+ * object starts and by grc_table_refresh.
+ *
+ * @cell must copy the content of a cell to @buf, with at most @size bytes,
+ * and return 0, or -1 to leave the cell empty. It is only called for the
+ * visible cells.
+ */
+struct grc_table_source {
+    int     (*count)(void *arg);
+    int     (*cell)(void *arg, int row, int column, char *buf, int size);
+
+    void    *arg;
+};
+
+/* An object state read by grc_batch_get_states */
+struct grc_object_state {
+    const char              *tag;       /** The object name */
+    enum grc_object_member  member;     /** Which state to read */
+    int                     value;      /** The state, filled by the library */
+};
+
+/**
+ * @name grc_batch_begin
+ * @brief Starts a batch of object changes.
+ *
+ * Every change made with the 'grc_batch_' functions is kept until a call to
+ * grc_batch_commit, which applies all of them and redraws each changed
+ * object only once.
+ *
+ * @param [in] grc: Previously created UI structure.
+ *
+ * @return On success returns 0 or -1 otherwise.
+ */
+int grc_batch_begin(grc_t *grc);
+
+/**
+ * @name grc_batch_set_data
+ * @brief Adds an object member change to the current batch.
+ *
+ * It accepts the same members and values as grc_object_set_data.
+ *
+ * @param [in] grc: Previously created UI structure.
+ * @param [in] object_name: The object name.
+ * @param [in] member: Object data type which will be changed.
+ * @param [in] data: Value which will be assigned to the object member.
+ *
+ * @return On success returns 0 or -1 otherwise.
+ */
+int grc_batch_set_data(grc_t *grc, const char *object_name,
+                       enum grc_object_member member, void *data);
+
+/**
+ * @name grc_batch_hide
+ * @brief Adds an object hiding to the current batch.
+ *
+ * @param [in] grc: Previously created UI structure.
+ * @param [in] object_name: The object name.
+ *
+ * @return On success returns 0 or -1 otherwise.
+ */
+int grc_batch_hide(grc_t *grc, const char *object_name);
+
+/**
+ * @name grc_batch_show
+ * @brief Adds an object showing to the current batch.
+ *
+ * @param [in] grc: Previously created UI structure.
+ * @param [in] object_name: The object name.
+ *
+ * @return On success returns 0 or -1 otherwise.
+ */
+int grc_batch_show(grc_t *grc, const char *object_name);
 
+/**
+ * @name grc_batch_commit
+ * @brief Applies all changes from the current batch.
+ *
+ * Every changed object is redrawn once, in a single pass. If an object was
+ * hidden by the batch the whole DIALOG is redrawn.
+ *
+ * @param [in] grc: Previously created UI structure.
+ *
+ * @return On success returns 0 or -1 otherwise.
+ */
+int grc_batch_commit(grc_t *grc);
+
+/**
+ * @name grc_batch_cancel
+ * @brief Discards all changes from the current batch.
+ *
+ * @param [in] grc: Previously created UI structure.
+ *
+ * @return On success returns 0 or -1 otherwise.
+ */
+int grc_batch_cancel(grc_t *grc);
+
+/**
+ * @name grc_batch_get_states
+ * @brief Reads the state of several objects at once.
+ *
+ * Each entry of \a states must have its object name and member filled by
+ * the caller. Supported members are the checkbox and radio states, the
+ * slider position and limit and the list position. Entries that could not
+ * be read have their value set to -1.
+ *
+ * @param [in] grc: Previously created UI structure.
+ * @param [in,out] states: Array of states to be read.
+ * @param [in] n: Number of entries inside \a states.
+ *
+ * @return On success returns the number of states read or -1 otherwise.
+ */
+int grc_batch_get_states(grc_t *grc, struct grc_object_state *states,
+                         unsigned int n);
+
+/**
+ * @name grc_list_set_source
+ * @brief Sets the data source of a 'list' object in virtual mode.
+ *
+ * A 'list' object is in virtual mode when it has the "virtual" property
+ * enabled inside the GRC. Its rows are fetched in blocks and only the
+ * visible ones are drawn, so it can hold millions of rows.
+ *
+ * @param [in] grc: Previously created UI structure.
+ * @param [in] object_name: The object name.
+ * @param [in] source: The data source. Its content is copied.
+ *
+ * @return On success returns 0 or -1 otherwise.
+ */
+int grc_list_set_source(grc_t *grc, const char *object_name,
+                        const struct grc_list_source *source);
+
+/**
+ * @name grc_list_set_rows
+ * @brief Delivers rows previously requested by a virtual list.
+ *
+ * This function may be called from any thread. The rows are copied and
+ * drawn at once or, if the DIALOG is running in another thread, the next
+ * time it is idle.
+ *
+ * @param [in] grc: Previously created UI structure.
+ * @param [in] object_name: The object name.
+ * @param [in] first: Index of the first delivered row.
+ * @param [in] n: Number of rows inside \a rows.
+ * @param [in] rows: The rows content.
+ *
+ * @return On success returns 0 or -1 otherwise.
+ */
+int grc_list_set_rows(grc_t *grc, const char *object_name, int first, int n,
+                      const char **rows);
+
+/**
+ * @name grc_list_refresh
+ * @brief Discards every cached row from a virtual list.
+ *
+ * The number of rows is requested again to the data source. If the DIALOG
+ * is running in another thread this is done the next time it is idle.
+ *
+ * @param [in] grc: Previously created UI structure.
+ * @param [in] object_name: The object name.
+ *
+ * @return On success returns 0 or -1 otherwise.
+ */
+int grc_list_refresh(grc_t *grc, const char *object_name);
+
+/**
+ * @name grc_table_set_source
+ * @brief Sets the data source of a 'table' object.
+ *
+ * The table columns are defined by its "columns" property inside the GRC,
+ * in the "title:width:align,..." format. Columns without a width share the
+ * remaining space. The selected row may be read with
+ * grc_list_get_selected_index.
+ *
+ * @param [in] grc: Previously created UI structure.
+ * @param [in] object_name: The object name.
+ * @param [in] source: The data source. Its content is copied.
+ *
+ * @return On success returns 0 or -1 otherwise.
+ */
+int grc_table_set_source(grc_t *grc, const char *object_name,
+                         const struct grc_table_source *source);
+
+/**
+ * @name grc_table_update_cell
+ * @brief Tells a 'table' object that a cell content has changed.
+ *
+ * This function may be called from any thread. If the cell is visible it
+ * is requested again and redrawn, alone, at once or, if the DIALOG is
+ * running in another thread, the next time it is idle.
+ *
+ * @param [in] grc: Previously created UI structure.
+ * @param [in] object_name: The object name.
+ * @param [in] row: The cell row.
+ * @param [in] column: The cell column.
+ *
+ * @return On success returns 0 or -1 otherwise.
+ */
+int grc_table_update_cell(grc_t *grc, const char *object_name, int row,
+                          int column);
+
+/**
+ * @name grc_table_refresh
+ * @brief Requests again the number of rows and every visible cell of a
+ *        'table' object.
+ *
+ * If the DIALOG is running in another thread this is done the next time it
+ * is idle.
+ *
+ * @param [in] grc: Previously created UI structure.
+ * @param [in] object_name: The object name.
+ *
+ * @return On success returns 0 or -1 otherwise.
+ */
+int grc_table_refresh(grc_t *grc, const char *object_name);
+
+/**
+ * @name grc_textbox_append
+ * @brief Appends text to a 'textbox' object.
+ *
+ * Only the last line of the current content is wrapped again. If the object
+ * was showing the end of its text it keeps showing it. After the first call
+ * the object keeps its own copy of the text, so the pointer previously given
+ * with grc_object_set_data is no longer used. If the DIALOG is running in
+ * another thread the text is appended the next time it is idle.
+ *
+ * @param [in] grc: Previously created UI structure.
+ * @param [in] object_name: The object name.
+ * @param [in] text: The text to be appended.
+ *
+ * @return On success returns 0 or -1 otherwise.
+ */
+int grc_textbox_append(grc_t *grc, const char *object_name, const char *text);
+
+/**
+ * @name grc_state_save
+ * @brief Saves the state of the DIALOG objects into a binary snapshot.
+ *
+ * Only what the user can change is saved: 'edit' and 'textbox' contents,
+ * 'check_box' and 'radio' states, 'slider' positions, list selections and
+ * the 'messages_log_box' lines. Objects are identified by their tags.
+ *
+ * The objects can't be read while another thread is using Allegro, as when
+ * the DIALOG is running in it, and it fails with GRC_ERROR_GUI_BUSY. A
+ * callback of the DIALOG may always save them.
+ *
+ * @param [in] grc: Previously created UI structure.
+ * @param [in] fd: An opened file descriptor.
+ *
+ * @return On success returns 0 or -1 otherwise.
+ */
+int grc_state_save(grc_t *grc, int fd);
+
+/**
+ * @name grc_state_restore
+ * @brief Restores the state of the DIALOG objects from a snapshot created
+ *        with grc_state_save.
+ *
+ * Saved objects which no longer exist are ignored. If the DIALOG is already
+ * prepared it is redrawn. As grc_state_save, it fails with
+ * GRC_ERROR_GUI_BUSY while another thread is using Allegro.
+ *
+ * @param [in] grc: Previously created UI structure.
+ * @param [in] fd: An opened file descriptor.
+ *
+ * @return On success returns 0 or -1 otherwise.
+ */
+int grc_state_restore(grc_t *grc, int fd);
+
+/**
+ * @name grc_session_begin
+ * @brief Keeps Allegro initialized between DIALOGs.
+ *
+ * Allegro and the graphic mode are shared by every loaded GRC and are only
+ * finished when the last one is released. While a session is open they are
+ * kept even after that, so the next DIALOG asking for the same resolution
+ * and color depth doesn't need to initialize them again. A DIALOG asking
+ * for another one changes it, once no other DIALOG is using it.
+ *
+ * @return On success returns 0 or -1 otherwise.
+ */
+int grc_session_begin(void);
+
+/**
+ * @name grc_session_end
+ * @brief Ends a session started with grc_session_begin.
+ *
+ * If no DIALOG is using Allegro it is finished here.
+ *
+ * @return On success returns 0 or -1 otherwise.
+ */
+int grc_session_end(void);
+
+/**
+ * @name grc_popup_run
+ * @brief Runs a DIALOG as a modal popup over another one.
+ *
+ * The screen region under the popup objects is saved before it is drawn
+ * and put back with a single blit when it closes, so the parent DIALOG does
+ * not need to be redrawn. While the popup runs, parent objects outside of
+ * this region keep receiving MSG_IDLE. A callback which opens a popup should
+ * return D_O_K, not D_REDRAW.
+ *
+ * Both DIALOGs must be prepared with grc_prepare_dialog.
+ *
+ * @param [in] parent: The running DIALOG.
+ * @param [in] popup: The popup DIALOG.
+ *
+ * @return On success returns 0 or -1 otherwise.
+ */
+int grc_popup_run(grc_t *parent, grc_t *popup);
+
+/**
+ * @name grc_layout_set_area
+ * @brief Changes the screen area where the DIALOG objects are placed.
+ *
+ * Objects anchored to the screen, or sized by percentages of it, are placed
+ * again, along with their children. Objects at absolute positions are left
+ * untouched.
+ *
+ * @param [in,out] grc: The grc_t object.
+ * @param [in] width: The new area width.
+ * @param [in] height: The new area height.
+ *
+ * @return On success returns 0 or -1 otherwise.
+ */
+int grc_layout_set_area(grc_t *grc, unsigned int width, unsigned int height);
+
+/**
+ * @name grc_layout_set_size
+ * @brief Resizes an object, placing again only what depends on it.
+ *
+ * The new size replaces the object 'width_percent' and 'height_percent'
+ * properties. Its children are placed again and, if its "father" places
+ * them in a row or a column, so are its siblings. Like the GRC itself, the
+ * size is given in its 'design_resolution', when it has one.
+ *
+ * @param [in,out] grc: The grc_t object.
+ * @param [in] tag: The object tag.
+ * @param [in] width: The new object width.
+ * @param [in] height: The new object height.
+ *
+ * @return On success returns 0 or -1 otherwise.
+ */
+int grc_layout_set_size(grc_t *grc, const char *tag, int width, int height);
+
+/**
+ * @name grc_trace_record
+ * @brief Runs a DIALOG, like grc_do_dialog, recording its input.
+ *
+ * Keys, with their scancodes, and the mouse are given to the DIALOG only
+ * once per frame and written to @fd, along with the value returned by each
+ * callback and how long each frame took. The trace can be played again with
+ * grc_trace_replay.
+ *
+ * @param [in] grc: The grc_t object.
+ * @param [in] fd: The file descriptor where the trace will be written.
+ *
+ * @return On success returns 0 or -1 otherwise.
+ */
+int grc_trace_record(grc_t *grc, int fd);
+
+/**
+ * @name grc_trace_replay
+ * @brief Runs a DIALOG feeding it the input of a recorded trace.
+ *
+ * Real keys and mouse are ignored while it runs, and it stops when the
+ * trace ends. For each frame a JSON line with its time, in microseconds, is
+ * written to @report_fd, followed by a line with the totals. A frame
+ * diverges if it didn't call as many callbacks as when it was recorded, or
+ * if it became much slower.
+ *
+ * The GRC must have the same resolution used to record the trace.
+ *
+ * @param [in] grc: The grc_t object.
+ * @param [in] trace_fd: The file descriptor to read the trace.
+ * @param [in] report_fd: The file descriptor to write the report, or -1.
+ *
+ * @return On success returns the number of divergent frames or -1 otherwise.
+ */
+int grc_trace_replay(grc_t *grc, int trace_fd, int report_fd);
+
+/**
+ * @name grc_inject_key
+ * @brief Gives a key to the running DIALOG, as if it had been typed.
+ *
+ * This is how a DIALOG using the memory backend, which has no keyboard,
+ * receives its keys. They are kept by each DIALOG and given to it at its
+ * next frame, so it may be called from any thread. With a display the key
+ * goes to its keyboard, shared by every DIALOG.
+ *
+ * @param [in] grc: The grc_t object.
+ * @param [in] key: The key unicode value.
+ * @param [in] scancode: The key scancode (KEY_*).
+ *
+ * @return On success returns 0 or -1 otherwise.
+ */
+int grc_inject_key(grc_t *grc, int key, int scancode);
+
+/**
+ * @name grc_inject_mouse
+ * @brief Moves the mouse seen by a DIALOG using the memory backend.
+ *
+ * The DIALOG sees this position and these buttons from its next frame
+ * until the next call. It may be called from any thread.
+ *
+ * @param [in] grc: The grc_t object.
+ * @param [in] x: The mouse horizontal position.
+ * @param [in] y: The mouse vertical position.
+ * @param [in] z: The mouse wheel position.
+ * @param [in] buttons: The pressed buttons, as Allegro mouse_b.
+ *
+ * @return On success returns 0 or -1 otherwise.
+ */
+int grc_inject_mouse(grc_t *grc, int x, int y, int z, int buttons);
+
+/**
+ * @name grc_get_framebuffer
+ * @brief Gets the bitmap where the DIALOG is drawn.
+ *
+ * With the memory backend every DIALOG has its own memory bitmap, with the
+ * GRC resolution and color depth, which may be read while the DIALOG is not
+ * being drawn. Otherwise it is the screen.
+ *
+ * @param [in] grc: The grc_t object.
+ *
+ * @return On success returns the bitmap or NULL otherwise.
+ */
+BITMAP *grc_get_framebuffer(grc_t *grc);
+
+/**
+ * @name grc_render
+ * @brief Draws every visible object of a DIALOG once, without running it.
+ *
+ * The DIALOG must be prepared. With the memory backend it is drawn into its
+ * framebuffer, so different threads may render their own DIALOGs, one at a
+ * time.
+ *
+ * @param [in] grc: The grc_t object.
+ *
+ * @return On success returns 0 or -1 otherwise.
+ */
+int grc_render(grc_t *grc);
+
+/**
+ * @name grc_render_batch
+ * @brief Renders many GRC files into images, without a display.
+ *
+ * Every GRC is loaded, prepared and drawn by the memory backend, whatever
+ * backend it asks for, and saved inside @out_dir as a BMP image with the
+ * same name as the GRC file. GRCs with the same file name overwrite each
+ * other's image. Fonts loaded by one GRC are shared with the others.
+ *
+ * The work is split between @threads workers, which take the remaining
+ * GRCs of the others when they finish their own. Allegro draws a single
+ * DIALOG at a time, so only loading and saving really run in parallel.
+ *
+ * @param [in] paths: The GRC files.
+ * @param [in] n: The number of GRC files.
+ * @param [in] out_dir: The directory where the images are saved.
+ * @param [in] threads: The number of workers, or 0 to use one for every
+ *                      processor.
+ *
+ * @return On success returns the number of GRCs which could not be rendered
+ *         or -1 otherwise.
+ */
+int grc_render_batch(const char **paths, unsigned int n, const char *out_dir,
+                     unsigned int threads);
+
+/**
+ * @name grc_screenshot
+ * @brief Saves what a DIALOG shows to an image file.
+ *
+ * Only a copy of the screen, or of the object rectangle, is made by the
+ * call, so it may be used while the DIALOG runs, even from a callback. The
+ * copy is saved later by a background thread, in the format Allegro gives
+ * to the file extension (BMP, PCX or TGA). 24 and 32 bit BMPs are written
+ * directly from the copy, without converting each pixel.
+ *
+ * Errors while saving can't be reported. Every screenshot taken is saved
+ * before Allegro is finished.
+ *
+ * @param [in] grc: The grc_t object.
+ * @param [in] tag: The tag of the object to be saved, or NULL for the whole
+ *                  screen.
+ * @param [in] path: The image file.
+ *
+ * @return On success returns 0 or -1 otherwise.
+ */
+int grc_screenshot(grc_t *grc, const char *tag, const char *path);
+
+/**
+ * @name grc_remote_start
+ * @brief Streams what a DIALOG draws to a viewer on a local Unix socket.
+ *
+ * A single viewer at a time may connect to @socket_path. It receives the
+ * whole screen first and, after every frame, only the parts which changed,
+ * as run-length encoded rectangles. Frames are sent by a thread of their
+ * own, and a viewer too late to follow gets the next screen whole instead
+ * of the frames it missed. The stream format is described in src/remote.c.
+ *
+ * The DIALOG then runs one frame at a time. A DIALOG of a display which is
+ * already running, having started without it, is only streamed the next
+ * time it runs, so it should be called before. A DIALOG of the memory
+ * backend always runs one frame at a time, and may start being streamed
+ * from one of its callbacks. Otherwise it waits for a running DIALOG to
+ * finish.
+ *
+ * @param [in] grc: The grc_t object.
+ * @param [in] socket_path: The Unix socket to be created.
+ *
+ * @return On success returns 0 or -1 otherwise.
+ */
+int grc_remote_start(grc_t *grc, const char *socket_path);
+
+/**
+ * @name grc_remote_stop
+ * @brief Stops streaming a DIALOG, disconnecting its viewer.
+ *
+ * It is also stopped when the DIALOG is released.
+ *
+ * @param [in] grc: The grc_t object.
+ *
+ * @return On success returns 0 or -1 otherwise.
+ */
+int grc_remote_stop(grc_t *grc);
+
+
+/* Messages counted apart, by their number. Any other goes to the last one. */
+#define GRC_PROFILE_MESSAGES            32
+
+/*
+ * Durations are kept in microseconds, each power of two split into 8
+ * buckets, so they are known within 12.5% up to more than an hour.
+ */
+#define GRC_HISTOGRAM_BUCKETS           240
+
+/* What an object drew, read by grc_profile_snapshot */
+struct grc_profile_object {
+    const char          *tag;       /** The object name, or NULL */
+    unsigned long long  draws;      /** How many MSG_DRAW it received */
+    unsigned long long  draw_time;  /** Time drawing, in nanoseconds */
+};
+
+/* Input latency of a DIALOG, in microseconds, for each kind of input */
+struct grc_latency {
+    unsigned long long  events[GRC_INPUT_EVENTS];
+    unsigned long long  histogram[GRC_INPUT_EVENTS][GRC_HISTOGRAM_BUCKETS];
+    unsigned long long  max_latency[GRC_INPUT_EVENTS];
+};
+
+/* The profile of a DIALOG, filled by grc_profile_snapshot */
+struct grc_profile {
+    unsigned long long          messages[GRC_PROFILE_MESSAGES];
+    unsigned long long          frames;
+    unsigned long long          frame_histogram[GRC_HISTOGRAM_BUCKETS];
+    unsigned long long          max_frame_time; /** In microseconds */
+    struct grc_latency          latency;
+
+    /* Given by the caller, to receive up to @objects_size objects */
+    struct grc_profile_object   *objects;
+    unsigned int                objects_size;
+
+    /* How many objects the DIALOG has */
+    unsigned int                n_objects;
+};
+
+/**
+ * @name grc_profile_snapshot
+ * @brief Gets what the objects of a DIALOG did since it was prepared.
+ *
+ * It is only available when the library is built with profiling (make
+ * PROFILE=1). The procedure of every object is then wrapped when the
+ * DIALOG is prepared, counting the messages it receives and timing its
+ * MSG_DRAW. A frame is an update of the running DIALOG, or a grc_render
+ * call, in which something was drawn, and its duration is the time spent
+ * inside the objects during it. Internal objects, like the background and
+ * the menu, are not profiled. The input latency is also measured, as by
+ * grc_latency_start.
+ *
+ * It may be called while the DIALOG runs, from any thread.
+ *
+ * @param [in] grc: The grc_t object.
+ * @param [in,out] profile: The structure to be filled. Its objects array,
+ *                          if any, must be set by the caller.
+ *
+ * @return On success returns 0 or -1 otherwise.
+ */
+int grc_profile_snapshot(grc_t *grc, struct grc_profile *profile);
+
+/**
+ * @name grc_profile_reset
+ * @brief Clears everything profiled from a DIALOG so far.
+ *
+ * @param [in] grc: The grc_t object.
+ *
+ * @return On success returns 0 or -1 otherwise.
+ */
+int grc_profile_reset(grc_t *grc);
+
+/**
+ * @name grc_profile_frame_percentile
+ * @brief Gets a percentile of the frame durations of a profile.
+ *
+ * @param [in] profile: A profile filled by grc_profile_snapshot.
+ * @param [in] percentile: The percentile, from 0 to 100.
+ *
+ * @return Returns the highest duration, in microseconds, of the histogram
+ *         bucket holding the percentile, or 0 if there are no frames.
+ */
+unsigned long long grc_profile_frame_percentile(
+                                    const struct grc_profile *profile,
+                                    double percentile);
+
+
+/**
+ * @name grc_trace_events_start
+ * @brief Starts writing what the library does as Chrome trace events.
+ *
+ * The file is a JSON array of events which may be loaded by about:tracing
+ * or Perfetto. There are events for the parsing of every GRC, for each
+ * frame of a running DIALOG, for each callback and for each message sent to
+ * the objects of DIALOGs prepared while the events are written.
+ *
+ * Each thread keeps its events until a background thread writes them, so
+ * none of them waits for the file. A thread with too many events waiting
+ * loses the next ones, and how many were lost is also written.
+ *
+ * Events are also written, from the first DIALOG created, to the file named
+ * by the GRC_TRACE_EVENTS environment variable.
+ *
+ * @param [in] path: The file to be written.
+ *
+ * @return On success returns 0 or -1 otherwise.
+ */
+int grc_trace_events_start(const char *path);
+
+/**
+ * @name grc_trace_events_stop
+ * @brief Writes the events left and closes their file.
+ *
+ * It is also called when the program exits.
+ *
+ * @return On success returns 0 or -1 otherwise.
+ */
+int grc_trace_events_stop(void);
+
+
+/**
+ * @name grc_latency_start
+ * @brief Starts measuring the input latency of a DIALOG.
+ *
+ * The latency of an input is the time from when Allegro receives it, a key
+ * or a mouse button pressed or released, until the end of the frame of the
+ * DIALOG which read it. That frame already shows what the input did, like
+ * a button pressed, a character typed into an edit object or a key of a
+ * virtual keyboard. For a DIALOG streamed by grc_remote_start, it ends
+ * when the frame is given to the viewer.
+ *
+ * It must be called before the DIALOG runs, which then runs one frame at
+ * a time, unless it's a DIALOG of the memory backend, which always does
+ * and may start being measured from one of its callbacks. Input injected into a DIALOG of the memory backend is measured
+ * from when it is injected.
+ *
+ * @param [in] grc: The grc_t object.
+ *
+ * @return On success returns 0 or -1 otherwise.
+ */
+int grc_latency_start(grc_t *grc);
+
+/**
+ * @name grc_latency_snapshot
+ * @brief Gets the input latency measured from a DIALOG.
+ *
+ * It may be called while the DIALOG runs, from any thread.
+ *
+ * @param [in] grc: The grc_t object.
+ * @param [out] latency: The structure to be filled.
+ *
+ * @return On success returns 0 or -1 otherwise.
+ */
+int grc_latency_snapshot(grc_t *grc, struct grc_latency *latency);
+
+/**
+ * @name grc_latency_reset
+ * @brief Clears the input latency measured from a DIALOG so far.
+ *
+ * @param [in] grc: The grc_t object.
+ *
+ * @return On success returns 0 or -1 otherwise.
+ */
+int grc_latency_reset(grc_t *grc);
+
+/**
+ * @name grc_latency_percentile
+ * @brief Gets a percentile of the latency of a kind of input.
+ *
+ * @param [in] latency: A latency filled by grc_latency_snapshot or by
+ *                      grc_profile_snapshot.
+ * @param [in] event: The kind of input.
+ * @param [in] percentile: The percentile, from 0 to 100.
+ *
+ * @return Returns the highest latency, in microseconds, of the histogram
+ *         bucket holding the percentile, or 0 if there is no input.
+ */
+unsigned long long grc_latency_percentile(const struct grc_latency *latency,
+                                          enum grc_input_event event,
+                                          double percentile);
+
+/**
+ * @name grc_stats_publish
+ * @brief Publishes the statistics of a DIALOG in a shared memory segment.
+ *
+ * A 'struct grc_stats', from grc/grc_stats.h, is kept in a POSIX shared
+ * memory segment and updated after every frame, so another process may
+ * watch the DIALOG by mapping it read only. The DIALOG then runs one frame
+ * at a time. Counters are kept if the statistics are published again.
+ *
+ * As with grc_remote_start, a DIALOG of a display only starts publishing
+ * them the next time it runs, so it should be called before. A DIALOG of
+ * the memory backend may start from one of its callbacks.
+ *
+ * @param [in] grc: The grc_t object.
+ * @param [in] name: The name of the segment, as given to shm_open.
+ *
+ * @return On success returns 0 or -1 otherwise.
+ */
+int grc_stats_publish(grc_t *grc, const char *name);
+
+/**
+ * @name grc_stats_unpublish
+ * @brief Stops publishing the statistics of a DIALOG and removes their
+ *        shared memory segment.
+ *
+ * It's also done when the grc_t object is released.
+ *
+ * @param [in] grc: The grc_t object.
+ *
+ * @return On success returns 0 or -1 otherwise.
+ */
+int grc_stats_unpublish(grc_t *grc);
+
+/* Bytes used by a DIALOG, filled by grc_memory_usage */
+struct grc_mem_stats {
+    size_t  json;           /** The GRC JSON tree, an estimate */
+    size_t  objects;        /** Objects, their DIALOG, tag and callback */
+    size_t  properties;     /** Object properties read from the GRC */
+    size_t  dialog;         /** The DIALOG array run by Allegro */
+    size_t  edit_buffers;
+    size_t  log_lines;      /** Lines of the log boxes */
+    size_t  bitmaps;        /** Images, caches, framebuffer and popup */
+    size_t  menus;
+    size_t  total;
+};
+
+/**
+ * @name grc_memory_usage
+ * @brief Gets how many bytes a DIALOG uses, by what they are used for.
+ *
+ * Only the objects are walked, so it may be called periodically, from any
+ * thread, even while the DIALOG runs. The JSON tree is measured as the
+ * memory the process allocated while parsing the GRC, so it's only an
+ * estimate: it's skewed by whatever other threads allocated or released
+ * meanwhile, and is 0 where the C library can't tell the memory in use,
+ * as outside glibc. Strings of the properties
+ * are counted inside it, or with the properties once the JSON is released
+ * by GRC_INIT_RELEASE_JSON. Fonts, shared by every DIALOG, aren't counted,
+ * but the bitmaps caching their text are, with the ones of every DIALOG.
+ *
+ * @param [in] grc: The grc_t object.
+ * @param [out] stats: The structure to be filled.
+ *
+ * @return On success returns 0 or -1 otherwise.
+ */
+int grc_memory_usage(grc_t *grc, struct grc_mem_stats *stats);
+
+#endif
@@ -58,6 +58,40 @@ enum grc_error_code {
     GRC_ERROR_UNKNOWN_PROPERTY,
     GRC_ERROR_UNSUPPORTED_DATA_TYPE,
     GRC_ERROR_NOT_PREPARED_YET,
+    GRC_ERROR_BATCH_NOT_STARTED,
+    GRC_ERROR_BATCH_ALREADY_STARTED,
+    GRC_ERROR_UNSUPPORTED_OBJECT,
+    GRC_ERROR_INVALID_TABLE_COLUMNS,
+    GRC_ERROR_INVALID_WRITER_STATE,
+    GRC_ERROR_STREAM_WRITE,
+    GRC_ERROR_INVALID_STATE,
+    GRC_ERROR_STATE_IO,
+    GRC_ERROR_SESSION_NOT_STARTED,
+    GRC_ERROR_FONT_LOAD,
+    GRC_ERROR_UNKNOWN_FONT,
+    GRC_ERROR_INVALID_PARENT,
+    GRC_ERROR_INVALID_DESIGN_RESOLUTION,
+    GRC_ERROR_TRACE_BUSY,
+    GRC_ERROR_TRACE_IO,
+    GRC_ERROR_INVALID_TRACE,
+    GRC_ERROR_UNKNOWN_BACKEND,
+    GRC_ERROR_BACKEND_IN_USE,
+    GRC_ERROR_UNSUPPORTED_BY_BACKEND,
+    GRC_ERROR_RENDER_OUTPUT,
+    GRC_ERROR_SCREENSHOT_QUEUE_FULL,
+    GRC_ERROR_OBJECT_OFF_SCREEN,
+    GRC_ERROR_REMOTE_SOCKET,
+    GRC_ERROR_REMOTE_RUNNING,
+    GRC_ERROR_PROFILE_DISABLED,
+    GRC_ERROR_TRACE_EVENTS_RUNNING,
+    GRC_ERROR_TRACE_EVENTS_IO,
+    GRC_ERROR_LATENCY_NOT_STARTED,
+    GRC_ERROR_INVALID_INPUT_EVENT,
+    GRC_ERROR_STATS_PUBLISHED,
+    GRC_ERROR_STATS_SHM,
+    GRC_ERROR_GUI_BUSY,
+    GRC_ERROR_INPUT_QUEUE_FULL,
+    GRC_ERROR_GFX_MODE_IN_USE,
 
     GRC_MAX_ERROR_CODE
 };
@@ -27,10 +27,9 @@
 #ifndef _LIBGRC_INTERNAL_H
 #define _LIBGRC_INTERNAL_H         1
 
-/** Defines */
+#include <time.h>
 
-/* Maximum string size supported by an 'edit' object */
-#define MAX_EDIT_SIZE               1024
+/** Defines */
 
 /* Default main window resolution and color */
 #define DEFAULT_WIDTH               800
@@ -46,6 +45,7 @@
 #define OBJ_MAIN_OPTIONS            "main_options"
 #define OBJ_MENU_OPTIONS            "menu_options"
 #define OBJ_OPTIONS                 "options"
+#define OBJ_FONTS                   "fonts"
 
 /* Secondary objects of a GRC file */
 #define OBJ_WIDTH                   "width"
@@ -55,6 +55,8 @@
 #define OBJ_BACKGROUND              "background"
 #define OBJ_BLOCK_EXIT_KEYS         "block_exit_keys"
 #define OBJ_MOUSE                   "mouse"
+#define OBJ_DESIGN_RESOLUTION       "design_resolution"
+#define OBJ_BACKEND                 "backend"
 #define OBJ_TYPE                    "type"
 #define OBJ_POS_X                   "pos_x"
 #define OBJ_POS_Y                   "pos_y"
@@ -72,6 +74,18 @@
 #define OBJ_HORIZONTAL_POSITION     "horizontal_position"
 #define OBJ_FPS                     "fps"
 #define OBJ_DEVICES                 "devices"
+#define OBJ_VIRTUAL                 "virtual"
+#define OBJ_COLUMNS                 "columns"
+#define OBJ_MULTILINE               "multiline"
+#define OBJ_FONT                    "font"
+#define OBJ_NAME                    "name"
+#define OBJ_FILE                    "file"
+#define OBJ_RESOLUTION              "resolution"
+#define OBJ_ANCHOR                  "anchor"
+#define OBJ_LAYOUT                  "layout"
+#define OBJ_PADDING                 "padding"
+#define OBJ_WIDTH_PERCENT           "width_percent"
+#define OBJ_HEIGHT_PERCENT          "height_percent"
 
 /* DIALOG supported object names (values) */
 #define DLG_OBJ_KEY                 "key"
@@ -93,6 +107,7 @@
 #define DLG_OBJ_VT_KEYBOARD         "virtual_keyboard"
 #define DLG_OBJ_ICON                "icon"
 #define DLG_OBJ_TEXTBOX             "textbox"
+#define DLG_OBJ_TABLE               "table"
 
 /* Menu separator string */
 #define MENU_SEPARATOR              "separator"
@@ -156,7 +171,10 @@ enum gfx_info {
     INFO_HEIGHT,
     INFO_COLOR_DEPTH,
     INFO_BLOCK_KEYS,
-    INFO_USE_MOUSE
+    INFO_USE_MOUSE,
+    INFO_DESIGN_WIDTH,
+    INFO_DESIGN_HEIGHT,
+    INFO_BACKEND
 };
 
 /* DIALOG colors */
@@ -182,10 +200,49 @@ struct gfx_info_s;
 /** DIALOG colors */
 struct gfx_color_s;
 
-struct grc_generic_data {
-    cl_list_entry_t *prev;
-    cl_list_entry_t *next;
-    char            data[MAX_EDIT_SIZE];
+/** Hash table to find objects by their tags */
+struct tag_index;
+
+/** Pending changes of a batch update */
+struct grc_batch;
+
+/** A GRC being written directly to its destination */
+struct writer_stream;
+
+/** Text storage of 'edit' objects */
+struct gap_buffer;
+
+/** Strings of the objects, once the GRC JSON is released */
+struct string_table;
+
+/** A font declared inside a GRC */
+struct grc_font;
+
+/** Geometry of the objects, computed from their layout properties */
+struct layout;
+struct layout_node;
+
+/** A DIALOG streamed to a remote viewer */
+struct remote;
+
+/** Messages and drawing time of the objects of a profiled DIALOG */
+struct profile;
+
+/** Input latency of a DIALOG */
+struct latency;
+
+/** Statistics of a DIALOG published in shared memory */
+struct stats;
+
+/** Input injected into a DIALOG drawn by the memory backend */
+struct headless_input;
+
+/** Mouse injected into a DIALOG drawn by the memory backend */
+struct headless_mouse {
+    int x;
+    int y;
+    int z;
+    int b;
 };
 
 struct grc_object_s {
@@ -196,8 +253,9 @@ struct grc_object_s {
     char                        *tag;       /** Reference tag */
 
     DIALOG                      *dlg;       /** Real Allegro's DIALOG object */
+    DIALOG                      *rdlg;      /** The object inside the running
+                                                DIALOG, once it is created */
     struct callback_data        *cb_data;   /** Object's callback */
-    struct grc_generic_data     *g_data; // TODO: Replace this for a cl_string_list_t
     struct grc_obj_properties   *prop;
 
     /* Maybe this a 'digital_clock' object */
@@ -206,6 +264,16 @@ struct grc_object_s {
     /* Is this a menu? */
     MENU                        *menu;
     struct grc_object_s         *items;
+
+    /* Must be redrawn at the end of a batch update */
+    bool                        redraw;
+
+    /* Object position inside the layout tree */
+    struct layout_node          *layout;
+
+    /* Internal state of objects implemented by the library */
+    void                        *priv;
+    void                        (*free_priv)(void *);
 };
 
 /* Main structure to handle an Allegro DIALOG */
@@ -213,6 +281,12 @@ struct grc_s {
     /* GRC is a JSON object inside */
     cl_json_t                 *jgrc;
 
+    /* Bytes allocated to parse @jgrc */
+    size_t                  jgrc_memory;
+
+    /* Strings of the objects, when @jgrc was released after being parsed */
+    struct string_table     *strings;
+
     /*
      * Even having a DIALOG structure inside every grc_object we keep this
      * to be the real DIALOG, the one used by Allegro.
@@ -223,6 +297,12 @@ struct grc_s {
     struct grc_object_s     *ui_keys;
     struct grc_object_s     *ui_menu;
 
+    /* Every object with a tag, so we don't need to walk the lists */
+    struct tag_index        *tags;
+
+    /* Changes waiting for a grc_batch_commit call */
+    struct grc_batch        *batch;
+
     /* Graphic mode info and colors */
     struct gfx_info_s       *info;
     struct gfx_color_s      *color;
@@ -239,21 +319,67 @@ struct grc_s {
     /* Temporary values while creating a GRC file. */
     void                    *internal;
     void                    (*free_internal)(void *);
+
+    /* Destination of a GRC file created in streaming mode */
+    struct writer_stream    *stream;
+
+    /* Holds a reference to the shared Allegro session */
+    bool                    session;
+
+    /* Screen under the DIALOG while it runs as a popup */
+    BITMAP                  *save_under;
+
+    /* Fonts declared inside the GRC */
+    struct grc_font         *fonts;
+
+    /* Computed geometry of every object */
+    struct layout           *layout;
+
+    /*
+     * Where the DIALOG is drawn with the memory backend, the mouse it sees
+     * during a frame and the input injected for the next one.
+     */
+    BITMAP                  *framebuffer;
+    struct headless_mouse   mouse;
+    struct headless_input   *input;
+
+    /* The objects were started by grc_render */
+    bool                    rendered;
+
+    /* Viewer of what the DIALOG draws, while it's streamed */
+    struct remote           *remote;
+
+    /* What the objects did, when the library is built with profiling */
+    struct profile          *profile;
+
+    /* How long the input takes to be shown */
+    struct latency          *latency;
+
+    /* Statistics watched by other processes */
+    struct stats            *stats;
 };
 
 /** Prototypes */
 
+/* api.c */
+struct grc_s *grc_load_headless(const char *grc_file);
+
 /* gui.c */
 int gui_init(struct grc_s *grc);
-void gui_reset_resolution(void);
 int DIALOG_create(struct grc_s *grc);
 void run_DIALOG(struct grc_s *grc);
+void render_DIALOG(struct grc_s *grc);
+void stop_render_DIALOG(struct grc_s *grc);
+void redraw_DIALOG(struct grc_s *grc);
+int dialog_frame(struct grc_s *grc, DIALOG_PLAYER *player, void (*input)(void));
 int grc_tr_color_to_al_color(int color_depth, const char *color);
 DIALOG *get_DIALOG_from_grc(struct grc_s *grc, const char *object_name);
 struct grc_menu *get_grc_menu_from_grc(struct grc_s *grc,
                                        const char *object_name);
 
 MENU *get_MENU_from_grc(struct grc_s *grc, const char *object_name);
+bool gui_object_is(DIALOG *d, int (*proc)(int, DIALOG *, int));
+void gui_object_set_proc(DIALOG *d, int (*proc)(int, DIALOG *, int));
 
 /* parser.c */
 int grc_get_object_value(cl_json_t *object, const char *object_name,
@@ -264,6 +390,7 @@ int parse_file(struct grc_s *grc, const char *grc_filename);
 int parse_mem(struct grc_s *grc, const char *data);
 int parse_colors(struct grc_s *grc);
 int parse_objects(struct grc_s *grc);
+int parse_release_JSON(struct grc_s *grc);
 
 /* error.c */
 void grc_errno_clear(void);
@@ -272,6 +399,7 @@ void grc_set_errno(enum grc_error_code code);
 /* callback.c */
 struct callback_data *new_callback_data(void);
 void destroy_callback_data(void *a);
+size_t callback_data_memory(void);
 void set_object_callback_data(struct grc_object_s *gobject,
                               struct grc_s *grc);
 
@@ -286,12 +414,26 @@ int set_callback(struct grc_s *grc, DIALOG *dlg,
 int run_callback(struct callback_data *acd, unsigned int default_return);
 void callback_set_int(struct callback_data *acd, int value);
 void callback_set_string(struct callback_data *acd, char *value);
+void callback_set_font(struct callback_data *acd, FONT *f,
+                       int (*proc)(int, DIALOG *, int));
+
+FONT *callback_get_font(struct callback_data *acd);
+int (*callback_get_proc(struct callback_data *acd))(int, DIALOG *, int);
+void callback_set_profile(struct callback_data *acd, void *profile);
+void *callback_get_profile(struct callback_data *acd);
+void callback_set_trace(struct callback_data *acd,
+                        int (*proc)(int, DIALOG *, int), const char *tag);
+int (*callback_get_trace_proc(struct callback_data *acd))(int, DIALOG *, int);
+const char *callback_get_tag(struct callback_data *acd);
 
 /* grc.c */
 struct grc_s *new_grc(void);
 void destroy_grc(struct grc_s *grc);
 void grc_creates_reference(struct grc_s *grc, struct grc_object_s *object);
 DIALOG *grc_get_DIALOG_from_tag(struct grc_s *grc, const char *tag);
+struct grc_object_s *grc_get_object_from_tag(struct grc_s *grc,
+                                             const char *tag);
+
 MENU *grc_get_MENU_from_tag(struct grc_s *grc, const char *tag);
 struct gfx_info_s *grc_get_info(struct grc_s *grc);
 cl_json_t *grc_get_JSON(struct grc_s *grc);
@@ -301,11 +443,13 @@ void grc_release_internal_data(struct grc_s *grc);
 int grc_set_internal_data(struct grc_s *grc, void *ptr,
                           void (*free_internal)(void *));
 
-/* grc_generic.c */
-struct grc_generic_data *new_grc_generic_data(void);
-void destroy_grc_generic_data(void *a);
-
 /* grc_object.c */
+int grc_object_set_member(struct grc_object_s *object, struct grc_s *grc,
+                          enum grc_object_member member, void *data);
+
+int grc_object_get_member_int(struct grc_object_s *object,
+                              enum grc_object_member member, int *value);
+
 void destroy_grc_object(void *a);
 struct grc_object_s *new_grc_object(enum grc_object_type type);
 struct grc_obj_properties *grc_object_get_properties(struct grc_object_s *object);
@@ -313,6 +457,10 @@ DIALOG *grc_object_get_DIALOG(struct grc_object_s *object);
 MENU *grc_object_get_MENU(struct grc_object_s *object);
 void grc_object_set_MENU(struct grc_object_s *object, MENU *menu);
 void grc_object_set_tag(struct grc_object_s *object, const char *tag);
+void *grc_object_get_private_data(struct grc_object_s *object);
+int grc_object_set_private_data(struct grc_object_s *object, void *ptr,
+                                void (*free_priv)(void *));
+
 DIALOG *grc_object_get_DIALOG_from_tag(struct grc_object_s *object,
                                        const char *tag);
 
@@ -321,14 +469,21 @@ MENU *grc_object_get_MENU_from_tag(struct grc_object_s *object, const char *tag)
 /* object_properties.c */
 void destroy_obj_properties(struct grc_obj_properties *odata);
 struct grc_obj_properties *new_obj_properties(cl_json_t *object);
+size_t obj_properties_memory(void);
+size_t obj_properties_strings_size(struct grc_obj_properties *prop);
+void obj_properties_compact(struct grc_obj_properties *prop,
+                            struct string_table *table, DIALOG *d);
 bool grc_obj_properties_has_name(struct grc_obj_properties *prop);
 bool grc_obj_properties_has_parent(struct grc_obj_properties *prop);
 bool grc_obj_properties_has_fg(struct grc_obj_properties *prop);
+bool grc_obj_properties_has_font(struct grc_obj_properties *prop);
 const char *grc_obj_get_property_name(struct grc_obj_properties *prop);
 const char *grc_obj_get_property_parent(struct grc_obj_properties *prop);
 const char *grc_obj_get_property_text(struct grc_obj_properties *prop);
 const char *grc_obj_get_property_fg(struct grc_obj_properties *prop);
 const char *grc_obj_get_property_key(struct grc_obj_properties *prop);
+const char *grc_obj_get_property_columns(struct grc_obj_properties *prop);
+const char *grc_obj_get_property_font(struct grc_obj_properties *prop);
 enum grc_object grc_obj_get_property_type(struct grc_obj_properties *prop);
 int grc_obj_get_property_x(struct grc_obj_properties *prop);
 int grc_obj_get_property_y(struct grc_obj_properties *prop);
@@ -341,6 +496,13 @@ int grc_obj_get_property_radio_type(struct grc_obj_properties *prop);
 int grc_obj_get_property_password_mode(struct grc_obj_properties *prop);
 int grc_obj_get_property_horizontal_position(struct grc_obj_properties *prop);
 bool grc_obj_get_property_hide(struct grc_obj_properties *prop);
+bool grc_obj_get_property_virtual_mode(struct grc_obj_properties *prop);
+bool grc_obj_get_property_multiline(struct grc_obj_properties *prop);
+int grc_obj_get_property_anchor(struct grc_obj_properties *prop);
+int grc_obj_get_property_layout(struct grc_obj_properties *prop);
+int grc_obj_get_property_padding(struct grc_obj_properties *prop);
+int grc_obj_get_property_width_percent(struct grc_obj_properties *prop);
+int grc_obj_get_property_height_percent(struct grc_obj_properties *prop);
 
 int grc_obj_set_property_type(struct grc_obj_properties *prop,
                               enum grc_object type);
@@ -365,12 +527,26 @@ int tr_str_type_to_grc_type(const char *type_name);
 int tr_line_break(const char *mode);
 int tr_radio_type(const char *type);
 int tr_horizontal_position(const char *pos);
+int tr_anchor(const char *anchor);
+int tr_layout(const char *layout);
+int tr_backend(const char *backend);
 int tr_str_key_to_al_key(const char *skey);
 const char *str_radio_type(enum grc_radio_button_fmt radio);
 const char *str_horizontal_position(enum grc_horizontal_position hpos);
+const char *str_anchor(enum grc_anchor anchor);
+const char *str_layout(enum grc_layout layout);
 const char *str_line_break(enum grc_line_break lbreak);
 const char *str_grc_obj_type(enum grc_object obj);
+const char *str_dlg_object(unsigned int index);
 cl_json_t *grc_get_object(struct grc_s *grc, const char *object);
+unsigned int put_le16(unsigned char *p, unsigned int value);
+unsigned int put_le32(unsigned char *p, unsigned int value);
+unsigned int get_le16(const unsigned char *p);
+unsigned int get_le32(const unsigned char *p);
+int write_all(int fd, const void *data, size_t n);
+int send_all(int fd, const void *data, size_t n);
+unsigned long long nsec_now(clockid_t clock);
+unsigned long long usec_now(clockid_t clock);
 
 /* colors.c */
 int color_parse(struct grc_s *grc);
@@ -381,6 +557,158 @@ struct gfx_color_s *color_start(void);
 void color_finish(struct gfx_color_s *color);
 int color_get(struct gfx_color_s *color, enum gfx_color type);
 
+/* tag_index.c */
+unsigned int tag_hash(const char *tag);
+struct tag_index *new_tag_index(void);
+void destroy_tag_index(struct tag_index *index);
+int tag_index_add(struct tag_index *index, struct grc_object_s *object);
+struct grc_object_s *tag_index_get(struct tag_index *index, const char *tag);
+struct grc_object_s *tag_index_get_hash(struct tag_index *index,
+                                        unsigned int hash);
+unsigned int tag_index_size(struct tag_index *index);
+
+/* batch.c */
+void destroy_grc_batch(struct grc_batch *batch);
+
+/* headless.c */
+void headless_install(void);
+void headless_uninstall(void);
+int headless_create_framebuffer(struct grc_s *grc);
+void headless_destroy_framebuffer(struct grc_s *grc);
+void headless_select(struct grc_s *grc);
+void headless_frame_input(struct grc_s *grc);
+
+/* session.c */
+int session_acquire(struct grc_s *grc);
+void session_release(void);
+void session_gui_lock(void);
+int session_gui_trylock(void);
+void session_gui_unlock(void);
+
+/* font.c */
+void font_install(void);
+void font_uninstall(void);
+void font_flush_atlases(void);
+size_t font_atlas_memory(void);
+void font_finish(struct grc_font *fonts);
+int font_parse(struct grc_s *grc);
+FONT *font_get(struct grc_s *grc, const char *name);
+int font_object_proc(int msg, DIALOG *d, int c);
+
+/* scale.c */
+bool scale_enabled(struct grc_s *grc);
+int scale_x(struct grc_s *grc, int value);
+int scale_y(struct grc_s *grc, int value);
+BITMAP *scale_image(struct grc_s *grc, BITMAP *bmp);
+
+/* layout.c */
+void destroy_layout(struct layout *layout);
+int layout_build(struct grc_s *grc);
+
+/* trace.c */
+void trace_callback(int ret);
+
+/* screenshot.c */
+void screenshot_finish(void);
+
+/* remote.c */
+void remote_frame(struct grc_s *grc);
+void remote_stop(struct grc_s *grc);
+
+/* trace_events.c */
+void trace_events_init(void);
+bool trace_events_enabled(void);
+unsigned long long trace_event_begin(void);
+void trace_event_end(unsigned long long start, const char *name,
+                     const char *category, const char *detail);
+int trace_events_object_proc(int msg, DIALOG *d, int c);
+void trace_events_attach(struct grc_s *grc);
+
+/* histogram.c */
+unsigned int histogram_bucket(unsigned long long usec);
+unsigned long long histogram_percentile(const unsigned long long *histogram,
+                                        unsigned long long count,
+                                        unsigned long long max,
+                                        double percentile);
+
+/* latency.c */
+void latency_install(void);
+void latency_install_mouse(void);
+void latency_uninstall(void);
+void latency_inject_mouse(int old_buttons, int buttons);
+int latency_attach(struct grc_s *grc);
+void latency_detach(struct grc_s *grc);
+void latency_frame_begin(struct grc_s *grc);
+void latency_frame_end(struct grc_s *grc);
+void latency_snapshot(struct grc_s *grc, struct grc_latency *latency);
+void latency_reset(struct grc_s *grc);
+
+/* profile.c */
+#ifdef GRC_PROFILE
+int profile_object_proc(int msg, DIALOG *d, int c);
+int (*profile_object_get_proc(DIALOG *d))(int, DIALOG *, int);
+void profile_object_set_proc(DIALOG *d, int (*proc)(int, DIALOG *, int));
+void profile_attach(struct grc_s *grc);
+void profile_detach(struct grc_s *grc);
+void profile_frame_begin(struct grc_s *grc);
+void profile_frame_end(struct grc_s *grc);
+#else
+/* Nothing is left of the profiling when it's not built */
+# define profile_attach(grc)       do { } while (0)
+# define profile_detach(grc)       do { } while (0)
+# define profile_frame_begin(grc)  do { } while (0)
+# define profile_frame_end(grc)    do { } while (0)
+#endif
+
+/* stats.c */
+void stats_destroy(struct grc_s *grc);
+void stats_frame_begin(struct grc_s *grc, bool redraw);
+void stats_frame_end(struct grc_s *grc);
+void stats_callback(struct grc_s *grc);
+void stats_log(struct grc_s *grc, unsigned int queued, unsigned int dropped);
+
+/* memory.c */
+size_t memory_in_use(void);
+size_t memory_used_since(size_t before);
+size_t bitmap_memory(BITMAP *bmp);
+
+/* writer_stream.c */
+struct writer_stream *new_writer_stream(void);
+void destroy_writer_stream(struct writer_stream *s);
+void writer_stream_reset(struct writer_stream *s, int fd);
+unsigned int writer_stream_depth(const struct writer_stream *s);
+int writer_stream_flush(struct writer_stream *s);
+int writer_stream_open(struct writer_stream *s, const char *key, char c);
+int writer_stream_close(struct writer_stream *s, char c);
+int writer_stream_string(struct writer_stream *s, const char *key,
+                         const char *value);
+int writer_stream_number(struct writer_stream *s, const char *key, int value);
+int writer_stream_bool(struct writer_stream *s, const char *key, bool value);
+const char *writer_stream_data(struct writer_stream *s, unsigned int *size);
+
+/* gap_buffer.c */
+struct gap_buffer *new_gap_buffer(unsigned int limit);
+void destroy_gap_buffer(struct gap_buffer *gb);
+unsigned int gap_buffer_length(const struct gap_buffer *gb);
+unsigned int gap_buffer_limit(const struct gap_buffer *gb);
+char gap_buffer_at(const struct gap_buffer *gb, unsigned int pos);
+int gap_buffer_insert(struct gap_buffer *gb, unsigned int pos, const char *s,
+                      unsigned int n);
+
+void gap_buffer_delete(struct gap_buffer *gb, unsigned int pos,
+                       unsigned int n);
+
+int gap_buffer_set(struct gap_buffer *gb, const char *s);
+const char *gap_buffer_text(struct gap_buffer *gb);
+const char *gap_buffer_storage(const struct gap_buffer *gb);
+size_t gap_buffer_memory(const struct gap_buffer *gb);
+
+/* string_table.c */
+struct string_table *new_string_table(size_t size);
+void destroy_string_table(struct string_table *t);
+const char *string_table_add(struct string_table *t, const char *s);
+size_t string_table_memory(const struct string_table *t);
+
 /* info.c */
 int info_parse(struct grc_s *grc);
 int info_color_depth(struct grc_s *grc);
@@ -0,0 +1,82 @@
+/*
+ * Description: Layout of the statistics a DIALOG publishes in a shared
+ *              memory segment. It may be included alone, by programs which
+ *              don't use the library.
+ *
+ * Author: Rodrigo Freitas
+ * Created at: Tue Oct 20 01:12:09 2026
+ * Project: libgrc
+ *
+ * Copyright (c) 2014 Rodrigo Freitas
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301
+ * USA
+ */
+
+#ifndef _LIBGRC_STATS_H
+#define _LIBGRC_STATS_H                         1
+
+#include <stdint.h>
+
+/* "GRST" */
+#define GRC_STATS_MAGIC                         0x54535247
+#define GRC_STATS_VERSION                       1
+
+/*
+ * The page is updated after every frame of the DIALOG. @sequence is odd
+ * while it's being updated, so a reader must copy it like this:
+ *
+ *   do {
+ *       seq = __atomic_load_n(&page->sequence, __ATOMIC_ACQUIRE);
+ *       copy = *page;
+ *       __atomic_thread_fence(__ATOMIC_ACQUIRE);
+ *   } while ((seq & 1) ||
+ *            (seq != __atomic_load_n(&page->sequence, __ATOMIC_RELAXED)));
+ *
+ * New fields are only added at the end, increasing @version and @size.
+ */
+struct grc_stats {
+    uint32_t    magic;
+    uint32_t    version;
+    uint32_t    size;               /** sizeof(struct grc_stats) */
+    uint32_t    sequence;
+
+    int32_t     pid;
+    uint32_t    objects;            /** Objects of the DIALOG */
+    uint64_t    updated_at;         /** CLOCK_REALTIME, in microseconds */
+
+    /*
+     * Frames which redrew some object, and the time spent running them, in
+     * microseconds.
+     */
+    uint64_t    frames;
+    uint64_t    avg_frame_time;
+    uint64_t    max_frame_time;
+
+    /* Pixels of the objects redrawn, counting each time they were */
+    uint64_t    redraw_area;
+
+    uint64_t    callbacks;
+    uint64_t    log_lines_queued;
+    uint64_t    log_lines_dropped;  /** Scrolled out before being drawn */
+
+    /*
+     * Bytes allocated by the whole process, from the malloc arenas, or 0
+     * where the C library can't tell.
+     */
+    uint64_t    arena_memory;
+};
+
+#endif
@@ -101,6 +101,39 @@ int grc_GRC_add_key(grc_t *grc, const char *key, const char *name);
  */
 int grc_GRC_keys_finish(grc_t *grc);
 
+/**
+ * @name grc_GRC_fonts_start
+ * @brief Creates the block of fonts used by the DIALOG objects.
+ *
+ * @param [in,out] grc: Previously created GRC structure.
+ *
+ * @return On success returns 0 or -1 otherwise.
+ */
+int grc_GRC_fonts_start(grc_t *grc);
+
+/**
+ * @name grc_GRC_add_font
+ * @brief Adds a font, which objects may use through its name.
+ *
+ * @param [in,out] grc: Previously created GRC structure.
+ * @param [in] name: The font name, used by the objects 'font' property.
+ * @param [in] file: The font file, in any format Allegro's load_font
+ *                   supports.
+ *
+ * @return On success returns 0 or -1 otherwise.
+ */
+int grc_GRC_add_font(grc_t *grc, const char *name, const char *file);
+
+/**
+ * @name grc_GRC_fonts_finish
+ * @brief Ends the fonts block.
+ *
+ * @param [in,out] grc: Previously created GRC structure.
+ *
+ * @return On success returns 0 or -1 otherwise.
+ */
+int grc_GRC_fonts_finish(grc_t *grc);
+
 /**
  * @name grc_GRC_objects_start
  * @brief Creates the block which will contain all DIALOG objects.
@@ -153,5 +186,58 @@ int grc_GRC_set_object_property(grc_t *grc, enum grc_object_property prop, ...);
  */
 int grc_GRC_objects_finish(grc_t *grc);
 
+/**
+ * @name grc_GRC_stream_to_fd
+ * @brief Starts writing a GRC directly to a file descriptor.
+ *
+ * While a stream is open the grc_GRC_* functions write their blocks as they
+ * are called, instead of building the GRC in memory. So they must be called
+ * in the same order of the file, and every started block must be finished
+ * before the next one.
+ *
+ * @param [in,out] grc: Previously created GRC structure.
+ * @param [in] fd: An opened file descriptor.
+ *
+ * @return On success returns 0 or -1 otherwise.
+ */
+int grc_GRC_stream_to_fd(grc_t *grc, int fd);
+
+/**
+ * @name grc_GRC_stream_to_buffer
+ * @brief Starts writing a GRC to an internal memory buffer.
+ *
+ * Works the same way as grc_GRC_stream_to_fd, but the written content is
+ * available through grc_GRC_stream_buffer.
+ *
+ * @param [in,out] grc: Previously created GRC structure.
+ *
+ * @return On success returns 0 or -1 otherwise.
+ */
+int grc_GRC_stream_to_buffer(grc_t *grc);
+
+/**
+ * @name grc_GRC_stream_finish
+ * @brief Ends a GRC being written in streaming mode.
+ *
+ * @param [in,out] grc: Previously created GRC structure.
+ *
+ * @return On success returns 0 or -1 otherwise.
+ */
+int grc_GRC_stream_finish(grc_t *grc);
+
+/**
+ * @name grc_GRC_stream_buffer
+ * @brief Gets a GRC written with grc_GRC_stream_to_buffer.
+ *
+ * The returned buffer belongs to the library and remains valid until the
+ * next stream is started.
+ *
+ * @param [in] grc: Previously created GRC structure.
+ * @param [out] size: The GRC length, in bytes.
+ *
+ * @return On success returns the GRC, as a string, or NULL otherwise.
+ */
+const char *grc_GRC_stream_buffer(grc_t *grc, unsigned int *size);
+
 #endif
 
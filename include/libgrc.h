@@ -72,6 +72,45 @@ enum grc_horizontal_position {
     GRC_H_POS_RIGHT
 };
 
+/* Object positions inside their parent (or the screen) */
+enum grc_anchor {
+    GRC_ANCHOR_TOP_LEFT = 1,
+    GRC_ANCHOR_TOP,
+    GRC_ANCHOR_TOP_RIGHT,
+    GRC_ANCHOR_LEFT,
+    GRC_ANCHOR_CENTER,
+    GRC_ANCHOR_RIGHT,
+    GRC_ANCHOR_BOTTOM_LEFT,
+    GRC_ANCHOR_BOTTOM,
+    GRC_ANCHOR_BOTTOM_RIGHT
+};
+
+/* How an object places its children */
+enum grc_layout {
+    GRC_LAYOUT_ROW = 1,
+    GRC_LAYOUT_COLUMN
+};
+
+/* Where a DIALOG is drawn */
+enum grc_backend {
+    GRC_BACKEND_DISPLAY = 1,    /* display */
+    GRC_BACKEND_MEMORY          /* memory */
+};
+
+/* Options of grc_init_from_file_flags and grc_init_from_mem_flags */
+enum grc_init_flag {
+    GRC_INIT_RELEASE_JSON = 1 << 0  /* release the GRC JSON once parsed */
+};
+
+/* Kinds of input whose latency is measured */
+enum grc_input_event {
+    GRC_INPUT_KEY,
+    GRC_INPUT_BUTTON_PRESS,
+    GRC_INPUT_BUTTON_RELEASE,
+
+    GRC_INPUT_EVENTS
+};
+
 /* Fields able to handle variable data inside an object */
 enum grc_object_member {
     /* Original Allegro names */
@@ -119,7 +158,8 @@ enum grc_object {
     GRC_OBJECT_ICON,
     GRC_OBJECT_TEXTBOX,
     GRC_OBJECT_MENU,
-    GRC_OBJECT_MENU_ITEM
+    GRC_OBJECT_MENU_ITEM,
+    GRC_OBJECT_TABLE
 };
 
 /* JSON objects of the GRC file */
@@ -147,7 +187,18 @@ enum grc_object_property {
     GRC_PROPERTY_PASSWORD_MODE,
     GRC_PROPERTY_H_POSITION,
     GRC_PROPERTY_FPS,
-    GRC_PROPERTY_DEVICES
+    GRC_PROPERTY_DEVICES,
+    GRC_PROPERTY_VIRTUAL,
+    GRC_PROPERTY_COLUMNS,
+    GRC_PROPERTY_MULTILINE,
+    GRC_PROPERTY_FONT,
+    GRC_PROPERTY_ANCHOR,
+    GRC_PROPERTY_LAYOUT,
+    GRC_PROPERTY_PADDING,
+    GRC_PROPERTY_WIDTH_PERCENT,
+    GRC_PROPERTY_HEIGHT_PERCENT,
+    GRC_PROPERTY_DESIGN_RESOLUTION,
+    GRC_PROPERTY_BACKEND
 };
 
 /*
@@ -235,12 +286,15 @@ enum grc_key {
 #define MSG_CLEAR_LOG_TEXT              MSG_USER + 1
 #define MSG_LOAD_IMAGE                  MSG_USER + 2
 #define MSG_UPDATE_CURSOR_POSITION      MSG_USER + 3
+#define MSG_LIST_REFRESH                MSG_USER + 4
+#define MSG_TABLE_REFRESH               MSG_USER + 5
 
 /* Exported types */
 typedef void    grc_t;
 typedef void    grc_callback_data_t;
 
 #include "grc/grc_error.h"
+#include "grc/grc_stats.h"
 #include "grc/grc_api.h"
 #include "grc/grc_write.h"
 
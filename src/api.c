@@ -44,14 +44,66 @@ static int start_grc(grc_t *grc __attribute__((unused)))
     return 0;
 }
 
+/*
+ * Everything from here uses Allegro, which is shared with the DIALOGs of
+ * every other thread.
+ */
+static int load_gui(grc_t *grc)
+{
+    unsigned long long start;
+    int ret = -1;
+
+    session_gui_lock();
+
+    /*
+     * We initialize Allegro here, so we can use anything from it from 
+     * this point. Like their color conversion, we need to do this things
+     * rigth after...
+     */
+    if (gui_init(grc) < 0)
+        goto end_block;
+
+    start = trace_event_begin();
+    ret = color_parse(grc);
+    trace_event_end(start, "color_parse", "parse", NULL);
+
+    if (ret < 0)
+        goto end_block;
+
+    /* Fonts must be known before objects are measured */
+    start = trace_event_begin();
+    ret = font_parse(grc);
+    trace_event_end(start, "font_parse", "parse", NULL);
+
+    if (ret < 0)
+        goto end_block;
+
+    /* Do the translation of every GRC object to internal grc_object. */
+    start = trace_event_begin();
+    ret = parse_objects(grc);
+    trace_event_end(start, "parse_objects", "parse", NULL);
+
+    if (ret < 0)
+        goto end_block;
+
+    ret = 0;
+
+end_block:
+    session_gui_unlock();
+
+    return ret;
+}
+
 static grc_t *grc_init(const char *grc_data, int load_mode,
-    bool gfx)
+    bool gfx, bool headless, unsigned int flags)
 {
     grc_t *grc;
     int ret = 0;
+    unsigned long long start;
     struct gfx_info_s *info;
 
     grc_errno_clear();
+    trace_events_init();
     grc = new_grc();
 
     if (NULL == grc)
@@ -81,22 +133,21 @@ static grc_t *grc_init(const char *grc_data, int load_mode,
     info = grc_get_info(grc);
     info_set_value(info, INFO_USE_GFX, gfx, NULL);
 
-    if (info_parse(grc) < 0)
-        goto end_block;
+    start = trace_event_begin();
+    ret = info_parse(grc);
+    trace_event_end(start, "info_parse", "parse", NULL);
 
-    /*
-     * We initialize Allegro here, so we can use anything from it from 
-     * this point. Like their color conversion, we need to do this things
-     * rigth after...
-     */
-    if (gui_init(grc) < 0)
+    if (ret < 0)
         goto end_block;
 
-    if (color_parse(grc) < 0)
+    /* Only drawn, whatever backend it was written for */
+    if (headless == true)
+        info_set_value(info, INFO_BACKEND, GRC_BACKEND_MEMORY, NULL);
+
+    if (load_gui(grc) < 0)
         goto end_block;
 
-    /* Do the translation of every GRC object to internal grc_object. */
-    if (parse_objects(grc) < 0)
+    if ((flags & GRC_INIT_RELEASE_JSON) && (parse_release_JSON(grc) < 0))
         goto end_block;
 
     return grc;
@@ -109,18 +160,36 @@ end_block:
 grc_t LIBEXPORT *grc_init_from_file(const char *grc_file,
     bool gfx)
 {
-    return grc_init(grc_file, LOAD_FROM_FILE, gfx);
+    return grc_init(grc_file, LOAD_FROM_FILE, gfx, false, 0);
 }
 
 grc_t LIBEXPORT *grc_init_from_mem(const char *data,
     bool gfx)
 {
-    return grc_init(data, LOAD_FROM_MEM, gfx);
+    return grc_init(data, LOAD_FROM_MEM, gfx, false, 0);
+}
+
+grc_t LIBEXPORT *grc_init_from_file_flags(const char *grc_file,
+    bool gfx, unsigned int flags)
+{
+    return grc_init(grc_file, LOAD_FROM_FILE, gfx, false, flags);
+}
+
+grc_t LIBEXPORT *grc_init_from_mem_flags(const char *data,
+    bool gfx, unsigned int flags)
+{
+    return grc_init(data, LOAD_FROM_MEM, gfx, false, flags);
 }
 
 grc_t LIBEXPORT *grc_create(void)
 {
-    return grc_init(NULL, LOAD_BARE_DATA, 0);
+    return grc_init(NULL, LOAD_BARE_DATA, 0, false, 0);
+}
+
+/* Loads a GRC file to be drawn by the memory backend */
+struct grc_s *grc_load_headless(const char *grc_file)
+{
+    return grc_init(grc_file, LOAD_FROM_FILE, true, true, 0);
 }
 
 /* TODO: Why do we need this function? */
@@ -140,8 +209,6 @@ int LIBEXPORT grc_init_from_bare_data(grc_t *grc)
 
 int LIBEXPORT grc_uninit(grc_t *grc)
 {
-    struct gfx_info_s *info;
-
     grc_errno_clear();
 
     if (NULL == grc) {
@@ -149,13 +216,10 @@ int LIBEXPORT grc_uninit(grc_t *grc)
         return -1;
     }
 
-    info = grc_get_info(grc);
-
-    /* Return the gfx to text mode */
-    if (info_get_value(info, INFO_USE_GFX) == true)
-        gui_reset_resolution();
-
-    /* Free the object */
+    /*
+     * Frees the object. The gfx only returns to text mode if no other
+     * DIALOG or session is using it.
+     */
     destroy_grc(grc);
 
     return 0;
@@ -163,6 +227,7 @@ int LIBEXPORT grc_uninit(grc_t *grc)
 
 int LIBEXPORT grc_prepare_dialog(grc_t *grc)
 {
+    unsigned long long start;
     int ret;
     struct gfx_info_s *info;
 
@@ -173,7 +238,11 @@ int LIBEXPORT grc_prepare_dialog(grc_t *grc)
         return -1;
     }
 
+    session_gui_lock();
+    start = trace_event_begin();
     ret = DIALOG_create(grc);
+    trace_event_end(start, "DIALOG_create", "parse", NULL);
+    session_gui_unlock();
 
     if (ret == 0) {
         /* And now we're prepared to run the DIALOG */
@@ -208,6 +277,29 @@ int LIBEXPORT grc_do_dialog(grc_t *grc)
     return 0;
 }
 
+int LIBEXPORT grc_render(grc_t *grc)
+{
+    struct gfx_info_s *info;
+
+    grc_errno_clear();
+
+    if (NULL == grc) {
+        grc_set_errno(GRC_ERROR_NULL_ARG);
+        return -1;
+    }
+
+    info = grc_get_info(grc);
+
+    if (info_get_value(info, INFO_ARE_WE_PREPARED) == false) {
+        grc_set_errno(GRC_ERROR_NOT_PREPARED_YET);
+        return -1;
+    }
+
+    render_DIALOG(grc);
+
+    return 0;
+}
+
 int LIBEXPORT grc_set_callback(grc_t *grc, const char *object_name,
     int (*callback)(grc_callback_data_t *), void *arg)
 {
@@ -293,8 +385,7 @@ grc_t LIBEXPORT *grc_get_callback_grc(grc_callback_data_t *acd)
 int LIBEXPORT grc_object_set_data(grc_t *grc, const char *object_name,
     enum grc_object_member member, void *data)
 {
-    DIALOG *d;
-    int s;
+    struct grc_object_s *o;
 
     grc_errno_clear();
 
@@ -303,59 +394,12 @@ int LIBEXPORT grc_object_set_data(grc_t *grc, const char *object_name,
         return -1;
     }
 
-    d = grc_get_DIALOG_from_tag(grc, object_name);
+    o = grc_get_object_from_tag(grc, object_name);
 
-    if (NULL == d)
+    if (NULL == o)
         return -1;
 
-    switch (member) {
-        case GRC_MEMBER_RADIO_STATE:
-        case GRC_MEMBER_CHECKBOX_STATE:
-            s = *((int *)&data);
-
-            if (s == true)
-                d->flags |= D_SELECTED;
-            else
-                d->flags &= ~D_SELECTED;
-
-            break;
-
-        case GRC_MEMBER_D1:
-        case GRC_MEMBER_SLIDER_LIMIT:
-            d->d1 = *((int *)&data);
-            break;
-
-        case GRC_MEMBER_D2:
-        case GRC_MEMBER_SLIDER_POSITION:
-            d->d2 = *((int *)&data);
-            break;
-
-        case GRC_MEMBER_DP:
-        case GRC_MEMBER_EDIT_VALUE:
-        case GRC_MEMBER_TEXT:
-        case GRC_MEMBER_LIST_CONTENT_BUILD:
-        case GRC_MEMBER_ICON:
-            d->dp = data;
-            break;
-
-        case GRC_MEMBER_DP2:
-            d->dp2 = data;
-            break;
-
-        case GRC_MEMBER_DP3:
-            /*
-             * To keep a standard in all object implemented internally we
-             * manipulate the callback structure from the object.
-             */
-            set_callback(grc, d, NULL, data);
-            break;
-
-        default:
-            grc_set_errno(GRC_ERROR_UNSUPPORTED_DATA_TYPE);
-            return -1;
-    }
-
-    return 0;
+    return grc_object_set_member(o, grc, member, data);
 }
 
 int LIBEXPORT grc_object_set_proc(grc_t *grc,
@@ -375,7 +419,7 @@ int LIBEXPORT grc_object_set_proc(grc_t *grc,
     if (NULL == d)
         return -1;
 
-    d->proc = function;
+    gui_object_set_proc(d, function);
 
     return 0;
 }
@@ -397,7 +441,15 @@ int LIBEXPORT grc_object_send_message(grc_t *grc,
     if (NULL == d)
         return -1;
 
+    /* The message can't wait, as the ones sent by Allegro */
+    if (session_gui_trylock() < 0) {
+        grc_set_errno(GRC_ERROR_GUI_BUSY);
+        return -1;
+    }
+
+    headless_select(grc);
     object_message(d, msg, c);
+    session_gui_unlock();
 
     return 0;
 }
@@ -410,7 +462,9 @@ void LIBEXPORT *grc_object_get_data(grc_t *grc,
     char tmp[512] = {0};
     void *data = NULL;
     int value = -1;
+    struct grc_object_s *o;
     DIALOG *d;
+    const char *text;
 
     grc_errno_clear();
 
@@ -419,66 +473,55 @@ void LIBEXPORT *grc_object_get_data(grc_t *grc,
         return NULL;
     }
 
-    d = grc_get_DIALOG_from_tag(grc, object_name);
+    o = grc_get_object_from_tag(grc, object_name);
 
-    if (NULL == d)
+    if (NULL == o)
         return NULL;
 
-    va_start(ap, NULL);
+    d = grc_object_get_DIALOG(o);
 
     switch (member) {
-        case GRC_MEMBER_RADIO_STATE:
-        case GRC_MEMBER_CHECKBOX_STATE:
-            if (d->flags & D_SELECTED)
-                value = 1;
-            else
-                value = 0;
-
-            break;
-
-        case GRC_MEMBER_D1:
-        case GRC_MEMBER_SLIDER_LIMIT:
-        case GRC_MEMBER_LIST_POSITION:
-            value = d->d1;
-            break;
-
-        case GRC_MEMBER_D2:
-        case GRC_MEMBER_SLIDER_POSITION:
-            value = d->d2;
-            break;
-
         case GRC_MEMBER_DP:
         case GRC_MEMBER_EDIT_VALUE:
         case GRC_MEMBER_TEXT:
-            data = d->dp;
-            break;
+            /*
+             * An 'edit' object text is only a valid string after this, which
+             * moves its gap, so it can't be done while the object edits it.
+             */
+            if (session_gui_trylock() < 0) {
+                grc_set_errno(GRC_ERROR_GUI_BUSY);
+                return NULL;
+            }
+
+            text = gui_edit_get_text(d);
+            session_gui_unlock();
+
+            return (void *)text;
 
         case GRC_MEMBER_DP2:
-            data = d->dp2;
-            break;
+            return d->dp2;
 
         case GRC_MEMBER_DP3:
-            data = d->dp3;
-            break;
+            return d->dp3;
 
         default:
-            grc_set_errno(GRC_ERROR_UNSUPPORTED_DATA_TYPE);
-            return NULL;
-    }
-
-    if (value != -1) {
-        snprintf(tmp, sizeof(tmp) - 1, ifmt, value);
-        vsscanf(tmp, ifmt, ap);
+            if (grc_object_get_member_int(o, member, &value) < 0)
+                return NULL;
 
-        /*
-         * Sets the return to a valid pointer, so the user can validate the
-         * function call.
-         */
-        data = grc;
+            break;
     }
 
+    va_start(ap, NULL);
+    snprintf(tmp, sizeof(tmp) - 1, ifmt, value);
+    vsscanf(tmp, ifmt, ap);
     va_end(ap);
 
+    /*
+     * Sets the return to a valid pointer, so the user can validate the
+     * function call.
+     */
+    data = grc;
+
     return data;
 }
 
@@ -528,6 +571,7 @@ int LIBEXPORT grc_log(grc_t *grc, const char *object_name,
     const char *msg, const char *color)
 {
     DIALOG *d;
+    unsigned int queued, dropped;
 
     grc_errno_clear();
 
@@ -542,10 +586,18 @@ int LIBEXPORT grc_log(grc_t *grc, const char *object_name,
         return -1;
 
     /* Sets internal message */
-    gui_messages_set(d->d1, d->fg, msg, color);
+    queued = gui_messages_set(d, msg, color, &dropped);
+    stats_log(grc, queued, dropped);
 
-    /* Notify the object about it */
-    object_message(d, MSG_NEW_LOG_TEXT, 0);
+    /*
+     * Notify the object about it. If another thread is using Allegro, as
+     * when the DIALOG is running, the object draws it by itself.
+     */
+    if (session_gui_trylock() == 0) {
+        headless_select(grc);
+        object_message(d, MSG_NEW_LOG_TEXT, 0);
+        session_gui_unlock();
+    }
 
     return 0;
 }
@@ -595,6 +647,264 @@ int LIBEXPORT grc_radio_get_status(grc_t *grc,
     return st;
 }
 
+/*
+ * Gets a 'list' object that is in virtual mode.
+ */
+static DIALOG *get_virtual_list(grc_t *grc, const char *object_name)
+{
+    DIALOG *d;
+
+    d = grc_get_DIALOG_from_tag(grc, object_name);
+
+    if (NULL == d)
+        return NULL;
+
+    if (gui_object_is(d, gui_d_virtual_list_proc) == false) {
+        grc_set_errno(GRC_ERROR_UNSUPPORTED_OBJECT);
+        return NULL;
+    }
+
+    return d;
+}
+
+int LIBEXPORT grc_list_set_source(grc_t *grc, const char *object_name,
+    const struct grc_list_source *source)
+{
+    DIALOG *d;
+
+    grc_errno_clear();
+
+    if ((NULL == grc) || (NULL == source)) {
+        grc_set_errno(GRC_ERROR_NULL_ARG);
+        return -1;
+    }
+
+    d = get_virtual_list(grc, object_name);
+
+    if (NULL == d)
+        return -1;
+
+    if (gui_virtual_list_set_source(d, source) < 0) {
+        grc_set_errno(GRC_ERROR_NULL_ARG);
+        return -1;
+    }
+
+    return 0;
+}
+
+int LIBEXPORT grc_list_set_rows(grc_t *grc, const char *object_name,
+    int first, int n, const char **rows)
+{
+    DIALOG *d;
+
+    grc_errno_clear();
+
+    if ((NULL == grc) || (NULL == rows)) {
+        grc_set_errno(GRC_ERROR_NULL_ARG);
+        return -1;
+    }
+
+    d = get_virtual_list(grc, object_name);
+
+    if (NULL == d)
+        return -1;
+
+    if (gui_virtual_list_set_rows(d, first, n, rows) < 0)
+        return -1;
+
+    /*
+     * Draws them at once, unless another thread is using Allegro, as when
+     * the DIALOG is running, which draws them by itself.
+     */
+    if (session_gui_trylock() == 0) {
+        headless_select(grc);
+        object_message(d, MSG_IDLE, 0);
+        session_gui_unlock();
+    }
+
+    return 0;
+}
+
+int LIBEXPORT grc_list_refresh(grc_t *grc, const char *object_name)
+{
+    DIALOG *d;
+
+    grc_errno_clear();
+
+    if (NULL == grc) {
+        grc_set_errno(GRC_ERROR_NULL_ARG);
+        return -1;
+    }
+
+    d = get_virtual_list(grc, object_name);
+
+    if (NULL == d)
+        return -1;
+
+    /*
+     * If another thread is using Allegro, as when the DIALOG is running,
+     * the object refreshes itself when it's idle.
+     */
+    if (session_gui_trylock() < 0) {
+        gui_virtual_list_request_refresh(d);
+        return 0;
+    }
+
+    headless_select(grc);
+    object_message(d, MSG_LIST_REFRESH, 0);
+    session_gui_unlock();
+
+    return 0;
+}
+
+/*
+ * Gets a 'table' object.
+ */
+static DIALOG *get_table(grc_t *grc, const char *object_name)
+{
+    DIALOG *d;
+
+    d = grc_get_DIALOG_from_tag(grc, object_name);
+
+    if (NULL == d)
+        return NULL;
+
+    if (gui_object_is(d, gui_d_table_proc) == false) {
+        grc_set_errno(GRC_ERROR_UNSUPPORTED_OBJECT);
+        return NULL;
+    }
+
+    return d;
+}
+
+int LIBEXPORT grc_table_set_source(grc_t *grc, const char *object_name,
+    const struct grc_table_source *source)
+{
+    DIALOG *d;
+
+    grc_errno_clear();
+
+    if ((NULL == grc) || (NULL == source)) {
+        grc_set_errno(GRC_ERROR_NULL_ARG);
+        return -1;
+    }
+
+    d = get_table(grc, object_name);
+
+    if (NULL == d)
+        return -1;
+
+    if (gui_table_set_source(d, source) < 0) {
+        grc_set_errno(GRC_ERROR_NULL_ARG);
+        return -1;
+    }
+
+    return 0;
+}
+
+int LIBEXPORT grc_table_update_cell(grc_t *grc, const char *object_name,
+    int row, int column)
+{
+    DIALOG *d;
+
+    grc_errno_clear();
+
+    if (NULL == grc) {
+        grc_set_errno(GRC_ERROR_NULL_ARG);
+        return -1;
+    }
+
+    d = get_table(grc, object_name);
+
+    if (NULL == d)
+        return -1;
+
+    if (gui_table_update_cell(d, row, column) < 0) {
+        grc_set_errno(GRC_ERROR_UNSUPPORTED_DATA_TYPE);
+        return -1;
+    }
+
+    /* The same as the rows of a virtual list */
+    if (session_gui_trylock() == 0) {
+        headless_select(grc);
+        object_message(d, MSG_IDLE, 0);
+        session_gui_unlock();
+    }
+
+    return 0;
+}
+
+int LIBEXPORT grc_table_refresh(grc_t *grc, const char *object_name)
+{
+    DIALOG *d;
+
+    grc_errno_clear();
+
+    if (NULL == grc) {
+        grc_set_errno(GRC_ERROR_NULL_ARG);
+        return -1;
+    }
+
+    d = get_table(grc, object_name);
+
+    if (NULL == d)
+        return -1;
+
+    if (session_gui_trylock() < 0) {
+        gui_table_request_refresh(d);
+        return 0;
+    }
+
+    headless_select(grc);
+    object_message(d, MSG_TABLE_REFRESH, 0);
+    session_gui_unlock();
+
+    return 0;
+}
+
+int LIBEXPORT grc_textbox_append(grc_t *grc, const char *object_name,
+    const char *text)
+{
+    DIALOG *d;
+    int ret;
+
+    grc_errno_clear();
+
+    if ((NULL == grc) || (NULL == text)) {
+        grc_set_errno(GRC_ERROR_NULL_ARG);
+        return -1;
+    }
+
+    d = grc_get_DIALOG_from_tag(grc, object_name);
+
+    if (NULL == d)
+        return -1;
+
+    if (gui_object_is(d, gui_d_textbox_proc) == false) {
+        grc_set_errno(GRC_ERROR_UNSUPPORTED_OBJECT);
+        return -1;
+    }
+
+    /*
+     * If another thread is using Allegro, as when the DIALOG is running,
+     * the object appends the text by itself when it's idle.
+     */
+    if (session_gui_trylock() < 0)
+        ret = gui_textbox_queue(d, text);
+    else {
+        headless_select(grc);
+        ret = gui_textbox_append(d, text);
+        session_gui_unlock();
+    }
+
+    if (ret < 0) {
+        grc_set_errno(GRC_ERROR_MEMORY);
+        return -1;
+    }
+
+    return 0;
+}
+
 char LIBEXPORT *grc_edit_get_data(grc_t *grc,
     const char *object_name)
 {
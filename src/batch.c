@@ -0,0 +1,405 @@
+/*
+ * Description: Functions to update several objects at once, with a single
+ *              redraw at the end.
+ *
+ * Author: Rodrigo Freitas
+ * Created at: Mon Oct 19 09:40:02 2026
+ * Project: libgrc
+ *
+ * Copyright (c) 2014 Rodrigo Freitas
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301
+ * USA
+ */
+
+#include <stdlib.h>
+
+#include "libgrc.h"
+
+/* Initial number of changes that a batch can hold */
+#define BATCH_INITIAL_SIZE          32
+
+enum batch_op_type {
+    BATCH_SET_DATA,
+    BATCH_HIDE,
+    BATCH_SHOW
+};
+
+/* A single pending change */
+struct batch_op {
+    enum batch_op_type      type;
+    struct grc_object_s     *object;
+    enum grc_object_member  member;
+    void                    *data;
+};
+
+/*
+ * The structure is kept between batches, so that an application updating
+ * the screen periodically does not need to allocate memory every time.
+ */
+struct grc_batch {
+    bool                    started;
+    unsigned int            size;
+    unsigned int            used;
+    struct batch_op         *op;
+};
+
+static struct grc_batch *new_grc_batch(void)
+{
+    struct grc_batch *b = NULL;
+
+    b = calloc(1, sizeof(struct grc_batch));
+
+    if (NULL == b) {
+        grc_set_errno(GRC_ERROR_MEMORY);
+        return NULL;
+    }
+
+    b->size = BATCH_INITIAL_SIZE;
+    b->op = calloc(b->size, sizeof(struct batch_op));
+
+    if (NULL == b->op) {
+        grc_set_errno(GRC_ERROR_MEMORY);
+        free(b);
+        return NULL;
+    }
+
+    return b;
+}
+
+void destroy_grc_batch(struct grc_batch *batch)
+{
+    if (NULL == batch)
+        return;
+
+    if (batch->op != NULL)
+        free(batch->op);
+
+    free(batch);
+}
+
+/*
+ * Only members which can be changed by grc_object_set_data are accepted,
+ * so that a commit never fails in the middle of the changes.
+ */
+static bool batch_member_is_supported(enum grc_object_member member)
+{
+    switch (member) {
+        case GRC_MEMBER_RADIO_STATE:
+        case GRC_MEMBER_CHECKBOX_STATE:
+        case GRC_MEMBER_D1:
+        case GRC_MEMBER_SLIDER_LIMIT:
+        case GRC_MEMBER_D2:
+        case GRC_MEMBER_SLIDER_POSITION:
+        case GRC_MEMBER_DP:
+        case GRC_MEMBER_EDIT_VALUE:
+        case GRC_MEMBER_TEXT:
+        case GRC_MEMBER_LIST_CONTENT_BUILD:
+        case GRC_MEMBER_ICON:
+        case GRC_MEMBER_DP2:
+        case GRC_MEMBER_DP3:
+            return true;
+
+        default:
+            break;
+    }
+
+    return false;
+}
+
+static int batch_add(struct grc_s *grc, const char *object_name,
+    enum batch_op_type type, enum grc_object_member member, void *data)
+{
+    struct grc_batch *b = grc->batch;
+    struct grc_object_s *o;
+    struct batch_op *op;
+
+    if ((NULL == b) || (b->started == false)) {
+        grc_set_errno(GRC_ERROR_BATCH_NOT_STARTED);
+        return -1;
+    }
+
+    if ((type == BATCH_SET_DATA) &&
+        (batch_member_is_supported(member) == false))
+    {
+        grc_set_errno(GRC_ERROR_UNSUPPORTED_DATA_TYPE);
+        return -1;
+    }
+
+    o = grc_get_object_from_tag(grc, object_name);
+
+    if (NULL == o)
+        return -1;
+
+    /* Menu items aren't part of the DIALOG */
+    if (grc_object_get_DIALOG(o) == NULL) {
+        grc_set_errno(GRC_ERROR_UNSUPPORTED_OBJECT);
+        return -1;
+    }
+
+    if (b->used == b->size) {
+        op = realloc(b->op, b->size * 2 * sizeof(struct batch_op));
+
+        if (NULL == op) {
+            grc_set_errno(GRC_ERROR_MEMORY);
+            return -1;
+        }
+
+        b->op = op;
+        b->size *= 2;
+    }
+
+    op = &b->op[b->used++];
+    op->type = type;
+    op->object = o;
+    op->member = member;
+    op->data = data;
+
+    return 0;
+}
+
+/*
+ * Draws every changed object only once. If an object was hidden we can't
+ * just draw over it, so the whole DIALOG is redrawn instead. If another
+ * thread is using Allegro, as when the DIALOG is running, the changed
+ * objects are left dirty to be redrawn by it.
+ */
+static void batch_redraw(struct grc_s *grc, bool redraw_all)
+{
+    struct grc_batch *b = grc->batch;
+    struct grc_object_s *o;
+    unsigned int i;
+    bool prepared, locked;
+    DIALOG *d;
+
+    prepared = info_get_value(grc->info, INFO_ARE_WE_PREPARED);
+
+    if ((prepared == true) && (redraw_all == true))
+        redraw_DIALOG(grc);
+
+    locked = (prepared == true) && (redraw_all == false) &&
+             (session_gui_trylock() == 0);
+
+    if (locked == true) {
+        headless_select(grc);
+        scare_mouse();
+        acquire_bitmap(gui_get_screen());
+    }
+
+    for (i = 0; i < b->used; i++) {
+        o = b->op[i].object;
+
+        if (o->redraw == false)
+            continue;
+
+        o->redraw = false;
+        d = grc_object_get_DIALOG(o);
+
+        if ((prepared == false) || (redraw_all == true) ||
+            (d->flags & D_HIDDEN))
+        {
+            continue;
+        }
+
+        if (locked == true)
+            object_message(d, MSG_DRAW, 0);
+        else
+            d->flags |= D_DIRTY;
+    }
+
+    if (locked == true) {
+        release_bitmap(gui_get_screen());
+        unscare_mouse();
+        session_gui_unlock();
+    }
+}
+
+int LIBEXPORT grc_batch_begin(grc_t *grc)
+{
+    struct grc_s *g = (struct grc_s *)grc;
+
+    grc_errno_clear();
+
+    if (NULL == grc) {
+        grc_set_errno(GRC_ERROR_NULL_ARG);
+        return -1;
+    }
+
+    if (NULL == g->batch) {
+        g->batch = new_grc_batch();
+
+        if (NULL == g->batch)
+            return -1;
+    }
+
+    if (g->batch->started == true) {
+        grc_set_errno(GRC_ERROR_BATCH_ALREADY_STARTED);
+        return -1;
+    }
+
+    g->batch->started = true;
+    g->batch->used = 0;
+
+    return 0;
+}
+
+int LIBEXPORT grc_batch_set_data(grc_t *grc, const char *object_name,
+    enum grc_object_member member, void *data)
+{
+    grc_errno_clear();
+
+    if ((NULL == grc) || (NULL == object_name)) {
+        grc_set_errno(GRC_ERROR_NULL_ARG);
+        return -1;
+    }
+
+    return batch_add(grc, object_name, BATCH_SET_DATA, member, data);
+}
+
+int LIBEXPORT grc_batch_hide(grc_t *grc, const char *object_name)
+{
+    grc_errno_clear();
+
+    if ((NULL == grc) || (NULL == object_name)) {
+        grc_set_errno(GRC_ERROR_NULL_ARG);
+        return -1;
+    }
+
+    return batch_add(grc, object_name, BATCH_HIDE, 0, NULL);
+}
+
+int LIBEXPORT grc_batch_show(grc_t *grc, const char *object_name)
+{
+    grc_errno_clear();
+
+    if ((NULL == grc) || (NULL == object_name)) {
+        grc_set_errno(GRC_ERROR_NULL_ARG);
+        return -1;
+    }
+
+    return batch_add(grc, object_name, BATCH_SHOW, 0, NULL);
+}
+
+int LIBEXPORT grc_batch_commit(grc_t *grc)
+{
+    struct grc_s *g = (struct grc_s *)grc;
+    struct grc_batch *b;
+    struct batch_op *op;
+    bool redraw_all = false;
+    unsigned int i;
+    DIALOG *d;
+
+    grc_errno_clear();
+
+    if (NULL == grc) {
+        grc_set_errno(GRC_ERROR_NULL_ARG);
+        return -1;
+    }
+
+    b = g->batch;
+
+    if ((NULL == b) || (b->started == false)) {
+        grc_set_errno(GRC_ERROR_BATCH_NOT_STARTED);
+        return -1;
+    }
+
+    /* Apply every change */
+    for (i = 0; i < b->used; i++) {
+        op = &b->op[i];
+        d = grc_object_get_DIALOG(op->object);
+
+        switch (op->type) {
+            case BATCH_SET_DATA:
+                grc_object_set_member(op->object, g, op->member, op->data);
+                break;
+
+            case BATCH_HIDE:
+                if (!(d->flags & D_HIDDEN))
+                    redraw_all = true;
+
+                d->flags |= D_HIDDEN;
+                break;
+
+            case BATCH_SHOW:
+                d->flags &= ~D_HIDDEN;
+                break;
+        }
+
+        op->object->redraw = true;
+    }
+
+    /* And draw the result */
+    batch_redraw(g, redraw_all);
+    b->started = false;
+    b->used = 0;
+
+    return 0;
+}
+
+int LIBEXPORT grc_batch_cancel(grc_t *grc)
+{
+    struct grc_s *g = (struct grc_s *)grc;
+
+    grc_errno_clear();
+
+    if (NULL == grc) {
+        grc_set_errno(GRC_ERROR_NULL_ARG);
+        return -1;
+    }
+
+    if ((NULL == g->batch) || (g->batch->started == false)) {
+        grc_set_errno(GRC_ERROR_BATCH_NOT_STARTED);
+        return -1;
+    }
+
+    g->batch->started = false;
+    g->batch->used = 0;
+
+    return 0;
+}
+
+int LIBEXPORT grc_batch_get_states(grc_t *grc,
+    struct grc_object_state *states, unsigned int n)
+{
+    struct grc_object_s *o;
+    unsigned int i;
+    int total = 0;
+
+    grc_errno_clear();
+
+    if ((NULL == grc) || (NULL == states)) {
+        grc_set_errno(GRC_ERROR_NULL_ARG);
+        return -1;
+    }
+
+    for (i = 0; i < n; i++) {
+        states[i].value = -1;
+        o = tag_index_get(((struct grc_s *)grc)->tags, states[i].tag);
+
+        if (NULL == o)
+            continue;
+
+        if (grc_object_get_member_int(o, states[i].member,
+                                      &states[i].value) == 0)
+        {
+            total++;
+        }
+    }
+
+    /* Failures from the loop must not be reported to the user */
+    grc_errno_clear();
+
+    return total;
+}
@@ -38,6 +38,17 @@ struct callback_data {
 
     /* internal */
     int             (*callback)(grc_callback_data_t *);
+
+    /* Objects with their own font */
+    FONT            *font;
+    int             (*proc)(int, DIALOG *, int);
+
+    /* Where the object is profiled, when the library is built to */
+    void            *profile;
+
+    /* Objects whose messages are written as trace events */
+    int             (*trace_proc)(int, DIALOG *, int);
+    const char      *tag;
 };
 
 /*
@@ -55,6 +66,11 @@ struct callback_data *new_callback_data(void)
     return cd;
 }
 
+size_t callback_data_memory(void)
+{
+    return sizeof(struct callback_data);
+}
+
 void destroy_callback_data(void *a)
 {
     struct callback_data *p = (struct callback_data *)a;
@@ -189,8 +205,18 @@ int set_callback(struct grc_s *grc, DIALOG *dlg,
  */
 int run_callback(struct callback_data *acd, unsigned int default_return)
 {
-    if (acd->callback != NULL)
-        return (acd->callback)(acd);
+    unsigned long long start;
+    int ret;
+
+    if (acd->callback != NULL) {
+        start = trace_event_begin();
+        ret = (acd->callback)(acd);
+        trace_event_end(start, "callback", "callback", acd->tag);
+        trace_callback(ret);
+        stats_callback(acd->grc);
+
+        return ret;
+    }
 
     return default_return;
 }
@@ -211,3 +237,78 @@ void callback_set_string(struct callback_data *acd, char *value)
     acd->value_string = value;
 }
 
+/*
+ * Keeps the font of an object and its real procedure, which is replaced by
+ * 'font_object_proc'.
+ */
+void callback_set_font(struct callback_data *acd, FONT *f,
+    int (*proc)(int, DIALOG *, int))
+{
+    if (NULL == acd)
+        return;
+
+    acd->font = f;
+    acd->proc = proc;
+}
+
+FONT *callback_get_font(struct callback_data *acd)
+{
+    if (NULL == acd)
+        return NULL;
+
+    return acd->font;
+}
+
+int (*callback_get_proc(struct callback_data *acd))(int, DIALOG *, int)
+{
+    if (NULL == acd)
+        return NULL;
+
+    return acd->proc;
+}
+
+void callback_set_profile(struct callback_data *acd, void *profile)
+{
+    if (NULL == acd)
+        return;
+
+    acd->profile = profile;
+}
+
+void *callback_get_profile(struct callback_data *acd)
+{
+    if (NULL == acd)
+        return NULL;
+
+    return acd->profile;
+}
+
+/*
+ * Keeps the real procedure of an object, which is replaced by
+ * 'trace_events_object_proc', and its name for the events.
+ */
+void callback_set_trace(struct callback_data *acd,
+    int (*proc)(int, DIALOG *, int), const char *tag)
+{
+    if (NULL == acd)
+        return;
+
+    acd->trace_proc = proc;
+    acd->tag = tag;
+}
+
+int (*callback_get_trace_proc(struct callback_data *acd))(int, DIALOG *, int)
+{
+    if (NULL == acd)
+        return NULL;
+
+    return acd->trace_proc;
+}
+
+const char *callback_get_tag(struct callback_data *acd)
+{
+    if (NULL == acd)
+        return NULL;
+
+    return acd->tag;
+}
@@ -49,10 +49,45 @@ static const char *__error_descriptions[] = {
     "Unsupported number of colors",
     "Unknown property",
     "Unsupported type",
-    "The DIALOG is not prepared to run"
+    "The DIALOG is not prepared to run",
+    "No batch update was started",
+    "A batch update is already in progress",
+    "Operation not supported by this object",
+    "Invalid or missing table columns",
+    "GRC writer function called out of order",
+    "Error writing the GRC stream",
+    "Invalid or incompatible state snapshot",
+    "Error reading or writing the state snapshot",
+    "No session was started",
+    "Error loading a font",
+    "Unknown font name",
+    "Unknown or circular object parent",
+    "Invalid design resolution",
+    "Another DIALOG is already being traced",
+    "Error reading or writing an input trace",
+    "Invalid input trace",
+    "Unknown rendering backend",
+    "Allegro is already running with another backend",
+    "Unsupported by the rendering backend",
+    "Error writing a rendered image",
+    "Too many screenshots waiting to be saved",
+    "The object is outside the screen",
+    "Error opening the remote viewing socket",
+    "The DIALOG is already being streamed",
+    "The library was built without profiling",
+    "Trace events are already being written",
+    "Error opening the trace events file",
+    "Input latency is not being measured",
+    "Invalid input event",
+    "The statistics are already published",
+    "Error creating the statistics shared memory",
+    "The GUI is being used by another thread",
+    "Too many keys injected before the next frame",
+    "Another DIALOG is using a different graphic mode"
 };
 
-static int __grc_errno;
+/* Each thread sees only its own errors */
+static __thread int __grc_errno;
 static const char *__unknown_error = "Unknown error";
 
 void grc_errno_clear(void)
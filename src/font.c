@@ -0,0 +1,663 @@
+/*
+ * Description: Functions to handle the fonts declared inside a GRC, drawing
+ *              their text from glyph atlases.
+ *
+ * Author: Rodrigo Freitas
+ * Created at: Mon Oct 19 17:12:08 2026
+ * Project: libgrc
+ *
+ * Copyright (c) 2014 Rodrigo Freitas
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301
+ * USA
+ */
+
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "libgrc.h"
+
+#include <allegro/internal/aintern.h>
+
+/* Glyphs kept inside an atlas, the others are drawn by the font itself */
+#define FONT_FIRST_GLYPH            32
+#define FONT_LAST_GLYPH             255
+#define FONT_GLYPHS                 (FONT_LAST_GLYPH - FONT_FIRST_GLYPH + 1)
+
+#define FONT_ATLAS_COLUMNS          16
+#define FONT_ATLAS_ROWS             \
+    ((FONT_GLYPHS + FONT_ATLAS_COLUMNS - 1) / FONT_ATLAS_COLUMNS)
+
+/* How many text colors of a single font have their own atlas */
+#define FONT_MAX_ATLASES            8
+
+/*
+ * A mono font glyph has no color of its own, so every text color used with a
+ * font gets an atlas, at the color depth it's drawn to. DIALOGs of the
+ * memory backend may each have a depth of their own, and the same color
+ * value means something else at each one.
+ */
+struct font_atlas {
+    int                 fg;
+    int                 depth;
+    BITMAP              *bmp;
+};
+
+/*
+ * A FONT drawing from atlases. Allegro only sees its vtable, so every object
+ * keeps calling text_length and textout_ex as usual.
+ */
+struct atlas_font {
+    FONT                font;       /** Must be the first member */
+    FONT                *src;       /** The real font, loaded from @file */
+    char                *file;      /** NULL for the Allegro default font */
+    int                 cell_w;
+
+    /* Width of every glyph, shared by all objects using the font */
+    int                 width[FONT_GLYPHS];
+
+    struct font_atlas   atlas[FONT_MAX_ATLASES];
+    unsigned int        n_atlas;
+    unsigned int        next_atlas; /** Next one replaced when it's full */
+
+    struct atlas_font   *next;
+};
+
+/* A font as it is known by a single GRC */
+struct grc_font {
+    cl_list_entry_t     *prev;
+    cl_list_entry_t     *next;
+    cl_string_t         *name;
+    FONT                *font;
+    bool                resolution; /** Only used at a specific resolution */
+};
+
+/*
+ * Fonts are loaded once and shared by every DIALOG of the session, while
+ * Allegro is installed.
+ */
+static struct {
+    pthread_mutex_t     lock;
+    struct atlas_font   *fonts;
+    FONT                *allegro_font;
+
+    /* Bytes of every atlas, read by grc_memory_usage from any thread */
+    size_t              atlas_memory;
+} __fonts = {
+    .lock = PTHREAD_MUTEX_INITIALIZER,
+};
+
+static bool is_atlas_glyph(int c)
+{
+    return (c >= FONT_FIRST_GLYPH) && (c <= FONT_LAST_GLYPH);
+}
+
+static void glyph_position(const struct atlas_font *af, int c, int *x, int *y)
+{
+    c -= FONT_FIRST_GLYPH;
+    *x = (c % FONT_ATLAS_COLUMNS) * af->cell_w;
+    *y = (c / FONT_ATLAS_COLUMNS) * af->font.height;
+}
+
+static BITMAP *atlas_create(struct atlas_font *af, int fg, int depth)
+{
+    BITMAP *bmp;
+    int c, x, y;
+
+    bmp = create_bitmap_ex(depth, af->cell_w * FONT_ATLAS_COLUMNS,
+                           af->font.height * FONT_ATLAS_ROWS);
+
+    if (NULL == bmp)
+        return NULL;
+
+    clear_to_color(bmp, bitmap_mask_color(bmp));
+
+    for (c = FONT_FIRST_GLYPH; c <= FONT_LAST_GLYPH; c++) {
+        glyph_position(af, c, &x, &y);
+        af->src->vtable->render_char(af->src, c, fg, -1, bmp, x, y);
+    }
+
+    return bmp;
+}
+
+static void atlas_destroy(struct font_atlas *a)
+{
+    __atomic_sub_fetch(&__fonts.atlas_memory, bitmap_memory(a->bmp),
+                       __ATOMIC_RELAXED);
+
+    destroy_bitmap(a->bmp);
+    a->bmp = NULL;
+}
+
+/*
+ * Gets the atlas to draw with @fg into @dst, creating it if needed. Returns
+ * NULL when the text must be drawn by the font itself.
+ */
+static BITMAP *font_atlas(struct atlas_font *af, int fg, BITMAP *dst)
+{
+    struct font_atlas *a;
+    int depth = bitmap_color_depth(dst);
+    unsigned int i;
+
+    /* The color would be transparent, or the atlas can't be blitted */
+    if ((fg == bitmap_mask_color(dst)) || (depth != get_color_depth()))
+        return NULL;
+
+    for (i = 0; i < af->n_atlas; i++)
+        if ((af->atlas[i].fg == fg) && (af->atlas[i].depth == depth))
+            return af->atlas[i].bmp;
+
+    if (af->n_atlas < FONT_MAX_ATLASES)
+        a = &af->atlas[af->n_atlas++];
+    else {
+        a = &af->atlas[af->next_atlas];
+        af->next_atlas = (af->next_atlas + 1) % FONT_MAX_ATLASES;
+
+        if (a->bmp != NULL)
+            atlas_destroy(a);
+    }
+
+    a->fg = fg;
+    a->depth = depth;
+    a->bmp = atlas_create(af, fg, depth);
+
+    if (NULL == a->bmp) {
+        /* Keeps the slot, it will be tried again */
+        a->fg = bitmap_mask_color(dst);
+        return NULL;
+    }
+
+    __atomic_add_fetch(&__fonts.atlas_memory, bitmap_memory(a->bmp),
+                       __ATOMIC_RELAXED);
+
+    return a->bmp;
+}
+
+static void atlas_flush(struct atlas_font *af)
+{
+    unsigned int i;
+
+    for (i = 0; i < af->n_atlas; i++)
+        if (af->atlas[i].bmp != NULL)
+            atlas_destroy(&af->atlas[i]);
+
+    af->n_atlas = 0;
+    af->next_atlas = 0;
+}
+
+/*
+ *
+ * FONT vtable
+ *
+ */
+
+static int atlas_font_height(const FONT *f)
+{
+    return f->height;
+}
+
+static int atlas_font_char_length(const FONT *f, int ch)
+{
+    const struct atlas_font *af = (const struct atlas_font *)f;
+
+    if (is_atlas_glyph(ch) == true)
+        return af->width[ch - FONT_FIRST_GLYPH];
+
+    return af->src->vtable->char_length(af->src, ch);
+}
+
+static int atlas_font_text_length(const FONT *f, const char *text)
+{
+    const char *p = text;
+    int c, w = 0;
+
+    while ((c = ugetxc(&p)) != 0)
+        w += atlas_font_char_length(f, c);
+
+    return w;
+}
+
+static int atlas_font_render_char(const FONT *f, int ch, int fg, int bg,
+    BITMAP *bmp, int x, int y)
+{
+    const struct atlas_font *af = (const struct atlas_font *)f;
+
+    return af->src->vtable->render_char(af->src, ch, fg, bg, bmp, x, y);
+}
+
+/* The whole text is drawn with one masked blit per glyph */
+static void atlas_font_render(const FONT *f, const char *text, int fg, int bg,
+    BITMAP *bmp, int x, int y)
+{
+    struct atlas_font *af = (struct atlas_font *)f;
+    const char *p = text;
+    BITMAP *atlas;
+    int c, gx, gy, w;
+
+    atlas = font_atlas(af, fg, bmp);
+
+    if (NULL == atlas) {
+        af->src->vtable->render(af->src, text, fg, bg, bmp, x, y);
+        return;
+    }
+
+    acquire_bitmap(bmp);
+
+    if (bg >= 0)
+        rectfill(bmp, x, y, x + atlas_font_text_length(f, text) - 1,
+                 y + f->height - 1, bg);
+
+    while ((c = ugetxc(&p)) != 0) {
+        if (is_atlas_glyph(c) == false) {
+            x += af->src->vtable->render_char(af->src, c, fg, -1, bmp, x, y);
+            continue;
+        }
+
+        glyph_position(af, c, &gx, &gy);
+        w = af->width[c - FONT_FIRST_GLYPH];
+        masked_blit(atlas, bmp, gx, gy, x, y, w, f->height);
+        x += w;
+    }
+
+    release_bitmap(bmp);
+}
+
+/* The font belongs to the session, so nobody else may destroy it */
+static void atlas_font_destroy(FONT *f __attribute__((unused)))
+{
+}
+
+static int atlas_font_get_ranges(FONT *f)
+{
+    FONT *src = ((struct atlas_font *)f)->src;
+
+    return src->vtable->get_font_ranges(src);
+}
+
+static int atlas_font_get_range_begin(FONT *f, int range)
+{
+    FONT *src = ((struct atlas_font *)f)->src;
+
+    return src->vtable->get_font_range_begin(src, range);
+}
+
+static int atlas_font_get_range_end(FONT *f, int range)
+{
+    FONT *src = ((struct atlas_font *)f)->src;
+
+    return src->vtable->get_font_range_end(src, range);
+}
+
+static FONT *atlas_font_extract_range(FONT *f, int begin, int end)
+{
+    FONT *src = ((struct atlas_font *)f)->src;
+
+    return src->vtable->extract_font_range(src, begin, end);
+}
+
+static FONT *atlas_font_merge(FONT *f1, FONT *f2)
+{
+    FONT *src = ((struct atlas_font *)f1)->src;
+
+    return src->vtable->merge_fonts(src, f2);
+}
+
+static int atlas_font_transpose(FONT *f, int drange)
+{
+    FONT *src = ((struct atlas_font *)f)->src;
+
+    return src->vtable->transpose_font(src, drange);
+}
+
+static FONT_VTABLE __atlas_font_vtable = {
+    atlas_font_height,
+    atlas_font_char_length,
+    atlas_font_text_length,
+    atlas_font_render_char,
+    atlas_font_render,
+    atlas_font_destroy,
+    atlas_font_get_ranges,
+    atlas_font_get_range_begin,
+    atlas_font_get_range_end,
+    atlas_font_extract_range,
+    atlas_font_merge,
+    atlas_font_transpose
+};
+
+/*
+ *
+ * Session fonts
+ *
+ */
+
+static struct atlas_font *new_atlas_font(FONT *src, const char *file)
+{
+    struct atlas_font *af;
+    int c, w;
+
+    af = calloc(1, sizeof(struct atlas_font));
+
+    if (NULL == af) {
+        grc_set_errno(GRC_ERROR_MEMORY);
+        return NULL;
+    }
+
+    if (file != NULL) {
+        af->file = strdup(file);
+
+        if (NULL == af->file) {
+            free(af);
+            grc_set_errno(GRC_ERROR_MEMORY);
+            return NULL;
+        }
+    }
+
+    af->src = src;
+    af->font.height = src->vtable->font_height(src);
+    af->font.vtable = &__atlas_font_vtable;
+
+    /* Every glyph is measured only once */
+    for (c = FONT_FIRST_GLYPH; c <= FONT_LAST_GLYPH; c++) {
+        w = src->vtable->char_length(src, c);
+        af->width[c - FONT_FIRST_GLYPH] = w;
+        af->cell_w = MAX(af->cell_w, w);
+    }
+
+    return af;
+}
+
+static void destroy_atlas_font(struct atlas_font *af)
+{
+    atlas_flush(af);
+
+    /* The Allegro default font is not ours */
+    if (af->file != NULL) {
+        destroy_font(af->src);
+        free(af->file);
+    }
+
+    free(af);
+}
+
+/*
+ * Replaces the Allegro default font, so objects without a font of their own
+ * also draw from an atlas. Must be called right after Allegro is installed.
+ */
+void font_install(void)
+{
+    struct atlas_font *af;
+
+    pthread_mutex_lock(&__fonts.lock);
+
+    if ((NULL == __fonts.allegro_font) && (font != NULL)) {
+        af = new_atlas_font(font, NULL);
+
+        if (af != NULL) {
+            af->next = __fonts.fonts;
+            __fonts.fonts = af;
+            __fonts.allegro_font = font;
+            font = &af->font;
+        }
+    }
+
+    pthread_mutex_unlock(&__fonts.lock);
+}
+
+/* Releases every font of the session, before Allegro is finished */
+void font_uninstall(void)
+{
+    struct atlas_font *af;
+
+    pthread_mutex_lock(&__fonts.lock);
+
+    if (__fonts.allegro_font != NULL) {
+        font = __fonts.allegro_font;
+        __fonts.allegro_font = NULL;
+    }
+
+    while (__fonts.fonts != NULL) {
+        af = __fonts.fonts;
+        __fonts.fonts = af->next;
+        destroy_atlas_font(af);
+    }
+
+    pthread_mutex_unlock(&__fonts.lock);
+}
+
+/*
+ * The atlases were created at the color depth of the previous graphic mode,
+ * so they are created again when needed.
+ */
+void font_flush_atlases(void)
+{
+    struct atlas_font *af;
+
+    pthread_mutex_lock(&__fonts.lock);
+
+    for (af = __fonts.fonts; af; af = af->next)
+        atlas_flush(af);
+
+    pthread_mutex_unlock(&__fonts.lock);
+}
+
+/* Bytes of the atlases of every font, shared by all DIALOGs */
+size_t font_atlas_memory(void)
+{
+    return __atomic_load_n(&__fonts.atlas_memory, __ATOMIC_RELAXED);
+}
+
+/* Loads a font from @file, unless another DIALOG has already loaded it */
+static FONT *font_load(const char *file)
+{
+    struct atlas_font *af;
+    FONT *src;
+
+    pthread_mutex_lock(&__fonts.lock);
+
+    for (af = __fonts.fonts; af; af = af->next)
+        if ((af->file != NULL) && (strcmp(af->file, file) == 0))
+            goto end_block;
+
+    src = load_font(file, NULL, NULL);
+
+    if (NULL == src) {
+        grc_set_errno(GRC_ERROR_FONT_LOAD);
+        goto end_block;
+    }
+
+    af = new_atlas_font(src, file);
+
+    if (NULL == af) {
+        destroy_font(src);
+        goto end_block;
+    }
+
+    af->next = __fonts.fonts;
+    __fonts.fonts = af;
+
+end_block:
+    pthread_mutex_unlock(&__fonts.lock);
+
+    return (af != NULL) ? &af->font : NULL;
+}
+
+/*
+ *
+ * GRC fonts
+ *
+ */
+
+static void destroy_grc_font(void *a)
+{
+    struct grc_font *gf = (struct grc_font *)a;
+
+    if (NULL == gf)
+        return;
+
+    if (gf->name != NULL)
+        cl_string_unref(gf->name);
+
+    free(gf);
+}
+
+void font_finish(struct grc_font *fonts)
+{
+    if (fonts != NULL)
+        cl_dll_free(fonts, destroy_grc_font);
+}
+
+/*
+ * A font declared with a "resolution" is a variant of the font with the same
+ * name, to be used only when the DIALOG runs at that resolution. Returns 1
+ * if it must be used, 0 if not or -1 on error.
+ */
+static int font_resolution_matches(struct grc_s *grc, cl_json_t *jfont)
+{
+    cl_string_t *res;
+    int w = 0, h = 0, ret;
+
+    res = grc_get_object_str(jfont, OBJ_RESOLUTION);
+
+    if (NULL == res)
+        return 1;
+
+    if (sscanf(cl_string_valueof(res), "%dx%d", &w, &h) != 2) {
+        grc_set_errno(GRC_ERROR_INVALID_DESIGN_RESOLUTION);
+        ret = -1;
+    } else
+        ret = (w == info_get_value(grc->info, INFO_WIDTH)) &&
+              (h == info_get_value(grc->info, INFO_HEIGHT));
+
+    cl_string_unref(res);
+
+    return ret;
+}
+
+static int load_grc_font(struct grc_s *grc, cl_json_t *jfont)
+{
+    struct grc_font *gf = NULL;
+    cl_string_t *file = NULL;
+    int use;
+
+    /* Variants for other resolutions are not even loaded */
+    use = font_resolution_matches(grc, jfont);
+
+    if (use <= 0)
+        return use;
+
+    gf = calloc(1, sizeof(struct grc_font));
+
+    if (NULL == gf) {
+        grc_set_errno(GRC_ERROR_MEMORY);
+        return -1;
+    }
+
+    gf->name = grc_get_object_str(jfont, OBJ_NAME);
+    file = grc_get_object_str(jfont, OBJ_FILE);
+
+    if ((NULL == gf->name) || (NULL == file)) {
+        grc_set_errno(GRC_ERROR_UNDEFINED_GRC_KEY);
+        goto error_block;
+    }
+
+    gf->resolution = (cl_json_get_object_item(jfont, OBJ_RESOLUTION) != NULL);
+    gf->font = font_load(cl_string_valueof(file));
+
+    if (NULL == gf->font)
+        goto error_block;
+
+    cl_string_unref(file);
+    grc->fonts = cl_dll_unshift(grc->fonts, gf);
+
+    return 0;
+
+error_block:
+    if (file != NULL)
+        cl_string_unref(file);
+
+    destroy_grc_font(gf);
+
+    return -1;
+}
+
+/*
+ * Loads the fonts declared inside the GRC. The block is optional, a GRC
+ * without it uses only the Allegro default font.
+ */
+int font_parse(struct grc_s *grc)
+{
+    cl_json_t *jfonts, *p;
+    int t_fonts, i;
+
+    jfonts = grc_get_object(grc, OBJ_FONTS);
+
+    if (NULL == jfonts)
+        return 0;
+
+    t_fonts = cl_json_get_array_size(jfonts);
+
+    for (i = 0; i < t_fonts; i++) {
+        p = cl_json_get_array_item(jfonts, i);
+
+        if ((NULL == p) || (load_grc_font(grc, p) < 0))
+            return -1;
+    }
+
+    return 0;
+}
+
+/*
+ * Gets a font declared inside the GRC by its name, preferring the variant
+ * made for the current resolution.
+ */
+FONT *font_get(struct grc_s *grc, const char *name)
+{
+    struct grc_font *gf;
+    FONT *f = NULL;
+
+    for (gf = grc->fonts; gf; gf = gf->next) {
+        if (strcmp(cl_string_valueof(gf->name), name) != 0)
+            continue;
+
+        if (gf->resolution == true)
+            return gf->font;
+
+        f = gf->font;
+    }
+
+    if (NULL == f)
+        grc_set_errno(GRC_ERROR_UNKNOWN_FONT);
+
+    return f;
+}
+
+/*
+ * Replaces the procedure of objects with their own font. Every widget uses
+ * the Allegro global font, so it is swapped only while the object runs.
+ */
+int font_object_proc(int msg, DIALOG *d, int c)
+{
+    struct callback_data *acd = d->dp3;
+    FONT *f = font;
+    int ret;
+
+    font = callback_get_font(acd);
+    ret = (callback_get_proc(acd))(msg, d, c);
+    font = f;
+
+    return ret;
+}
@@ -0,0 +1,237 @@
+/*
+ * Description: Functions to manipulate a 'struct gap_buffer' structure, the
+ *              text storage of the 'edit' objects.
+ *
+ * Author: Rodrigo Freitas
+ * Created at: Mon Oct 19 13:02:17 2026
+ * Project: libgrc
+ *
+ * Copyright (c) 2014 Rodrigo Freitas
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301
+ * USA
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "libgrc.h"
+
+/* Initial size of a buffer without length limit */
+#define GAP_BUFFER_INITIAL_SIZE     64
+
+/*
+ * The text is kept in @buf, around a gap that starts at @gap_start and ends
+ * before @gap_end. Insertions and deletions happen at the gap, so moving it
+ * only costs the distance between two consecutive edits.
+ *
+ * The gap is never empty, so that gap_buffer_text is always able to write
+ * the string terminator.
+ */
+struct gap_buffer {
+    char            *buf;
+    unsigned int    size;
+    unsigned int    gap_start;
+    unsigned int    gap_end;
+    unsigned int    limit;      /** Maximum text length, 0 for none */
+};
+
+struct gap_buffer *new_gap_buffer(unsigned int limit)
+{
+    struct gap_buffer *gb = NULL;
+
+    gb = calloc(1, sizeof(struct gap_buffer));
+
+    if (NULL == gb) {
+        grc_set_errno(GRC_ERROR_MEMORY);
+        return NULL;
+    }
+
+    gb->limit = limit;
+    gb->size = (limit > 0) ? limit + 1 : GAP_BUFFER_INITIAL_SIZE;
+    gb->buf = calloc(gb->size, sizeof(char));
+
+    if (NULL == gb->buf) {
+        grc_set_errno(GRC_ERROR_MEMORY);
+        free(gb);
+        return NULL;
+    }
+
+    gb->gap_end = gb->size;
+
+    return gb;
+}
+
+void destroy_gap_buffer(struct gap_buffer *gb)
+{
+    if (NULL == gb)
+        return;
+
+    if (gb->buf != NULL)
+        free(gb->buf);
+
+    free(gb);
+}
+
+unsigned int gap_buffer_length(const struct gap_buffer *gb)
+{
+    return gb->size - (gb->gap_end - gb->gap_start);
+}
+
+unsigned int gap_buffer_limit(const struct gap_buffer *gb)
+{
+    return gb->limit;
+}
+
+char gap_buffer_at(const struct gap_buffer *gb, unsigned int pos)
+{
+    if (pos < gb->gap_start)
+        return gb->buf[pos];
+
+    pos += gb->gap_end - gb->gap_start;
+
+    if (pos >= gb->size)
+        return '\0';
+
+    return gb->buf[pos];
+}
+
+static void gap_buffer_move(struct gap_buffer *gb, unsigned int pos)
+{
+    unsigned int n;
+
+    if (pos < gb->gap_start) {
+        n = gb->gap_start - pos;
+        memmove(gb->buf + gb->gap_end - n, gb->buf + pos, n);
+        gb->gap_start -= n;
+        gb->gap_end -= n;
+    } else if (pos > gb->gap_start) {
+        n = pos - gb->gap_start;
+        memmove(gb->buf + gb->gap_start, gb->buf + gb->gap_end, n);
+        gb->gap_start += n;
+        gb->gap_end += n;
+    }
+}
+
+/* Makes room for, at least, @n bytes plus the string terminator */
+static int gap_buffer_reserve(struct gap_buffer *gb, unsigned int n)
+{
+    unsigned int size, tail;
+    char *p;
+
+    if (gb->gap_end - gb->gap_start > n)
+        return 0;
+
+    size = gb->size * 2;
+
+    while (size - gap_buffer_length(gb) <= n)
+        size *= 2;
+
+    p = realloc(gb->buf, size);
+
+    if (NULL == p) {
+        grc_set_errno(GRC_ERROR_MEMORY);
+        return -1;
+    }
+
+    /* Moves the text after the gap to the end of the new area */
+    tail = gb->size - gb->gap_end;
+    memmove(p + size - tail, p + gb->gap_end, tail);
+    gb->buf = p;
+    gb->gap_end = size - tail;
+    gb->size = size;
+
+    return 0;
+}
+
+/*
+ * Inserts @n bytes from @s at @pos. Fails, without changing anything, if the
+ * text would exceed the buffer limit.
+ */
+int gap_buffer_insert(struct gap_buffer *gb, unsigned int pos, const char *s,
+    unsigned int n)
+{
+    unsigned int length = gap_buffer_length(gb);
+
+    if (pos > length)
+        pos = length;
+
+    if ((gb->limit > 0) && (length + n > gb->limit))
+        return -1;
+
+    if (gap_buffer_reserve(gb, n) < 0)
+        return -1;
+
+    gap_buffer_move(gb, pos);
+    memcpy(gb->buf + gb->gap_start, s, n);
+    gb->gap_start += n;
+
+    return 0;
+}
+
+void gap_buffer_delete(struct gap_buffer *gb, unsigned int pos, unsigned int n)
+{
+    unsigned int length = gap_buffer_length(gb);
+
+    if (pos >= length)
+        return;
+
+    if (pos + n > length)
+        n = length - pos;
+
+    gap_buffer_move(gb, pos);
+    gb->gap_end += n;
+}
+
+/*
+ * Replaces the whole content. A text longer than the buffer limit is
+ * truncated.
+ */
+int gap_buffer_set(struct gap_buffer *gb, const char *s)
+{
+    unsigned int n = strlen(s);
+
+    if ((gb->limit > 0) && (n > gb->limit))
+        n = gb->limit;
+
+    gb->gap_start = 0;
+    gb->gap_end = gb->size;
+
+    return gap_buffer_insert(gb, 0, s, n);
+}
+
+/*
+ * Gets the content as a regular string. The gap is moved to the end of the
+ * text, so this must not be called on every change.
+ */
+const char *gap_buffer_text(struct gap_buffer *gb)
+{
+    gap_buffer_move(gb, gap_buffer_length(gb));
+    gb->buf[gb->gap_start] = '\0';
+
+    return gb->buf;
+}
+
+/* The storage, which is only a valid string after gap_buffer_text */
+const char *gap_buffer_storage(const struct gap_buffer *gb)
+{
+    return gb->buf;
+}
+
+/* Bytes allocated by the buffer, including its gap */
+size_t gap_buffer_memory(const struct gap_buffer *gb)
+{
+    return sizeof(struct gap_buffer) + gb->size;
+}
@@ -33,6 +33,13 @@
  */
 void destroy_grc(struct grc_s *grc)
 {
+    /* Objects started by grc_render still hold their resources */
+    if (grc->rendered == true)
+        stop_render_DIALOG(grc);
+
+    if (grc->remote != NULL)
+        remote_stop(grc);
+
     if (grc->ui_objects != NULL)
         cl_dll_free(grc->ui_objects, destroy_grc_object);
 
@@ -45,16 +52,54 @@ void destroy_grc(struct grc_s *grc)
     if (grc->dlg != NULL)
         free(grc->dlg);
 
+    if (grc->profile != NULL)
+        profile_detach(grc);
+
+    if (grc->latency != NULL)
+        latency_detach(grc);
+
+    if (grc->stats != NULL)
+        stats_destroy(grc);
+
     if (grc->jgrc != NULL)
         cl_json_delete(grc->jgrc);
 
+    if (grc->strings != NULL)
+        destroy_string_table(grc->strings);
+
     if (grc->info != NULL)
         info_finish(grc->info);
 
     if (grc->color != NULL)
         color_finish(grc->color);
 
+    if (grc->tags != NULL)
+        destroy_tag_index(grc->tags);
+
+    if (grc->batch != NULL)
+        destroy_grc_batch(grc->batch);
+
+    if (grc->stream != NULL)
+        destroy_writer_stream(grc->stream);
+
     grc_release_internal_data(grc);
+
+    if (grc->save_under != NULL)
+        destroy_bitmap(grc->save_under);
+
+    if (grc->fonts != NULL)
+        font_finish(grc->fonts);
+
+    if (grc->layout != NULL)
+        destroy_layout(grc->layout);
+
+    if (grc->framebuffer != NULL)
+        headless_destroy_framebuffer(grc);
+
+    /* Allegro must be the last one to go */
+    if (grc->session == true)
+        session_release();
+
     free(grc);
 }
 
@@ -73,11 +118,22 @@ struct grc_s *new_grc(void)
     }
 
     g->jgrc = NULL;
+    g->strings = NULL;
     g->dlg = NULL;
     g->ui_objects = NULL;
     g->tmp_objects = NULL;
     g->ui_keys = NULL;
     g->ui_menu = NULL;
+    g->batch = NULL;
+    g->stream = NULL;
+    g->session = false;
+    g->save_under = NULL;
+    g->framebuffer = NULL;
+    g->rendered = false;
+    g->remote = NULL;
+    g->profile = NULL;
+    g->latency = NULL;
+    g->stats = NULL;
 
     g->info = info_start();
 
@@ -94,6 +150,15 @@ struct grc_s *new_grc(void)
         return NULL;
     }
 
+    g->tags = new_tag_index();
+
+    if (NULL == g->tags) {
+        color_finish(g->color);
+        info_finish(g->info);
+        free(g);
+        return NULL;
+    }
+
     /*
      * Let the virtual keyboard disabled by now. If there is such an object
      * this flag will be enabled later.
@@ -109,60 +174,61 @@ struct grc_s *new_grc(void)
     return g;
 }
 
-DIALOG *grc_get_DIALOG_from_tag(struct grc_s *grc, const char *tag)
+/*
+ * Stores an object inside the tag index, so it can be found later by the
+ * API functions. Objects without a tag are silently ignored.
+ */
+void grc_creates_reference(struct grc_s *grc, struct grc_object_s *object)
 {
-    struct tmp_list {
-        struct grc_object_s *ui;
-    };
-
-    DIALOG *d = NULL;
-    unsigned int i, t;
-    struct grc_object_s *p;
-    struct tmp_list ui_list[] = {
-        { grc->ui_objects },
-        { grc->ui_keys },
-        { grc->ui_menu },
-        { grc->tmp_objects }
-    };
-
-    t = sizeof(ui_list) / sizeof(ui_list[0]);
-
-    for (i = 0; i < t; i++) {
-        p = ui_list[i].ui;
-        d = grc_object_get_DIALOG_from_tag(p, tag);
-
-        if (d != NULL)
-            return d;
+    if ((NULL == grc) || (NULL == object) || (NULL == object->tag))
+        return;
+
+    if (tag_index_add(grc->tags, object) < 0)
+        grc_set_errno(GRC_ERROR_NEW_REF);
+}
+
+struct grc_object_s *grc_get_object_from_tag(struct grc_s *grc,
+    const char *tag)
+{
+    struct grc_object_s *o;
+
+    if ((NULL == grc) || (NULL == tag)) {
+        grc_set_errno(GRC_ERROR_NULL_ARG);
+        return NULL;
+    }
+
+    o = tag_index_get(grc->tags, tag);
+
+    if (NULL == o) {
+        grc_set_errno(GRC_ERROR_OBJECT_NOT_FOUND);
+        return NULL;
     }
 
-    return NULL;
+    return o;
+}
+
+DIALOG *grc_get_DIALOG_from_tag(struct grc_s *grc, const char *tag)
+{
+    struct grc_object_s *o;
+
+    o = grc_get_object_from_tag(grc, tag);
+
+    if (NULL == o)
+        return NULL;
+
+    return grc_object_get_DIALOG(o);
 }
 
 MENU *grc_get_MENU_from_tag(struct grc_s *grc, const char *tag)
 {
-    struct tmp_list {
-        struct grc_object_s *ui;
-    };
-
-    MENU *m = NULL;
-    unsigned int i, t;
-    struct grc_object_s *p;
-    struct tmp_list ui_list[] = {
-        { grc->ui_menu },
-        { grc->tmp_objects }
-    };
-
-    t = sizeof(ui_list) / sizeof(ui_list[0]);
-
-    for (i = 0; i < t; i++) {
-        p = ui_list[i].ui;
-        m = grc_object_get_MENU_from_tag(p, tag);
-
-        if (m != NULL)
-            return m;
-    }
+    struct grc_object_s *o;
+
+    o = grc_get_object_from_tag(grc, tag);
+
+    if (NULL == o)
+        return NULL;
 
-    return NULL;
+    return grc_object_get_MENU(o);
 }
 
 struct gfx_info_s *grc_get_info(struct grc_s *grc)
@@ -27,6 +27,7 @@
 #include <stdlib.h>
 
 #include "libgrc.h"
+#include "gui/objects.h"
 
 void destroy_grc_object(void *a)
 {
@@ -50,6 +51,10 @@ void destroy_grc_object(void *a)
     if (p->tag != NULL)
         free(p->tag);
 
+    /* Destroy the internal state of the object */
+    if ((p->priv != NULL) && (p->free_priv != NULL))
+        (p->free_priv)(p->priv);
+
     free(p);
 }
 
@@ -98,6 +103,13 @@ DIALOG *grc_object_get_DIALOG(struct grc_object_s *object)
     if (NULL == object)
         return NULL;
 
+    /*
+     * After the DIALOG is created, the object that Allegro really uses is
+     * the copy inside it.
+     */
+    if (object->rdlg != NULL)
+        return object->rdlg;
+
     return object->dlg;
 }
 
@@ -126,6 +138,26 @@ void grc_object_set_tag(struct grc_object_s *object, const char *tag)
     object->tag = strdup(tag);
 }
 
+void *grc_object_get_private_data(struct grc_object_s *object)
+{
+    if (NULL == object)
+        return NULL;
+
+    return object->priv;
+}
+
+int grc_object_set_private_data(struct grc_object_s *object, void *ptr,
+    void (*free_priv)(void *))
+{
+    if (NULL == object)
+        return -1;
+
+    object->priv = ptr;
+    object->free_priv = free_priv;
+
+    return 0;
+}
+
 static int search_object_by_tag(void *a, void *b)
 {
     struct grc_object_s *o = (struct grc_object_s *)a;
@@ -177,7 +209,124 @@ MENU *grc_object_get_MENU_from_tag(struct grc_object_s *object, const char *tag)
 }
 
 /*
- * TODO: Add function to store a grc_generic_data node and remove the code
- *       that does this from parser.c
+ * Changes an object member that can receive variable data.
  */
+int grc_object_set_member(struct grc_object_s *object, struct grc_s *grc,
+    enum grc_object_member member, void *data)
+{
+    DIALOG *d;
+    int s;
+
+    d = grc_object_get_DIALOG(object);
 
+    if (NULL == d) {
+        grc_set_errno(GRC_ERROR_NULL_ARG);
+        return -1;
+    }
+
+    switch (member) {
+        case GRC_MEMBER_RADIO_STATE:
+        case GRC_MEMBER_CHECKBOX_STATE:
+            s = *((int *)&data);
+
+            if (s == true)
+                d->flags |= D_SELECTED;
+            else
+                d->flags &= ~D_SELECTED;
+
+            break;
+
+        case GRC_MEMBER_D1:
+        case GRC_MEMBER_SLIDER_LIMIT:
+            d->d1 = *((int *)&data);
+            break;
+
+        case GRC_MEMBER_D2:
+        case GRC_MEMBER_SLIDER_POSITION:
+            d->d2 = *((int *)&data);
+            break;
+
+        case GRC_MEMBER_DP:
+            /*
+             * An 'image' object owns its bitmap, so it may be replaced by
+             * one at the real resolution, only once, and is released with
+             * the object or when another one is given.
+             */
+            if (gui_object_is(d, gui_d_bitmap_proc) == true) {
+                data = scale_image(grc, data);
+
+                if ((object->priv != NULL) && (object->priv != data))
+                    gui_bitmap_destroy(object->priv);
+
+                grc_object_set_private_data(object, data, gui_bitmap_destroy);
+            }
+
+            d->dp = data;
+            break;
+
+        case GRC_MEMBER_EDIT_VALUE:
+        case GRC_MEMBER_TEXT:
+        case GRC_MEMBER_LIST_CONTENT_BUILD:
+        case GRC_MEMBER_ICON:
+            d->dp = data;
+            break;
+
+        case GRC_MEMBER_DP2:
+            d->dp2 = data;
+            break;
+
+        case GRC_MEMBER_DP3:
+            /*
+             * To keep a standard in all object implemented internally we
+             * manipulate the callback structure from the object.
+             */
+            set_callback(grc, d, NULL, data);
+            break;
+
+        default:
+            grc_set_errno(GRC_ERROR_UNSUPPORTED_DATA_TYPE);
+            return -1;
+    }
+
+    return 0;
+}
+
+/*
+ * Gets an object member that holds an integer value.
+ */
+int grc_object_get_member_int(struct grc_object_s *object,
+    enum grc_object_member member, int *value)
+{
+    DIALOG *d;
+
+    d = grc_object_get_DIALOG(object);
+
+    if ((NULL == d) || (NULL == value)) {
+        grc_set_errno(GRC_ERROR_NULL_ARG);
+        return -1;
+    }
+
+    switch (member) {
+        case GRC_MEMBER_RADIO_STATE:
+        case GRC_MEMBER_CHECKBOX_STATE:
+            *value = (d->flags & D_SELECTED) ? 1 : 0;
+            break;
+
+        case GRC_MEMBER_D1:
+        case GRC_MEMBER_SLIDER_LIMIT:
+        case GRC_MEMBER_LIST_POSITION:
+            *value = d->d1;
+            break;
+
+        case GRC_MEMBER_D2:
+        case GRC_MEMBER_SLIDER_POSITION:
+            *value = d->d2;
+            break;
+
+        default:
+            grc_set_errno(GRC_ERROR_UNSUPPORTED_DATA_TYPE);
+            return -1;
+    }
+
+    return 0;
+}
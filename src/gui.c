@@ -28,17 +28,6 @@
 #include "libgrc.h"
 #include "gui/objects.h"
 
-/*
- * Turn back to text mode.
- */
-void gui_reset_resolution(void)
-{
-    cl_msleep(100);
-    set_gfx_mode(GFX_TEXT, 0, 0, 0, 0);
-    remove_keyboard();
-    allegro_exit();
-}
-
 /*
  * ------- DIALOG handling functions -------
  */
@@ -199,6 +188,26 @@ static int create_menu(unsigned int index, void *a, void *b)
     return 0;
 }
 
+/*
+ * Allegro draws menus with its global GUI colors, so they are changed only
+ * while the menu is being handled, to the ones of its own DIALOG. Otherwise
+ * one DIALOG would change the menus of every other.
+ */
+static int gui_d_menu_proc(int msg, DIALOG *d, int c)
+{
+    int fg, bg, ret;
+
+    fg = gui_fg_color;
+    bg = gui_bg_color;
+    gui_fg_color = d->fg;
+    gui_bg_color = d->bg;
+    ret = d_menu_proc(msg, d, c);
+    gui_fg_color = fg;
+    gui_bg_color = bg;
+
+    return ret;
+}
+
 static void DIALOG_add_menu(DIALOG *dlg, unsigned int index, struct grc_s *grc)
 {
     MENU *m = NULL;
@@ -226,16 +235,11 @@ static void DIALOG_add_menu(DIALOG *dlg, unsigned int index, struct grc_s *grc)
     cl_dll_map_indexed(grc->ui_menu, create_menu, m);
     grc_object_set_MENU(gobj, m);
 
-    /*
-     * Changes the main color so that the menu uses the same that the user
-     * defined.
-     */
-    gui_fg_color = color_get(grc->color, COLOR_FG);
-    gui_bg_color = color_get(grc->color, COLOR_BG);
-
-    /* Create the DIALOG menu entry */
-    p->proc = d_menu_proc;
+    /* Create the DIALOG menu entry, with the colors the user defined */
+    p->proc = gui_d_menu_proc;
     p->dp = m;
+    p->fg = color_get(grc->color, COLOR_FG);
+    p->bg = color_get(grc->color, COLOR_BG);
     p->x = 0;
     p->y = 0;
     dlg[index] = *p;
@@ -250,6 +254,25 @@ error_block:
         destroy_grc_object(gobj);
 }
 
+/*
+ * The procedure of an object, without the ones wrapping it to be profiled
+ * or to have its messages traced.
+ */
+static int (*object_proc(DIALOG *d))(int, DIALOG *, int)
+{
+    int (*p)(int, DIALOG *, int) = d->proc;
+
+    if (p == trace_events_object_proc)
+        p = callback_get_trace_proc(d->dp3);
+
+#ifdef GRC_PROFILE
+    if (p == profile_object_proc)
+        p = profile_object_get_proc(d);
+#endif
+
+    return p;
+}
+
 /*
  * Here we create the Allegro DIALOG array pointing to every previously loaded
  * object.
@@ -296,16 +319,22 @@ int DIALOG_create(struct grc_s *grc)
     if (info_get_value(grc->info, INFO_USE_GFX) == true)
         DIALOG_creation_start(d, grc);
 
-    /* Add user defined objects */
+    /*
+     * Add user defined objects. If the DIALOG was already created they may
+     * still be wrapped by the previous one.
+     */
     for (p = grc->ui_objects, index = 1; p; p = p->next, index++) {
         q = grc_object_get_DIALOG(p);
         d[index] = *q;
+        d[index].proc = object_proc(q);
+        p->rdlg = &d[index];
     }
     
     /* Add keys */
     for (p = grc->ui_keys; p; p = p->next, index++) {
         q = grc_object_get_DIALOG(p);
         d[index] = *q;
+        p->rdlg = &d[index];
     }
 
     /* Ends the DIALOG */
@@ -323,55 +352,272 @@ int DIALOG_create(struct grc_s *grc)
 
     /* Points to the new DIALOG */
     grc->dlg = d;
+    profile_attach(grc);
+    trace_events_attach(grc);
 
     return 0;
 }
 
+/*
+ * Allegro and the graphic mode are shared with every other DIALOG, so they
+ * are only really initialized by the first one.
+ */
 int gui_init(struct grc_s *grc)
 {
-    int w, h;
-
-    if (install_allegro(SYSTEM_AUTODETECT, NULL, NULL)) {
-        grc_set_errno(GRC_ERROR_LIB_INIT);
-        return -1;
-    }
-
-    if (install_keyboard()) {
-        grc_set_errno(GRC_ERROR_KEYBOARD_INIT);
+    if (session_acquire(grc) < 0)
         return -1;
-    }
 
-    install_timer();
-    set_color_depth(info_color_depth(grc));
-    w = info_get_value(grc->info, INFO_WIDTH);
-    h = info_get_value(grc->info, INFO_HEIGHT);
+    grc->session = true;
 
-    if (set_gfx_mode(GFX_XWINDOWS, w, h, 0, 0) != 0) {
-        if (set_gfx_mode(GFX_FBCON, w, h, 0, 0) != 0) {
-            remove_keyboard();
-            allegro_exit();
-            grc_set_errno(GRC_ERROR_SET_GFX_MODE);
+    if (info_get_value(grc->info, INFO_BACKEND) == GRC_BACKEND_MEMORY) {
+        if (headless_create_framebuffer(grc) < 0)
             return -1;
-        }
-    } else {
-        if (info_get_value(grc->info, INFO_USE_MOUSE) == true) {
-            install_mouse();
-            gui_mouse_focus = FALSE;
-        }
+
+        headless_select(grc);
     }
 
     /* Disable ctrl+alt+end */
     if (info_get_value(grc->info, INFO_BLOCK_KEYS) == false)
         three_finger_flag = FALSE;
+    else
+        three_finger_flag = TRUE;
 
     return 0;
 }
 
+/*
+ * Ends the objects started by render_DIALOG, since running the DIALOG starts
+ * them again.
+ */
+void stop_render_DIALOG(struct grc_s *grc)
+{
+    DIALOG *d;
+
+    if (grc->rendered == false)
+        return;
+
+    session_gui_lock();
+    headless_select(grc);
+
+    for (d = grc->dlg; d->proc != NULL; d++)
+        object_message(d, MSG_END, 0);
+
+    grc->rendered = false;
+    session_gui_unlock();
+}
+
+static void draw_objects(struct grc_s *grc)
+{
+    DIALOG *d;
+
+    for (d = grc->dlg; d->proc != NULL; d++) {
+        if (d->flags & D_HIDDEN)
+            continue;
+
+        object_message(d, MSG_DRAW, 0);
+
+        /* Log boxes only draw their lines when told about new ones */
+        if (gui_object_is(d, gui_messages_log_proc) == true)
+            object_message(d, MSG_NEW_LOG_TEXT, 0);
+    }
+}
+
+/*
+ * Draws every visible object once, without running the DIALOG. Objects are
+ * started by the first call and stay that way until the DIALOG runs or is
+ * freed.
+ */
+void render_DIALOG(struct grc_s *grc)
+{
+    DIALOG *d;
+    unsigned long long start;
+
+    session_gui_lock();
+    headless_select(grc);
+
+    if (grc->rendered == false) {
+        for (d = grc->dlg; d->proc != NULL; d++)
+            object_message(d, MSG_START, 0);
+
+        grc->rendered = true;
+    }
+
+    start = trace_event_begin();
+    profile_frame_begin(grc);
+    stats_frame_begin(grc, true);
+    draw_objects(grc);
+    profile_frame_end(grc);
+    stats_frame_end(grc);
+    trace_event_end(start, "frame", "frame", NULL);
+
+    if (grc->remote != NULL)
+        remote_frame(grc);
+
+    session_gui_unlock();
+}
+
+/*
+ * Redraws every visible object after a change made through the API. If
+ * another thread is using Allegro, as when the DIALOG is running, they are
+ * only marked as dirty, to be redrawn by it.
+ */
+void redraw_DIALOG(struct grc_s *grc)
+{
+    DIALOG *d;
+
+    if (session_gui_trylock() < 0) {
+        for (d = grc->dlg; d->proc != NULL; d++)
+            d->flags |= D_DIRTY;
+
+        return;
+    }
+
+    headless_select(grc);
+    draw_objects(grc);
+    session_gui_unlock();
+}
+
+/*
+ * A streamed DIALOG is sent to its viewer after every frame, while a
+ * profiled or traced one, or one with its input latency measured, has each
+ * of them timed. Published statistics are also written by frame, and a
+ * DIALOG of the memory backend receives its injected input by frame.
+ * Otherwise Allegro runs it by itself, and it's only decided when the
+ * DIALOG starts running, which the API documents.
+ */
+static bool run_by_frames(struct grc_s *grc)
+{
+    return (grc->remote != NULL) || (grc->profile != NULL) ||
+           (grc->latency != NULL) || (grc->stats != NULL) ||
+           (grc->input != NULL) || (trace_events_enabled() == true);
+}
+
+/*
+ * Runs a single frame of a DIALOG started with init_dialog, giving it the
+ * injected input and then whatever @input adds, if not NULL. Returns what
+ * update_dialog does.
+ */
+int dialog_frame(struct grc_s *grc, DIALOG_PLAYER *player, void (*input)(void))
+{
+    unsigned long long start;
+    int running;
+
+    headless_frame_input(grc);
+
+    if (input != NULL)
+        (input)();
+
+    start = trace_event_begin();
+    latency_frame_begin(grc);
+    profile_frame_begin(grc);
+    stats_frame_begin(grc, false);
+    running = update_dialog(player);
+    profile_frame_end(grc);
+    stats_frame_end(grc);
+
+    if (grc->remote != NULL)
+        remote_frame(grc);
+
+    latency_frame_end(grc);
+    trace_event_end(start, "frame", "frame", NULL);
+
+    return running;
+}
+
+static void run_frames(struct grc_s *grc)
+{
+    DIALOG_PLAYER *player;
+
+    player = init_dialog(grc->dlg, -1);
+
+    if (NULL == player)
+        return;
+
+    while (dialog_frame(grc, player, NULL))
+        ;
+
+    shutdown_dialog(player);
+}
+
+/*
+ * Allegro is held for as long as the DIALOG runs, since it draws through
+ * its globals.
+ */
 void run_DIALOG(struct grc_s *grc)
 {
+    stop_render_DIALOG(grc);
+
     if (info_get_value(grc->info, INFO_USE_GFX) == false)
         centre_dialog(grc->dlg);
 
-    do_dialog(grc->dlg, -1);
+    session_gui_lock();
+    headless_select(grc);
+
+    if (run_by_frames(grc) == true)
+        run_frames(grc);
+    else
+        do_dialog(grc->dlg, -1);
+
+    session_gui_unlock();
+}
+
+
+/*
+ * Checks if @d is an object of a specific kind, even when its procedure was
+ * replaced to use its own font, to be profiled or traced.
+ */
+bool gui_object_is(DIALOG *d, int (*proc)(int, DIALOG *, int))
+{
+    int (*p)(int, DIALOG *, int) = object_proc(d);
+
+    if (p == font_object_proc)
+        return callback_get_proc(d->dp3) == proc;
+
+    return p == proc;
+}
+
+static bool is_wrapper(int (*proc)(int, DIALOG *, int))
+{
+#ifdef GRC_PROFILE
+    if (proc == profile_object_proc)
+        return true;
+#endif
+
+    return (proc == trace_events_object_proc) || (proc == font_object_proc);
 }
 
+/*
+ * Replaces the procedure of an object, keeping the ones wrapping it to use
+ * its own font, to be profiled or traced.
+ */
+void gui_object_set_proc(DIALOG *d, int (*proc)(int, DIALOG *, int))
+{
+    int (*p)(int, DIALOG *, int) = d->proc;
+
+    if (p == trace_events_object_proc) {
+        p = callback_get_trace_proc(d->dp3);
+
+        if (is_wrapper(p) == false) {
+            callback_set_trace(d->dp3, proc, callback_get_tag(d->dp3));
+            return;
+        }
+    }
+
+#ifdef GRC_PROFILE
+    if (p == profile_object_proc) {
+        p = profile_object_get_proc(d);
+
+        if (is_wrapper(p) == false) {
+            profile_object_set_proc(d, proc);
+            return;
+        }
+    }
+#endif
+
+    if (p == font_object_proc) {
+        callback_set_font(d->dp3, callback_get_font(d->dp3), proc);
+        return;
+    }
+
+    d->proc = proc;
+}
@@ -26,6 +26,12 @@
 
 #include "libgrc.h"
 
+/* The object owns its bitmap, which is drawn again in every frame */
+void gui_bitmap_destroy(void *a)
+{
+    destroy_bitmap((BITMAP *)a);
+}
+
 int gui_d_bitmap_proc(int msg, DIALOG *d, int c __attribute__((unused)))
 {
     BITMAP *b;
@@ -41,7 +47,6 @@ int gui_d_bitmap_proc(int msg, DIALOG *d, int c __attribute__((unused)))
             if (d->dp != NULL) {
                 b = (BITMAP *)d->dp;
                 blit(b, gui_get_screen(), 0, 0, d->x, d->y, b->w, b->h);
-                destroy_bitmap(b);
             }
 
             break;
@@ -24,150 +24,917 @@
  * USA
  */
 
+#include <limits.h>
+
 #include "libgrc.h"
+#include "objects.h"
+
+/* Marks the end of a span to be redrawn */
+#define EDIT_END                    UINT_MAX
+
+/*
+ * The line of the cursor in a multi-line object, kept as the cursor moves so
+ * that a key never scans it again.
+ */
+struct edit_line {
+    unsigned int        start;
+    int                 row;        /** From the first visible line */
+    unsigned int        column;     /** Characters before the cursor */
+    int                 x;          /** Their width */
+};
+
+/*
+ * Internal state of 'edit' objects, kept in @dp2. The text lives inside a
+ * gap buffer and @dp points to its storage, which only holds a valid string
+ * after gui_edit_get_text. @d1 is the maximum text length, or 0 for none,
+ * and @d2 is the cursor position, in bytes.
+ */
+struct edit {
+    struct gap_buffer   *gb;
+    bool                password;
+    bool                multiline;
+    bool                ignore_next_uchar;
+
+    /*
+     * First visible byte or, in a multi-line object, the start of the first
+     * visible line.
+     */
+    unsigned int        first;
+    int                 hscroll;    /** Multi-line horizontal scroll */
+
+    /* @line is valid while @tracked is set and @cursor is still @d2 */
+    struct edit_line    line;
+    unsigned int        cursor;
+    bool                tracked;
+};
+
+void *gui_edit_create(unsigned int limit, bool password, bool multiline)
+{
+    struct edit *e = NULL;
+
+    e = calloc(1, sizeof(struct edit));
+
+    if (NULL == e)
+        return NULL;
+
+    e->gb = new_gap_buffer(limit);
+
+    if (NULL == e->gb) {
+        free(e);
+        return NULL;
+    }
+
+    e->password = password;
+    e->multiline = multiline;
+
+    return e;
+}
+
+void gui_edit_destroy(void *a)
+{
+    struct edit *e = (struct edit *)a;
+
+    if (NULL == e)
+        return;
+
+    destroy_gap_buffer(e->gb);
+    free(e);
+}
+
+size_t gui_edit_memory(void *a)
+{
+    struct edit *e = (struct edit *)a;
+
+    return sizeof(struct edit) + gap_buffer_memory(e->gb);
+}
+
+/*
+ * If the user replaced the object content through grc_object_set_data we
+ * take a copy of it.
+ */
+static void edit_adopt_text(DIALOG *d, struct edit *e)
+{
+    const char *storage = gap_buffer_storage(e->gb);
+
+    if (d->dp == storage)
+        return;
+
+    if (d->dp != NULL)
+        gap_buffer_set(e->gb, d->dp);
+
+    d->dp = (char *)gap_buffer_storage(e->gb);
+    e->first = 0;
+    e->hscroll = 0;
+    e->tracked = false;
+}
+
+const char *gui_edit_get_text(DIALOG *d)
+{
+    struct edit *e = d->dp2;
+
+    if ((gui_object_is(d, gui_d_edit_proc) == false) &&
+        (gui_object_is(d, gui_d_password_proc) == false))
+    {
+        return d->dp;
+    }
+
+    edit_adopt_text(d, e);
+
+    return gap_buffer_text(e->gb);
+}
+
+/*
+ * Replaces the object content with @n bytes from @text, which don't need to
+ * be a string.
+ */
+int gui_edit_set_text(DIALOG *d, const char *text, unsigned int n)
+{
+    struct edit *e = d->dp2;
+    unsigned int limit;
+
+    if ((gui_object_is(d, gui_d_edit_proc) == false) &&
+        (gui_object_is(d, gui_d_password_proc) == false))
+    {
+        return -1;
+    }
+
+    limit = gap_buffer_limit(e->gb);
+
+    if ((limit > 0) && (n > limit))
+        n = limit;
+
+    if ((gap_buffer_set(e->gb, "") < 0) ||
+        (gap_buffer_insert(e->gb, 0, text, n) < 0))
+    {
+        return -1;
+    }
+
+    d->dp = (char *)gap_buffer_storage(e->gb);
+    e->first = 0;
+    e->hscroll = 0;
+    e->tracked = false;
+
+    if ((unsigned int)d->d2 > n)
+        d->d2 = n;
+
+    return 0;
+}
+
+/* Size, in bytes, of the UTF-8 character at @pos */
+static unsigned int char_size(struct edit *e, unsigned int pos)
+{
+    unsigned char c = gap_buffer_at(e->gb, pos);
+    unsigned int n = 1, length = gap_buffer_length(e->gb);
+
+    if ((c & 0xE0) == 0xC0)
+        n = 2;
+    else if ((c & 0xF0) == 0xE0)
+        n = 3;
+    else if ((c & 0xF8) == 0xF0)
+        n = 4;
+
+    return (pos + n > length) ? length - pos : n;
+}
+
+static unsigned int prev_char(struct edit *e, unsigned int pos)
+{
+    if (pos == 0)
+        return 0;
+
+    pos--;
+
+    while ((pos > 0) && ((gap_buffer_at(e->gb, pos) & 0xC0) == 0x80))
+        pos--;
+
+    return pos;
+}
+
+static unsigned int next_char(struct edit *e, unsigned int pos)
+{
+    if (pos >= gap_buffer_length(e->gb))
+        return pos;
+
+    return pos + char_size(e, pos);
+}
 
 /*
- * Function like a d_edit_proc from Allegro, @dp2 is the value displayed
- * with asterisks (*), @dp is the real value.
+ * Gets the displayed text of the character at @pos. The end of the text and
+ * line breaks are displayed as a space, so the cursor has where to stay.
  */
-static int d_password_proc(int msg, DIALOG *d, int c)
+static void char_at(struct edit *e, unsigned int pos, char *buf)
+{
+    unsigned int i, n;
+    char c;
+
+    c = gap_buffer_at(e->gb, pos);
+
+    if ((pos >= gap_buffer_length(e->gb)) || (c == '\n')) {
+        strcpy(buf, " ");
+        return;
+    }
+
+    if (e->password == true) {
+        strcpy(buf, "*");
+        return;
+    }
+
+    n = char_size(e, pos);
+
+    for (i = 0; i < n; i++)
+        buf[i] = gap_buffer_at(e->gb, pos + i);
+
+    buf[n] = '\0';
+}
+
+static int char_width(struct edit *e, unsigned int pos)
+{
+    char buf[8];
+
+    char_at(e, pos, buf);
+
+    return text_length(font, buf);
+}
+
+static void cell_colors(DIALOG *d, unsigned int pos, int *fg, int *bg)
 {
-    static int ignore_next_uchar = FALSE;
-    int f, l, p, w, x, fg, b = 0, scroll;
-    char buf[16], *s, *dp2;
+    *fg = (d->flags & D_DISABLED) ? gui_mg_color : d->fg;
+    *bg = d->bg;
 
-    ASSERT(d);
+    if ((pos == (unsigned int)d->d2) && (d->flags & D_GOTFOCUS)) {
+        *bg = *fg;
+        *fg = d->bg;
+    }
+}
 
-    s = d->dp2;
-    l = ustrlen(s);
+/*
+ * Single line objects
+ */
 
-    if (d->d2 > l)
-        d->d2 = l;
+/*
+ * Draws the characters from @from to @to. Only the visible window is
+ * measured, never the whole text.
+ */
+static void edit_draw_span(DIALOG *d, struct edit *e, unsigned int from,
+    unsigned int to)
+{
+    BITMAP *gui_bmp = gui_get_screen();
+    unsigned int pos = e->first, length = gap_buffer_length(e->gb);
+    int x = 0, w, fg, bg;
+    char buf[8];
 
-    /* Its size is the same as len(s) */
-    dp2 = d->dp;
+    while ((pos < from) && (pos < length)) {
+        x += char_width(e, pos);
+        pos = next_char(e, pos);
+    }
 
-    /* calculate maximal number of displayable characters */
-    if (d->d2 == l) {
-        usetc(buf + usetc(buf, ' '), 0);
-        x = text_length(font, buf);
-    } else
-        x = 0;
+    while (pos <= to) {
+        char_at(e, pos, buf);
+        w = text_length(font, buf);
 
-    for (p = d->d2; p >= 0; p--) {
-        usetc(buf + usetc(buf, ugetat(s, p)), 0);
-        x += text_length(font, buf);
-        b++;
+        if (x + w > d->w)
+            break;
 
-        if (x > d->w)
+        cell_colors(d, pos, &fg, &bg);
+        textout_ex(gui_bmp, font, buf, d->x + x, d->y, fg, bg);
+        x += w;
+
+        if (pos >= length)
             break;
+
+        pos = next_char(e, pos);
+    }
+
+    if ((to == EDIT_END) && (x < d->w))
+        rectfill(gui_bmp, d->x + x, d->y, d->x + d->w - 1,
+                 d->y + text_height(font) - 1, d->bg);
+}
+
+/* Checks if the text from @from up to the cursor is wider than @w */
+static bool edit_span_exceeds(DIALOG *d, struct edit *e, unsigned int from,
+    int w)
+{
+    unsigned int pos = from;
+    int x = 0;
+
+    while (1) {
+        x += char_width(e, pos);
+
+        if (x > w)
+            return true;
+
+        if ((pos >= (unsigned int)d->d2) ||
+            (pos >= gap_buffer_length(e->gb)))
+        {
+            return false;
+        }
+
+        pos = next_char(e, pos);
+    }
+}
+
+/*
+ * Keeps the cursor inside the visible window. Returns true if the window
+ * has moved.
+ */
+static bool edit_follow_cursor(DIALOG *d, struct edit *e)
+{
+    unsigned int old = e->first, p;
+    int w, cw;
+
+    if ((unsigned int)d->d2 < e->first)
+        e->first = d->d2;
+    else if (edit_span_exceeds(d, e, e->first, d->w) == true) {
+        /* Fills the window backwards, from the cursor */
+        e->first = d->d2;
+        w = char_width(e, e->first);
+
+        while (e->first > 0) {
+            p = prev_char(e, e->first);
+            cw = char_width(e, p);
+
+            if (w + cw > d->w)
+                break;
+
+            w += cw;
+            e->first = p;
+        }
+    }
+
+    return old != e->first;
+}
+
+/*
+ * Multi-line objects
+ */
+
+static unsigned int line_start(struct edit *e, unsigned int pos)
+{
+    while ((pos > 0) && (gap_buffer_at(e->gb, pos - 1) != '\n'))
+        pos--;
+
+    return pos;
+}
+
+static unsigned int line_end(struct edit *e, unsigned int pos)
+{
+    unsigned int length = gap_buffer_length(e->gb);
+
+    while ((pos < length) && (gap_buffer_at(e->gb, pos) != '\n'))
+        pos++;
+
+    return pos;
+}
+
+/* Start of the next line, or -1 if @pos is inside the last one */
+static int next_line(struct edit *e, unsigned int pos)
+{
+    pos = line_end(e, pos);
+
+    if (pos >= gap_buffer_length(e->gb))
+        return -1;
+
+    return pos + 1;
+}
+
+static int visible_lines(DIALOG *d)
+{
+    int n = d->h / text_height(font);
+
+    return (n > 0) ? n : 1;
+}
+
+/* Measures the cursor column, from the start of its line */
+static void line_column(DIALOG *d, struct edit *e)
+{
+    unsigned int pos;
+
+    e->line.column = 0;
+    e->line.x = 0;
+
+    for (pos = e->line.start; pos < (unsigned int)d->d2;
+         pos = next_char(e, pos))
+    {
+        e->line.column++;
+        e->line.x += char_width(e, pos);
+    }
+}
+
+/*
+ * Finds the line of the cursor when it was moved by something else than a
+ * key, such as the mouse or the API. Keys keep it up to date by themselves.
+ */
+static void mledit_track_cursor(DIALOG *d, struct edit *e)
+{
+    unsigned int pos;
+
+    if ((e->tracked == true) && (e->cursor == (unsigned int)d->d2))
+        return;
+
+    e->line.start = line_start(e, d->d2);
+    line_column(d, e);
+
+    if (e->line.start < e->first)
+        e->line.row = -1;
+    else {
+        e->line.row = 0;
+
+        for (pos = e->first; pos < e->line.start; pos = next_line(e, pos))
+            e->line.row++;
     }
 
-    if (x <= d->w) {
-        b = l;
-        scroll = FALSE;
+    e->cursor = d->d2;
+    e->tracked = true;
+}
+
+/* The cursor has moved forward, over the character at @pos */
+static void mledit_cursor_forward(DIALOG *d, struct edit *e, unsigned int pos)
+{
+    if (e->multiline == false)
+        return;
+
+    if (gap_buffer_at(e->gb, pos) == '\n') {
+        e->line.start = pos + 1;
+        e->line.row++;
+        e->line.column = 0;
+        e->line.x = 0;
     } else {
-        b--;
-        scroll = TRUE;
+        e->line.column++;
+        e->line.x += char_width(e, pos);
     }
 
-    switch (msg) {
-        case MSG_START:
-            d->d2 = l;
+    e->cursor = d->d2;
+}
+
+/*
+ * The cursor has moved back to the previous character. Only a line break
+ * costs the previous line length.
+ */
+static void mledit_cursor_backward(DIALOG *d, struct edit *e)
+{
+    if (e->multiline == false)
+        return;
+
+    if (gap_buffer_at(e->gb, d->d2) == '\n') {
+        e->line.start = line_start(e, d->d2);
+        e->line.row--;
+        line_column(d, e);
+    } else {
+        e->line.column--;
+        e->line.x -= char_width(e, d->d2);
+    }
+
+    e->cursor = d->d2;
+}
+
+static void mledit_draw_line(DIALOG *d, struct edit *e, int start, int row)
+{
+    BITMAP *gui_bmp = gui_get_screen();
+    unsigned int pos = start, length = gap_buffer_length(e->gb);
+    int x = -e->hscroll, y, w, fg, bg;
+    char buf[8];
+
+    y = d->y + row * text_height(font);
+    rectfill(gui_bmp, d->x, y, d->x + d->w - 1, y + text_height(font) - 1,
+             d->bg);
+
+    /* Beyond the end of the text */
+    if (start < 0)
+        return;
+
+    while (x < d->w) {
+        char_at(e, pos, buf);
+        w = text_length(font, buf);
+
+        if (x + w > 0) {
+            cell_colors(d, pos, &fg, &bg);
+            textout_ex(gui_bmp, font, buf, d->x + x, y, fg,
+                       (bg == d->bg) ? -1 : bg);
+        }
+
+        x += w;
+
+        if ((pos >= length) || (gap_buffer_at(e->gb, pos) == '\n'))
             break;
 
-        case MSG_DRAW:
-            fg = (d->flags & D_DISABLED) ? gui_mg_color : d->fg;
-            x = 0;
+        pos = next_char(e, pos);
+    }
+}
 
-            if (scroll) {
-                p = d->d2-b + 1;
-                b = d->d2;
-            } else
-                p = 0;
+/* Draws every visible line starting at @from_row */
+static void mledit_draw_lines(DIALOG *d, struct edit *e, int from_row)
+{
+    BITMAP *gui_bmp = gui_get_screen();
+    int row, n = visible_lines(d), start = e->first;
+    int cx1, cy1, cx2, cy2;
+
+    get_clip_rect(gui_bmp, &cx1, &cy1, &cx2, &cy2);
+    set_clip_rect(gui_bmp, d->x, d->y, d->x + d->w - 1, d->y + d->h - 1);
 
-            for (; p <= b; p++) {
-                f = ugetat(s, p);
-                usetc(buf + usetc(buf, (f) ? f : ' '), 0);
-                w = text_length(font, buf);
+    for (row = 0; row < n; row++) {
+        if (row >= from_row)
+            mledit_draw_line(d, e, start, row);
 
-                if (x + w > d->w)
-                    break;
+        if (start >= 0)
+            start = next_line(e, start);
+    }
 
-                f = ((p == d->d2) && (d->flags & D_GOTFOCUS));
+    set_clip_rect(gui_bmp, cx1, cy1, cx2, cy2);
+}
 
-                textout_ex(screen, font, buf, d->x + x, d->y, (f) ? d->bg : fg,
-                           (f) ? fg : d->bg);
+static void mledit_redraw_line(DIALOG *d, struct edit *e, unsigned int start,
+    int row)
+{
+    BITMAP *gui_bmp = gui_get_screen();
+    int cx1, cy1, cx2, cy2;
 
-                x += w;
-            }
+    if ((row < 0) || (row >= visible_lines(d)))
+        return;
+
+    get_clip_rect(gui_bmp, &cx1, &cy1, &cx2, &cy2);
+    set_clip_rect(gui_bmp, d->x, d->y, d->x + d->w - 1, d->y + d->h - 1);
+    mledit_draw_line(d, e, start, row);
+    set_clip_rect(gui_bmp, cx1, cy1, cx2, cy2);
+}
+
+/*
+ * Keeps the cursor inside the visible lines and columns. Returns true if
+ * the visible area has moved.
+ */
+static bool mledit_follow_cursor(DIALOG *d, struct edit *e)
+{
+    unsigned int old_first = e->first;
+    int old_hscroll = e->hscroll, n = visible_lines(d), w;
+
+    mledit_track_cursor(d, e);
+
+    if (e->line.row < 0) {
+        e->first = e->line.start;
+        e->line.row = 0;
+    }
+
+    while (e->line.row >= n) {
+        e->first = next_line(e, e->first);
+        e->line.row--;
+    }
+
+    w = char_width(e, d->d2);
+
+    if (e->line.x < e->hscroll)
+        e->hscroll = e->line.x;
+    else if (e->line.x + w > e->hscroll + d->w)
+        e->hscroll = e->line.x + w - d->w;
+
+    return (old_first != e->first) || (old_hscroll != e->hscroll);
+}
+
+/* Moves the cursor to the same column of another line */
+static void mledit_move_line(DIALOG *d, struct edit *e, bool up)
+{
+    unsigned int pos, column = e->line.column;
+    int target;
+
+    if (up == true) {
+        if (e->line.start == 0)
+            return;
+
+        target = line_start(e, e->line.start - 1);
+    } else {
+        target = next_line(e, d->d2);
+
+        if (target < 0)
+            return;
+    }
+
+    e->line.start = target;
+    e->line.row += (up == true) ? -1 : 1;
+    e->line.column = 0;
+    e->line.x = 0;
+    pos = target;
+
+    while ((e->line.column < column) && (pos < gap_buffer_length(e->gb)) &&
+           (gap_buffer_at(e->gb, pos) != '\n'))
+    {
+        e->line.column++;
+        e->line.x += char_width(e, pos);
+        pos = next_char(e, pos);
+    }
+
+    d->d2 = pos;
+    e->cursor = pos;
+}
 
-            if (x < d->w)
-                rectfill(screen, d->x + x, d->y, d->x + d->w - 1,
-                         d->y + text_height(font) - 1, d->bg);
+static void mledit_cursor_from_mouse(DIALOG *d, struct edit *e)
+{
+    int row, x, w;
+    int pos = e->first;
+
+    row = (gui_mouse_y() - d->y) / text_height(font);
+    x = gui_mouse_x() - d->x + e->hscroll;
 
+    while ((row-- > 0) && (pos >= 0)) {
+        if (next_line(e, pos) < 0)
             break;
 
-        case MSG_WANTFOCUS:
-        case MSG_LOSTFOCUS:
-        case MSG_KEY:
-            return D_WANTFOCUS;
+        pos = next_line(e, pos);
+    }
 
-        case MSG_CHAR:
-            ignore_next_uchar = FALSE;
-
-            if ((c >> 8) == KEY_LEFT) {
-                if (d->d2 > 0)
-                    d->d2--;
-            } else if ((c >> 8) == KEY_RIGHT) {
-                if (d->d2 < l)
-                    d->d2++;
-            } else if ((c >> 8) == KEY_HOME) {
-                d->d2 = 0;
-            } else if ((c >> 8) == KEY_END) {
-                d->d2 = l;
-            } else if ((c >> 8) == KEY_DEL) {
-                if (d->d2 < l) {
-                    uremove(s, d->d2);
-                    uremove(dp2, d->d2);
-                }
-            } else if ((c >> 8) == KEY_BACKSPACE) {
-                if (d->d2 > 0) {
-                    d->d2--;
-                    uremove(s, d->d2);
-                    uremove(dp2, d->d2);
-                }
-            } else if ((c >> 8) == KEY_ENTER) {
-                if (d->flags & D_EXIT) {
-                    object_message(d, MSG_DRAW, 0);
-                    return D_CLOSE;
-                } else
-                    return D_O_K;
-            } else if ((c >> 8) == KEY_TAB) {
-                ignore_next_uchar = TRUE;
-                return D_O_K;
-            } else {
-                /* don't process regular keys here: MSG_UCHAR will do that */
+    while (((unsigned int)pos < gap_buffer_length(e->gb)) &&
+           (gap_buffer_at(e->gb, pos) != '\n'))
+    {
+        w = char_width(e, pos);
+
+        if (x < w)
+            break;
+
+        x -= w;
+        pos = next_char(e, pos);
+    }
+
+    d->d2 = pos;
+}
+
+static void edit_cursor_from_mouse(DIALOG *d, struct edit *e)
+{
+    unsigned int pos = e->first;
+    int x, w;
+
+    if (e->multiline == true) {
+        mledit_cursor_from_mouse(d, e);
+        return;
+    }
+
+    x = gui_mouse_x() - d->x;
+
+    while (pos < gap_buffer_length(e->gb)) {
+        w = char_width(e, pos);
+
+        if (x < w)
+            break;
+
+        x -= w;
+        pos = next_char(e, pos);
+    }
+
+    d->d2 = pos;
+}
+
+/*
+ * Common code
+ */
+
+static void edit_draw(DIALOG *d, struct edit *e)
+{
+    if (e->multiline == true) {
+        mledit_follow_cursor(d, e);
+        mledit_draw_lines(d, e, 0);
+    } else {
+        edit_follow_cursor(d, e);
+        edit_draw_span(d, e, e->first, EDIT_END);
+    }
+}
+
+/*
+ * Draws only what changed after a key was handled: the text from @changed
+ * on, if it was modified, or the old and the new cursor positions. @old is
+ * the cursor line of a multi-line object before the key.
+ *
+ * @lines tells that a line break was inserted or removed.
+ */
+static void edit_update(DIALOG *d, struct edit *e, unsigned int old_cursor,
+    const struct edit_line *old, unsigned int changed, bool lines)
+{
+    int row;
+
+    if (e->multiline == false) {
+        if (edit_follow_cursor(d, e) == true)
+            edit_draw_span(d, e, e->first, EDIT_END);
+        else if (changed != EDIT_END)
+            edit_draw_span(d, e, changed, EDIT_END);
+        else {
+            edit_draw_span(d, e, old_cursor, old_cursor);
+            edit_draw_span(d, e, d->d2, d->d2);
+        }
+
+        return;
+    }
+
+    if (mledit_follow_cursor(d, e) == true) {
+        mledit_draw_lines(d, e, 0);
+        return;
+    }
+
+    /* A line break splits the line before the cursor one */
+    if (lines == true) {
+        row = (changed < e->line.start) ? e->line.row - 1 : e->line.row;
+        mledit_draw_lines(d, e, (row < 0) ? 0 : row);
+        return;
+    }
+
+    if (old->start != e->line.start)
+        mledit_redraw_line(d, e, old->start, old->row);
+
+    mledit_redraw_line(d, e, e->line.start, e->line.row);
+}
+
+static int edit_char(DIALOG *d, struct edit *e, int c)
+{
+    unsigned int old = d->d2, changed = EDIT_END, length, i;
+    struct edit_line old_line;
+    bool lines = false;
+    char nl = '\n';
+
+    length = gap_buffer_length(e->gb);
+    e->ignore_next_uchar = false;
+
+    if (e->multiline == true)
+        mledit_track_cursor(d, e);
+
+    old_line = e->line;
+
+    switch (c >> 8) {
+        case KEY_LEFT:
+            if (d->d2 == 0)
                 break;
-            }
 
-            object_message(d, MSG_DRAW, 0);
-            return D_USED_CHAR;
+            d->d2 = prev_char(e, d->d2);
+            mledit_cursor_backward(d, e);
+            break;
 
-        case MSG_UCHAR:
-            if ((c >= ' ') && (uisok(c)) && (!ignore_next_uchar)) {
-                if (l < d->d1) {
-                    uinsert(s, d->d2, '*');
-                    uinsert(dp2, d->d2, c);
+        case KEY_RIGHT:
+            if ((unsigned int)d->d2 >= length)
+                break;
+
+            d->d2 = next_char(e, d->d2);
+            mledit_cursor_forward(d, e, old);
+            break;
 
-                    d->d2++;
+        case KEY_UP:
+        case KEY_DOWN:
+            if (e->multiline == false)
+                return D_O_K;
+
+            mledit_move_line(d, e, ((c >> 8) == KEY_UP));
+            break;
+
+        case KEY_PGUP:
+        case KEY_PGDN:
+            if (e->multiline == false)
+                return D_O_K;
+
+            for (i = 1; i < (unsigned int)visible_lines(d); i++)
+                mledit_move_line(d, e, ((c >> 8) == KEY_PGUP));
 
-                    object_message(d, MSG_DRAW, 0);
+            break;
+
+        case KEY_HOME:
+            if ((e->multiline == true) && !(key_shifts & KB_CTRL_FLAG)) {
+                d->d2 = e->line.start;
+                e->line.column = 0;
+                e->line.x = 0;
+                e->cursor = d->d2;
+            } else
+                d->d2 = 0;
+
+            break;
+
+        case KEY_END:
+            if ((e->multiline == true) && !(key_shifts & KB_CTRL_FLAG)) {
+                while (((unsigned int)d->d2 < length) &&
+                       (gap_buffer_at(e->gb, d->d2) != '\n'))
+                {
+                    i = d->d2;
+                    d->d2 = next_char(e, d->d2);
+                    mledit_cursor_forward(d, e, i);
                 }
+            } else
+                d->d2 = length;
+
+            break;
 
+        case KEY_DEL:
+            if ((unsigned int)d->d2 >= length)
                 return D_USED_CHAR;
+
+            lines = (gap_buffer_at(e->gb, d->d2) == '\n');
+            gap_buffer_delete(e->gb, d->d2, char_size(e, d->d2));
+            changed = d->d2;
+            break;
+
+        case KEY_BACKSPACE:
+            if (d->d2 == 0)
+                return D_USED_CHAR;
+
+            d->d2 = prev_char(e, d->d2);
+            mledit_cursor_backward(d, e);
+            lines = (gap_buffer_at(e->gb, d->d2) == '\n');
+            gap_buffer_delete(e->gb, d->d2, char_size(e, d->d2));
+            changed = d->d2;
+            break;
+
+        case KEY_ENTER:
+            /* A multi-line object only exits with Ctrl+Enter */
+            if ((e->multiline == true) && !(key_shifts & KB_CTRL_FLAG)) {
+                if (gap_buffer_insert(e->gb, d->d2, &nl, 1) < 0)
+                    return D_USED_CHAR;
+
+                d->dp = (char *)gap_buffer_storage(e->gb);
+                changed = d->d2;
+                lines = true;
+                d->d2++;
+                mledit_cursor_forward(d, e, changed);
+                break;
+            }
+
+            if (d->flags & D_EXIT) {
+                object_message(d, MSG_DRAW, 0);
+                return D_CLOSE;
             }
+
+            return D_O_K;
+
+        case KEY_TAB:
+            e->ignore_next_uchar = true;
+            return D_O_K;
+
+        default:
+            /* Regular keys are handled by MSG_UCHAR */
+            return D_O_K;
+    }
+
+    edit_update(d, e, old, &old_line, changed, lines);
+
+    return D_USED_CHAR;
+}
+
+static int edit_uchar(DIALOG *d, struct edit *e, int c)
+{
+    struct edit_line old_line;
+    char buf[8];
+    int n;
+
+    if ((c < ' ') || !uisok(c) || (e->ignore_next_uchar == true))
+        return D_O_K;
+
+    n = usetc(buf, c);
+
+    if (e->multiline == true)
+        mledit_track_cursor(d, e);
+
+    old_line = e->line;
+
+    if (gap_buffer_insert(e->gb, d->d2, buf, n) == 0) {
+        d->dp = (char *)gap_buffer_storage(e->gb);
+        d->d2 += n;
+        mledit_cursor_forward(d, e, d->d2 - n);
+        edit_update(d, e, d->d2 - n, &old_line, d->d2 - n, false);
+    }
+
+    return D_USED_CHAR;
+}
+
+/*
+ * Works like a d_edit_proc from Allegro, but the text is kept inside a gap
+ * buffer, so editing a large text costs the same as editing a small one.
+ */
+static int edit_proc(int msg, DIALOG *d, int c)
+{
+    struct edit *e = d->dp2;
+
+    if (NULL == e)
+        return D_O_K;
+
+    edit_adopt_text(d, e);
+
+    if ((d->d2 < 0) || ((unsigned int)d->d2 > gap_buffer_length(e->gb)))
+        d->d2 = gap_buffer_length(e->gb);
+
+    switch (msg) {
+        case MSG_START:
+            d->d2 = gap_buffer_length(e->gb);
+            e->first = 0;
+            e->hscroll = 0;
+            e->tracked = false;
+            break;
+
+        case MSG_DRAW:
+            edit_draw(d, e);
             break;
+
+        case MSG_CLICK:
+            edit_cursor_from_mouse(d, e);
+            edit_draw(d, e);
+            break;
+
+        case MSG_WANTFOCUS:
+        case MSG_LOSTFOCUS:
+        case MSG_KEY:
+            return D_WANTFOCUS;
+
+        case MSG_CHAR:
+            return edit_char(d, e, c);
+
+        case MSG_UCHAR:
+            return edit_uchar(d, e, c);
     }
 
     return D_O_K;
@@ -203,14 +970,14 @@ int gui_d_password_proc(int msg, DIALOG *d, int c)
     if (msg == MSG_UPDATE_CURSOR_POSITION)
         d->d2 = c;
 
-    ret = d_password_proc(msg, d, c);
+    ret = edit_proc(msg, d, c);
 
     if (msg == MSG_LOSTFOCUS)
         set_actual_edit_object(d, acd);
 
     if (ret == D_CLOSE) {
         if (d->dp3 != NULL) {
-            callback_set_string(acd, (char *)d->dp);
+            callback_set_string(acd, (char *)gui_edit_get_text(d));
             run_callback(acd, D_O_K);
 
             /*
@@ -234,7 +1001,7 @@ int gui_d_edit_proc(int msg, DIALOG *d, int c)
     if (msg == MSG_UPDATE_CURSOR_POSITION)
         d->d2 = c;
 
-    ret = d_edit_proc(msg, d, c);
+    ret = edit_proc(msg, d, c);
 
     /*
      * If the user passes over the object we let it selected so the
@@ -245,7 +1012,7 @@ int gui_d_edit_proc(int msg, DIALOG *d, int c)
 
     if (ret == D_CLOSE) {
         if (d->dp3 != NULL) {
-            callback_set_string(acd, (char *)d->dp);
+            callback_set_string(acd, (char *)gui_edit_get_text(d));
             run_callback(acd, D_O_K);
 
             /*
@@ -39,15 +39,77 @@ struct line {
     int         fg;
 };
 
+/*
+ * Every object keeps its own lines. Messages may arrive from any thread,
+ * while the object is drawn by the one running the DIALOG, so they are
+ * protected by @lock.
+ */
 struct messages {
+    pthread_mutex_t lock;
     unsigned int    c; /* total columns */
     unsigned int    l; /* total lines */
     struct line     *lines;
     char            **tmp;
+    unsigned int    pending;  /* lines not drawn yet */
 };
 
-static struct messages __mlog;
-static pthread_mutex_t __m_lines = PTHREAD_MUTEX_INITIALIZER;
+void *gui_messages_create(void)
+{
+    struct messages *m = NULL;
+
+    m = calloc(1, sizeof(struct messages));
+
+    if (NULL == m)
+        return NULL;
+
+    pthread_mutex_init(&m->lock, NULL);
+
+    return m;
+}
+
+static void free_tmp(struct messages *m)
+{
+    unsigned int i;
+
+    if (NULL == m->tmp)
+        return;
+
+    for (i = 0; i < m->l; i++)
+        free(m->tmp[i]);
+
+    free(m->tmp);
+    m->tmp = NULL;
+}
+
+void gui_messages_destroy(void *a)
+{
+    struct messages *m = (struct messages *)a;
+
+    if (NULL == m)
+        return;
+
+    free_tmp(m);
+    cl_dll_free(m->lines, NULL);
+    pthread_mutex_destroy(&m->lock);
+    free(m);
+}
+
+/* Bytes taken by the lines of the object and its buffer for new ones */
+size_t gui_messages_memory(void *a)
+{
+    struct messages *m = (struct messages *)a;
+    size_t size = sizeof(struct messages);
+
+    pthread_mutex_lock(&m->lock);
+    size += cl_dll_size(m->lines) * sizeof(struct line);
+
+    if (m->tmp != NULL)
+        size += (m->l + 1) * sizeof(char *) + m->l * (MAX_LINE_CHARS + 1);
+
+    pthread_mutex_unlock(&m->lock);
+
+    return size;
+}
 
 static struct line *new_line(const char *msg, int fg_color, const char *color)
 {
@@ -72,76 +134,109 @@ static struct line *new_line(const char *msg, int fg_color, const char *color)
 
 static void init_messages(DIALOG *d)
 {
+    struct messages *m = d->dp2;
     unsigned int i;
+    struct line *line;
 
-    __mlog.c = (d->w - d->x) / text_length(font, WIDEST_CHAR);
-    __mlog.l = d->h / (text_height(font) + 2);
+    pthread_mutex_lock(&m->lock);
+    free_tmp(m);
+    m->c = (d->w - d->x) / text_length(font, WIDEST_CHAR);
+    m->l = d->h / (text_height(font) + 2);
 
-    __mlog.lines = NULL;
+    /* Lines restored before the object starts may not fit */
+    while ((unsigned int)cl_dll_size(m->lines) > m->l) {
+        line = cl_dll_pop(&m->lines);
+        free(line);
+    }
 
     /* This buffer is for new messages... */
-    __mlog.tmp = calloc(__mlog.l + 1, sizeof(char *));
+    m->tmp = calloc(m->l + 1, sizeof(char *));
 
-    for (i = 0; i < __mlog.l; i++)
-        __mlog.tmp[i] = calloc(MAX_LINE_CHARS + 1, sizeof(char));
+    for (i = 0; (m->tmp != NULL) && (i < m->l); i++)
+        m->tmp[i] = calloc(MAX_LINE_CHARS + 1, sizeof(char));
+
+    pthread_mutex_unlock(&m->lock);
 }
 
-static void uninit_messages(void)
+static void uninit_messages(DIALOG *d)
 {
-    unsigned int i;
-
-    for (i = 0; i < __mlog.l; i++)
-        free(__mlog.tmp[i]);
-
-    free(__mlog.tmp);
-    cl_dll_free(__mlog.lines, NULL);
+    struct messages *m = d->dp2;
+
+    pthread_mutex_lock(&m->lock);
+    free_tmp(m);
+    cl_dll_free(m->lines, NULL);
+    m->lines = NULL;
+    m->pending = 0;
+    m->l = 0;
+    pthread_mutex_unlock(&m->lock);
 }
 
 static void print_messages(DIALOG *d)
 {
+    struct messages *m = d->dp2;
     int y = d->y;
     struct line *p;
 
-    for (p = __mlog.lines; p; p = p->next, y += text_height(font) + 2) {
+    pthread_mutex_lock(&m->lock);
+    m->pending = 0;
+
+    for (p = m->lines; p; p = p->next, y += text_height(font) + 2) {
         textprintf_ex(gui_get_screen(), font, d->x, y, d->bg, d->bg, "%*c",
-                      __mlog.c, ' ');
+                      m->c, ' ');
 
         textprintf_ex(gui_get_screen(), font, d->x, y, p->fg, d->bg, "%s", p->s);
     }
+
+    pthread_mutex_unlock(&m->lock);
+}
+
+static bool has_pending_messages(DIALOG *d)
+{
+    struct messages *m = d->dp2;
+    bool pending;
+
+    pthread_mutex_lock(&m->lock);
+    pending = (m->pending > 0);
+    pthread_mutex_unlock(&m->lock);
+
+    return pending;
 }
 
 static void clear_messages(DIALOG *d)
 {
+    struct messages *m = d->dp2;
     unsigned int i;
     int y;
 
-    pthread_mutex_lock(&__m_lines);
+    pthread_mutex_lock(&m->lock);
 
-    for (i = 0, y = d->y; i < __mlog.l; i++, y += text_height(font) + 2) {
+    for (i = 0, y = d->y; i < m->l; i++, y += text_height(font) + 2) {
         textprintf_ex(gui_get_screen(), font, d->x, y, d->bg, d->bg, "%*c",
-                      __mlog.c, ' ');
+                      m->c, ' ');
     }
 
-    cl_dll_free(__mlog.lines, NULL);
-    __mlog.lines = NULL;
+    cl_dll_free(m->lines, NULL);
+    m->lines = NULL;
+    m->pending = 0;
 
-    pthread_mutex_unlock(&__m_lines);
+    pthread_mutex_unlock(&m->lock);
 }
 
-static int split_line(enum grc_line_break lbreak, const char *msg)
+static int split_line(struct messages *m, enum grc_line_break lbreak,
+    const char *msg)
 {
     size_t l;
     int i, exact_l = 0, splitted = 0, p = 0, r;
 
     l = strlen(msg);
-    exact_l = l / __mlog.c;
+    exact_l = l / m->c;
 
     for (i = 0; i < exact_l; i++, splitted++) {
-        if ((unsigned int)splitted >= __mlog.l)
+        if ((unsigned int)splitted >= m->l)
             break;
 
-        memset(__mlog.tmp[i], 0, MAX_LINE_CHARS);
-        strncpy(__mlog.tmp[i], msg + p, __mlog.c);
+        memset(m->tmp[i], 0, MAX_LINE_CHARS);
+        strncpy(m->tmp[i], msg + p, m->c);
 
         /*
          * To make this way of breaking the columns really efficient, we
@@ -152,71 +247,147 @@ static int split_line(enum grc_line_break lbreak, const char *msg)
             int n, x;
             char *s;
 
-            s = strrchr(__mlog.tmp[i], ' ');
+            s = strrchr(m->tmp[i], ' ');
 
             if (s) {
                 n = strlen(s);
-                x = strlen(__mlog.tmp[i]);
-                __mlog.tmp[i][x - n] = '\0';
+                x = strlen(m->tmp[i]);
+                m->tmp[i][x - n] = '\0';
                 p++;
             }
         }
 
-        p += strlen(__mlog.tmp[i]);
+        p += strlen(m->tmp[i]);
     }
 
     r = l - p;
 
     if (r > 0) {
-        memset(__mlog.tmp[i], 0, MAX_LINE_CHARS);
-        strncpy(__mlog.tmp[i], msg + p, r);
+        memset(m->tmp[i], 0, MAX_LINE_CHARS);
+        strncpy(m->tmp[i], msg + p, r);
         splitted++;
     }
 
     return splitted;
 }
 
-void gui_messages_set(enum grc_line_break lbreak, int fg_color,
-    const char *msg, const char *color)
+/*
+ * Adds @msg to the object, returning how many lines it took. Lines which
+ * were scrolled out before being drawn, or the message itself when the
+ * object has not started, are given back in @dropped.
+ */
+unsigned int gui_messages_set(DIALOG *d, const char *msg, const char *color,
+    unsigned int *dropped)
 {
+    struct messages *m = d->dp2;
     size_t l;
-    unsigned int msg_lines = 0, i = 0;
+    unsigned int msg_lines = 0, i = 0, drawn;
     int rm_lines = 0;
     struct line *line;
 
-    pthread_mutex_lock(&__m_lines);
+    *dropped = 0;
+    pthread_mutex_lock(&m->lock);
+
+    /* The object has not started yet */
+    if (NULL == m->tmp) {
+        *dropped = 1;
+        goto end_block;
+    }
 
     l = strlen(msg);
 
-    if (l > __mlog.c) {
+    if (l > m->c) {
         /*
          * We need to split the line because it exceeded the object column
          * limit.
          */
-        msg_lines = split_line(lbreak, msg);
+        msg_lines = split_line(m, d->d1, msg);
     } else {
         msg_lines = 1;
-        strcpy(__mlog.tmp[0], msg);
-        __mlog.tmp[0][l] = '\0';
+        strcpy(m->tmp[0], msg);
+        m->tmp[0][l] = '\0';
     }
 
     /* Remove lines that reach the limit */
-    rm_lines = (cl_dll_size(__mlog.lines) + msg_lines) - __mlog.l;
+    rm_lines = (cl_dll_size(m->lines) + msg_lines) - m->l;
 
     if (rm_lines > 0) {
+        /* The oldest lines go first, and those not drawn are the newest */
+        drawn = cl_dll_size(m->lines) - m->pending;
+
+        if ((unsigned int)rm_lines > drawn) {
+            *dropped = MIN(rm_lines - drawn, m->pending);
+            m->pending -= *dropped;
+        }
+
         for (i = 0; i < (unsigned int)rm_lines; i++) {
-            line = cl_dll_pop(&__mlog.lines);
+            line = cl_dll_pop(&m->lines);
             free(line);
         }
     }
 
     /* Add new lines */
     for (i = 0; i < msg_lines; i++) {
-        line = new_line(__mlog.tmp[i], fg_color, color);
-        __mlog.lines = cl_dll_unshift(__mlog.lines, line);
+        line = new_line(m->tmp[i], d->fg, color);
+        m->lines = cl_dll_unshift(m->lines, line);
     }
 
-    pthread_mutex_unlock(&__m_lines);
+    m->pending += msg_lines;
+
+end_block:
+    pthread_mutex_unlock(&m->lock);
+
+    return msg_lines;
+}
+
+/* Calls @fn for every line on the screen, from the oldest one */
+void gui_messages_foreach(DIALOG *d,
+    void (*fn)(const char *, int, void *), void *arg)
+{
+    struct messages *m = d->dp2;
+    struct line *p;
+
+    pthread_mutex_lock(&m->lock);
+
+    for (p = m->lines; p; p = p->next)
+        fn(p->s, p->fg, arg);
+
+    pthread_mutex_unlock(&m->lock);
+}
+
+/*
+ * Adds a line previously obtained with gui_messages_foreach. It may be called
+ * before the object starts.
+ */
+int gui_messages_restore(DIALOG *d, const char *msg, unsigned int n,
+    int fg_color)
+{
+    struct messages *m = d->dp2;
+    struct line *line;
+
+    line = calloc(1, sizeof(struct line));
+
+    if (NULL == line)
+        return -1;
+
+    if (n >= MAX_LINE_CHARS)
+        n = MAX_LINE_CHARS - 1;
+
+    memcpy(line->s, msg, n);
+    line->fg = fg_color;
+
+    pthread_mutex_lock(&m->lock);
+
+    if ((m->l > 0) &&
+        ((unsigned int)cl_dll_size(m->lines) >= m->l))
+    {
+        free(cl_dll_pop(&m->lines));
+    }
+
+    m->lines = cl_dll_unshift(m->lines, line);
+    pthread_mutex_unlock(&m->lock);
+
+    return 0;
 }
 
 int gui_messages_log_proc(int msg, DIALOG *d, int c __attribute__((unused)))
@@ -227,7 +398,7 @@ int gui_messages_log_proc(int msg, DIALOG *d, int c __attribute__((unused)))
             break;
 
         case MSG_END:
-            uninit_messages();
+            uninit_messages(d);
             break;
 
         case MSG_NEW_LOG_TEXT:
@@ -241,8 +412,17 @@ int gui_messages_log_proc(int msg, DIALOG *d, int c __attribute__((unused)))
         case MSG_CLEAR_LOG_TEXT:
             clear_messages(d);
             break;
+
+        case MSG_IDLE:
+            /*
+             * Messages set while another thread was drawing, which could
+             * not notify the object.
+             */
+            if (has_pending_messages(d) == true)
+                print_messages(d);
+
+            break;
     }
 
     return D_O_K;
 }
-
@@ -0,0 +1,188 @@
+/*
+ * Description: Row viewport shared by the objects that scroll through rows
+ *              kept outside the DIALOG, like the 'table' and the virtual
+ *              'list': keyboard and mouse navigation and the scrollbar.
+ *
+ * Author: Rodrigo Freitas
+ * Created at: Mon Oct 19 16:02:38 2026
+ * Project: libgrc
+ *
+ * Copyright (c) 2014 Rodrigo Freitas
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301
+ * USA
+ */
+
+#include "libgrc.h"
+#include "objects.h"
+
+#define ROW_VIEW_WHEEL_ROWS         3
+
+/* Position and height of the scrollbar thumb, relative to the rows area */
+static void scrollbar_thumb(DIALOG *d, const struct row_view *v, int *ty,
+    int *th)
+{
+    *th = (v->rows_h * v->visible) / v->total;
+
+    if (*th < 4)
+        *th = 4;
+
+    *ty = (int)(((long long)(v->rows_h - *th) * d->d2) /
+                (v->total - v->visible));
+}
+
+void row_view_draw_scrollbar(DIALOG *d, const struct row_view *v)
+{
+    BITMAP *gui_bmp = gui_get_screen();
+    int x, y, ty, th;
+
+    x = d->x + d->w - ROW_VIEW_SCROLLBAR_WIDTH;
+    y = d->y + v->rows_y;
+    rectfill(gui_bmp, x, d->y + 1, x + ROW_VIEW_SCROLLBAR_WIDTH - 2,
+             d->y + d->h - 2, d->bg);
+
+    if (v->total <= v->visible)
+        return;
+
+    scrollbar_thumb(d, v, &ty, &th);
+    rectfill(gui_bmp, x + 1, y + ty, x + ROW_VIEW_SCROLLBAR_WIDTH - 3,
+             y + ty + th - 1, d->fg);
+}
+
+/* Adjusts the first visible row so that the selected one can be seen */
+void row_view_follow_selection(DIALOG *d, const struct row_view *v)
+{
+    if (d->d1 >= v->total)
+        d->d1 = v->total - 1;
+
+    if (d->d1 < 0)
+        d->d1 = 0;
+
+    if (d->d1 < d->d2)
+        d->d2 = d->d1;
+    else if (d->d1 >= d->d2 + v->visible)
+        d->d2 = d->d1 - v->visible + 1;
+}
+
+void row_view_scroll_to(DIALOG *d, const struct row_view *v, int top)
+{
+    if (top > v->total - v->visible)
+        top = v->total - v->visible;
+
+    if (top < 0)
+        top = 0;
+
+    d->d2 = top;
+}
+
+void row_view_wheel(DIALOG *d, const struct row_view *v, int c)
+{
+    row_view_scroll_to(d, v, d->d2 - c * ROW_VIEW_WHEEL_ROWS);
+}
+
+/*
+ * Moves the selection with the navigation keys. Returns true if @c was one
+ * of them, so that the object must be drawn again.
+ */
+bool row_view_key(DIALOG *d, const struct row_view *v, int c)
+{
+    switch (c >> 8) {
+        case KEY_UP:
+            d->d1--;
+            break;
+
+        case KEY_DOWN:
+            d->d1++;
+            break;
+
+        case KEY_PGUP:
+            d->d1 -= v->visible - 1;
+            break;
+
+        case KEY_PGDN:
+            d->d1 += v->visible - 1;
+            break;
+
+        case KEY_HOME:
+            d->d1 = 0;
+            break;
+
+        case KEY_END:
+            d->d1 = v->total - 1;
+            break;
+
+        default:
+            return false;
+    }
+
+    row_view_follow_selection(d, v);
+
+    return true;
+}
+
+/*
+ * Handles a mouse click: a click inside the scrollbar turns the page and
+ * one over a row selects it.
+ */
+enum row_view_click row_view_click(DIALOG *d, const struct row_view *v)
+{
+    int x, y, row, ty, th;
+
+    x = gui_mouse_x() - d->x;
+    y = gui_mouse_y() - d->y - v->rows_y;
+
+    if (x >= d->w - ROW_VIEW_SCROLLBAR_WIDTH) {
+        if (v->total <= v->visible)
+            return ROW_VIEW_CLICK_NONE;
+
+        scrollbar_thumb(d, v, &ty, &th);
+
+        if (y < ty)
+            row_view_scroll_to(d, v, d->d2 - v->visible);
+        else if (y >= ty + th)
+            row_view_scroll_to(d, v, d->d2 + v->visible);
+
+        return ROW_VIEW_CLICK_SCROLL;
+    }
+
+    /* Clicks above the rows area, like over a header, are ignored */
+    if (y < 0)
+        return ROW_VIEW_CLICK_NONE;
+
+    row = d->d2 + y / v->row_h;
+
+    if (row >= v->total)
+        return ROW_VIEW_CLICK_NONE;
+
+    d->d1 = row;
+
+    return ROW_VIEW_CLICK_ROW;
+}
+
+/*
+ * Makes the object refresh itself the next time it's idle, for when it
+ * can't receive its refresh message because another thread is using
+ * Allegro.
+ */
+void row_view_request_refresh(struct row_view *v)
+{
+    __atomic_store_n(&v->refresh, true, __ATOMIC_RELEASE);
+}
+
+/* Returns and clears a refresh requested with row_view_request_refresh */
+bool row_view_take_refresh(struct row_view *v)
+{
+    return __atomic_exchange_n(&v->refresh, false, __ATOMIC_ACQ_REL);
+}
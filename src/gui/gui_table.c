@@ -0,0 +1,845 @@
+/*
+ * Description: A table object, showing rows and columns fetched on demand
+ *              from a data source.
+ *
+ * Author: Rodrigo Freitas
+ * Created at: Mon Oct 19 11:20:44 2026
+ * Project: libgrc
+ *
+ * Copyright (c) 2014 Rodrigo Freitas
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301
+ * USA
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include <pthread.h>
+
+#include "libgrc.h"
+#include "objects.h"
+
+/* Maximum size of a cell or a column title, including the '\0' */
+#define TABLE_CELL_SIZE             64
+
+#define TABLE_CELL_PADDING          2
+#define TABLE_MIN_COLUMN_WIDTH      16
+
+/* Separators of the "columns" property */
+#define COLUMN_SEPARATOR            ","
+#define COLUMN_FIELD_SEPARATOR      ':'
+
+/* Column alignments */
+#define ALIGN_LEFT_STR              "left"
+#define ALIGN_CENTER_STR            "center"
+#define ALIGN_RIGHT_STR             "right"
+
+enum table_align {
+    TABLE_ALIGN_LEFT,
+    TABLE_ALIGN_CENTER,
+    TABLE_ALIGN_RIGHT
+};
+
+struct table_column {
+    char                title[TABLE_CELL_SIZE];
+    int                 width;      /** Width from the GRC, 0 fills space */
+    enum table_align    align;
+
+    /* Layout, computed only once when the object starts */
+    int                 x;          /** Offset from the first column */
+    int                 w;
+};
+
+/*
+ * The object uses the same fields of a 'list' object: @d1 is the selected
+ * row and @d2 the first visible row. This structure is kept in @dp2.
+ *
+ * @cells keeps the text of every visible cell, so that moving the selection
+ * or receiving a cell update never requests unchanged cells again.
+ */
+struct table {
+    pthread_mutex_t         lock;
+    struct grc_table_source source;
+    bool                    has_source;
+    int                     columns;
+    struct table_column     *column;
+    int                     first_col;      /** Horizontal scroll */
+    int                     last_col;       /** Last visible column */
+    struct row_view         view;
+    int                     rendered_top;   /** First row inside @backing */
+    int                     rendered_sel;
+    int                     rendered_col;
+    char                    *cells;
+    bool                    *dirty;         /** Cells updated by the user */
+    bool                    *pending;
+    bool                    damaged;
+    BITMAP                  *backing;       /** Rows area, without header */
+
+    /* Read by grc_memory_usage from any thread */
+    size_t                  backing_memory;
+};
+
+static enum table_align tr_align(const char *align)
+{
+    if (!strcmp(align, ALIGN_RIGHT_STR))
+        return TABLE_ALIGN_RIGHT;
+    else if (!strcmp(align, ALIGN_CENTER_STR))
+        return TABLE_ALIGN_CENTER;
+
+    return TABLE_ALIGN_LEFT;
+}
+
+/*
+ * Parses a single column definition, in the "title:width:align" format.
+ * Both the width and the alignment are optional.
+ */
+static void parse_column(struct table_column *c, char *def)
+{
+    char *width, *align = NULL;
+
+    width = strchr(def, COLUMN_FIELD_SEPARATOR);
+
+    if (width != NULL) {
+        *width++ = '\0';
+        align = strchr(width, COLUMN_FIELD_SEPARATOR);
+
+        if (align != NULL)
+            *align++ = '\0';
+
+        c->width = atoi(width);
+    }
+
+    snprintf(c->title, TABLE_CELL_SIZE, "%s", def);
+    c->align = (align != NULL) ? tr_align(align) : TABLE_ALIGN_LEFT;
+
+    if (c->width < 0)
+        c->width = 0;
+}
+
+static int parse_columns(struct table *t, const char *columns)
+{
+    char *s, *p, *def, *save = NULL;
+    int n = 1;
+
+    for (p = (char *)columns; *p != '\0'; p++)
+        if (*p == COLUMN_SEPARATOR[0])
+            n++;
+
+    t->column = calloc(n, sizeof(struct table_column));
+    s = strdup(columns);
+
+    if ((NULL == t->column) || (NULL == s)) {
+        if (s != NULL)
+            free(s);
+
+        return -1;
+    }
+
+    for (def = strtok_r(s, COLUMN_SEPARATOR, &save);
+         def != NULL;
+         def = strtok_r(NULL, COLUMN_SEPARATOR, &save))
+    {
+        parse_column(&t->column[t->columns++], def);
+    }
+
+    free(s);
+
+    return (t->columns > 0) ? 0 : -1;
+}
+
+void gui_table_destroy(void *a)
+{
+    struct table *t = (struct table *)a;
+
+    if (NULL == t)
+        return;
+
+    if (t->backing != NULL)
+        destroy_bitmap(t->backing);
+
+    if (t->cells != NULL)
+        free(t->cells);
+
+    if (t->dirty != NULL)
+        free(t->dirty);
+
+    if (t->pending != NULL)
+        free(t->pending);
+
+    if (t->column != NULL)
+        free(t->column);
+
+    pthread_mutex_destroy(&t->lock);
+    free(t);
+}
+
+/* Bytes of the backing bitmap, while the table runs */
+size_t gui_table_memory(void *a)
+{
+    struct table *t = (struct table *)a;
+
+    return __atomic_load_n(&t->backing_memory, __ATOMIC_RELAXED);
+}
+
+/*
+ * Creates the internal table structure from its "columns" property. Returns
+ * NULL if there is no valid column.
+ */
+void *gui_table_create(const char *columns)
+{
+    struct table *t = NULL;
+
+    if (NULL == columns)
+        return NULL;
+
+    t = calloc(1, sizeof(struct table));
+
+    if (NULL == t)
+        return NULL;
+
+    pthread_mutex_init(&t->lock, NULL);
+    t->rendered_top = -1;
+    t->rendered_sel = -1;
+    t->rendered_col = -1;
+
+    if (parse_columns(t, columns) < 0) {
+        gui_table_destroy(t);
+        return NULL;
+    }
+
+    return t;
+}
+
+/*
+ * Computes the position of every column. Columns without a width share the
+ * space left by the others inside the viewport.
+ */
+static void compute_layout(struct table *t, int viewport_w)
+{
+    int i, x = 0, fixed = 0, flexible = 0, w;
+
+    for (i = 0; i < t->columns; i++) {
+        if (t->column[i].width > 0)
+            fixed += t->column[i].width;
+        else
+            flexible++;
+    }
+
+    w = (flexible > 0) ? (viewport_w - fixed) / flexible : 0;
+
+    if (w < TABLE_MIN_COLUMN_WIDTH)
+        w = TABLE_MIN_COLUMN_WIDTH;
+
+    for (i = 0; i < t->columns; i++) {
+        t->column[i].x = x;
+        t->column[i].w = (t->column[i].width > 0) ? t->column[i].width : w;
+        x += t->column[i].w;
+    }
+}
+
+/* Updates the last visible column, after a horizontal scroll */
+static void update_visible_columns(struct table *t)
+{
+    int i, start = t->column[t->first_col].x;
+
+    t->last_col = t->first_col;
+
+    for (i = t->first_col; i < t->columns; i++) {
+        if (t->column[i].x - start >= t->backing->w)
+            break;
+
+        t->last_col = i;
+    }
+}
+
+static char *cell_text(struct table *t, int slot, int col)
+{
+    return t->cells + ((slot * t->columns) + col) * TABLE_CELL_SIZE;
+}
+
+static void update_total_rows(struct table *t)
+{
+    int total = 0;
+
+    if ((t->has_source == true) && (t->source.count != NULL))
+        total = (t->source.count)(t->source.arg);
+
+    t->view.total = (total < 0) ? 0 : total;
+}
+
+static void fetch_cell(struct table *t, int row, int col, char *buf)
+{
+    buf[0] = '\0';
+
+    if (t->has_source == false)
+        return;
+
+    if ((t->source.cell)(t->source.arg, row, col, buf, TABLE_CELL_SIZE) < 0)
+        buf[0] = '\0';
+
+    buf[TABLE_CELL_SIZE - 1] = '\0';
+}
+
+static void row_colors(DIALOG *d, int row, int *fg, int *bg)
+{
+    *fg = (d->flags & D_DISABLED) ? gui_mg_color : d->fg;
+    *bg = d->bg;
+
+    if (row == d->d1) {
+        *fg = d->bg;
+        *bg = (d->flags & D_DISABLED) ? gui_mg_color : d->fg;
+    }
+}
+
+/* Renders a single cell into the backing bitmap, using its cached text */
+static void render_cell(DIALOG *d, struct table *t, int slot, int col)
+{
+    struct table_column *c = &t->column[col];
+    int row, x, y, fg, bg, tx;
+    const char *text;
+
+    row = d->d2 + slot;
+    x = c->x - t->column[t->first_col].x;
+    y = slot * t->view.row_h;
+    row_colors(d, row, &fg, &bg);
+
+    if (row >= t->view.total)
+        bg = d->bg;
+
+    rectfill(t->backing, x, y, x + c->w - 1, y + t->view.row_h - 1, bg);
+    vline(t->backing, x + c->w - 1, y, y + t->view.row_h - 1, gui_mg_color);
+
+    if (row >= t->view.total)
+        return;
+
+    text = cell_text(t, slot, col);
+    set_clip_rect(t->backing, x, y, x + c->w - 1 - TABLE_CELL_PADDING,
+                  y + t->view.row_h - 1);
+
+    switch (c->align) {
+        case TABLE_ALIGN_LEFT:
+            tx = x + TABLE_CELL_PADDING;
+            textout_ex(t->backing, font, text, tx, y + 1, fg, -1);
+            break;
+
+        case TABLE_ALIGN_CENTER:
+            tx = x + c->w / 2;
+            textout_centre_ex(t->backing, font, text, tx, y + 1, fg, -1);
+            break;
+
+        case TABLE_ALIGN_RIGHT:
+            tx = x + c->w - 1 - TABLE_CELL_PADDING;
+            textout_right_ex(t->backing, font, text, tx, y + 1, fg, -1);
+            break;
+    }
+
+    set_clip_rect(t->backing, 0, 0, t->backing->w - 1, t->backing->h - 1);
+}
+
+/*
+ * Renders a viewport slot. If @fetch is true the visible cells are
+ * requested again to the data source.
+ */
+static void render_slot(DIALOG *d, struct table *t, int slot, bool fetch)
+{
+    int col, row, x, y;
+
+    row = d->d2 + slot;
+    y = slot * t->view.row_h;
+
+    for (col = t->first_col; col <= t->last_col; col++) {
+        if ((fetch == true) && (row < t->view.total))
+            fetch_cell(t, row, col, cell_text(t, slot, col));
+
+        render_cell(d, t, slot, col);
+    }
+
+    /* Space after the last column */
+    x = t->column[t->last_col].x + t->column[t->last_col].w -
+        t->column[t->first_col].x;
+
+    if (x < t->backing->w)
+        rectfill(t->backing, x, y, t->backing->w - 1, y + t->view.row_h - 1,
+                 d->bg);
+}
+
+/*
+ * Moves the cached texts and updates of the slots along with a vertical
+ * scroll. Must be called with the lock held.
+ */
+static void shift_slots(struct table *t, int delta)
+{
+    int keep = t->view.visible - abs(delta), n = t->columns;
+
+    if (delta > 0) {
+        memmove(t->cells, cell_text(t, delta, 0),
+                keep * n * TABLE_CELL_SIZE);
+
+        memmove(t->dirty, t->dirty + delta * n, keep * n * sizeof(bool));
+        memset(t->dirty + keep * n, 0, delta * n * sizeof(bool));
+    } else {
+        memmove(cell_text(t, -delta, 0), t->cells,
+                keep * n * TABLE_CELL_SIZE);
+
+        memmove(t->dirty - delta * n, t->dirty, keep * n * sizeof(bool));
+        memset(t->dirty, 0, -delta * n * sizeof(bool));
+    }
+}
+
+/*
+ * Brings the backing bitmap to the current object state. A vertical scroll
+ * moves the rows already rendered and fetches only the exposed ones.
+ */
+static void update_backing(DIALOG *d, struct table *t)
+{
+    int i, delta, keep, old_sel;
+    bool full = false;
+
+    pthread_mutex_lock(&t->lock);
+    delta = d->d2 - t->rendered_top;
+
+    if ((t->rendered_top < 0) || (t->rendered_col != t->first_col) ||
+        (abs(delta) >= t->view.visible))
+    {
+        memset(t->dirty, 0, t->view.visible * t->columns * sizeof(bool));
+        full = true;
+    } else if (delta != 0)
+        shift_slots(t, delta);
+
+    t->rendered_top = d->d2;
+    pthread_mutex_unlock(&t->lock);
+
+    if (full == true) {
+        update_visible_columns(t);
+
+        for (i = 0; i < t->view.visible; i++)
+            render_slot(d, t, i, true);
+    } else if (delta != 0) {
+        keep = t->view.visible - abs(delta);
+
+        if (delta > 0) {
+            blit(t->backing, t->backing, 0, delta * t->view.row_h, 0, 0,
+                 t->backing->w, keep * t->view.row_h);
+
+            for (i = keep; i < t->view.visible; i++)
+                render_slot(d, t, i, true);
+        } else {
+            blit(t->backing, t->backing, 0, 0, 0, -delta * t->view.row_h,
+                 t->backing->w, keep * t->view.row_h);
+
+            for (i = 0; i < -delta; i++)
+                render_slot(d, t, i, true);
+        }
+    }
+
+    /* The selection may have moved without scrolling */
+    if ((full == false) && (t->rendered_sel != d->d1)) {
+        old_sel = t->rendered_sel - d->d2;
+
+        if ((old_sel >= 0) && (old_sel < t->view.visible))
+            render_slot(d, t, old_sel, false);
+
+        if ((d->d1 - d->d2 >= 0) && (d->d1 - d->d2 < t->view.visible))
+            render_slot(d, t, d->d1 - d->d2, false);
+    }
+
+    t->rendered_sel = d->d1;
+    t->rendered_col = t->first_col;
+}
+
+static void draw_header(DIALOG *d, struct table *t)
+{
+    BITMAP *gui_bmp = gui_get_screen();
+    struct table_column *c;
+    int col, x, y = d->y + 1, right, cx1, cy1, cx2, cy2;
+
+    right = d->x + d->w - ROW_VIEW_SCROLLBAR_WIDTH - 2;
+    get_clip_rect(gui_bmp, &cx1, &cy1, &cx2, &cy2);
+    set_clip_rect(gui_bmp, d->x + 1, y, right, y + t->view.row_h - 1);
+    rectfill(gui_bmp, d->x + 1, y, right, y + t->view.row_h - 1, d->bg);
+
+    for (col = t->first_col; col <= t->last_col; col++) {
+        c = &t->column[col];
+        x = d->x + 1 + c->x - t->column[t->first_col].x;
+        textout_ex(gui_bmp, font, c->title, x + TABLE_CELL_PADDING, y + 1,
+                   d->fg, -1);
+
+        vline(gui_bmp, x + c->w - 1, y, y + t->view.row_h - 1, gui_mg_color);
+    }
+
+    set_clip_rect(gui_bmp, cx1, cy1, cx2, cy2);
+    hline(gui_bmp, d->x + 1, y + t->view.row_h, right, d->fg);
+}
+
+static void draw_table(DIALOG *d, struct table *t, bool frame)
+{
+    BITMAP *gui_bmp = gui_get_screen();
+    bool header;
+
+    header = (frame == true) || (t->rendered_col != t->first_col);
+    update_backing(d, t);
+
+    if (frame == true) {
+        rect(gui_bmp, d->x, d->y, d->x + d->w - 1, d->y + d->h - 1, d->fg);
+        vline(gui_bmp, d->x + d->w - ROW_VIEW_SCROLLBAR_WIDTH - 1, d->y,
+              d->y + d->h - 1, d->fg);
+    }
+
+    if (header == true)
+        draw_header(d, t);
+
+    blit(t->backing, gui_bmp, 0, 0, d->x + 1, d->y + t->view.rows_y,
+         t->backing->w, t->backing->h);
+
+    row_view_draw_scrollbar(d, &t->view);
+}
+
+/*
+ * Redraws only the cells updated with grc_table_update_cell whose content
+ * really changed.
+ */
+static void draw_damaged_cells(DIALOG *d, struct table *t)
+{
+    char tmp[TABLE_CELL_SIZE];
+    int slot, col, n = t->view.visible * t->columns;
+    struct table_column *c;
+
+    pthread_mutex_lock(&t->lock);
+
+    if ((t->damaged == false) || (t->rendered_top != d->d2)) {
+        pthread_mutex_unlock(&t->lock);
+        return;
+    }
+
+    memcpy(t->pending, t->dirty, n * sizeof(bool));
+    memset(t->dirty, 0, n * sizeof(bool));
+    t->damaged = false;
+    pthread_mutex_unlock(&t->lock);
+
+    for (slot = 0; slot < t->view.visible; slot++) {
+        if (d->d2 + slot >= t->view.total)
+            break;
+
+        for (col = t->first_col; col <= t->last_col; col++) {
+            if (t->pending[slot * t->columns + col] == false)
+                continue;
+
+            fetch_cell(t, d->d2 + slot, col, tmp);
+
+            if (!strcmp(tmp, cell_text(t, slot, col)))
+                continue;
+
+            strcpy(cell_text(t, slot, col), tmp);
+            render_cell(d, t, slot, col);
+
+            c = &t->column[col];
+            blit(t->backing, gui_get_screen(),
+                 c->x - t->column[t->first_col].x, slot * t->view.row_h,
+                 d->x + 1 + c->x - t->column[t->first_col].x,
+                 d->y + t->view.rows_y + slot * t->view.row_h, c->w,
+                 t->view.row_h);
+        }
+    }
+}
+
+static int start_table(DIALOG *d, struct table *t)
+{
+    int w, n;
+
+    t->view.row_h = text_height(font) + 2;
+
+    /* The first line is used by the columns titles */
+    t->view.visible = (d->h - 3 - t->view.row_h) / t->view.row_h;
+    t->view.rows_y = t->view.row_h + 2;
+    t->view.rows_h = t->view.visible * t->view.row_h;
+    w = d->w - ROW_VIEW_SCROLLBAR_WIDTH - 2;
+
+    if ((t->view.visible <= 0) || (w <= 0))
+        return -1;
+
+    n = t->view.visible * t->columns;
+    t->backing = create_bitmap(w, t->view.visible * t->view.row_h);
+    t->cells = calloc(n, TABLE_CELL_SIZE);
+    t->dirty = calloc(n, sizeof(bool));
+    t->pending = calloc(n, sizeof(bool));
+
+    if ((NULL == t->backing) || (NULL == t->cells) || (NULL == t->dirty) ||
+        (NULL == t->pending))
+    {
+        return -1;
+    }
+
+    __atomic_store_n(&t->backing_memory, bitmap_memory(t->backing),
+                     __ATOMIC_RELAXED);
+
+    compute_layout(t, w);
+    update_visible_columns(t);
+    update_total_rows(t);
+    row_view_follow_selection(d, &t->view);
+    row_view_scroll_to(d, &t->view, d->d2);
+
+    return 0;
+}
+
+static void stop_table(struct table *t)
+{
+    pthread_mutex_lock(&t->lock);
+
+    if (t->backing != NULL) {
+        destroy_bitmap(t->backing);
+        t->backing = NULL;
+        __atomic_store_n(&t->backing_memory, 0, __ATOMIC_RELAXED);
+    }
+
+    if (t->cells != NULL) {
+        free(t->cells);
+        t->cells = NULL;
+    }
+
+    if (t->dirty != NULL) {
+        free(t->dirty);
+        t->dirty = NULL;
+    }
+
+    if (t->pending != NULL) {
+        free(t->pending);
+        t->pending = NULL;
+    }
+
+    t->rendered_top = -1;
+    t->damaged = false;
+    pthread_mutex_unlock(&t->lock);
+}
+
+static int handle_char(DIALOG *d, struct table *t, int c)
+{
+    switch (c >> 8) {
+        case KEY_LEFT:
+            if (t->first_col > 0)
+                t->first_col--;
+
+            break;
+
+        case KEY_RIGHT:
+            if (t->last_col < t->columns - 1)
+                t->first_col++;
+
+            break;
+
+        case KEY_ENTER:
+            return (d->flags & D_EXIT) ? D_CLOSE : D_USED_CHAR;
+
+        default:
+            if (row_view_key(d, &t->view, c) == false)
+                return D_O_K;
+
+            break;
+    }
+
+    draw_table(d, t, false);
+
+    return D_USED_CHAR;
+}
+
+static int handle_click(DIALOG *d, struct table *t, int msg)
+{
+    enum row_view_click click;
+
+    click = row_view_click(d, &t->view);
+
+    if (click == ROW_VIEW_CLICK_NONE)
+        return D_O_K;
+
+    draw_table(d, t, false);
+
+    if ((click == ROW_VIEW_CLICK_ROW) && (msg == MSG_DCLICK) &&
+        (d->flags & D_EXIT))
+    {
+        return D_CLOSE;
+    }
+
+    return D_O_K;
+}
+
+static void refresh_table(DIALOG *d, struct table *t)
+{
+    /* A pending request is served by this refresh too */
+    row_view_take_refresh(&t->view);
+
+    if (t->backing == NULL)
+        return;
+
+    update_total_rows(t);
+    pthread_mutex_lock(&t->lock);
+    t->rendered_top = -1;
+    pthread_mutex_unlock(&t->lock);
+    row_view_follow_selection(d, &t->view);
+    row_view_scroll_to(d, &t->view, d->d2);
+
+    if (!(d->flags & D_HIDDEN))
+        draw_table(d, t, false);
+}
+
+static int table_proc(int msg, DIALOG *d, int c)
+{
+    struct table *t = d->dp2;
+
+    if (NULL == t)
+        return D_O_K;
+
+    switch (msg) {
+        case MSG_START:
+            if (start_table(d, t) < 0)
+                stop_table(t);
+
+            break;
+
+        case MSG_END:
+            stop_table(t);
+            break;
+
+        case MSG_DRAW:
+            if (t->backing != NULL)
+                draw_table(d, t, true);
+
+            break;
+
+        case MSG_TABLE_REFRESH:
+            refresh_table(d, t);
+            break;
+
+        case MSG_IDLE:
+            if (row_view_take_refresh(&t->view) == true)
+                refresh_table(d, t);
+
+            if ((t->backing != NULL) && !(d->flags & D_HIDDEN))
+                draw_damaged_cells(d, t);
+
+            break;
+
+        case MSG_WANTFOCUS:
+            return D_WANTFOCUS;
+
+        case MSG_CHAR:
+            if (t->backing != NULL)
+                return handle_char(d, t, c);
+
+            break;
+
+        case MSG_CLICK:
+        case MSG_DCLICK:
+            if ((t->backing != NULL) && (t->view.total > 0))
+                return handle_click(d, t, msg);
+
+            break;
+
+        case MSG_WHEEL:
+            if (t->backing != NULL) {
+                row_view_wheel(d, &t->view, c);
+                draw_table(d, t, false);
+            }
+
+            break;
+    }
+
+    return D_O_K;
+}
+
+int gui_table_set_source(DIALOG *d, const struct grc_table_source *source)
+{
+    struct table *t = d->dp2;
+
+    if ((NULL == t) || (NULL == source) || (NULL == source->cell))
+        return -1;
+
+    pthread_mutex_lock(&t->lock);
+    t->source = *source;
+    t->has_source = true;
+    t->rendered_top = -1;
+    pthread_mutex_unlock(&t->lock);
+
+    return 0;
+}
+
+/*
+ * Marks a cell as changed. It is only fetched again, on the next MSG_IDLE,
+ * if it is visible.
+ */
+int gui_table_update_cell(DIALOG *d, int row, int column)
+{
+    struct table *t = d->dp2;
+    int slot;
+
+    if ((NULL == t) || (row < 0) || (column < 0) || (column >= t->columns))
+        return -1;
+
+    pthread_mutex_lock(&t->lock);
+
+    if (t->dirty != NULL) {
+        slot = row - t->rendered_top;
+
+        if ((t->rendered_top >= 0) && (slot >= 0) && (slot < t->view.visible)) {
+            t->dirty[slot * t->columns + column] = true;
+            t->damaged = true;
+        }
+    }
+
+    pthread_mutex_unlock(&t->lock);
+
+    return 0;
+}
+
+/*
+ * Makes the object refresh itself the next time it's idle, for when it
+ * can't receive MSG_TABLE_REFRESH because another thread is using Allegro.
+ */
+void gui_table_request_refresh(DIALOG *d)
+{
+    struct table *t = d->dp2;
+
+    if (NULL == t)
+        return;
+
+    row_view_request_refresh(&t->view);
+}
+
+/*
+ * A 'table' object. Cells come from a 'struct grc_table_source' installed
+ * with grc_table_set_source.
+ */
+int gui_d_table_proc(int msg, DIALOG *d, int c)
+{
+    struct callback_data *acd = d->dp3;
+    int ret;
+
+    ret = table_proc(msg, d, c);
+
+    if (ret == D_CLOSE) {
+        if (d->dp3 != NULL) {
+            callback_set_int(acd, d->d1);
+            run_callback(acd, D_O_K);
+
+            /*
+             * We don't let the interface shutdown if the user forgets the
+             * correct return value.
+             */
+            ret = D_O_K;
+        } else
+            return D_REDRAWME;
+    }
+
+    return ret;
+}
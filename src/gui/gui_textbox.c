@@ -1,6 +1,6 @@
 
 /*
- * Description:
+ * Description: A 'textbox' object that keeps an index of its wrapped lines.
  *
  * Author: Rodrigo Freitas
  * Created at: Mon Dec 29 11:41:01 2014
@@ -24,17 +24,658 @@
  * USA
  */
 
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+
 #include "libgrc.h"
 
+#define TEXTBOX_SCROLLBAR_WIDTH     12
+#define TEXTBOX_MARGIN              2
+#define TEXTBOX_WHEEL_LINES         3
+
+/* Initial number of entries of the lines index */
+#define TEXTBOX_INITIAL_LINES       256
+
+struct textbox_line {
+    size_t                  start;
+    unsigned int            length;
+};
+
+/*
+ * Internal state of a 'textbox' object, kept in @dp2. As an Allegro
+ * 'd_textbox_proc', @d1 is the number of lines and @d2 the first visible
+ * one.
+ *
+ * The text is wrapped only once, into @line. While the user does not append
+ * anything @text is the @dp pointer itself; after that the object keeps its
+ * own copy in @own.
+ *
+ * Text appended while another thread was using Allegro waits in @queued,
+ * the only member protected by @lock, until the object is idle.
+ */
+struct textbox {
+    const char              *text;
+    size_t                  length;         /** Indexed bytes */
+    char                    *own;
+    size_t                  capacity;
+
+    struct textbox_line     *line;
+    int                     lines;
+    int                     line_capacity;
+    unsigned int            max_line;       /** Longest line, in bytes */
+    char                    *tmp;           /** Buffer to draw a line */
+
+    int                     wrap_w;         /** -1 until it is known */
+    int                     glyph_w[128];   /** ASCII widths cache */
+    bool                    running;
+
+    pthread_mutex_t         lock;
+    char                    *queued;
+    size_t                  queued_length;
+    size_t                  queued_capacity;
+};
+
+void *gui_textbox_create(void)
+{
+    struct textbox *t = NULL;
+
+    t = calloc(1, sizeof(struct textbox));
+
+    if (NULL == t)
+        return NULL;
+
+    pthread_mutex_init(&t->lock, NULL);
+    t->wrap_w = -1;
+
+    return t;
+}
+
+void gui_textbox_destroy(void *a)
+{
+    struct textbox *t = (struct textbox *)a;
+
+    if (NULL == t)
+        return;
+
+    if (t->own != NULL)
+        free(t->own);
+
+    if (t->line != NULL)
+        free(t->line);
+
+    if (t->tmp != NULL)
+        free(t->tmp);
+
+    if (t->queued != NULL)
+        free(t->queued);
+
+    pthread_mutex_destroy(&t->lock);
+    free(t);
+}
+
+static int char_length(unsigned char c)
+{
+    if ((c & 0xE0) == 0xC0)
+        return 2;
+    else if ((c & 0xF0) == 0xE0)
+        return 3;
+    else if ((c & 0xF8) == 0xF0)
+        return 4;
+
+    return 1;
+}
+
+static int glyph_width(struct textbox *t, const char *s, int n)
+{
+    char buf[8];
+
+    memcpy(buf, s, n);
+    buf[n] = '\0';
+
+    if ((n > 1) || ((unsigned char)s[0] >= 128))
+        return text_length(font, buf);
+
+    if (t->glyph_w[(int)s[0]] == 0)
+        t->glyph_w[(int)s[0]] = text_length(font, buf) + 1;
+
+    /* Stored plus one, so that 0 means unknown */
+    return t->glyph_w[(int)s[0]] - 1;
+}
+
+static int add_line(struct textbox *t, size_t start, size_t end)
+{
+    struct textbox_line *l;
+    int n;
+
+    if (t->lines == t->line_capacity) {
+        n = (t->line_capacity == 0) ? TEXTBOX_INITIAL_LINES
+                                    : t->line_capacity * 2;
+
+        l = realloc(t->line, n * sizeof(struct textbox_line));
+
+        if (NULL == l)
+            return -1;
+
+        t->line = l;
+        t->line_capacity = n;
+    }
+
+    t->line[t->lines].start = start;
+    t->line[t->lines].length = end - start;
+    t->lines++;
+
+    if (end - start > t->max_line)
+        t->max_line = end - start;
+
+    return 0;
+}
+
+/*
+ * Wraps the text from @pos, which must be the start of a line, to its end.
+ * Lines are broken at the last space that fits inside the object or, when
+ * there is none, at the last character that fits.
+ */
+static int index_text(struct textbox *t, size_t pos)
+{
+    const char *s = t->text;
+    size_t start = pos, space = 0, i;
+    bool has_space = false;
+    int x = 0, w, n;
+
+    while (pos < t->length) {
+        if (s[pos] == '\n') {
+            if (add_line(t, start, pos) < 0)
+                return -1;
+
+            start = ++pos;
+            x = 0;
+            has_space = false;
+            continue;
+        }
+
+        n = char_length(s[pos]);
+
+        if (pos + n > t->length)
+            n = t->length - pos;
+
+        w = glyph_width(t, s + pos, n);
+
+        if ((x + w > t->wrap_w) && (pos > start)) {
+            if (has_space == true) {
+                if (add_line(t, start, space) < 0)
+                    return -1;
+
+                start = space + 1;
+
+                /* The characters after the space move to the new line */
+                for (x = 0, i = start; i < pos; i += n) {
+                    n = char_length(s[i]);
+                    x += glyph_width(t, s + i, n);
+                }
+            } else {
+                if (add_line(t, start, pos) < 0)
+                    return -1;
+
+                start = pos;
+                x = 0;
+            }
+
+            has_space = false;
+            continue;
+        }
+
+        if (s[pos] == ' ') {
+            space = pos;
+            has_space = true;
+        }
+
+        x += w;
+        pos += n;
+    }
+
+    return add_line(t, start, t->length);
+}
+
+static int update_draw_buffer(struct textbox *t)
+{
+    char *p;
+
+    p = realloc(t->tmp, t->max_line + 1);
+
+    if (NULL == p)
+        return -1;
+
+    t->tmp = p;
+
+    return 0;
+}
+
+/*
+ * Builds the lines index if the object text was replaced. This is the only
+ * place where the whole text is wrapped.
+ */
+static void update_index(DIALOG *d, struct textbox *t)
+{
+    int wrap_w;
+
+    wrap_w = d->w - TEXTBOX_SCROLLBAR_WIDTH - 2 * TEXTBOX_MARGIN - 2;
+
+    if ((d->dp == t->text) && (wrap_w == t->wrap_w))
+        return;
+
+    if (d->dp != t->text) {
+        t->text = d->dp;
+        t->length = (t->text != NULL) ? strlen(t->text) : 0;
+    }
+
+    t->wrap_w = wrap_w;
+    t->lines = 0;
+    t->max_line = 0;
+
+    if ((index_text(t, 0) < 0) || (update_draw_buffer(t) < 0))
+        t->lines = 0;
+
+    d->d1 = t->lines;
+}
+
+static int visible_lines(DIALOG *d)
+{
+    int n = (d->h - 2 * TEXTBOX_MARGIN) / text_height(font);
+
+    return (n > 0) ? n : 1;
+}
+
+static void scroll_to(DIALOG *d, struct textbox *t, int first)
+{
+    if (first > t->lines - visible_lines(d))
+        first = t->lines - visible_lines(d);
+
+    if (first < 0)
+        first = 0;
+
+    d->d2 = first;
+}
+
+/* Draws the visible lines starting at @from */
+static void draw_lines(DIALOG *d, struct textbox *t, int from)
+{
+    BITMAP *gui_bmp = gui_get_screen();
+    struct textbox_line *l;
+    int i, x, y, right, fg, th = text_height(font);
+
+    x = d->x + 1 + TEXTBOX_MARGIN;
+    right = d->x + d->w - TEXTBOX_SCROLLBAR_WIDTH - 2;
+    fg = (d->flags & D_DISABLED) ? gui_mg_color : d->fg;
+
+    if (from < d->d2)
+        from = d->d2;
+
+    for (i = from; i < d->d2 + visible_lines(d); i++) {
+        y = d->y + TEXTBOX_MARGIN + (i - d->d2) * th;
+        rectfill(gui_bmp, d->x + 1, y, right, y + th - 1, d->bg);
+
+        if (i >= t->lines)
+            continue;
+
+        l = &t->line[i];
+        memcpy(t->tmp, t->text + l->start, l->length);
+        t->tmp[l->length] = '\0';
+        textout_ex(gui_bmp, font, t->tmp, x, y, fg, -1);
+    }
+}
+
+static void draw_scrollbar(DIALOG *d, struct textbox *t)
+{
+    BITMAP *gui_bmp = gui_get_screen();
+    int x, h = d->h - 2, ty, th, visible = visible_lines(d);
+
+    x = d->x + d->w - TEXTBOX_SCROLLBAR_WIDTH;
+    rectfill(gui_bmp, x, d->y + 1, x + TEXTBOX_SCROLLBAR_WIDTH - 2,
+             d->y + d->h - 2, d->bg);
+
+    if (t->lines <= visible)
+        return;
+
+    th = (h * visible) / t->lines;
+
+    if (th < 4)
+        th = 4;
+
+    ty = 1 + (int)(((long long)(h - th) * d->d2) / (t->lines - visible));
+    rectfill(gui_bmp, x + 1, d->y + ty, x + TEXTBOX_SCROLLBAR_WIDTH - 3,
+             d->y + ty + th - 1, d->fg);
+}
+
+static void draw_textbox(DIALOG *d, struct textbox *t)
+{
+    BITMAP *gui_bmp = gui_get_screen();
+    int y;
+
+    rect(gui_bmp, d->x, d->y, d->x + d->w - 1, d->y + d->h - 1, d->fg);
+    vline(gui_bmp, d->x + d->w - TEXTBOX_SCROLLBAR_WIDTH - 1, d->y,
+          d->y + d->h - 1, d->fg);
+
+    /* Margins */
+    y = d->y + TEXTBOX_MARGIN + visible_lines(d) * text_height(font);
+    rectfill(gui_bmp, d->x + 1, d->y + 1,
+             d->x + d->w - TEXTBOX_SCROLLBAR_WIDTH - 2,
+             d->y + TEXTBOX_MARGIN - 1, d->bg);
+
+    if (y < d->y + d->h - 1)
+        rectfill(gui_bmp, d->x + 1, y,
+                 d->x + d->w - TEXTBOX_SCROLLBAR_WIDTH - 2, d->y + d->h - 2,
+                 d->bg);
+
+    draw_lines(d, t, d->d2);
+    draw_scrollbar(d, t);
+}
+
+/*
+ * Appends text without wrapping again what was already indexed: only the
+ * last line, which may continue with the new text, is wrapped again.
+ */
+static int append_text(DIALOG *d, struct textbox *t, const char *text)
+{
+    size_t n, capacity;
+    int first, old_top;
+    bool at_end;
+    char *p;
+
+    n = strlen(text);
+
+    /* Only an appended text may be changed by us, so we take a copy */
+    if ((d->dp == NULL) || (d->dp != t->own)) {
+        t->length = (d->dp != NULL) ? strlen(d->dp) : 0;
+        capacity = (t->length + n + 1) * 2;
+        p = malloc(capacity);
+
+        if (NULL == p)
+            return -1;
+
+        memcpy(p, (d->dp != NULL) ? d->dp : "", t->length);
+
+        if (t->own != NULL)
+            free(t->own);
+
+        t->own = p;
+        t->capacity = capacity;
+
+        /* Only reindexes if the user changed the text in the meantime */
+        if (d->dp != t->text)
+            t->wrap_w = -1;
+
+        t->text = t->own;
+        d->dp = t->own;
+    } else if (t->length + n + 1 > t->capacity) {
+        capacity = (t->length + n + 1) * 2;
+        p = realloc(t->own, capacity);
+
+        if (NULL == p)
+            return -1;
+
+        t->own = p;
+        t->capacity = capacity;
+        t->text = t->own;
+        d->dp = t->own;
+    }
+
+    memcpy(t->own + t->length, text, n + 1);
+    t->length += n;
+
+    /* The index is built when the object starts */
+    if (t->wrap_w < 0) {
+        if ((t->running == true) && !(d->flags & D_HIDDEN)) {
+            update_index(d, t);
+            draw_textbox(d, t);
+        }
+
+        return 0;
+    }
+
+    at_end = (d->d2 >= t->lines - visible_lines(d));
+    old_top = d->d2;
+    first = (t->lines > 0) ? t->lines - 1 : 0;
+
+    if (t->lines > 0)
+        t->lines--;
+
+    if ((index_text(t, (t->lines > 0) ? t->line[t->lines].start : 0) < 0) ||
+        (update_draw_buffer(t) < 0))
+    {
+        return -1;
+    }
+
+    d->d1 = t->lines;
+
+    /* Keeps showing the end of the text, as a log does */
+    if (at_end)
+        scroll_to(d, t, t->lines);
+
+    if ((t->running == true) && !(d->flags & D_HIDDEN)) {
+        draw_lines(d, t, (d->d2 != old_top) ? d->d2 : first);
+
+        draw_scrollbar(d, t);
+    }
+
+    return 0;
+}
+
+/* Appends the text queued by gui_textbox_queue, keeping its order */
+static int append_queued(DIALOG *d, struct textbox *t)
+{
+    char *queued;
+    int ret;
+
+    pthread_mutex_lock(&t->lock);
+    queued = t->queued;
+    t->queued = NULL;
+    t->queued_length = 0;
+    t->queued_capacity = 0;
+    pthread_mutex_unlock(&t->lock);
+
+    if (NULL == queued)
+        return 0;
+
+    ret = append_text(d, t, queued);
+    free(queued);
+
+    return ret;
+}
+
+/* Must be called with the GUI lock held */
+int gui_textbox_append(DIALOG *d, const char *text)
+{
+    struct textbox *t = d->dp2;
+
+    if ((NULL == t) || (NULL == text))
+        return -1;
+
+    if (append_queued(d, t) < 0)
+        return -1;
+
+    return append_text(d, t, text);
+}
+
+/*
+ * Keeps @text to be appended by the object itself, the next time it's idle.
+ * It may be called from any thread.
+ */
+int gui_textbox_queue(DIALOG *d, const char *text)
+{
+    struct textbox *t = d->dp2;
+    size_t n, capacity;
+    char *p;
+    int ret = 0;
+
+    if ((NULL == t) || (NULL == text))
+        return -1;
+
+    n = strlen(text);
+    pthread_mutex_lock(&t->lock);
+
+    if (t->queued_length + n + 1 > t->queued_capacity) {
+        capacity = (t->queued_length + n + 1) * 2;
+        p = realloc(t->queued, capacity);
+
+        if (NULL == p) {
+            ret = -1;
+            goto end_block;
+        }
+
+        t->queued = p;
+        t->queued_capacity = capacity;
+    }
+
+    memcpy(t->queued + t->queued_length, text, n + 1);
+    t->queued_length += n;
+
+end_block:
+    pthread_mutex_unlock(&t->lock);
+
+    return ret;
+}
+
+/*
+ * Replaces the object content with @n bytes from @text, keeping our own copy
+ * of it.
+ */
+int gui_textbox_set_text(DIALOG *d, const char *text, size_t n)
+{
+    struct textbox *t = d->dp2;
+    char *p;
+
+    if ((NULL == t) || (NULL == text))
+        return -1;
+
+    if ((NULL == t->own) || (n + 1 > t->capacity)) {
+        p = realloc(t->own, n + 1);
+
+        if (NULL == p)
+            return -1;
+
+        t->own = p;
+        t->capacity = n + 1;
+    }
+
+    memcpy(t->own, text, n);
+    t->own[n] = '\0';
+    t->text = t->own;
+    t->length = n;
+    d->dp = t->own;
+
+    /* Forces the whole text to be wrapped again */
+    t->wrap_w = -1;
+
+    if (t->running == true)
+        update_index(d, t);
+
+    return 0;
+}
+
+static int handle_char(DIALOG *d, struct textbox *t, int c)
+{
+    int visible = visible_lines(d);
+
+    switch (c >> 8) {
+        case KEY_UP:
+            scroll_to(d, t, d->d2 - 1);
+            break;
+
+        case KEY_DOWN:
+            scroll_to(d, t, d->d2 + 1);
+            break;
+
+        case KEY_PGUP:
+            scroll_to(d, t, d->d2 - visible + 1);
+            break;
+
+        case KEY_PGDN:
+            scroll_to(d, t, d->d2 + visible - 1);
+            break;
+
+        case KEY_HOME:
+            scroll_to(d, t, 0);
+            break;
+
+        case KEY_END:
+            scroll_to(d, t, t->lines);
+            break;
+
+        default:
+            return D_O_K;
+    }
+
+    draw_lines(d, t, d->d2);
+    draw_scrollbar(d, t);
+
+    return D_USED_CHAR;
+}
+
+/*
+ * A text box that wraps its text only once, keeping an index of its lines,
+ * so that drawing and scrolling cost the same with any text size.
+ */
 int gui_d_textbox_proc(int msg, DIALOG *d, int c)
 {
-    /*
-     * In case the text is not passed yet we do nothing and avoid draw
-     * something invalid into the screen.
-     */
-    if (NULL == d->dp)
+    struct textbox *t = d->dp2;
+    int y;
+
+    if (NULL == t)
         return D_O_K;
 
-    return d_textbox_proc(msg, d, c);
-}
+    switch (msg) {
+        case MSG_START:
+            t->running = true;
+            update_index(d, t);
+            scroll_to(d, t, d->d2);
+            break;
+
+        case MSG_END:
+            t->running = false;
+            break;
+
+        case MSG_DRAW:
+            update_index(d, t);
+            scroll_to(d, t, d->d2);
+            draw_textbox(d, t);
+            break;
+
+        case MSG_IDLE:
+            append_queued(d, t);
+            break;
+
+        case MSG_WANTFOCUS:
+            return D_WANTFOCUS;
+
+        case MSG_CHAR:
+            update_index(d, t);
+            return handle_char(d, t, c);
 
+        case MSG_CLICK:
+            if (gui_mouse_x() < d->x + d->w - TEXTBOX_SCROLLBAR_WIDTH)
+                break;
+
+            /* A click inside the scrollbar turns the page */
+            update_index(d, t);
+            y = gui_mouse_y() - d->y;
+
+            if (y < d->h / 2)
+                scroll_to(d, t, d->d2 - visible_lines(d) + 1);
+            else
+                scroll_to(d, t, d->d2 + visible_lines(d) - 1);
+
+            draw_lines(d, t, d->d2);
+            draw_scrollbar(d, t);
+            break;
+
+        case MSG_WHEEL:
+            update_index(d, t);
+            scroll_to(d, t, d->d2 - c * TEXTBOX_WHEEL_LINES);
+            draw_lines(d, t, d->d2);
+            draw_scrollbar(d, t);
+            break;
+    }
+
+    return D_O_K;
+}
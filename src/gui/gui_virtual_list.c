@@ -0,0 +1,661 @@
+/*
+ * Description: A 'list' object able to handle a huge number of rows. Rows
+ *              are fetched in blocks from a user data source and the
+ *              rendered rows are kept in a bitmap, so scrolling only needs
+ *              to draw the rows that became visible.
+ *
+ * Author: Rodrigo Freitas
+ * Created at: Mon Oct 19 10:31:17 2026
+ * Project: libgrc
+ *
+ * Copyright (c) 2014 Rodrigo Freitas
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301
+ * USA
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include <pthread.h>
+
+#include "libgrc.h"
+#include "objects.h"
+
+/* Number of rows fetched from the data source at once */
+#define VLIST_BLOCK_ROWS            64
+
+/* Number of row blocks kept in memory */
+#define VLIST_CACHE_BLOCKS          16
+
+/* Maximum size of a row, including the '\0' */
+#define VLIST_ROW_SIZE              256
+
+#define VLIST_PLACEHOLDER           "..."
+
+enum vlist_block_state {
+    BLOCK_UNUSED,
+    BLOCK_PENDING,
+    BLOCK_READY
+};
+
+struct vlist_block {
+    int                     first;      /** First row of the block */
+    enum vlist_block_state  state;
+    unsigned int            last_use;
+    char                    rows[VLIST_BLOCK_ROWS][VLIST_ROW_SIZE];
+};
+
+/*
+ * The object uses the same fields of an Allegro 'd_list_proc': @d1 is the
+ * selected row and @d2 the first visible row. This structure is kept in
+ * @dp2, leaving @dp to an optional 'd_list_proc' like getter.
+ */
+struct vlist {
+    pthread_mutex_t         lock;
+    struct grc_list_source  source;
+    bool                    has_source;
+    struct row_view         view;
+    int                     rendered_top;   /** First row inside @backing */
+    int                     rendered_sel;
+    bool                    delivered;      /** Asynchronous rows arrived */
+    bool                    *placeholder;   /** Slots drawn without text */
+    unsigned int            tick;
+    struct vlist_block      block[VLIST_CACHE_BLOCKS];
+    BITMAP                  *backing;
+
+    /* Read by grc_memory_usage from any thread */
+    size_t                  backing_memory;
+};
+
+void *gui_virtual_list_create(void)
+{
+    struct vlist *vl = NULL;
+    unsigned int i;
+
+    vl = calloc(1, sizeof(struct vlist));
+
+    if (NULL == vl)
+        return NULL;
+
+    pthread_mutex_init(&vl->lock, NULL);
+    vl->rendered_top = -1;
+    vl->rendered_sel = -1;
+
+    for (i = 0; i < VLIST_CACHE_BLOCKS; i++)
+        vl->block[i].first = -1;
+
+    return vl;
+}
+
+void gui_virtual_list_destroy(void *a)
+{
+    struct vlist *vl = (struct vlist *)a;
+
+    if (NULL == vl)
+        return;
+
+    if (vl->backing != NULL)
+        destroy_bitmap(vl->backing);
+
+    if (vl->placeholder != NULL)
+        free(vl->placeholder);
+
+    pthread_mutex_destroy(&vl->lock);
+    free(vl);
+}
+
+/* Bytes of the backing bitmap, while the list runs */
+size_t gui_virtual_list_memory(void *a)
+{
+    struct vlist *vl = (struct vlist *)a;
+
+    return __atomic_load_n(&vl->backing_memory, __ATOMIC_RELAXED);
+}
+
+static void invalidate_blocks(struct vlist *vl)
+{
+    unsigned int i;
+
+    for (i = 0; i < VLIST_CACHE_BLOCKS; i++) {
+        vl->block[i].first = -1;
+        vl->block[i].state = BLOCK_UNUSED;
+    }
+
+    vl->rendered_top = -1;
+}
+
+/*
+ * The number of rows is only requested when the object starts or when the
+ * user asks for a refresh, never while drawing.
+ */
+static void update_total_rows(DIALOG *d, struct vlist *vl)
+{
+    char *(*getter)(int, int *) = d->dp;
+    int total = 0;
+
+    if (vl->has_source == true) {
+        if (vl->source.count != NULL)
+            total = (vl->source.count)(vl->source.arg);
+    } else if (getter != NULL)
+        getter(-1, &total);
+
+    vl->view.total = (total < 0) ? 0 : total;
+}
+
+static struct vlist_block *search_block(struct vlist *vl, int first)
+{
+    unsigned int i;
+
+    for (i = 0; i < VLIST_CACHE_BLOCKS; i++)
+        if ((vl->block[i].state != BLOCK_UNUSED) &&
+            (vl->block[i].first == first))
+        {
+            return &vl->block[i];
+        }
+
+    return NULL;
+}
+
+/* The least recently used block is replaced */
+static struct vlist_block *victim_block(struct vlist *vl)
+{
+    struct vlist_block *b = &vl->block[0];
+    unsigned int i;
+
+    for (i = 0; i < VLIST_CACHE_BLOCKS; i++) {
+        if (vl->block[i].state == BLOCK_UNUSED)
+            return &vl->block[i];
+
+        if (vl->block[i].last_use < b->last_use)
+            b = &vl->block[i];
+    }
+
+    return b;
+}
+
+/*
+ * Fills a block with rows from the data source. The lock is released while
+ * the user function runs, so it may deliver the rows through
+ * grc_list_set_rows immediately.
+ */
+static void fetch_block(DIALOG *d, struct vlist *vl, struct vlist_block *b)
+{
+    char *(*getter)(int, int *) = d->dp;
+    char *rows[VLIST_BLOCK_ROWS], *s;
+    int i, n, first = b->first;
+
+    n = vl->view.total - first;
+
+    if (n > VLIST_BLOCK_ROWS)
+        n = VLIST_BLOCK_ROWS;
+
+    if (vl->has_source == false) {
+        for (i = 0; i < n; i++) {
+            s = (getter != NULL) ? getter(first + i, NULL) : NULL;
+            snprintf(b->rows[i], VLIST_ROW_SIZE, "%s", (s != NULL) ? s : "");
+        }
+
+        b->state = BLOCK_READY;
+        return;
+    }
+
+    for (i = 0; i < n; i++) {
+        b->rows[i][0] = '\0';
+        rows[i] = b->rows[i];
+    }
+
+    pthread_mutex_unlock(&vl->lock);
+    n = (vl->source.fetch)(vl->source.arg, first, n, rows, VLIST_ROW_SIZE);
+    pthread_mutex_lock(&vl->lock);
+
+    /* Zero rows means that they will be delivered later */
+    if ((n > 0) && (b->first == first))
+        b->state = BLOCK_READY;
+}
+
+/*
+ * Gets the text of a row, or NULL if it is still being fetched. Must be
+ * called with the lock held.
+ */
+static const char *get_row(DIALOG *d, struct vlist *vl, int row)
+{
+    struct vlist_block *b;
+    int first;
+
+    first = row - (row % VLIST_BLOCK_ROWS);
+    b = search_block(vl, first);
+
+    if (NULL == b) {
+        b = victim_block(vl);
+        b->first = first;
+        b->state = BLOCK_PENDING;
+        fetch_block(d, vl, b);
+    }
+
+    b->last_use = ++vl->tick;
+
+    if (b->state != BLOCK_READY)
+        return NULL;
+
+    return b->rows[row - first];
+}
+
+/* Renders a single viewport slot into the backing bitmap */
+static void render_slot(DIALOG *d, struct vlist *vl, int slot)
+{
+    const char *text = NULL;
+    int row, y, fg, bg;
+
+    row = d->d2 + slot;
+    y = slot * vl->view.row_h;
+    fg = (d->flags & D_DISABLED) ? gui_mg_color : d->fg;
+    bg = d->bg;
+
+    if (row == d->d1) {
+        fg = d->bg;
+        bg = (d->flags & D_DISABLED) ? gui_mg_color : d->fg;
+    }
+
+    vl->placeholder[slot] = false;
+
+    if (row >= vl->view.total) {
+        rectfill(vl->backing, 0, y, vl->backing->w - 1,
+                 y + vl->view.row_h - 1, d->bg);
+
+        return;
+    }
+
+    rectfill(vl->backing, 0, y, vl->backing->w - 1, y + vl->view.row_h - 1,
+             bg);
+    text = get_row(d, vl, row);
+
+    if (NULL == text) {
+        vl->placeholder[slot] = true;
+        textout_ex(vl->backing, font, VLIST_PLACEHOLDER, 2, y + 1,
+                   gui_mg_color, -1);
+    } else
+        textout_ex(vl->backing, font, text, 2, y + 1, fg, -1);
+}
+
+/*
+ * Brings the backing bitmap to the current object state. When the list is
+ * scrolled the rows already rendered are moved inside the bitmap and only
+ * the exposed ones are rendered.
+ */
+static void update_backing(DIALOG *d, struct vlist *vl)
+{
+    int i, delta, keep, old_sel;
+
+    delta = d->d2 - vl->rendered_top;
+
+    if ((vl->rendered_top < 0) || (abs(delta) >= vl->view.visible)) {
+        for (i = 0; i < vl->view.visible; i++)
+            render_slot(d, vl, i);
+    } else if (delta != 0) {
+        keep = vl->view.visible - abs(delta);
+
+        if (delta > 0) {
+            blit(vl->backing, vl->backing, 0, delta * vl->view.row_h, 0, 0,
+                 vl->backing->w, keep * vl->view.row_h);
+
+            memmove(vl->placeholder, vl->placeholder + delta,
+                    keep * sizeof(bool));
+
+            for (i = keep; i < vl->view.visible; i++)
+                render_slot(d, vl, i);
+        } else {
+            blit(vl->backing, vl->backing, 0, 0, 0, -delta * vl->view.row_h,
+                 vl->backing->w, keep * vl->view.row_h);
+
+            memmove(vl->placeholder - delta, vl->placeholder,
+                    keep * sizeof(bool));
+
+            for (i = 0; i < -delta; i++)
+                render_slot(d, vl, i);
+        }
+    }
+
+    /* The selection may have moved without scrolling */
+    if ((vl->rendered_top >= 0) && (vl->rendered_sel != d->d1)) {
+        old_sel = vl->rendered_sel - d->d2;
+
+        if ((old_sel >= 0) && (old_sel < vl->view.visible))
+            render_slot(d, vl, old_sel);
+
+        if ((d->d1 - d->d2 >= 0) && (d->d1 - d->d2 < vl->view.visible))
+            render_slot(d, vl, d->d1 - d->d2);
+    }
+
+    vl->rendered_top = d->d2;
+    vl->rendered_sel = d->d1;
+}
+
+/* Copies the viewport to the screen */
+static void draw_list(DIALOG *d, struct vlist *vl, bool frame)
+{
+    BITMAP *gui_bmp = gui_get_screen();
+
+    pthread_mutex_lock(&vl->lock);
+    update_backing(d, vl);
+    pthread_mutex_unlock(&vl->lock);
+
+    if (frame == true) {
+        rect(gui_bmp, d->x, d->y, d->x + d->w - 1, d->y + d->h - 1, d->fg);
+        vline(gui_bmp, d->x + d->w - ROW_VIEW_SCROLLBAR_WIDTH - 1, d->y,
+              d->y + d->h - 1, d->fg);
+    }
+
+    blit(vl->backing, gui_bmp, 0, 0, d->x + 1, d->y + 1, vl->backing->w,
+         vl->backing->h);
+
+    row_view_draw_scrollbar(d, &vl->view);
+}
+
+/*
+ * Redraws only the rows whose content arrived after they were drawn as
+ * placeholders.
+ */
+static void draw_delivered_rows(DIALOG *d, struct vlist *vl)
+{
+    int i;
+
+    pthread_mutex_lock(&vl->lock);
+
+    if (vl->delivered == false) {
+        pthread_mutex_unlock(&vl->lock);
+        return;
+    }
+
+    vl->delivered = false;
+
+    for (i = 0; i < vl->view.visible; i++) {
+        if (vl->placeholder[i] == false)
+            continue;
+
+        render_slot(d, vl, i);
+
+        if (vl->placeholder[i] == false)
+            blit(vl->backing, gui_get_screen(), 0, i * vl->view.row_h,
+                 d->x + 1, d->y + 1 + i * vl->view.row_h, vl->backing->w,
+                 vl->view.row_h);
+    }
+
+    pthread_mutex_unlock(&vl->lock);
+}
+
+static int start_list(DIALOG *d, struct vlist *vl)
+{
+    int w;
+
+    vl->view.row_h = text_height(font) + 2;
+    vl->view.visible = (d->h - 2) / vl->view.row_h;
+    vl->view.rows_y = 1;
+    vl->view.rows_h = d->h - 2;
+    w = d->w - ROW_VIEW_SCROLLBAR_WIDTH - 2;
+
+    if ((vl->view.visible <= 0) || (w <= 0))
+        return -1;
+
+    vl->backing = create_bitmap(w, vl->view.visible * vl->view.row_h);
+    vl->placeholder = calloc(vl->view.visible, sizeof(bool));
+
+    if ((NULL == vl->backing) || (NULL == vl->placeholder))
+        return -1;
+
+    __atomic_store_n(&vl->backing_memory, bitmap_memory(vl->backing),
+                     __ATOMIC_RELAXED);
+
+    update_total_rows(d, vl);
+    row_view_follow_selection(d, &vl->view);
+    row_view_scroll_to(d, &vl->view, d->d2);
+
+    return 0;
+}
+
+static void stop_list(struct vlist *vl)
+{
+    if (vl->backing != NULL) {
+        destroy_bitmap(vl->backing);
+        vl->backing = NULL;
+        __atomic_store_n(&vl->backing_memory, 0, __ATOMIC_RELAXED);
+    }
+
+    if (vl->placeholder != NULL) {
+        free(vl->placeholder);
+        vl->placeholder = NULL;
+    }
+
+    invalidate_blocks(vl);
+}
+
+static int handle_char(DIALOG *d, struct vlist *vl, int c)
+{
+    if ((c >> 8) == KEY_ENTER)
+        return (d->flags & D_EXIT) ? D_CLOSE : D_USED_CHAR;
+
+    if (row_view_key(d, &vl->view, c) == false)
+        return D_O_K;
+
+    draw_list(d, vl, false);
+
+    return D_USED_CHAR;
+}
+
+static int handle_click(DIALOG *d, struct vlist *vl, int msg)
+{
+    enum row_view_click click;
+
+    click = row_view_click(d, &vl->view);
+
+    if (click == ROW_VIEW_CLICK_NONE)
+        return D_O_K;
+
+    draw_list(d, vl, false);
+
+    if ((click == ROW_VIEW_CLICK_ROW) && (msg == MSG_DCLICK) &&
+        (d->flags & D_EXIT))
+    {
+        return D_CLOSE;
+    }
+
+    return D_O_K;
+}
+
+static void refresh_list(DIALOG *d, struct vlist *vl)
+{
+    /* A pending request is served by this refresh too */
+    row_view_take_refresh(&vl->view);
+
+    pthread_mutex_lock(&vl->lock);
+    invalidate_blocks(vl);
+    update_total_rows(d, vl);
+    pthread_mutex_unlock(&vl->lock);
+    row_view_follow_selection(d, &vl->view);
+    row_view_scroll_to(d, &vl->view, d->d2);
+
+    if ((vl->backing != NULL) && !(d->flags & D_HIDDEN))
+        draw_list(d, vl, false);
+}
+
+static int virtual_list_proc(int msg, DIALOG *d, int c)
+{
+    struct vlist *vl = d->dp2;
+
+    if (NULL == vl)
+        return D_O_K;
+
+    switch (msg) {
+        case MSG_START:
+            if (start_list(d, vl) < 0)
+                stop_list(vl);
+
+            break;
+
+        case MSG_END:
+            stop_list(vl);
+            break;
+
+        case MSG_DRAW:
+            if (vl->backing != NULL)
+                draw_list(d, vl, true);
+
+            break;
+
+        case MSG_LIST_REFRESH:
+            refresh_list(d, vl);
+            break;
+
+        case MSG_IDLE:
+            if (row_view_take_refresh(&vl->view) == true)
+                refresh_list(d, vl);
+
+            if ((vl->backing != NULL) && !(d->flags & D_HIDDEN))
+                draw_delivered_rows(d, vl);
+
+            break;
+
+        case MSG_WANTFOCUS:
+            return D_WANTFOCUS;
+
+        case MSG_CHAR:
+            if (vl->backing != NULL)
+                return handle_char(d, vl, c);
+
+            break;
+
+        case MSG_CLICK:
+        case MSG_DCLICK:
+            if ((vl->backing != NULL) && (vl->view.total > 0))
+                return handle_click(d, vl, msg);
+
+            break;
+
+        case MSG_WHEEL:
+            if (vl->backing != NULL) {
+                row_view_wheel(d, &vl->view, c);
+                draw_list(d, vl, false);
+            }
+
+            break;
+    }
+
+    return D_O_K;
+}
+
+int gui_virtual_list_set_source(DIALOG *d,
+    const struct grc_list_source *source)
+{
+    struct vlist *vl = d->dp2;
+
+    if ((NULL == vl) || (NULL == source) || (NULL == source->fetch))
+        return -1;
+
+    pthread_mutex_lock(&vl->lock);
+    vl->source = *source;
+    vl->has_source = true;
+    invalidate_blocks(vl);
+    pthread_mutex_unlock(&vl->lock);
+
+    return 0;
+}
+
+/*
+ * Stores rows delivered asynchronously by the data source. Rows from blocks
+ * that were already discarded are ignored.
+ */
+int gui_virtual_list_set_rows(DIALOG *d, int first, int n, const char **rows)
+{
+    struct vlist *vl = d->dp2;
+    struct vlist_block *b = NULL;
+    int i, row;
+
+    if ((NULL == vl) || (NULL == rows) || (first < 0))
+        return -1;
+
+    pthread_mutex_lock(&vl->lock);
+
+    for (i = 0; i < n; i++) {
+        row = first + i;
+
+        if ((NULL == b) || (row - b->first >= VLIST_BLOCK_ROWS)) {
+            if ((b != NULL) && (b->state == BLOCK_PENDING))
+                b->state = BLOCK_READY;
+
+            b = search_block(vl, row - (row % VLIST_BLOCK_ROWS));
+        }
+
+        if (NULL == b) {
+            /* Skips to the next block */
+            i += VLIST_BLOCK_ROWS - (row % VLIST_BLOCK_ROWS) - 1;
+            continue;
+        }
+
+        snprintf(b->rows[row - b->first], VLIST_ROW_SIZE, "%s",
+                 (rows[i] != NULL) ? rows[i] : "");
+    }
+
+    if ((b != NULL) && (b->state == BLOCK_PENDING))
+        b->state = BLOCK_READY;
+
+    /* Let MSG_IDLE redraw the rows */
+    vl->delivered = true;
+    pthread_mutex_unlock(&vl->lock);
+
+    return 0;
+}
+
+/*
+ * Makes the object refresh itself the next time it's idle, for when it
+ * can't receive MSG_LIST_REFRESH because another thread is using Allegro.
+ */
+void gui_virtual_list_request_refresh(DIALOG *d)
+{
+    struct vlist *vl = d->dp2;
+
+    if (NULL == vl)
+        return;
+
+    row_view_request_refresh(&vl->view);
+}
+
+/*
+ * A 'list' object in virtual mode. Rows come from a 'struct grc_list_source'
+ * installed with grc_list_set_source or, if there is none, from the same
+ * function used by a regular 'list' object, passed in @d->dp.
+ */
+int gui_d_virtual_list_proc(int msg, DIALOG *d, int c)
+{
+    struct callback_data *acd = d->dp3;
+    int ret;
+
+    ret = virtual_list_proc(msg, d, c);
+
+    if (ret == D_CLOSE) {
+        if (d->dp3 != NULL) {
+            callback_set_int(acd, d->d1);
+            run_callback(acd, D_O_K);
+
+            /*
+             * We don't let the interface shutdown if the user forgets the
+             * correct return value.
+             */
+            ret = D_O_K;
+        } else
+            return D_REDRAWME;
+    }
+
+    return ret;
+}
@@ -25,6 +25,7 @@
  */
 
 #include "libgrc.h"
+#include "objects.h"
 
 /*
  * Layout (1):
@@ -113,7 +114,11 @@ struct keyboard_layout_s {
     struct screen_line  line[TOTAL_LINES];
 };
 
-static struct keyboard_layout_s __klayout[] = {
+/*
+ * Every object draws and clicks its keys through a copy of these layouts,
+ * kept in @dp2, since the key areas depend on the object geometry.
+ */
+static const struct keyboard_layout_s __klayout[] = {
     /* format 1 */
     {
         .format = 1,
@@ -352,10 +357,31 @@ static const char *translate_special_key(const char *btn_text)
     return spk->user_key;
 }
 
+void *gui_vt_keyboard_create(void)
+{
+    struct keyboard_layout_s *k = NULL;
+
+    k = malloc(sizeof(__klayout));
+
+    if (NULL == k)
+        return NULL;
+
+    memcpy(k, __klayout, sizeof(__klayout));
+
+    return k;
+}
+
+void gui_vt_keyboard_destroy(void *a)
+{
+    if (a != NULL)
+        free(a);
+}
+
 static void calc_buttons_area(DIALOG *d, int keyb_layout)
 {
     int i, j, x, y, w, btn_height;
-    struct keyboard_layout_s *k = &__klayout[keyb_layout];
+    struct keyboard_layout_s *k = (struct keyboard_layout_s *)d->dp2 +
+                                  keyb_layout;
     struct screen_key *sk;
     struct special_key *spk = NULL;
 
@@ -514,7 +540,8 @@ static void draw_special_key(struct screen_key *key, struct special_key *spk,
 static void draw_keyboard(DIALOG *d, int keyb_layout)
 {
     int i, btn_height, j, half_letter = text_height(font) / 2, fg, bg;
-    struct keyboard_layout_s *k = &__klayout[keyb_layout];
+    struct keyboard_layout_s *k = (struct keyboard_layout_s *)d->dp2 +
+                                  keyb_layout;
     struct screen_key *sk, *dotted_key = NULL;
     struct special_key *spk;
     char *btn_text;
@@ -580,10 +607,12 @@ static void draw_keyboard(DIALOG *d, int keyb_layout)
     }
 }
 
-static struct screen_key *find_clicked_button(int x, int y, int keyb_layout)
+static struct screen_key *find_clicked_button(DIALOG *d, int x, int y,
+    int keyb_layout)
 {
     struct screen_key *key = NULL, *sk;
-    struct keyboard_layout_s *k = &__klayout[keyb_layout];
+    struct keyboard_layout_s *k = (struct keyboard_layout_s *)d->dp2 +
+                                  keyb_layout;
     int i, j;
 
     for (i = 0; i < TOTAL_LINES; i++) {
@@ -603,35 +632,6 @@ static struct screen_key *find_clicked_button(int x, int y, int keyb_layout)
     return NULL;
 }
 
-static char *add_char(const char *s, unsigned int pos, char *c)
-{
-    size_t l;
-    cl_string_t *tmp = NULL;
-    char *p = NULL;
-
-    l = strlen(s);
-
-    /* Are we inserting into the end? */
-    if (pos == l) {
-        tmp = cl_string_create("%s", s);
-        cl_string_cat(tmp, "%s", c);
-        p = strdup(cl_string_valueof(tmp));
-        cl_string_unref(tmp);
-
-        return p;
-    }
-
-    p = strdup(s);
-    p[pos] = '\0';
-
-    tmp = cl_string_create("%s%s%s", p, c, s + pos);
-    free(p);
-    p = strdup(cl_string_valueof(tmp));
-    cl_string_unref(tmp);
-
-    return p;
-}
-
 static void run_edit_callback(DIALOG *edit)
 {
     struct callback_data *acd = edit->dp3;
@@ -639,7 +639,7 @@ static void run_edit_callback(DIALOG *edit)
     if (NULL == acd)
         return;
 
-    callback_set_string(acd, (char *)edit->dp);
+    callback_set_string(acd, (char *)gui_edit_get_text(edit));
     run_callback(acd, D_O_K);
 }
 
@@ -647,9 +647,8 @@ static int update_last_edit_object_value(DIALOG *d, struct grc_s *grc,
     struct screen_key *key)
 {
     struct special_key *spk = NULL;
-    char *tmp = NULL, *ed_value;
+    const char *p;
     DIALOG *edit;
-    unsigned int ed_pos = 0;
 
     if (NULL == grc->last_edit_object)
         return D_O_K;
@@ -688,65 +687,37 @@ static int update_last_edit_object_value(DIALOG *d, struct grc_s *grc,
         }
     }
 
-    ed_value = edit->dp;
-
-    /* Do nothing since we reached the object string limit */
-    if (strlen(ed_value) >= (size_t)edit->d1)
-        return D_O_K;
-
+    /*
+     * The edit object handles the keys the same way it handles the real
+     * keyboard ones, including its length limit.
+     */
     if (spk != NULL) {
-        tmp = strdup(ed_value);
-
         switch (spk->value) {
             case SPK_BACKSPACE:
-                /* Do nothing since we're at the begining of the string */
-                if (edit->d2 == 0)
-                    return D_O_K;
-
-                /* FIXME: We need to rewrite this... */
-                {
-                    cl_string_t *__p = cl_string_create("%s", tmp);
-                    cl_string_idchr(__p, edit->d2 - 1);
-                    free(tmp);
-                    tmp = strdup(cl_string_valueof(__p));
-                }
-
-                ed_pos = edit->d2 - 1;
+                object_message(edit, MSG_CHAR, KEY_BACKSPACE << 8);
                 break;
 
             case SPK_SPACEBAR:
-                tmp = add_char(ed_value, edit->d2, " ");
-                ed_pos = edit->d2 + 1;
+                object_message(edit, MSG_UCHAR, ' ');
                 break;
 
             default:
                 break;
         }
     } else {
-        tmp = add_char(ed_value, edit->d2,
-                       key->key[d->d2 & DLG_SPK_SHIFT].key);
+        p = key->key[d->d2 & DLG_SPK_SHIFT].key;
 
-        ed_pos = edit->d2 + 1;
+        while (*p != '\0')
+            object_message(edit, MSG_UCHAR, ugetxc(&p));
     }
 
-    strcpy(ed_value, tmp);
-    free(tmp);
-
-    /*
-     * Updates the cursor so we can make the scroll looks correctly onto
-     * the edited line.
-     */
-    object_message(edit, MSG_UPDATE_CURSOR_POSITION, ed_pos);
-
-    /* Updates the obejct content to the user */
-    object_message(edit, MSG_DRAW, 0);
-
     return D_O_K;
 }
 
 /*
  * d1 - Keyboard layout
  * d2 - Internal flags (shift key, ...)
+ * dp2 - Its own copy of the keyboard layouts
  * dp3 - Standard callback
  */
 int gui_d_vt_keyboard_proc(int msg, DIALOG *d, int c __attribute__((unused)))
@@ -779,7 +750,7 @@ int gui_d_vt_keyboard_proc(int msg, DIALOG *d, int c __attribute__((unused)))
         case MSG_CLICK:
             mx = gui_mouse_x();
             my = gui_mouse_y();
-            key = find_clicked_button(mx, my, klayout);
+            key = find_clicked_button(d, mx, my, klayout);
 
             while (gui_mouse_b()) {
                 /* Needs to redraw the clicked button */
@@ -28,6 +28,7 @@
 #define _LIBALEX_OBJECTS_H              1
 
 /* gui_bitmap.c */
+void gui_bitmap_destroy(void *a);
 int gui_d_bitmap_proc(int msg, DIALOG *d, int c);
 
 /* gui_button.c */
@@ -41,6 +42,11 @@ char *gui_clock_proc_str(void);
 int gui_clock_proc(int msg, DIALOG *d, int c);
 
 /* gui_edit.c */
+void *gui_edit_create(unsigned int limit, bool password, bool multiline);
+void gui_edit_destroy(void *a);
+size_t gui_edit_memory(void *a);
+const char *gui_edit_get_text(DIALOG *d);
+int gui_edit_set_text(DIALOG *d, const char *text, unsigned int n);
 int gui_d_edit_proc(int msg, DIALOG *d, int c);
 int gui_d_password_proc(int msg, DIALOG *d, int c);
 
@@ -54,20 +60,86 @@ int gui_d_keyboard_proc(int msg, DIALOG *d, int c);
 int gui_d_list_proc(int msg, DIALOG *d, int c);
 
 /* gui_messages_log_box.c */
+void *gui_messages_create(void);
+void gui_messages_destroy(void *a);
+size_t gui_messages_memory(void *a);
 int gui_messages_log_proc(int msg, DIALOG *d, int c);
-void gui_messages_set(enum grc_line_break lbreak, int fg_color,
-                      const char *msg, const char *color);
+unsigned int gui_messages_set(DIALOG *d, const char *msg, const char *color,
+                              unsigned int *dropped);
+void gui_messages_foreach(DIALOG *d,
+                          void (*fn)(const char *, int, void *), void *arg);
+
+int gui_messages_restore(DIALOG *d, const char *msg, unsigned int n,
+                         int fg_color);
 
 /* gui_radio.c */
 int gui_d_radio_proc(int msg, DIALOG *d, int c);
 
+/* gui_row_view.c */
+#define ROW_VIEW_SCROLLBAR_WIDTH        12
+
+enum row_view_click {
+    ROW_VIEW_CLICK_NONE,
+    ROW_VIEW_CLICK_SCROLL,
+    ROW_VIEW_CLICK_ROW
+};
+
+/*
+ * Rows of an object: @d1 of its DIALOG is the selected row and @d2 the first
+ * visible one. The rows area starts @rows_y pixels below the object.
+ */
+struct row_view {
+    int     total;          /** Cached number of rows */
+    int     visible;        /** Rows inside the viewport */
+    int     row_h;
+    int     rows_y;
+    int     rows_h;
+    bool    refresh;        /** Requested by another thread */
+};
+
+void row_view_draw_scrollbar(DIALOG *d, const struct row_view *v);
+void row_view_follow_selection(DIALOG *d, const struct row_view *v);
+void row_view_scroll_to(DIALOG *d, const struct row_view *v, int top);
+void row_view_wheel(DIALOG *d, const struct row_view *v, int c);
+bool row_view_key(DIALOG *d, const struct row_view *v, int c);
+enum row_view_click row_view_click(DIALOG *d, const struct row_view *v);
+void row_view_request_refresh(struct row_view *v);
+bool row_view_take_refresh(struct row_view *v);
+
 /* gui_slider.c */
 int gui_d_slider_proc(int msg, DIALOG *d, int c);
 
+/* gui_table.c */
+void *gui_table_create(const char *columns);
+void gui_table_destroy(void *a);
+size_t gui_table_memory(void *a);
+int gui_table_set_source(DIALOG *d, const struct grc_table_source *source);
+int gui_table_update_cell(DIALOG *d, int row, int column);
+void gui_table_request_refresh(DIALOG *d);
+int gui_d_table_proc(int msg, DIALOG *d, int c);
+
 /* gui_textbox.c */
+void *gui_textbox_create(void);
+void gui_textbox_destroy(void *a);
+int gui_textbox_append(DIALOG *d, const char *text);
+int gui_textbox_queue(DIALOG *d, const char *text);
+int gui_textbox_set_text(DIALOG *d, const char *text, size_t n);
 int gui_d_textbox_proc(int msg, DIALOG *d, int c);
 
+/* gui_virtual_list.c */
+void *gui_virtual_list_create(void);
+void gui_virtual_list_destroy(void *a);
+size_t gui_virtual_list_memory(void *a);
+int gui_virtual_list_set_source(DIALOG *d,
+                                const struct grc_list_source *source);
+
+int gui_virtual_list_set_rows(DIALOG *d, int first, int n, const char **rows);
+void gui_virtual_list_request_refresh(DIALOG *d);
+int gui_d_virtual_list_proc(int msg, DIALOG *d, int c);
+
 /* gui_vt_keyboard.c */
+void *gui_vt_keyboard_create(void);
+void gui_vt_keyboard_destroy(void *a);
 int gui_d_vt_keyboard_proc(int msg, DIALOG *d, int c);
 
 #endif
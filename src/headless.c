@@ -0,0 +1,295 @@
+/*
+ * Description: Functions to draw DIALOGs into a memory bitmap, without a
+ *              display, receiving their input from the application.
+ *
+ * Author: Rodrigo Freitas
+ * Created at: Mon Oct 19 20:48:33 2026
+ * Project: libgrc
+ *
+ * Copyright (c) 2014 Rodrigo Freitas
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301
+ * USA
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+
+#include "libgrc.h"
+
+/* The size of the Allegro keyboard buffer */
+#define HEADLESS_MAX_KEYS           64
+
+/*
+ * With the memory backend Allegro runs without a system driver, so there is
+ * no screen. Every DIALOG draws into its own framebuffer, through
+ * gui_set_screen, and sees only the mouse and keys given to it by
+ * grc_inject_mouse and grc_inject_key.
+ */
+struct headless {
+    bool        installed;
+
+    /* Allegro GUI mouse functions, replaced while installed */
+    int         (*mouse_x)(void);
+    int         (*mouse_y)(void);
+    int         (*mouse_z)(void);
+    int         (*mouse_b)(void);
+};
+
+static struct headless __headless = {
+    .installed = false,
+};
+
+/*
+ * Input injected into a DIALOG, from any thread. The thread running the
+ * DIALOG takes it at the beginning of every frame, so the DIALOG sees the
+ * same mouse during a whole frame.
+ */
+struct headless_input {
+    pthread_mutex_t         lock;
+    struct headless_mouse   mouse;
+    int                     keys[HEADLESS_MAX_KEYS];
+    int                     scancodes[HEADLESS_MAX_KEYS];
+    unsigned int            n_keys;
+};
+
+/* The DIALOG being drawn by the thread, while it holds the GUI lock */
+static __thread struct grc_s *__current = NULL;
+
+static int headless_mouse_x(void)
+{
+    return (__current != NULL) ? __current->mouse.x : 0;
+}
+
+static int headless_mouse_y(void)
+{
+    return (__current != NULL) ? __current->mouse.y : 0;
+}
+
+static int headless_mouse_z(void)
+{
+    return (__current != NULL) ? __current->mouse.z : 0;
+}
+
+static int headless_mouse_b(void)
+{
+    return (__current != NULL) ? __current->mouse.b : 0;
+}
+
+void headless_install(void)
+{
+    __headless.mouse_x = gui_mouse_x;
+    __headless.mouse_y = gui_mouse_y;
+    __headless.mouse_z = gui_mouse_z;
+    __headless.mouse_b = gui_mouse_b;
+    gui_mouse_x = headless_mouse_x;
+    gui_mouse_y = headless_mouse_y;
+    gui_mouse_z = headless_mouse_z;
+    gui_mouse_b = headless_mouse_b;
+    __headless.installed = true;
+}
+
+void headless_uninstall(void)
+{
+    if (__headless.installed == false)
+        return;
+
+    gui_set_screen(NULL);
+    gui_mouse_x = __headless.mouse_x;
+    gui_mouse_y = __headless.mouse_y;
+    gui_mouse_z = __headless.mouse_z;
+    gui_mouse_b = __headless.mouse_b;
+    __headless.installed = false;
+}
+
+/* The memory backend version of set_gfx_mode, for a single DIALOG */
+int headless_create_framebuffer(struct grc_s *grc)
+{
+    BITMAP *bmp;
+
+    bmp = create_bitmap_ex(info_color_depth(grc),
+                           info_get_value(grc->info, INFO_WIDTH),
+                           info_get_value(grc->info, INFO_HEIGHT));
+
+    if (NULL == bmp) {
+        grc_set_errno(GRC_ERROR_SET_GFX_MODE);
+        return -1;
+    }
+
+    grc->input = calloc(1, sizeof(struct headless_input));
+
+    if (NULL == grc->input) {
+        destroy_bitmap(bmp);
+        grc_set_errno(GRC_ERROR_MEMORY);
+        return -1;
+    }
+
+    pthread_mutex_init(&grc->input->lock, NULL);
+    clear_bitmap(bmp);
+    grc->framebuffer = bmp;
+
+    return 0;
+}
+
+void headless_destroy_framebuffer(struct grc_s *grc)
+{
+    if (NULL == grc->framebuffer)
+        return;
+
+    session_gui_lock();
+
+    if (gui_get_screen() == grc->framebuffer)
+        gui_set_screen(NULL);
+
+    if (__current == grc)
+        __current = NULL;
+
+    destroy_bitmap(grc->framebuffer);
+    grc->framebuffer = NULL;
+    session_gui_unlock();
+
+    pthread_mutex_destroy(&grc->input->lock);
+    free(grc->input);
+    grc->input = NULL;
+}
+
+/*
+ * Makes Allegro draw into the framebuffer of @grc, with its color depth and
+ * mouse. Must be called with the GUI lock held, before anything is drawn.
+ */
+void headless_select(struct grc_s *grc)
+{
+    if (NULL == grc->framebuffer)
+        return;
+
+    __current = grc;
+    set_color_depth(bitmap_color_depth(grc->framebuffer));
+    gui_set_screen(grc->framebuffer);
+}
+
+/*
+ * Gives the input injected since the last frame to the DIALOG. Must be
+ * called by the thread running it, with the GUI lock held.
+ */
+void headless_frame_input(struct grc_s *grc)
+{
+    struct headless_input *in = grc->input;
+    int keys[HEADLESS_MAX_KEYS], scancodes[HEADLESS_MAX_KEYS];
+    unsigned int i, n;
+
+    if (NULL == in)
+        return;
+
+    pthread_mutex_lock(&in->lock);
+    grc->mouse = in->mouse;
+    n = in->n_keys;
+    memcpy(keys, in->keys, n * sizeof(int));
+    memcpy(scancodes, in->scancodes, n * sizeof(int));
+    in->n_keys = 0;
+    pthread_mutex_unlock(&in->lock);
+
+    for (i = 0; i < n; i++)
+        simulate_ukeypress(keys[i], scancodes[i]);
+}
+
+/*
+ *
+ * API
+ *
+ */
+
+int LIBEXPORT grc_inject_key(grc_t *grc, int key, int scancode)
+{
+    struct grc_s *g = (struct grc_s *)grc;
+    struct headless_input *in;
+    int ret = 0;
+
+    grc_errno_clear();
+
+    if (NULL == grc) {
+        grc_set_errno(GRC_ERROR_NULL_ARG);
+        return -1;
+    }
+
+    /* A display has a single keyboard, shared by every DIALOG */
+    if (NULL == g->input) {
+        simulate_ukeypress(key, scancode);
+        return 0;
+    }
+
+    /* It reaches the DIALOG at its next frame, as if it had been typed */
+    in = g->input;
+    pthread_mutex_lock(&in->lock);
+
+    if (in->n_keys == HEADLESS_MAX_KEYS) {
+        grc_set_errno(GRC_ERROR_INPUT_QUEUE_FULL);
+        ret = -1;
+    } else {
+        in->keys[in->n_keys] = key;
+        in->scancodes[in->n_keys] = scancode;
+        in->n_keys++;
+    }
+
+    pthread_mutex_unlock(&in->lock);
+
+    return ret;
+}
+
+int LIBEXPORT grc_inject_mouse(grc_t *grc, int x, int y, int z, int buttons)
+{
+    struct grc_s *g = (struct grc_s *)grc;
+
+    grc_errno_clear();
+
+    if (NULL == grc) {
+        grc_set_errno(GRC_ERROR_NULL_ARG);
+        return -1;
+    }
+
+    /* A display has a real mouse */
+    if (NULL == g->input) {
+        grc_set_errno(GRC_ERROR_UNSUPPORTED_BY_BACKEND);
+        return -1;
+    }
+
+    /* Seen by the DIALOG at its next frame */
+    pthread_mutex_lock(&g->input->lock);
+    latency_inject_mouse(g->input->mouse.b, buttons);
+    g->input->mouse.x = x;
+    g->input->mouse.y = y;
+    g->input->mouse.z = z;
+    g->input->mouse.b = buttons;
+    pthread_mutex_unlock(&g->input->lock);
+
+    return 0;
+}
+
+BITMAP LIBEXPORT *grc_get_framebuffer(grc_t *grc)
+{
+    struct grc_s *g = (struct grc_s *)grc;
+
+    grc_errno_clear();
+
+    if (NULL == grc) {
+        grc_set_errno(GRC_ERROR_NULL_ARG);
+        return NULL;
+    }
+
+    if (g->framebuffer != NULL)
+        return g->framebuffer;
+
+    return gui_get_screen();
+}
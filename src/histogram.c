@@ -0,0 +1,88 @@
+/*
+ * Description: Histograms of durations, with a bucket for each 1/8 of a
+ *              power of two of microseconds.
+ *
+ * Author: Rodrigo Freitas
+ * Created at: Tue Oct 20 00:26:14 2026
+ * Project: libgrc
+ *
+ * Copyright (c) 2014 Rodrigo Freitas
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301
+ * USA
+ */
+
+#include "libgrc.h"
+
+/* Sub buckets of each power of two, as bits */
+#define SUB_BUCKET_BITS             3
+#define SUB_BUCKETS                 (1 << SUB_BUCKET_BITS)
+
+/*
+ * Values below 8 have a bucket each. From there each power of two is split
+ * in 8, so any value is known within 12.5%.
+ */
+unsigned int histogram_bucket(unsigned long long usec)
+{
+    unsigned int e;
+
+    if (usec < SUB_BUCKETS)
+        return usec;
+
+    e = 63 - __builtin_clzll(usec);
+
+    if (e >= GRC_HISTOGRAM_BUCKETS / SUB_BUCKETS + SUB_BUCKET_BITS - 1)
+        return GRC_HISTOGRAM_BUCKETS - 1;
+
+    return (e - SUB_BUCKET_BITS + 1) * SUB_BUCKETS +
+           ((usec >> (e - SUB_BUCKET_BITS)) & (SUB_BUCKETS - 1));
+}
+
+/*
+ * Returns the highest value of the bucket holding @percentile of the @count
+ * values of @histogram, but never above the highest one seen, @max.
+ */
+unsigned long long histogram_percentile(const unsigned long long *histogram,
+    unsigned long long count, unsigned long long max, double percentile)
+{
+    unsigned long long wanted, seen = 0;
+    unsigned int i, e;
+
+    if (count == 0)
+        return 0;
+
+    percentile = MIN(MAX(percentile, 0.0), 100.0);
+    wanted = (unsigned long long)(count * percentile / 100.0 + 0.5);
+    wanted = MAX(wanted, 1ULL);
+
+    for (i = 0; i < GRC_HISTOGRAM_BUCKETS; i++) {
+        seen += histogram[i];
+
+        if (seen >= wanted)
+            break;
+    }
+
+    if (i < SUB_BUCKETS)
+        return i;
+
+    if (i >= GRC_HISTOGRAM_BUCKETS - 1)
+        return max;
+
+    e = i / SUB_BUCKETS + SUB_BUCKET_BITS - 1;
+
+    return MIN(((unsigned long long)(SUB_BUCKETS + i % SUB_BUCKETS + 1)
+                    << (e - SUB_BUCKET_BITS)) - 1,
+               max);
+}
@@ -24,6 +24,8 @@
  * USA
  */
 
+#include <stdio.h>
+
 #include "libgrc.h"
 
 struct gfx_info_s {
@@ -50,6 +52,12 @@ struct gfx_info_s {
     int                     color_depth;
     bool                    block_keys;
     bool                    use_mouse;
+
+    /* Resolution the GRC was written for, 0 if it is not scaled */
+    int                     design_width;
+    int                     design_height;
+
+    enum grc_backend        backend;
 };
 
 struct gfx_info_s *info_start(void)
@@ -126,6 +134,18 @@ int info_set_value(struct gfx_info_s *info, enum gfx_info field, ...)
             info->use_mouse = value;
             break;
 
+        case INFO_DESIGN_WIDTH:
+            info->design_width = value;
+            break;
+
+        case INFO_DESIGN_HEIGHT:
+            info->design_height = value;
+            break;
+
+        case INFO_BACKEND:
+            info->backend = value;
+            break;
+
         default:
             return -1;
     }
@@ -171,12 +191,74 @@ int info_get_value(struct gfx_info_s *info, enum gfx_info field)
 
         case INFO_USE_MOUSE:
             return info->use_mouse;
+
+        case INFO_DESIGN_WIDTH:
+            return info->design_width;
+
+        case INFO_DESIGN_HEIGHT:
+            return info->design_height;
+
+        case INFO_BACKEND:
+            return info->backend;
     }
 
     /* default */
     return -1;
 }
 
+/*
+ * A GRC written for another resolution, as "<width>x<height>", has all its
+ * objects scaled to the real one while they are loaded.
+ */
+static int parse_design_resolution(struct grc_s *grc, cl_json_t *jinfo,
+    const char *key)
+{
+    cl_string_t *tmp;
+    int w = 0, h = 0, ret = 0;
+
+    tmp = grc_get_object_str(jinfo, key);
+
+    if (NULL == tmp)
+        return 0;
+
+    if ((sscanf(cl_string_valueof(tmp), "%dx%d", &w, &h) != 2) ||
+        (w <= 0) || (h <= 0))
+    {
+        grc_set_errno(GRC_ERROR_INVALID_DESIGN_RESOLUTION);
+        ret = -1;
+    } else {
+        info_set_value(grc->info, INFO_DESIGN_WIDTH, w, NULL);
+        info_set_value(grc->info, INFO_DESIGN_HEIGHT, h, NULL);
+    }
+
+    cl_string_unref(tmp);
+
+    return ret;
+}
+
+/* A DIALOG is drawn on the display unless it asks for the memory backend */
+static int parse_backend(struct grc_s *grc, cl_json_t *jinfo,
+    const char *key)
+{
+    cl_string_t *tmp;
+    int backend;
+
+    tmp = grc_get_object_str(jinfo, key);
+    backend = tr_backend((tmp != NULL) ? cl_string_valueof(tmp) : NULL);
+
+    if (tmp != NULL)
+        cl_string_unref(tmp);
+
+    if (backend < 0) {
+        grc_set_errno(GRC_ERROR_UNKNOWN_BACKEND);
+        return -1;
+    }
+
+    info_set_value(grc->info, INFO_BACKEND, backend, NULL);
+
+    return 0;
+}
+
 /*
  * Parse main DIALOG informations, such as screen resolution, color depth,
  * etc.
@@ -253,6 +335,24 @@ int info_parse(struct grc_s *grc)
                    grc_get_object_value(jinfo, property_detail_string(dt),
                                         false), NULL);
 
+    /* design_resolution */
+    dt = get_property_detail(GRC_PROPERTY_DESIGN_RESOLUTION);
+
+    if (NULL == dt)
+        goto unknown_grc_key_block;
+
+    if (parse_design_resolution(grc, jinfo, property_detail_string(dt)) < 0)
+        return -1;
+
+    /* backend */
+    dt = get_property_detail(GRC_PROPERTY_BACKEND);
+
+    if (NULL == dt)
+        goto unknown_grc_key_block;
+
+    if (parse_backend(grc, jinfo, property_detail_string(dt)) < 0)
+        return -1;
+
     return 0;
 
 unknown_grc_key_block:
@@ -0,0 +1,404 @@
+/*
+ * Description: Measures how long the input takes, from when Allegro gets
+ *              it until the end of the frame which handled it.
+ *
+ * Author: Rodrigo Freitas
+ * Created at: Tue Oct 20 00:41:52 2026
+ * Project: libgrc
+ *
+ * Copyright (c) 2014 Rodrigo Freitas
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301
+ * USA
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include <pthread.h>
+
+#include "libgrc.h"
+
+/* Keys waiting in the Allegro buffer which have their time kept */
+#define MAX_PENDING_KEYS            64
+
+#define MOUSE_FLAG_DOWN             \
+    (MOUSE_FLAG_LEFT_DOWN | MOUSE_FLAG_RIGHT_DOWN | MOUSE_FLAG_MIDDLE_DOWN)
+
+#define MOUSE_FLAG_UP               \
+    (MOUSE_FLAG_LEFT_UP | MOUSE_FLAG_RIGHT_UP | MOUSE_FLAG_MIDDLE_UP)
+
+struct latency {
+    pthread_mutex_t     lock;
+    unsigned long long  events[GRC_INPUT_EVENTS];
+    unsigned long long  histogram[GRC_INPUT_EVENTS][GRC_HISTOGRAM_BUCKETS];
+    unsigned long long  max_latency[GRC_INPUT_EVENTS];
+
+    /* Mouse buttons seen by the last frame */
+    int                 buttons;
+
+    /* When the input handled by the frame being run arrived */
+    unsigned long long  arrived[GRC_INPUT_EVENTS];
+};
+
+/*
+ * Input is shared by every DIALOG, so its arrival is kept here, until the
+ * DIALOG which reads it. Keys are read in the order they arrived, while the
+ * mouse only has its last press and release.
+ */
+static struct {
+    pthread_mutex_t     lock;
+    unsigned int        measuring;
+    unsigned long long  keys[MAX_PENDING_KEYS];
+    unsigned int        first;
+    unsigned int        n_keys;
+    unsigned long long  press;
+    unsigned long long  release;
+
+    /* Allegro callbacks replaced */
+    int                 (*ucallback)(int, int *);
+    void                (*mouse_callback)(int);
+} __input = {
+    .lock = PTHREAD_MUTEX_INITIALIZER,
+};
+
+static void key_arrived(void)
+{
+    pthread_mutex_lock(&__input.lock);
+
+    if ((__input.measuring > 0) && (__input.n_keys < MAX_PENDING_KEYS)) {
+        __input.keys[(__input.first + __input.n_keys) % MAX_PENDING_KEYS] =
+            usec_now(CLOCK_MONOTONIC);
+
+        __input.n_keys++;
+    }
+
+    pthread_mutex_unlock(&__input.lock);
+}
+
+static unsigned long long key_read(void)
+{
+    unsigned long long t = 0;
+
+    if (__input.n_keys > 0) {
+        t = __input.keys[__input.first];
+        __input.first = (__input.first + 1) % MAX_PENDING_KEYS;
+        __input.n_keys--;
+    }
+
+    return t;
+}
+
+static int latency_keyboard_callback(int key, int *scancode)
+{
+    key_arrived();
+
+    if (__input.ucallback != NULL)
+        return (__input.ucallback)(key, scancode);
+
+    return key;
+}
+
+static void mouse_arrived(int flags)
+{
+    unsigned long long now = usec_now(CLOCK_MONOTONIC);
+
+    pthread_mutex_lock(&__input.lock);
+
+    if (flags & MOUSE_FLAG_DOWN)
+        __input.press = now;
+
+    if (flags & MOUSE_FLAG_UP)
+        __input.release = now;
+
+    pthread_mutex_unlock(&__input.lock);
+}
+
+static void latency_mouse_callback(int flags)
+{
+    if (flags & (MOUSE_FLAG_DOWN | MOUSE_FLAG_UP))
+        mouse_arrived(flags);
+
+    if (__input.mouse_callback != NULL)
+        (__input.mouse_callback)(flags);
+}
+
+static void record_latency(struct latency *l, enum grc_input_event event,
+    unsigned long long now)
+{
+    unsigned long long usec;
+
+    if (l->arrived[event] == 0)
+        return;
+
+    usec = (now > l->arrived[event]) ? now - l->arrived[event] : 0;
+    l->histogram[event][histogram_bucket(usec)]++;
+    l->max_latency[event] = MAX(l->max_latency[event], usec);
+    l->events[event]++;
+    l->arrived[event] = 0;
+}
+
+/* Called when Allegro is installed, before any key is read */
+void latency_install(void)
+{
+    __input.ucallback = keyboard_ucallback;
+    keyboard_ucallback = latency_keyboard_callback;
+}
+
+void latency_install_mouse(void)
+{
+    __input.mouse_callback = mouse_callback;
+    mouse_callback = latency_mouse_callback;
+}
+
+void latency_uninstall(void)
+{
+    if (keyboard_ucallback == latency_keyboard_callback)
+        keyboard_ucallback = __input.ucallback;
+
+    if (mouse_callback == latency_mouse_callback)
+        mouse_callback = __input.mouse_callback;
+
+    __input.ucallback = NULL;
+    __input.mouse_callback = NULL;
+}
+
+/*
+ * A mouse injected into a DIALOG of the memory backend arrives when it
+ * changes its buttons.
+ */
+void latency_inject_mouse(int old_buttons, int buttons)
+{
+    int changed = old_buttons ^ buttons;
+
+    if (changed & buttons)
+        mouse_arrived(MOUSE_FLAG_LEFT_DOWN);
+
+    if (changed & old_buttons)
+        mouse_arrived(MOUSE_FLAG_LEFT_UP);
+}
+
+int latency_attach(struct grc_s *grc)
+{
+    struct latency *l;
+
+    if (grc->latency != NULL)
+        return 0;
+
+    l = calloc(1, sizeof(struct latency));
+
+    if (NULL == l) {
+        grc_set_errno(GRC_ERROR_MEMORY);
+        return -1;
+    }
+
+    pthread_mutex_init(&l->lock, NULL);
+    grc->latency = l;
+
+    pthread_mutex_lock(&__input.lock);
+    __input.measuring++;
+    pthread_mutex_unlock(&__input.lock);
+
+    return 0;
+}
+
+void latency_detach(struct grc_s *grc)
+{
+    pthread_mutex_lock(&__input.lock);
+    __input.measuring--;
+
+    if (__input.measuring == 0)
+        __input.n_keys = 0;
+
+    pthread_mutex_unlock(&__input.lock);
+
+    pthread_mutex_destroy(&grc->latency->lock);
+    free(grc->latency);
+    grc->latency = NULL;
+}
+
+/*
+ * Finds the input the next update of the DIALOG will read. It reads one
+ * key, if there is any, and the mouse buttons as they are.
+ */
+void latency_frame_begin(struct grc_s *grc)
+{
+    struct latency *l = grc->latency;
+    int buttons, changed;
+    bool key;
+
+    if (NULL == l)
+        return;
+
+    buttons = gui_mouse_b();
+    changed = buttons ^ l->buttons;
+    l->buttons = buttons;
+
+    /* Polling the keyboard may call the key callback */
+    key = keypressed();
+    pthread_mutex_lock(&__input.lock);
+
+    /* Keys read without being measured leave their times behind */
+    if (key == true)
+        l->arrived[GRC_INPUT_KEY] = key_read();
+    else
+        __input.n_keys = 0;
+
+    if (changed & buttons) {
+        l->arrived[GRC_INPUT_BUTTON_PRESS] = __input.press;
+        __input.press = 0;
+    }
+
+    if (changed & ~buttons) {
+        l->arrived[GRC_INPUT_BUTTON_RELEASE] = __input.release;
+        __input.release = 0;
+    }
+
+    pthread_mutex_unlock(&__input.lock);
+}
+
+/*
+ * Everything the frame did is already on the screen, or given to a remote
+ * viewer.
+ */
+void latency_frame_end(struct grc_s *grc)
+{
+    struct latency *l = grc->latency;
+    unsigned long long now;
+    unsigned int i;
+
+    if (NULL == l)
+        return;
+
+    now = usec_now(CLOCK_MONOTONIC);
+    pthread_mutex_lock(&l->lock);
+
+    for (i = 0; i < GRC_INPUT_EVENTS; i++)
+        record_latency(l, i, now);
+
+    pthread_mutex_unlock(&l->lock);
+}
+
+void latency_snapshot(struct grc_s *grc, struct grc_latency *latency)
+{
+    struct latency *l = grc->latency;
+
+    if (NULL == l) {
+        memset(latency, 0, sizeof(struct grc_latency));
+        return;
+    }
+
+    pthread_mutex_lock(&l->lock);
+    memcpy(latency->events, l->events, sizeof(l->events));
+    memcpy(latency->histogram, l->histogram, sizeof(l->histogram));
+    memcpy(latency->max_latency, l->max_latency, sizeof(l->max_latency));
+    pthread_mutex_unlock(&l->lock);
+}
+
+void latency_reset(struct grc_s *grc)
+{
+    struct latency *l = grc->latency;
+
+    if (NULL == l)
+        return;
+
+    pthread_mutex_lock(&l->lock);
+    memset(l->events, 0, sizeof(l->events));
+    memset(l->histogram, 0, sizeof(l->histogram));
+    memset(l->max_latency, 0, sizeof(l->max_latency));
+    pthread_mutex_unlock(&l->lock);
+}
+
+/*
+ *
+ * API
+ *
+ */
+
+int LIBEXPORT grc_latency_start(grc_t *grc)
+{
+    grc_errno_clear();
+
+    if (NULL == grc) {
+        grc_set_errno(GRC_ERROR_NULL_ARG);
+        return -1;
+    }
+
+    return latency_attach((struct grc_s *)grc);
+}
+
+int LIBEXPORT grc_latency_snapshot(grc_t *grc, struct grc_latency *latency)
+{
+    struct grc_s *g = (struct grc_s *)grc;
+
+    grc_errno_clear();
+
+    if ((NULL == grc) || (NULL == latency)) {
+        grc_set_errno(GRC_ERROR_NULL_ARG);
+        return -1;
+    }
+
+    if (NULL == g->latency) {
+        grc_set_errno(GRC_ERROR_LATENCY_NOT_STARTED);
+        return -1;
+    }
+
+    latency_snapshot(g, latency);
+
+    return 0;
+}
+
+int LIBEXPORT grc_latency_reset(grc_t *grc)
+{
+    struct grc_s *g = (struct grc_s *)grc;
+
+    grc_errno_clear();
+
+    if (NULL == grc) {
+        grc_set_errno(GRC_ERROR_NULL_ARG);
+        return -1;
+    }
+
+    if (NULL == g->latency) {
+        grc_set_errno(GRC_ERROR_LATENCY_NOT_STARTED);
+        return -1;
+    }
+
+    latency_reset(g);
+
+    return 0;
+}
+
+unsigned long long LIBEXPORT grc_latency_percentile(
+    const struct grc_latency *latency, enum grc_input_event event,
+    double percentile)
+{
+    grc_errno_clear();
+
+    if (NULL == latency) {
+        grc_set_errno(GRC_ERROR_NULL_ARG);
+        return 0;
+    }
+
+    if ((event < 0) || (event >= GRC_INPUT_EVENTS)) {
+        grc_set_errno(GRC_ERROR_INVALID_INPUT_EVENT);
+        return 0;
+    }
+
+    return histogram_percentile(latency->histogram[event],
+                                latency->events[event],
+                                latency->max_latency[event], percentile);
+}
@@ -0,0 +1,455 @@
+/*
+ * Description: Functions to compute the objects geometry from their layout
+ *              properties, such as anchors, percentages and rows/columns.
+ *
+ * Author: Rodrigo Freitas
+ * Created at: Mon Oct 19 18:03:40 2026
+ * Project: libgrc
+ *
+ * Copyright (c) 2014 Rodrigo Freitas
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301
+ * USA
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "libgrc.h"
+
+/* Space between an object and its "father", before the layout properties */
+#define LEGACY_PARENT_SPACER        2
+#define LEGACY_EDIT_SPACER          3
+
+struct layout_rect {
+    int                 x;
+    int                 y;
+    int                 w;
+    int                 h;
+};
+
+struct layout_node {
+    struct grc_object_s *object;
+    struct layout_node  *parent;
+
+    /* Children, in the same order they were declared */
+    struct layout_node  *child;
+    struct layout_node  *last_child;
+    struct layout_node  *next;
+
+    /* Geometry from the GRC, or from the user */
+    struct layout_rect  base;
+    int                 anchor;
+    int                 flow;
+    int                 padding;
+    int                 w_percent;
+    int                 h_percent;
+
+    /* Computed geometry, only changed by the layout pass */
+    struct layout_rect  rect;
+    bool                dirty;
+};
+
+struct layout {
+    struct layout_node  *nodes;
+    unsigned int        n_nodes;
+
+    /* Objects without a "father" */
+    struct layout_node  *root;
+    struct layout_node  *last_root;
+    struct layout_rect  area;
+};
+
+void destroy_layout(struct layout *layout)
+{
+    if (NULL == layout)
+        return;
+
+    if (layout->nodes != NULL)
+        free(layout->nodes);
+
+    free(layout);
+}
+
+static void append_child(struct layout_node **first, struct layout_node **last,
+    struct layout_node *n)
+{
+    if (NULL == *first)
+        *first = n;
+    else
+        (*last)->next = n;
+
+    *last = n;
+}
+
+/* Area where the children of @n are placed */
+static void inner_rect(const struct layout_node *n, struct layout_rect *r)
+{
+    r->x = n->rect.x + n->padding;
+    r->y = n->rect.y + n->padding;
+    r->w = MAX(n->rect.w - 2 * n->padding, 0);
+    r->h = MAX(n->rect.h - 2 * n->padding, 0);
+}
+
+/*
+ * The old "parent" behaviour: images and log boxes fill their "father" and
+ * an edit is placed at its top.
+ */
+static bool legacy_rect(const struct layout_node *n,
+    const struct layout_rect *area, struct layout_rect *r)
+{
+    struct grc_obj_properties *prop = grc_object_get_properties(n->object);
+
+    if ((n->anchor > 0) || (n->w_percent > 0) || (n->h_percent > 0))
+        return false;
+
+    switch (PROP_get(prop, type)) {
+        case GRC_OBJECT_IMAGE:
+        case GRC_OBJECT_MESSAGES_LOG_BOX:
+            r->x = area->x + LEGACY_PARENT_SPACER;
+            r->y = area->y + LEGACY_PARENT_SPACER;
+            r->w = area->w - LEGACY_PARENT_SPACER;
+            r->h = area->h - LEGACY_PARENT_SPACER;
+            return true;
+
+        case GRC_OBJECT_EDIT:
+            r->x = area->x + LEGACY_EDIT_SPACER;
+            r->y = area->y + LEGACY_EDIT_SPACER;
+            r->w = area->w - (LEGACY_EDIT_SPACER + 1);
+            r->h = n->base.h;
+            return true;
+
+        default:
+            break;
+    }
+
+    return false;
+}
+
+/*
+ * Position of an object of size @size inside @length. @align is 0 to place
+ * it at the start, 1 at the center and 2 at the end.
+ */
+static int anchor_position(int start, int length, int size, int offset,
+    int align)
+{
+    switch (align) {
+        case 1:
+            return start + (length - size) / 2 + offset;
+
+        case 2:
+            return start + length - size - offset;
+    }
+
+    return start + offset;
+}
+
+/*
+ * Computes the geometry of @n inside @area. @cursor is where the next object
+ * goes when @area places its children in sequence (@flow).
+ */
+static void compute_rect(const struct layout_node *n,
+    const struct layout_rect *area, int flow, int gap, int *cursor,
+    struct layout_rect *r)
+{
+    int off_x = MAX(n->base.x, 0), off_y = MAX(n->base.y, 0);
+
+    r->w = (n->w_percent > 0) ? area->w * n->w_percent / 100 : n->base.w;
+    r->h = (n->h_percent > 0) ? area->h * n->h_percent / 100 : n->base.h;
+
+    if (flow == GRC_LAYOUT_ROW) {
+        r->x = area->x + *cursor;
+        r->y = area->y + off_y;
+        *cursor += r->w + gap;
+    } else if (flow == GRC_LAYOUT_COLUMN) {
+        r->x = area->x + off_x;
+        r->y = area->y + *cursor;
+        *cursor += r->h + gap;
+    } else if (n->anchor > 0) {
+        r->x = anchor_position(area->x, area->w, r->w, off_x,
+                               (n->anchor - GRC_ANCHOR_TOP_LEFT) % 3);
+
+        r->y = anchor_position(area->y, area->h, r->h, off_y,
+                               (n->anchor - GRC_ANCHOR_TOP_LEFT) / 3);
+    } else if (n->parent != NULL) {
+        if (legacy_rect(n, area, r) == false) {
+            r->x = area->x + off_x;
+            r->y = area->y + off_y;
+        }
+    } else {
+        /* Absolute position, as it was written */
+        r->x = n->base.x;
+        r->y = n->base.y;
+    }
+}
+
+static void apply_rect(struct layout_node *n)
+{
+    DIALOG *d;
+
+    d = grc_object_get_DIALOG(n->object);
+    d->x = n->rect.x;
+    d->y = n->rect.y;
+    d->w = n->rect.w;
+    d->h = n->rect.h;
+
+    /* The object inside an already created DIALOG */
+    d = n->object->rdlg;
+
+    if (d != NULL) {
+        d->x = n->rect.x;
+        d->y = n->rect.y;
+        d->w = n->rect.w;
+        d->h = n->rect.h;
+    }
+}
+
+/*
+ * Places a list of siblings inside @area. Only the children of an object
+ * whose geometry changed, or which was marked dirty, are placed again.
+ * Returns the number of objects moved or resized.
+ */
+static unsigned int place_children(struct layout_node *first,
+    const struct layout_rect *area, int flow, int gap)
+{
+    struct layout_node *n;
+    struct layout_rect r, inner;
+    unsigned int changed = 0;
+    int cursor = 0;
+
+    for (n = first; n; n = n->next) {
+        compute_rect(n, area, flow, gap, &cursor, &r);
+
+        if (memcmp(&r, &n->rect, sizeof(r)) != 0) {
+            n->rect = r;
+            n->dirty = true;
+            apply_rect(n);
+            changed++;
+        }
+
+        if (n->dirty == false)
+            continue;
+
+        n->dirty = false;
+
+        if (n->child != NULL) {
+            inner_rect(n, &inner);
+            changed += place_children(n->child, &inner, n->flow, n->padding);
+        }
+    }
+
+    return changed;
+}
+
+/* Places again the siblings of @n, and everything below them that changed */
+static unsigned int layout_update(struct layout *layout, struct layout_node *n)
+{
+    struct layout_rect inner;
+
+    if (NULL == n->parent)
+        return place_children(layout->root, &layout->area, 0, 0);
+
+    inner_rect(n->parent, &inner);
+
+    return place_children(n->parent->child, &inner, n->parent->flow,
+                          n->parent->padding);
+}
+
+/*
+ * Loads the object geometry, scaled to the real resolution if the GRC was
+ * written for another one. Widths measured from the object text are kept,
+ * since the object font was already chosen for the real resolution.
+ */
+static void load_node(struct grc_s *grc, struct layout_node *n,
+    struct grc_object_s *object)
+{
+    struct grc_obj_properties *prop = grc_object_get_properties(object);
+    DIALOG *d = grc_object_get_DIALOG(object);
+
+    n->object = object;
+    n->base.x = scale_x(grc, d->x);
+    n->base.y = scale_y(grc, d->y);
+    n->base.w = (PROP_get(prop, w) < 0) ? d->w : scale_x(grc, d->w);
+    n->base.h = scale_y(grc, d->h);
+    n->anchor = MAX(PROP_get(prop, anchor), 0);
+    n->flow = MAX(PROP_get(prop, layout), 0);
+    n->padding = scale_x(grc, MAX(PROP_get(prop, padding), 0));
+    n->w_percent = PROP_get(prop, width_percent);
+    n->h_percent = PROP_get(prop, height_percent);
+    n->dirty = true;
+
+    /* Forces every object to be placed on the first pass */
+    n->rect.w = -1;
+
+    object->layout = n;
+}
+
+/* Objects may reference a "father" declared after them */
+static int link_node(struct grc_s *grc, struct layout_node *n)
+{
+    struct layout *layout = grc->layout;
+    struct grc_obj_properties *prop;
+    struct grc_object_s *o;
+    struct layout_node *p;
+    unsigned int depth = 0;
+
+    prop = grc_object_get_properties(n->object);
+
+    if (PROP_check(prop, parent) == false) {
+        append_child(&layout->root, &layout->last_root, n);
+        return 0;
+    }
+
+    o = tag_index_get(grc->tags, PROP_get(prop, parent));
+
+    if ((NULL == o) || (NULL == o->layout) || (o->layout == n)) {
+        grc_set_errno(GRC_ERROR_INVALID_PARENT);
+        return -1;
+    }
+
+    /* A "father" may not be one of its own children */
+    for (p = o->layout; p; p = p->parent)
+        if ((p == n) || (++depth > layout->n_nodes)) {
+            grc_set_errno(GRC_ERROR_INVALID_PARENT);
+            return -1;
+        }
+
+    n->parent = o->layout;
+    append_child(&n->parent->child, &n->parent->last_child, n);
+
+    return 0;
+}
+
+/*
+ * Builds the layout tree of every loaded object and computes its geometry.
+ * Must be called after all objects are loaded.
+ */
+int layout_build(struct grc_s *grc)
+{
+    struct layout *layout;
+    struct grc_object_s *o;
+    unsigned int i;
+
+    layout = calloc(1, sizeof(struct layout));
+
+    if (NULL == layout) {
+        grc_set_errno(GRC_ERROR_MEMORY);
+        return -1;
+    }
+
+    layout->n_nodes = cl_dll_size(grc->ui_objects);
+    layout->nodes = calloc(MAX(layout->n_nodes, 1),
+                           sizeof(struct layout_node));
+
+    if (NULL == layout->nodes) {
+        free(layout);
+        grc_set_errno(GRC_ERROR_MEMORY);
+        return -1;
+    }
+
+    layout->area.w = info_get_value(grc->info, INFO_WIDTH);
+    layout->area.h = info_get_value(grc->info, INFO_HEIGHT);
+    grc->layout = layout;
+
+    for (o = grc->ui_objects, i = 0; o; o = o->next, i++)
+        load_node(grc, &layout->nodes[i], o);
+
+    /* Parents are linked only after every node exists */
+    for (i = 0; i < layout->n_nodes; i++)
+        if (link_node(grc, &layout->nodes[i]) < 0)
+            return -1;
+
+    place_children(layout->root, &layout->area, 0, 0);
+
+    return 0;
+}
+
+/*
+ *
+ * API
+ *
+ */
+
+static void layout_redraw(struct grc_s *grc, unsigned int changed)
+{
+    if ((changed > 0) &&
+        (info_get_value(grc->info, INFO_ARE_WE_PREPARED) == true))
+    {
+        redraw_DIALOG(grc);
+    }
+}
+
+int LIBEXPORT grc_layout_set_area(grc_t *grc, unsigned int width,
+    unsigned int height)
+{
+    struct grc_s *g = (struct grc_s *)grc;
+
+    grc_errno_clear();
+
+    if (NULL == grc) {
+        grc_set_errno(GRC_ERROR_NULL_ARG);
+        return -1;
+    }
+
+    if (NULL == g->layout) {
+        grc_set_errno(GRC_ERROR_NOT_PREPARED_YET);
+        return -1;
+    }
+
+    g->layout->area.w = width;
+    g->layout->area.h = height;
+
+    /* Objects at absolute positions don't move, nor their children */
+    layout_redraw(g, place_children(g->layout->root, &g->layout->area, 0, 0));
+
+    return 0;
+}
+
+int LIBEXPORT grc_layout_set_size(grc_t *grc, const char *tag, int width,
+    int height)
+{
+    struct grc_s *g = (struct grc_s *)grc;
+    struct grc_object_s *o;
+    struct layout_node *n;
+
+    grc_errno_clear();
+
+    if ((NULL == grc) || (NULL == tag)) {
+        grc_set_errno(GRC_ERROR_NULL_ARG);
+        return -1;
+    }
+
+    if (NULL == g->layout) {
+        grc_set_errno(GRC_ERROR_NOT_PREPARED_YET);
+        return -1;
+    }
+
+    o = tag_index_get(g->tags, tag);
+
+    if ((NULL == o) || (NULL == o->layout)) {
+        grc_set_errno(GRC_ERROR_OBJECT_NOT_FOUND);
+        return -1;
+    }
+
+    /* An explicit size replaces the percentages */
+    n = o->layout;
+    n->base.w = scale_x(g, width);
+    n->base.h = scale_y(g, height);
+    n->w_percent = -1;
+    n->h_percent = -1;
+    layout_redraw(g, layout_update(g->layout, n));
+
+    return 0;
+}
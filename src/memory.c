@@ -0,0 +1,195 @@
+/*
+ * Description: Accounting of the memory used by a DIALOG.
+ *
+ * Author: Rodrigo Freitas
+ * Created at: Tue Oct 20 01:48:26 2026
+ * Project: libgrc
+ *
+ * Copyright (c) 2014 Rodrigo Freitas
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301
+ * USA
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <malloc.h>
+
+#include "libgrc.h"
+#include "gui/objects.h"
+
+/*
+ * Bytes allocated by the whole process, from every malloc arena and the
+ * blocks mapped by it, or 0 where the C library can't tell. It walks the
+ * arenas, so it's not for every frame.
+ *
+ * Before glibc 2.33 only mallinfo exists, whose fields are ints and wrap
+ * past 4GB.
+ */
+size_t memory_in_use(void)
+{
+#if defined(__GLIBC__)
+# if __GLIBC_PREREQ(2, 33)
+    struct mallinfo2 mi;
+
+    mi = mallinfo2();
+
+    return mi.uordblks + mi.hblkhd;
+# else
+    struct mallinfo mi;
+
+    mi = mallinfo();
+
+    return (size_t)(unsigned int)mi.uordblks + (unsigned int)mi.hblkhd;
+# endif
+#else
+    return 0;
+#endif
+}
+
+/*
+ * Bytes allocated since @before, a previous memory_in_use. Other threads may
+ * allocate or free meanwhile, so it's only an estimate.
+ */
+size_t memory_used_since(size_t before)
+{
+    size_t now = memory_in_use();
+
+    return (now > before) ? now - before : 0;
+}
+
+size_t bitmap_memory(BITMAP *bmp)
+{
+    return sizeof(BITMAP) + bmp->h * sizeof(unsigned char *) +
+           (size_t)bmp->w * bmp->h * ((bitmap_color_depth(bmp) + 7) / 8);
+}
+
+/*
+ * A menu item has its own entry, while a menu has one for each item plus
+ * the terminator. The main menu, created with the DIALOG, has one for each
+ * menu.
+ */
+static size_t menu_memory(struct grc_s *grc, struct grc_object_s *o)
+{
+    if (NULL == o->menu)
+        return 0;
+
+    if (o->type == MENU_ITEM_OBJECT)
+        return sizeof(MENU);
+
+    if (o->type == MENU_OBJECT)
+        return (cl_dll_size(o->items) + 1) * sizeof(MENU);
+
+    return (cl_dll_size(grc->ui_menu) + 1) * sizeof(MENU);
+}
+
+static void object_memory(struct grc_s *grc, struct grc_object_s *objects,
+    struct grc_mem_stats *stats)
+{
+    struct grc_object_s *o;
+
+    for (o = objects; o; o = o->next) {
+        stats->objects += sizeof(struct grc_object_s);
+
+        if (o->dlg != NULL)
+            stats->objects += sizeof(DIALOG);
+
+        if (o->tag != NULL)
+            stats->objects += strlen(o->tag) + 1;
+
+        if (o->cb_data != NULL)
+            stats->objects += callback_data_memory();
+
+        if (o->prop != NULL)
+            stats->properties += obj_properties_memory();
+
+        if (o->free_priv == gui_edit_destroy)
+            stats->edit_buffers += gui_edit_memory(o->priv);
+        else if (o->free_priv == gui_messages_destroy)
+            stats->log_lines += gui_messages_memory(o->priv);
+        else if (o->free_priv == gui_bitmap_destroy)
+            stats->bitmaps += bitmap_memory(o->priv);
+        else if (o->free_priv == gui_table_destroy)
+            stats->bitmaps += gui_table_memory(o->priv);
+        else if (o->free_priv == gui_virtual_list_destroy)
+            stats->bitmaps += gui_virtual_list_memory(o->priv);
+
+        stats->menus += menu_memory(grc, o);
+
+        if (o->items != NULL)
+            object_memory(grc, o->items, stats);
+    }
+}
+
+static void DIALOG_memory(struct grc_s *grc, struct grc_mem_stats *stats)
+{
+    DIALOG *d;
+
+    if (NULL == grc->dlg)
+        return;
+
+    /* With its terminator */
+    for (d = grc->dlg; d->proc != NULL; d++)
+        stats->dialog += sizeof(DIALOG);
+
+    stats->dialog += sizeof(DIALOG);
+}
+
+/*
+ *
+ * API
+ *
+ */
+
+int LIBEXPORT grc_memory_usage(grc_t *grc, struct grc_mem_stats *stats)
+{
+    struct grc_s *g = (struct grc_s *)grc;
+
+    grc_errno_clear();
+
+    if ((NULL == grc) || (NULL == stats)) {
+        grc_set_errno(GRC_ERROR_NULL_ARG);
+        return -1;
+    }
+
+    memset(stats, 0, sizeof(struct grc_mem_stats));
+
+    if (g->jgrc != NULL)
+        stats->json = g->jgrc_memory;
+
+    /* Strings of the properties, once the JSON is released */
+    if (g->strings != NULL)
+        stats->properties += string_table_memory(g->strings);
+
+    object_memory(g, g->ui_objects, stats);
+    object_memory(g, g->tmp_objects, stats);
+    object_memory(g, g->ui_keys, stats);
+    object_memory(g, g->ui_menu, stats);
+    DIALOG_memory(g, stats);
+
+    if (g->framebuffer != NULL)
+        stats->bitmaps += bitmap_memory(g->framebuffer);
+
+    if (g->save_under != NULL)
+        stats->bitmaps += bitmap_memory(g->save_under);
+
+    stats->bitmaps += font_atlas_memory();
+
+    stats->total = stats->json + stats->objects + stats->properties +
+                   stats->dialog + stats->edit_buffers + stats->log_lines +
+                   stats->bitmaps + stats->menus;
+
+    return 0;
+}
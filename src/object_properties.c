@@ -26,9 +26,13 @@
  */
 
 #include <stdlib.h>
+#include <string.h>
 
 #include "libgrc.h"
 
+/* name, parent, text, fg, key, columns and font */
+#define MAX_PROPERTY_STRINGS        7
+
 /* Structure to hold a property detail, such as its name, type, etc */
 struct property_detail {
     char                        string[128];
@@ -39,11 +43,13 @@ struct property_detail {
 /* Structure to store an object "object" of a GRC file */
 struct grc_obj_properties {
     enum grc_object     type;
-    cl_string_t         *name;
-    cl_string_t         *parent;
-    cl_string_t         *text;
-    cl_string_t         *fg;
-    cl_string_t         *key;
+    const char          *name;
+    const char          *parent;
+    const char          *text;
+    const char          *fg;
+    const char          *key;
+    const char          *columns;
+    const char          *font;
     int                 x;
     int                 y;
     int                 w;
@@ -57,6 +63,20 @@ struct grc_obj_properties {
     int                 horizontal_position;
     int                 fps;
     int                 devices;
+    bool                virtual_mode;
+    bool                multiline;
+    int                 anchor;
+    int                 layout;
+    int                 padding;
+    int                 width_percent;
+    int                 height_percent;
+
+    /*
+     * The strings above belong to the GRC JSON, which is kept alive by these
+     * references, until they are copied into a string table.
+     */
+    cl_string_t         *refs[MAX_PROPERTY_STRINGS];
+    unsigned int        n_refs;
 };
 
 /* Supported properties from an object of a GRC file */
@@ -84,7 +104,18 @@ static struct property_detail __properties[] = {
     { OBJ_PASSWORD,             GRC_PROPERTY_PASSWORD_MODE,      GRC_BOOL    },
     { OBJ_HORIZONTAL_POSITION,  GRC_PROPERTY_H_POSITION,         GRC_STRING  },
     { OBJ_FPS,                  GRC_PROPERTY_FPS,                GRC_NUMBER  },
-    { OBJ_DEVICES,              GRC_PROPERTY_DEVICES,            GRC_NUMBER  }
+    { OBJ_DEVICES,              GRC_PROPERTY_DEVICES,            GRC_NUMBER  },
+    { OBJ_VIRTUAL,              GRC_PROPERTY_VIRTUAL,            GRC_BOOL    },
+    { OBJ_COLUMNS,              GRC_PROPERTY_COLUMNS,            GRC_STRING  },
+    { OBJ_MULTILINE,            GRC_PROPERTY_MULTILINE,          GRC_BOOL    },
+    { OBJ_FONT,                 GRC_PROPERTY_FONT,               GRC_STRING  },
+    { OBJ_ANCHOR,               GRC_PROPERTY_ANCHOR,             GRC_STRING  },
+    { OBJ_LAYOUT,               GRC_PROPERTY_LAYOUT,             GRC_STRING  },
+    { OBJ_PADDING,              GRC_PROPERTY_PADDING,            GRC_NUMBER  },
+    { OBJ_WIDTH_PERCENT,        GRC_PROPERTY_WIDTH_PERCENT,      GRC_NUMBER  },
+    { OBJ_HEIGHT_PERCENT,       GRC_PROPERTY_HEIGHT_PERCENT,     GRC_NUMBER  },
+    { OBJ_DESIGN_RESOLUTION,    GRC_PROPERTY_DESIGN_RESOLUTION,  GRC_STRING  },
+    { OBJ_BACKEND,              GRC_PROPERTY_BACKEND,            GRC_STRING  }
 };
 
 #define MAX_PROPERTIES              \
@@ -132,24 +163,101 @@ enum grc_entry_type_value propery_detail_type(struct property_detail *d)
     return d->type;
 }
 
+/* Releases the strings of the GRC JSON kept by the properties */
+static void unref_strings(struct grc_obj_properties *prop)
+{
+    unsigned int i;
+
+    for (i = 0; i < prop->n_refs; i++)
+        cl_string_unref(prop->refs[i]);
+
+    prop->n_refs = 0;
+}
+
 /*
  * Destroy a structure 'struct grc_obj_properties'.
  */
 void destroy_obj_properties(struct grc_obj_properties *prop)
 {
-    if (prop->parent != NULL)
-        cl_string_unref(prop->parent);
+    unref_strings(prop);
+    free(prop);
+}
+
+/* Keeps a string of the GRC JSON for as long as the properties need it */
+static const char *keep_string(struct grc_obj_properties *prop,
+    cl_string_t *s)
+{
+    if (NULL == s)
+        return NULL;
+
+    prop->refs[prop->n_refs++] = s;
+
+    return cl_string_valueof(s);
+}
 
-    if (prop->name != NULL)
-        cl_string_unref(prop->name);
+static void string_properties(struct grc_obj_properties *prop,
+    const char **strings[MAX_PROPERTY_STRINGS])
+{
+    strings[0] = &prop->name;
+    strings[1] = &prop->parent;
+    strings[2] = &prop->text;
+    strings[3] = &prop->fg;
+    strings[4] = &prop->key;
+    strings[5] = &prop->columns;
+    strings[6] = &prop->font;
+}
 
-    if (prop->text != NULL)
-        cl_string_unref(prop->text);
+/* Bytes needed to copy the strings into a string table */
+size_t obj_properties_strings_size(struct grc_obj_properties *prop)
+{
+    const char **strings[MAX_PROPERTY_STRINGS];
+    unsigned int i;
+    size_t size = 0;
 
-    if (prop->fg != NULL)
-        cl_string_unref(prop->fg);
+    string_properties(prop, strings);
 
-    free(prop);
+    for (i = 0; i < MAX_PROPERTY_STRINGS; i++)
+        if (*strings[i] != NULL)
+            size += strlen(*strings[i]) + 1;
+
+    return size;
+}
+
+/*
+ * Copies the strings into @table, releasing the ones of the GRC JSON. The
+ * text pointed by @d is replaced by its copy.
+ */
+void obj_properties_compact(struct grc_obj_properties *prop,
+    struct string_table *table, DIALOG *d)
+{
+    const char **strings[MAX_PROPERTY_STRINGS];
+    const char *s;
+    unsigned int i;
+
+    string_properties(prop, strings);
+
+    for (i = 0; i < MAX_PROPERTY_STRINGS; i++) {
+        if (NULL == *strings[i])
+            continue;
+
+        s = string_table_add(table, *strings[i]);
+
+        if ((d != NULL) && (d->dp == *strings[i]))
+            d->dp = (char *)s;
+
+        *strings[i] = s;
+    }
+
+    unref_strings(prop);
+}
+
+/*
+ * Bytes taken by a structure 'struct grc_obj_properties'. Its strings belong
+ * to the GRC JSON or to the string table of the DIALOG.
+ */
+size_t obj_properties_memory(void)
+{
+    return sizeof(struct grc_obj_properties);
 }
 
 /*
@@ -199,10 +307,7 @@ struct grc_obj_properties *new_obj_properties(cl_json_t *object)
 
     tmp = grc_get_object_str(object, property_detail_string(dt));
 
-    if (tmp != NULL)
-        p->name = tmp;
-    else
-        p->name = NULL;
+    p->name = keep_string(p, tmp);
 
     /* parent */
     dt = get_property_detail(GRC_PROPERTY_PARENT);
@@ -212,10 +317,7 @@ struct grc_obj_properties *new_obj_properties(cl_json_t *object)
 
     tmp = grc_get_object_str(object, property_detail_string(dt));
 
-    if (tmp != NULL)
-        p->parent = tmp;
-    else
-        p->parent = NULL;
+    p->parent = keep_string(p, tmp);
 
     /* text */
     dt = get_property_detail(GRC_PROPERTY_TEXT);
@@ -225,10 +327,7 @@ struct grc_obj_properties *new_obj_properties(cl_json_t *object)
 
     tmp = grc_get_object_str(object, property_detail_string(dt));
 
-    if (tmp != NULL)
-        p->text = tmp;
-    else
-        p->text = NULL;
+    p->text = keep_string(p, tmp);
 
     /* key */
     dt = get_property_detail(GRC_PROPERTY_KEY);
@@ -238,10 +337,7 @@ struct grc_obj_properties *new_obj_properties(cl_json_t *object)
 
     tmp = grc_get_object_str(object, property_detail_string(dt));
 
-    if (tmp != NULL)
-        p->key = tmp;
-    else
-        p->key = NULL;
+    p->key = keep_string(p, tmp);
 
     /* foreground */
     dt = get_property_detail(GRC_PROPERTY_FOREGROUND);
@@ -251,8 +347,7 @@ struct grc_obj_properties *new_obj_properties(cl_json_t *object)
 
     tmp = grc_get_object_str(object, property_detail_string(dt));
 
-    if (tmp != NULL)
-        p->fg = tmp;
+    p->fg = keep_string(p, tmp);
 
     /* pos_x */
     dt = get_property_detail(GRC_PROPERTY_POS_X);
@@ -367,6 +462,92 @@ struct grc_obj_properties *new_obj_properties(cl_json_t *object)
 
     p->devices = grc_get_object_value(object, property_detail_string(dt), 1);
 
+    /* virtual */
+    dt = get_property_detail(GRC_PROPERTY_VIRTUAL);
+
+    if (NULL == dt)
+        goto undefined_grc_jkey_block;
+
+    p->virtual_mode = grc_get_object_value(object, property_detail_string(dt),
+                                           false);
+
+    /* columns */
+    dt = get_property_detail(GRC_PROPERTY_COLUMNS);
+
+    if (NULL == dt)
+        goto undefined_grc_jkey_block;
+
+    p->columns = keep_string(p, grc_get_object_str(object,
+                                                   property_detail_string(dt)));
+
+    /* multiline */
+    dt = get_property_detail(GRC_PROPERTY_MULTILINE);
+
+    if (NULL == dt)
+        goto undefined_grc_jkey_block;
+
+    p->multiline = grc_get_object_value(object, property_detail_string(dt),
+                                        false);
+
+    /* font */
+    dt = get_property_detail(GRC_PROPERTY_FONT);
+
+    if (NULL == dt)
+        goto undefined_grc_jkey_block;
+
+    p->font = keep_string(p, grc_get_object_str(object,
+                                                property_detail_string(dt)));
+
+    /* anchor */
+    dt = get_property_detail(GRC_PROPERTY_ANCHOR);
+
+    if (NULL == dt)
+        goto undefined_grc_jkey_block;
+
+    tmp = grc_get_object_str(object, property_detail_string(dt));
+    p->anchor = tr_anchor(cl_string_valueof(tmp));
+
+    if (tmp != NULL)
+        cl_string_unref(tmp);
+
+    /* layout */
+    dt = get_property_detail(GRC_PROPERTY_LAYOUT);
+
+    if (NULL == dt)
+        goto undefined_grc_jkey_block;
+
+    tmp = grc_get_object_str(object, property_detail_string(dt));
+    p->layout = tr_layout(cl_string_valueof(tmp));
+
+    if (tmp != NULL)
+        cl_string_unref(tmp);
+
+    /* padding */
+    dt = get_property_detail(GRC_PROPERTY_PADDING);
+
+    if (NULL == dt)
+        goto undefined_grc_jkey_block;
+
+    p->padding = grc_get_object_value(object, property_detail_string(dt), 0);
+
+    /* width_percent */
+    dt = get_property_detail(GRC_PROPERTY_WIDTH_PERCENT);
+
+    if (NULL == dt)
+        goto undefined_grc_jkey_block;
+
+    p->width_percent = grc_get_object_value(object,
+                                            property_detail_string(dt), -1);
+
+    /* height_percent */
+    dt = get_property_detail(GRC_PROPERTY_HEIGHT_PERCENT);
+
+    if (NULL == dt)
+        goto undefined_grc_jkey_block;
+
+    p->height_percent = grc_get_object_value(object,
+                                             property_detail_string(dt), -1);
+
     return p;
 
 undefined_grc_jkey_block:
@@ -409,12 +590,23 @@ bool grc_obj_properties_has_fg(struct grc_obj_properties *prop)
     return true;
 }
 
+bool grc_obj_properties_has_font(struct grc_obj_properties *prop)
+{
+    if (NULL == prop)
+        return false;
+
+    if (NULL == prop->font)
+        return false;
+
+    return true;
+}
+
 const char *grc_obj_get_property_name(struct grc_obj_properties *prop)
 {
     if (NULL == prop)
         return NULL;
 
-    return cl_string_valueof(prop->name);
+    return prop->name;
 }
 
 const char *grc_obj_get_property_key(struct grc_obj_properties *prop)
@@ -422,7 +614,23 @@ const char *grc_obj_get_property_key(struct grc_obj_properties *prop)
     if (NULL == prop)
         return NULL;
 
-    return cl_string_valueof(prop->key);
+    return prop->key;
+}
+
+const char *grc_obj_get_property_columns(struct grc_obj_properties *prop)
+{
+    if (NULL == prop)
+        return NULL;
+
+    return prop->columns;
+}
+
+const char *grc_obj_get_property_font(struct grc_obj_properties *prop)
+{
+    if (NULL == prop)
+        return NULL;
+
+    return prop->font;
 }
 
 const char *grc_obj_get_property_parent(struct grc_obj_properties *prop)
@@ -430,7 +638,7 @@ const char *grc_obj_get_property_parent(struct grc_obj_properties *prop)
     if (NULL == prop)
         return NULL;
 
-    return cl_string_valueof(prop->parent);
+    return prop->parent;
 }
 
 const char *grc_obj_get_property_text(struct grc_obj_properties *prop)
@@ -438,7 +646,7 @@ const char *grc_obj_get_property_text(struct grc_obj_properties *prop)
     if (NULL == prop)
         return NULL;
 
-    return cl_string_valueof(prop->text);
+    return prop->text;
 }
 
 const char *grc_obj_get_property_fg(struct grc_obj_properties *prop)
@@ -446,7 +654,7 @@ const char *grc_obj_get_property_fg(struct grc_obj_properties *prop)
     if (NULL == prop)
         return NULL;
 
-    return cl_string_valueof(prop->fg);
+    return prop->fg;
 }
 
 enum grc_object grc_obj_get_property_type(struct grc_obj_properties *prop)
@@ -497,6 +705,62 @@ bool grc_obj_get_property_hide(struct grc_obj_properties *prop)
     return prop->hide;
 }
 
+bool grc_obj_get_property_virtual_mode(struct grc_obj_properties *prop)
+{
+    if (NULL == prop)
+        return false;
+
+    return prop->virtual_mode;
+}
+
+bool grc_obj_get_property_multiline(struct grc_obj_properties *prop)
+{
+    if (NULL == prop)
+        return false;
+
+    return prop->multiline;
+}
+
+int grc_obj_get_property_anchor(struct grc_obj_properties *prop)
+{
+    if (NULL == prop)
+        return -1;
+
+    return prop->anchor;
+}
+
+int grc_obj_get_property_layout(struct grc_obj_properties *prop)
+{
+    if (NULL == prop)
+        return -1;
+
+    return prop->layout;
+}
+
+int grc_obj_get_property_padding(struct grc_obj_properties *prop)
+{
+    if (NULL == prop)
+        return -1;
+
+    return prop->padding;
+}
+
+int grc_obj_get_property_width_percent(struct grc_obj_properties *prop)
+{
+    if (NULL == prop)
+        return -1;
+
+    return prop->width_percent;
+}
+
+int grc_obj_get_property_height_percent(struct grc_obj_properties *prop)
+{
+    if (NULL == prop)
+        return -1;
+
+    return prop->height_percent;
+}
+
 int grc_obj_get_property_line_break_mode(struct grc_obj_properties *prop)
 {
     if (NULL == prop)
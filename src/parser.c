@@ -36,11 +36,15 @@
  */
 int parse_file(struct grc_s *grc, const char *grc_filename)
 {
+    size_t before = memory_in_use();
+
     grc->jgrc = cl_json_read_file(grc_filename);
 
     if (NULL == grc->jgrc)
         return -1;
 
+    grc->jgrc_memory = memory_used_since(before);
+
     return 0;
 }
 
@@ -50,11 +54,15 @@ int parse_file(struct grc_s *grc, const char *grc_filename)
  */
 int parse_mem(struct grc_s *grc, const char *data)
 {
+    size_t before = memory_in_use();
+
     grc->jgrc = cl_json_parse(data);
 
     if (NULL == grc->jgrc)
         return -1;
 
+    grc->jgrc_memory = memory_used_since(before);
+
     return 0;
 }
 
@@ -64,11 +72,9 @@ int parse_mem(struct grc_s *grc, const char *data)
  */
 static int grc_to_DIALOG(struct grc_object_s *gobject, struct grc_s *grc)
 {
-    DIALOG *d, *p = NULL;
+    DIALOG *d;
     struct grc_obj_properties *prop;
-    struct grc_generic_data *gdata;
     int w = -1, h = -1;
-    char tmp[MAX_EDIT_SIZE] = {0};
     enum grc_object type;
 
     prop = grc_object_get_properties(gobject);
@@ -102,6 +108,15 @@ static int grc_to_DIALOG(struct grc_object_s *gobject, struct grc_s *grc)
             if (type == GRC_OBJECT_MESSAGES_LOG_BOX) {
                 d->proc = gui_messages_log_proc;
                 d->d1 = PROP_get(prop, line_break_mode);
+                d->dp2 = gui_messages_create();
+
+                if (NULL == d->dp2) {
+                    grc_set_errno(GRC_ERROR_MEMORY);
+                    return -1;
+                }
+
+                grc_object_set_private_data(gobject, d->dp2,
+                                            gui_messages_destroy);
             } else {
                 d->proc = gui_d_bitmap_proc;
 
@@ -113,21 +128,9 @@ static int grc_to_DIALOG(struct grc_object_s *gobject, struct grc_s *grc)
             }
 
             /*
-             * If we have a reference to a "father" object, the object position
-             * will derived from his position. Worth mentioning that, for this
-             * work correctly the "father" object must have been defined BEFORE
-             * the object, otherwise we can't get his positions. ;-)
+             * An object with a "father" fills it, which is done by the layout
+             * pass, after every object is loaded.
              */
-            if (PROP_check(prop, parent) == true) {
-                p = grc_get_DIALOG_from_tag(grc,
-                                            PROP_get(prop, parent));
-
-                d->x = p->x + 2;
-                d->y = p->y + 2;
-                d->w = p->w - 2;
-                d->h = p->h - 2;
-            }
-
             break;
 
         case GRC_OBJECT_CUSTOM:
@@ -164,29 +167,31 @@ static int grc_to_DIALOG(struct grc_object_s *gobject, struct grc_s *grc)
             break;
 
         case GRC_OBJECT_EDIT:
-            if (PROP_get(prop, data_length) >= MAX_EDIT_SIZE) {
+            if (PROP_get(prop, data_length) < 0) {
                 grc_set_errno(GRC_ERROR_UNSUPPORTED_EDIT_INPUT_LENGTH);
                 return -1;
             }
 
             if (PROP_get(prop, password_mode) == false)
                 d->proc = gui_d_edit_proc;
-            else {
+            else
                 d->proc = gui_d_password_proc;
 
-                /*
-                 * Creates a temporary buffer to store the asterisks strings.
-                 */
-                gdata = new_grc_generic_data();
-                gobject->g_data = cl_dll_unshift(gobject->g_data, gdata);
-                d->dp2 = gdata->data;
-            }
+            /*
+             * Creates the buffer to store the typed string in the object. An
+             * 'input_length' of 0 means that there is no limit.
+             */
+            d->dp2 = gui_edit_create(PROP_get(prop, data_length),
+                                     PROP_get(prop, password_mode),
+                                     PROP_get(prop, multiline));
 
-            /* Creates the buffer to store the typed string in the object. */
-            gdata = new_grc_generic_data();
-            gobject->g_data = cl_dll_unshift(gobject->g_data, gdata);
-            d->dp = gdata->data;
+            if (NULL == d->dp2) {
+                grc_set_errno(GRC_ERROR_MEMORY);
+                return -1;
+            }
 
+            grc_object_set_private_data(gobject, d->dp2, gui_edit_destroy);
+            d->dp = (char *)gui_edit_get_text(d);
             d->flags = D_EXIT;
             d->d1 = PROP_get(prop, data_length);
 
@@ -194,29 +199,58 @@ static int grc_to_DIALOG(struct grc_object_s *gobject, struct grc_s *grc)
              * Adjusts a default size allowing that the mouse may set the
              * focus on this object.
              */
-            h = DEFAULT_EDIT_HEIGHT;
+            if ((PROP_get(prop, multiline) == true) &&
+                (PROP_get(prop, h) > 0))
+            {
+                h = PROP_get(prop, h);
+            } else
+                h = DEFAULT_EDIT_HEIGHT;
 
-            /* We compute width automatically, case is necessary */
-            if (PROP_check(prop, parent) == true) {
-                p = grc_get_DIALOG_from_tag(grc,
-                                            PROP_get(prop, parent));
+            /*
+             * We compute width automatically, case is necessary. Inside a
+             * "father" object it is replaced by the layout pass.
+             */
+            if (PROP_get(prop, w) < 0)
+                w = text_length(font, "0") * (PROP_get(prop, data_length) + 1);
 
-                d->x = p->x + 3;
-                d->y = p->y + 3;
-                d->w = p->w - 4;
-                d->h = h;
-            } else {
-                if (PROP_get(prop, w) < 0) {
-                    memset(tmp, '0', PROP_get(prop, data_length) + 1);
-                    w = text_length(font, tmp);
-                }
+            break;
+
+        case GRC_OBJECT_LIST:
+            d->flags = D_EXIT;
+
+            if (PROP_get(prop, virtual_mode) == false) {
+                d->proc = gui_d_list_proc;
+                break;
+            }
+
+            /*
+             * In virtual mode the object keeps its rows cache in @dp2, so
+             * @dp still may receive the same function of a regular list.
+             */
+            d->proc = gui_d_virtual_list_proc;
+            d->dp2 = gui_virtual_list_create();
+
+            if (NULL == d->dp2) {
+                grc_set_errno(GRC_ERROR_MEMORY);
+                return -1;
             }
 
+            grc_object_set_private_data(gobject, d->dp2,
+                                        gui_virtual_list_destroy);
+
             break;
 
-        case GRC_OBJECT_LIST:
-            d->proc = gui_d_list_proc;
+        case GRC_OBJECT_TABLE:
+            d->proc = gui_d_table_proc;
             d->flags = D_EXIT;
+            d->dp2 = gui_table_create(PROP_get(prop, columns));
+
+            if (NULL == d->dp2) {
+                grc_set_errno(GRC_ERROR_INVALID_TABLE_COLUMNS);
+                return -1;
+            }
+
+            grc_object_set_private_data(gobject, d->dp2, gui_table_destroy);
             break;
 
         case GRC_OBJECT_CHECK:
@@ -261,6 +295,15 @@ static int grc_to_DIALOG(struct grc_object_s *gobject, struct grc_s *grc)
             d->proc = gui_d_vt_keyboard_proc;
             d->d1 = KEYBOARD_LAYOUT_LETTERS;
             d->dp = grc;
+            d->dp2 = gui_vt_keyboard_create();
+
+            if (NULL == d->dp2) {
+                grc_set_errno(GRC_ERROR_MEMORY);
+                return -1;
+            }
+
+            grc_object_set_private_data(gobject, d->dp2,
+                                        gui_vt_keyboard_destroy);
 
             /*
              * Set that the virtual keyboard is enabled to this DIALOG
@@ -275,7 +318,15 @@ static int grc_to_DIALOG(struct grc_object_s *gobject, struct grc_s *grc)
             break;
 
         case GRC_OBJECT_TEXTBOX:
-            d->proc = d_textbox_proc;
+            d->proc = gui_d_textbox_proc;
+            d->dp2 = gui_textbox_create();
+
+            if (NULL == d->dp2) {
+                grc_set_errno(GRC_ERROR_MEMORY);
+                return -1;
+            }
+
+            grc_object_set_private_data(gobject, d->dp2, gui_textbox_destroy);
             break;
 
         default:
@@ -283,13 +334,14 @@ static int grc_to_DIALOG(struct grc_object_s *gobject, struct grc_s *grc)
             return -1;
     }
 
-    /* Object position into the screen */
-    if (PROP_check(prop, parent) == false) {
-        d->x = PROP_get(prop, x);
-        d->y = PROP_get(prop, y);
-        d->w = (w == -1) ? PROP_get(prop, w) : w;
-        d->h = (h == -1) ? PROP_get(prop, h) : h;
-    }
+    /*
+     * Object position into the screen. Objects with a "father" or with
+     * layout properties are moved later, by the layout pass.
+     */
+    d->x = PROP_get(prop, x);
+    d->y = PROP_get(prop, y);
+    d->w = (w == -1) ? PROP_get(prop, w) : w;
+    d->h = (h == -1) ? PROP_get(prop, h) : h;
 
     /* Specific object colors */
     if (PROP_check(prop, fg) == true)
@@ -314,6 +366,9 @@ static int grc_to_DIALOG(struct grc_object_s *gobject, struct grc_s *grc)
 static int __load_object_to_grc(cl_json_t *object, struct grc_s *grc)
 {
     struct grc_object_s *gobj = NULL;
+    FONT *obj_font = NULL, *f = font;
+    DIALOG *d;
+    int ret;
 
     gobj = new_grc_object(STANDARD_OBJECT);
 
@@ -326,8 +381,24 @@ static int __load_object_to_grc(cl_json_t *object, struct grc_s *grc)
     if (NULL == gobj->prop)
         goto error_block;
 
-    /* Translate this to Allegro's DIALOG format */
-    if (grc_to_DIALOG(gobj, grc) < 0)
+    if (PROP_check(gobj->prop, font) == true) {
+        obj_font = font_get(grc, PROP_get(gobj->prop, font));
+
+        if (NULL == obj_font)
+            goto error_block;
+    }
+
+    /*
+     * Translate this to Allegro's DIALOG format. Objects are measured with
+     * their own font.
+     */
+    if (obj_font != NULL)
+        font = obj_font;
+
+    ret = grc_to_DIALOG(gobj, grc);
+    font = f;
+
+    if (ret < 0)
         goto error_block;
 
     /*
@@ -336,8 +407,21 @@ static int __load_object_to_grc(cl_json_t *object, struct grc_s *grc)
      */
     set_object_callback_data(gobj, grc);
 
+    if (obj_font != NULL) {
+        /* Its font is kept with the callback data, which couldn't be made */
+        if (NULL == gobj->cb_data) {
+            grc_set_errno(GRC_ERROR_MEMORY);
+            goto error_block;
+        }
+
+        d = grc_object_get_DIALOG(gobj);
+        callback_set_font(gobj->cb_data, obj_font, d->proc);
+        d->proc = font_object_proc;
+    }
+
     /* Creates a reference for this object, if it has a tag */
     grc_object_set_tag(gobj, PROP_get(gobj->prop, name));
+    grc_creates_reference(grc, gobj);
 
     /* Store the loaded object */
     grc->ui_objects = cl_dll_unshift(grc->ui_objects, gobj);
@@ -433,6 +517,7 @@ static int __load_key_to_grc(cl_json_t *key, struct grc_s *grc)
 
     /* Creates a reference for this object, if it has a tag */
     grc_object_set_tag(gobj, PROP_get(gobj->prop, name));
+    grc_creates_reference(grc, gobj);
 
     /* Store the loaded key */
     grc->ui_keys = cl_dll_unshift(grc->ui_keys, gobj);
@@ -482,7 +567,8 @@ static int load_keys_to_grc(struct grc_s *grc, cl_json_t *keys)
     return 0;
 }
 
-static int load_menu_items(cl_json_t *menu, struct grc_object_s *gobject)
+static int load_menu_items(cl_json_t *menu, struct grc_object_s *gobject,
+    struct grc_s *grc)
 {
     cl_json_t *items, *p;
     int i, t;
@@ -513,6 +599,7 @@ static int load_menu_items(cl_json_t *menu, struct grc_object_s *gobject)
 
         /* Creates a reference for this object, if it has a tag */
         grc_object_set_tag(gobj, PROP_get(gobj->prop, name));
+        grc_creates_reference(grc, gobj);
 
         /* Store the item */
         gobject->items = cl_dll_unshift(gobject->items, gobj);
@@ -545,7 +632,7 @@ static int __load_menu_to_grc(cl_json_t *menu, struct grc_s *grc)
     PROP_set(gobj->prop, type, GRC_OBJECT_MENU);
 
     /* We parse the "items" object here, because a menu is a special object */
-    load_menu_items(menu, gobj);
+    load_menu_items(menu, gobj, grc);
 
     /* Store the loaded menu */
     grc->ui_menu = cl_dll_unshift(grc->ui_menu, gobj);
@@ -620,6 +707,66 @@ int parse_objects(struct grc_s *grc)
     if (load_menu_to_grc(grc, n) < 0)
         return -1;
 
+    /* Every object is known now, so their parents may be resolved */
+    return layout_build(grc);
+}
+
+static size_t objects_strings_size(struct grc_object_s *objects)
+{
+    struct grc_object_s *o;
+    size_t size = 0;
+
+    for (o = objects; o; o = o->next) {
+        if (o->prop != NULL)
+            size += obj_properties_strings_size(o->prop);
+
+        size += objects_strings_size(o->items);
+    }
+
+    return size;
+}
+
+static void compact_objects(struct grc_object_s *objects,
+    struct string_table *table)
+{
+    struct grc_object_s *o;
+
+    for (o = objects; o; o = o->next) {
+        if (o->prop != NULL)
+            obj_properties_compact(o->prop, table, o->dlg);
+
+        compact_objects(o->items, table);
+    }
+}
+
+/*
+ * Once the objects are loaded, the only strings still needed from the GRC
+ * JSON are inside their properties. They are copied into a single table, so
+ * the JSON can be released.
+ */
+int parse_release_JSON(struct grc_s *grc)
+{
+    struct string_table *table;
+    size_t size;
+
+    size = objects_strings_size(grc->ui_objects) +
+           objects_strings_size(grc->ui_keys) +
+           objects_strings_size(grc->ui_menu);
+
+    table = new_string_table(size);
+
+    if (NULL == table)
+        return -1;
+
+    compact_objects(grc->ui_objects, table);
+    compact_objects(grc->ui_keys, table);
+    compact_objects(grc->ui_menu, table);
+
+    grc->strings = table;
+    cl_json_delete(grc->jgrc);
+    grc->jgrc = NULL;
+    grc->jgrc_memory = 0;
+
     return 0;
 }
 
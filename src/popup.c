@@ -0,0 +1,221 @@
+/*
+ * Description: Functions to run a DIALOG as a modal popup over another one,
+ *              restoring the screen under it when it closes.
+ *
+ * Author: Rodrigo Freitas
+ * Created at: Mon Oct 19 16:34:51 2026
+ * Project: libgrc
+ *
+ * Copyright (c) 2014 Rodrigo Freitas
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301
+ * USA
+ */
+
+#include "libgrc.h"
+
+struct area {
+    int     x;
+    int     y;
+    int     w;
+    int     h;
+};
+
+/* Replaces the DIALOG d_clear_proc, which would clear the whole screen */
+static int popup_no_clear_proc(int msg __attribute__((unused)),
+    DIALOG *d __attribute__((unused)), int c __attribute__((unused)))
+{
+    return D_O_K;
+}
+
+/*
+ * Keeps the parent on the screen while the popup runs, returning its
+ * d_clear_proc object to be given back when it closes.
+ */
+static DIALOG *hide_clear_object(DIALOG *dlg)
+{
+    DIALOG *d;
+
+    for (d = dlg; d->proc != NULL; d++)
+        if (d->proc == d_clear_proc) {
+            d->proc = popup_no_clear_proc;
+            return d;
+        }
+
+    return NULL;
+}
+
+static void restore_clear_object(DIALOG *d)
+{
+    if (d != NULL)
+        d->proc = d_clear_proc;
+}
+
+static bool is_frame_object(DIALOG *d)
+{
+    return (d->proc == d_clear_proc) || (d->proc == popup_no_clear_proc) ||
+           (d->proc == d_yield_proc);
+}
+
+/*
+ * The area of the screen covered by the popup objects. Returns false if it
+ * has nothing to draw.
+ */
+static bool popup_area(DIALOG *dlg, struct area *a)
+{
+    BITMAP *bmp = gui_get_screen();
+    int x1 = bmp->w, y1 = bmp->h, x2 = 0, y2 = 0;
+    DIALOG *d;
+
+    for (d = dlg; d->proc != NULL; d++) {
+        if (is_frame_object(d) || (d->w <= 0) || (d->h <= 0))
+            continue;
+
+        x1 = MIN(x1, d->x);
+        y1 = MIN(y1, d->y);
+        x2 = MAX(x2, d->x + d->w);
+        y2 = MAX(y2, d->y + d->h);
+    }
+
+    x1 = MAX(x1, 0);
+    y1 = MAX(y1, 0);
+    x2 = MIN(x2, bmp->w);
+    y2 = MIN(y2, bmp->h);
+
+    if ((x2 <= x1) || (y2 <= y1))
+        return false;
+
+    a->x = x1;
+    a->y = y1;
+    a->w = x2 - x1;
+    a->h = y2 - y1;
+
+    return true;
+}
+
+static bool overlaps(DIALOG *d, const struct area *a)
+{
+    return (d->x < a->x + a->w) && (d->x + d->w > a->x) &&
+           (d->y < a->y + a->h) && (d->y + d->h > a->y);
+}
+
+/*
+ * Keeps the parent objects alive while the popup runs. Objects under the
+ * popup would draw over it, so they wait until it closes.
+ */
+static void parent_idle(DIALOG *dlg, const struct area *a)
+{
+    DIALOG *d;
+
+    for (d = dlg; d->proc != NULL; d++) {
+        if (is_frame_object(d) || (d->flags & D_HIDDEN) || overlaps(d, a))
+            continue;
+
+        object_message(d, MSG_IDLE, 0);
+    }
+}
+
+/* Gets a bitmap to save the screen under the popup, reusing the last one */
+static BITMAP *save_under_bitmap(struct grc_s *popup, const struct area *a)
+{
+    if ((popup->save_under != NULL) &&
+        ((popup->save_under->w != a->w) || (popup->save_under->h != a->h)))
+    {
+        destroy_bitmap(popup->save_under);
+        popup->save_under = NULL;
+    }
+
+    if (NULL == popup->save_under)
+        popup->save_under = create_bitmap(a->w, a->h);
+
+    return popup->save_under;
+}
+
+int LIBEXPORT grc_popup_run(grc_t *parent, grc_t *popup)
+{
+    struct grc_s *p = (struct grc_s *)parent, *g = (struct grc_s *)popup;
+    DIALOG_PLAYER *player;
+    BITMAP *bmp = NULL;
+    struct area a = { 0, 0, 0, 0 };
+    bool has_area;
+    DIALOG *clear;
+    int ret = -1;
+
+    grc_errno_clear();
+
+    if ((NULL == parent) || (NULL == popup)) {
+        grc_set_errno(GRC_ERROR_NULL_ARG);
+        return -1;
+    }
+
+    if ((info_get_value(p->info, INFO_ARE_WE_PREPARED) == false) ||
+        (info_get_value(g->info, INFO_ARE_WE_PREPARED) == false))
+    {
+        grc_set_errno(GRC_ERROR_NOT_PREPARED_YET);
+        return -1;
+    }
+
+    /* The popup is drawn over its parent, wherever it is */
+    session_gui_lock();
+    headless_select(p);
+    clear = hide_clear_object(g->dlg);
+    has_area = popup_area(g->dlg, &a);
+
+    if (has_area == true) {
+        bmp = save_under_bitmap(g, &a);
+
+        if (NULL == bmp) {
+            grc_set_errno(GRC_ERROR_MEMORY);
+            goto end_block;
+        }
+
+        scare_mouse_area(a.x, a.y, a.w, a.h);
+        blit(gui_get_screen(), bmp, a.x, a.y, 0, 0, a.w, a.h);
+        unscare_mouse();
+    }
+
+    player = init_dialog(g->dlg, -1);
+
+    if (NULL == player) {
+        grc_set_errno(GRC_ERROR_MEMORY);
+        goto end_block;
+    }
+
+    /* It's drawn by the parent, which also receives the injected input */
+    headless_frame_input(p);
+
+    while (update_dialog(player)) {
+        parent_idle(p->dlg, &a);
+        headless_frame_input(p);
+    }
+
+    shutdown_dialog(player);
+
+    /* Puts back what was under the popup, with a single blit */
+    if (has_area == true) {
+        scare_mouse_area(a.x, a.y, a.w, a.h);
+        blit(bmp, gui_get_screen(), 0, 0, a.x, a.y, a.w, a.h);
+        unscare_mouse();
+    }
+
+    ret = 0;
+
+end_block:
+    /* The popup may also be run by itself later */
+    restore_clear_object(clear);
+    session_gui_unlock();
+
+    return ret;
+}
@@ -0,0 +1,337 @@
+/*
+ * Description: Optional profiling of DIALOGs, counting the messages their
+ *              objects receive and timing what they draw.
+ *
+ * Author: Rodrigo Freitas
+ * Created at: Mon Oct 19 23:31:05 2026
+ * Project: libgrc
+ *
+ * Copyright (c) 2014 Rodrigo Freitas
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301
+ * USA
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "libgrc.h"
+
+#ifdef GRC_PROFILE
+
+/*
+ * The real procedure of an object, which is replaced by 'profile_object_proc'
+ * when the DIALOG is created, and what it did.
+ *
+ * Each object has its own counters, so objects never wait for each other
+ * to count a message. They are only summed by grc_profile_snapshot.
+ */
+struct profile_object {
+    struct profile          *profile;
+    int                     (*proc)(int, DIALOG *, int);
+    const char              *tag;
+    unsigned long long      messages[GRC_PROFILE_MESSAGES];
+    unsigned long long      draws;
+    unsigned long long      draw_time;
+};
+
+/*
+ * Counters are atomic, without a lock, since they may be read or reset by
+ * any thread while the DIALOG runs.
+ */
+struct profile {
+    unsigned long long      frames;
+    unsigned long long      frame_histogram[GRC_HISTOGRAM_BUCKETS];
+    unsigned long long      max_frame_time;
+
+    /* The frame being run, only seen by the thread running it */
+    unsigned long long      frame_start;
+    bool                    frame_drawn;
+
+    unsigned int            n_objects;
+    struct profile_object   objects[];
+};
+
+static void counter_add(unsigned long long *counter, unsigned long long n)
+{
+    __atomic_fetch_add(counter, n, __ATOMIC_RELAXED);
+}
+
+static unsigned long long counter_get(unsigned long long *counter)
+{
+    return __atomic_load_n(counter, __ATOMIC_RELAXED);
+}
+
+static void counter_clear(unsigned long long *counter)
+{
+    __atomic_store_n(counter, 0, __ATOMIC_RELAXED);
+}
+
+static void clear_profile(struct profile *p)
+{
+    struct profile_object *o;
+    unsigned int i, k;
+
+    for (k = 0; k < GRC_HISTOGRAM_BUCKETS; k++)
+        counter_clear(&p->frame_histogram[k]);
+
+    counter_clear(&p->frames);
+    counter_clear(&p->max_frame_time);
+
+    for (i = 0; i < p->n_objects; i++) {
+        o = &p->objects[i];
+
+        for (k = 0; k < GRC_PROFILE_MESSAGES; k++)
+            counter_clear(&o->messages[k]);
+
+        counter_clear(&o->draws);
+        counter_clear(&o->draw_time);
+    }
+}
+
+static void destroy_profile(struct profile *p)
+{
+    free(p);
+}
+
+/* Only drawing is timed, the frames are timed by the DIALOG loop */
+int profile_object_proc(int msg, DIALOG *d, int c)
+{
+    struct profile_object *o = callback_get_profile(d->dp3);
+    unsigned long long start;
+    int ret;
+
+    counter_add(&o->messages[MIN((unsigned int)msg, GRC_PROFILE_MESSAGES - 1)],
+                1);
+
+    if (msg != MSG_DRAW)
+        return (o->proc)(msg, d, c);
+
+    start = nsec_now(CLOCK_MONOTONIC);
+    ret = (o->proc)(msg, d, c);
+    counter_add(&o->draw_time, nsec_now(CLOCK_MONOTONIC) - start);
+    counter_add(&o->draws, 1);
+    o->profile->frame_drawn = true;
+
+    return ret;
+}
+
+/* The procedure an object had before being profiled */
+int (*profile_object_get_proc(DIALOG *d))(int, DIALOG *, int)
+{
+    struct profile_object *o = callback_get_profile(d->dp3);
+
+    return o->proc;
+}
+
+void profile_object_set_proc(DIALOG *d, int (*proc)(int, DIALOG *, int))
+{
+    struct profile_object *o = callback_get_profile(d->dp3);
+
+    o->proc = proc;
+}
+
+/*
+ * Replaces the procedure of every object with its own callback data, which
+ * keeps where it is profiled. Internal objects, such as the background and
+ * the menu, are left as they are.
+ */
+void profile_attach(struct grc_s *grc)
+{
+    struct profile *p;
+    struct profile_object *o;
+    struct grc_object_s *gobj;
+    DIALOG *d;
+    unsigned int n;
+
+    n = cl_dll_size(grc->ui_objects);
+    p = calloc(1, sizeof(struct profile) + n * sizeof(struct profile_object));
+
+    if (NULL == p)
+        return;
+
+    for (gobj = grc->ui_objects; gobj; gobj = gobj->next) {
+        if (NULL == gobj->cb_data)
+            continue;
+
+        d = grc_object_get_DIALOG(gobj);
+        o = &p->objects[p->n_objects++];
+        o->profile = p;
+        o->tag = gobj->tag;
+        o->proc = d->proc;
+
+        callback_set_profile(gobj->cb_data, o);
+        d->proc = profile_object_proc;
+    }
+
+    if (grc->profile != NULL)
+        destroy_profile(grc->profile);
+
+    grc->profile = p;
+    latency_attach(grc);
+}
+
+void profile_detach(struct grc_s *grc)
+{
+    destroy_profile(grc->profile);
+    grc->profile = NULL;
+}
+
+void profile_frame_begin(struct grc_s *grc)
+{
+    struct profile *p = grc->profile;
+
+    if (NULL == p)
+        return;
+
+    p->frame_drawn = false;
+    p->frame_start = nsec_now(CLOCK_MONOTONIC);
+}
+
+/*
+ * A frame takes the whole time between its beginning and its end, as seen
+ * by the user. Only frames in which something was drawn are kept, since
+ * every other one just tells the objects that nothing happened.
+ */
+void profile_frame_end(struct grc_s *grc)
+{
+    struct profile *p = grc->profile;
+    unsigned long long usec;
+
+    if ((NULL == p) || (p->frame_drawn == false))
+        return;
+
+    usec = (nsec_now(CLOCK_MONOTONIC) - p->frame_start) / 1000;
+    counter_add(&p->frame_histogram[histogram_bucket(usec)], 1);
+    counter_add(&p->frames, 1);
+
+    /* Only the thread running the DIALOG raises it */
+    if (usec > counter_get(&p->max_frame_time))
+        __atomic_store_n(&p->max_frame_time, usec, __ATOMIC_RELAXED);
+}
+
+static int profile_snapshot(struct grc_s *grc, struct grc_profile *profile)
+{
+    struct profile *p = grc->profile;
+    struct profile_object *o;
+    unsigned int i, k;
+
+    if (NULL == p) {
+        grc_set_errno(GRC_ERROR_NOT_PREPARED_YET);
+        return -1;
+    }
+
+    memset(profile->messages, 0, sizeof(profile->messages));
+
+    for (k = 0; k < GRC_HISTOGRAM_BUCKETS; k++)
+        profile->frame_histogram[k] = counter_get(&p->frame_histogram[k]);
+
+    profile->frames = counter_get(&p->frames);
+    profile->max_frame_time = counter_get(&p->max_frame_time);
+    profile->n_objects = p->n_objects;
+
+    for (i = 0; i < p->n_objects; i++) {
+        o = &p->objects[i];
+
+        for (k = 0; k < GRC_PROFILE_MESSAGES; k++)
+            profile->messages[k] += counter_get(&o->messages[k]);
+
+        if (i >= profile->objects_size)
+            continue;
+
+        profile->objects[i].tag = o->tag;
+        profile->objects[i].draws = counter_get(&o->draws);
+        profile->objects[i].draw_time = counter_get(&o->draw_time);
+    }
+
+    latency_snapshot(grc, &profile->latency);
+
+    return 0;
+}
+
+static int profile_reset(struct grc_s *grc)
+{
+    if (NULL == grc->profile) {
+        grc_set_errno(GRC_ERROR_NOT_PREPARED_YET);
+        return -1;
+    }
+
+    clear_profile(grc->profile);
+    latency_reset(grc);
+
+    return 0;
+}
+
+#else
+
+static int profile_snapshot(struct grc_s *grc __attribute__((unused)),
+    struct grc_profile *profile __attribute__((unused)))
+{
+    grc_set_errno(GRC_ERROR_PROFILE_DISABLED);
+    return -1;
+}
+
+static int profile_reset(struct grc_s *grc __attribute__((unused)))
+{
+    grc_set_errno(GRC_ERROR_PROFILE_DISABLED);
+    return -1;
+}
+
+#endif
+
+/*
+ *
+ * API
+ *
+ */
+
+int LIBEXPORT grc_profile_snapshot(grc_t *grc, struct grc_profile *profile)
+{
+    grc_errno_clear();
+
+    if ((NULL == grc) || (NULL == profile)) {
+        grc_set_errno(GRC_ERROR_NULL_ARG);
+        return -1;
+    }
+
+    return profile_snapshot((struct grc_s *)grc, profile);
+}
+
+int LIBEXPORT grc_profile_reset(grc_t *grc)
+{
+    grc_errno_clear();
+
+    if (NULL == grc) {
+        grc_set_errno(GRC_ERROR_NULL_ARG);
+        return -1;
+    }
+
+    return profile_reset((struct grc_s *)grc);
+}
+
+unsigned long long LIBEXPORT grc_profile_frame_percentile(
+    const struct grc_profile *profile, double percentile)
+{
+    grc_errno_clear();
+
+    if (NULL == profile) {
+        grc_set_errno(GRC_ERROR_NULL_ARG);
+        return 0;
+    }
+
+    return histogram_percentile(profile->frame_histogram, profile->frames,
+                                profile->max_frame_time, percentile);
+}
@@ -0,0 +1,647 @@
+/*
+ * Description: Streams what a DIALOG draws to a viewer connected to a local
+ *              Unix socket, sending only what changed between frames.
+ *
+ * Author: Rodrigo Freitas
+ * Created at: Mon Oct 19 23:02:51 2026
+ * Project: libgrc
+ *
+ * Copyright (c) 2014 Rodrigo Freitas
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301
+ * USA
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <time.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+
+#include <pthread.h>
+
+#include "libgrc.h"
+
+/*
+ * A viewer receives a header as soon as it connects, followed by frames:
+ *
+ *   header: "GRCR" | version (u32) | width (u32) | height (u32) |
+ *           color depth (u32)
+ *   frame:  type (u8) | frame number (u32) | rectangles (u16) | rectangle...
+ *   rectangle: x (u16) | y (u16) | w (u16) | h (u16) | size (u32) | runs
+ *   run:    count (u8) | pixel (color depth / 8 bytes)
+ *
+ * A rectangle holds its pixels, line by line, as runs of the same pixel.
+ * The first frame a viewer receives is a keyframe, with the whole screen,
+ * and every other one holds only what changed since the previous frame.
+ * Every number is written in little-endian and pixels as Allegro keeps them.
+ */
+#define REMOTE_MAGIC                "GRCR"
+#define REMOTE_VERSION              1
+#define REMOTE_HEADER_SIZE          20
+#define REMOTE_FRAME_HEADER_SIZE    7
+#define REMOTE_RECT_HEADER_SIZE     12
+
+/* Size of the squares the screen is compared in */
+#define REMOTE_TILE                 32
+
+/*
+ * Frames waiting to be sent. When the viewer is this late, they are all
+ * dropped and replaced by a keyframe.
+ */
+#define REMOTE_MAX_QUEUED           4
+
+/* How long the sending thread waits before checking if it must stop */
+#define REMOTE_POLL_MSEC            100
+
+enum remote_frame_type {
+    REMOTE_KEYFRAME = 1,
+    REMOTE_DELTA
+};
+
+struct remote_frame {
+    struct remote_frame *next;
+    unsigned char       *data;
+    unsigned int        size;
+};
+
+/*
+ * The thread running the DIALOG compares and encodes each frame, which is
+ * sent to the viewer by another one, so a slow viewer never holds the
+ * DIALOG. Only the frame queue and @viewer are shared, under @lock.
+ */
+struct remote {
+    pthread_mutex_t     lock;
+    pthread_cond_t      cond;
+    pthread_t           thread;
+    bool                stop;
+    int                 listen_fd;
+    int                 viewer;
+    char                *path;
+
+    /* Frames waiting to be sent */
+    struct remote_frame *first;
+    struct remote_frame *last;
+    unsigned int        queued;
+    bool                keyframe;   /** The next frame must be a keyframe */
+
+    /* Used only by the DIALOG thread */
+    BITMAP              *current;
+    BITMAP              *previous;
+    unsigned int        frame;
+    int                 bpp;
+    unsigned char       *buffer;
+    unsigned int        used;
+    unsigned int        size;
+};
+
+static void free_frames(struct remote *r)
+{
+    struct remote_frame *f;
+
+    while (r->first != NULL) {
+        f = r->first;
+        r->first = f->next;
+        free(f->data);
+        free(f);
+    }
+
+    r->last = NULL;
+    r->queued = 0;
+}
+
+/*
+ *
+ * Encoding, by the DIALOG thread
+ *
+ */
+
+/* Makes room for @n more bytes inside the frame being encoded */
+static unsigned char *reserve(struct remote *r, unsigned int n)
+{
+    unsigned char *p;
+    unsigned int size;
+
+    if (r->used + n > r->size) {
+        size = MAX(r->size * 2, r->used + n);
+        p = realloc(r->buffer, size);
+
+        if (NULL == p)
+            return NULL;
+
+        r->buffer = p;
+        r->size = size;
+    }
+
+    p = r->buffer + r->used;
+    r->used += n;
+
+    return p;
+}
+
+static int encode_rect(struct remote *r, int x, int y, int w, int h)
+{
+    unsigned char *header, *run, *p, *end;
+    unsigned int start, count;
+    int line;
+
+    header = reserve(r, REMOTE_RECT_HEADER_SIZE);
+
+    if (NULL == header)
+        return -1;
+
+    start = r->used;
+    put_le16(header, x);
+    put_le16(header + 2, y);
+    put_le16(header + 4, w);
+    put_le16(header + 6, h);
+
+    for (line = y; line < y + h; line++) {
+        p = r->current->line[line] + x * r->bpp;
+        end = p + w * r->bpp;
+
+        while (p < end) {
+            count = 1;
+
+            while ((p + count * r->bpp < end) && (count < 255) &&
+                   !memcmp(p, p + count * r->bpp, r->bpp))
+            {
+                count++;
+            }
+
+            run = reserve(r, 1 + r->bpp);
+
+            if (NULL == run)
+                return -1;
+
+            run[0] = count;
+            memcpy(run + 1, p, r->bpp);
+            p += count * r->bpp;
+        }
+    }
+
+    /* The buffer may have moved while the runs were added */
+    put_le32(r->buffer + start - 4, r->used - start);
+
+    return 0;
+}
+
+static bool tile_changed(struct remote *r, int x, int y, int w, int h)
+{
+    int line;
+
+    for (line = y; line < y + h; line++)
+        if (memcmp(r->current->line[line] + x * r->bpp,
+                   r->previous->line[line] + x * r->bpp, w * r->bpp))
+        {
+            return true;
+        }
+
+    return false;
+}
+
+/*
+ * Adds every changed part of the screen, or all of it for a keyframe. Tiles
+ * changed side by side are sent as a single rectangle. Returns the number
+ * of rectangles or -1 on error.
+ */
+static int encode_damage(struct remote *r, bool keyframe)
+{
+    int x, y, w, h, span, rects = 0, width, height;
+
+    width = r->current->w;
+    height = r->current->h;
+
+    if (keyframe == true)
+        return (encode_rect(r, 0, 0, width, height) < 0) ? -1 : 1;
+
+    for (y = 0; y < height; y += REMOTE_TILE) {
+        h = MIN(REMOTE_TILE, height - y);
+        span = -1;
+
+        /* The last tile may be narrower, and it ends any open span */
+        for (x = 0; x < width + REMOTE_TILE; x += REMOTE_TILE) {
+            w = MIN(REMOTE_TILE, width - x);
+
+            if ((w > 0) && tile_changed(r, x, y, w, h)) {
+                if (span < 0)
+                    span = x;
+
+                continue;
+            }
+
+            if (span >= 0) {
+                if (encode_rect(r, span, y, MIN(x, width) - span, h) < 0)
+                    return -1;
+
+                rects++;
+                span = -1;
+            }
+        }
+    }
+
+    return rects;
+}
+
+static int queue_frame(struct remote *r)
+{
+    struct remote_frame *f;
+
+    f = calloc(1, sizeof(struct remote_frame));
+
+    if (NULL == f)
+        return -1;
+
+    f->data = malloc(r->used);
+
+    if (NULL == f->data) {
+        free(f);
+        return -1;
+    }
+
+    memcpy(f->data, r->buffer, r->used);
+    f->size = r->used;
+
+    if (r->last != NULL)
+        r->last->next = f;
+    else
+        r->first = f;
+
+    r->last = f;
+    r->queued++;
+    pthread_cond_signal(&r->cond);
+
+    return 0;
+}
+
+/* Called by the DIALOG thread after every frame is drawn */
+void remote_frame(struct grc_s *grc)
+{
+    struct remote *r = grc->remote;
+    BITMAP *src, *tmp;
+    bool keyframe;
+    int rects;
+
+    pthread_mutex_lock(&r->lock);
+
+    /* Nobody is watching */
+    if (r->viewer < 0) {
+        pthread_mutex_unlock(&r->lock);
+        return;
+    }
+
+    /* A late viewer gets only the most recent screen */
+    if (r->queued >= REMOTE_MAX_QUEUED) {
+        free_frames(r);
+        r->keyframe = true;
+    }
+
+    keyframe = r->keyframe;
+    pthread_mutex_unlock(&r->lock);
+
+    src = (grc->framebuffer != NULL) ? grc->framebuffer : gui_get_screen();
+
+    if (NULL == src)
+        return;
+
+    blit(src, r->current, 0, 0, 0, 0, r->current->w, r->current->h);
+    r->used = 0;
+    rects = (reserve(r, REMOTE_FRAME_HEADER_SIZE) != NULL)
+                ? encode_damage(r, keyframe) : -1;
+
+    /* Nothing changed */
+    if (rects == 0)
+        return;
+
+    pthread_mutex_lock(&r->lock);
+
+    /*
+     * The viewer may have changed while the frame was encoded, and a frame
+     * which can't be sent leaves it behind, so it needs a keyframe.
+     */
+    if (rects > 0) {
+        r->buffer[0] = keyframe ? REMOTE_KEYFRAME : REMOTE_DELTA;
+        put_le32(r->buffer + 1, r->frame++);
+        put_le16(r->buffer + 5, rects);
+
+        if ((r->viewer >= 0) && (keyframe == r->keyframe) &&
+            (queue_frame(r) == 0))
+        {
+            r->keyframe = false;
+        } else
+            r->keyframe = true;
+    } else
+        r->keyframe = true;
+
+    pthread_mutex_unlock(&r->lock);
+
+    /* What the viewer has now */
+    tmp = r->previous;
+    r->previous = r->current;
+    r->current = tmp;
+}
+
+/*
+ *
+ * Sending thread
+ *
+ */
+
+static int send_header(struct remote *r, int fd)
+{
+    unsigned char h[REMOTE_HEADER_SIZE];
+
+    memcpy(h, REMOTE_MAGIC, 4);
+    put_le32(h + 4, REMOTE_VERSION);
+    put_le32(h + 8, r->current->w);
+    put_le32(h + 12, r->current->h);
+    put_le32(h + 16, bitmap_color_depth(r->current));
+
+    return send_all(fd, h, sizeof(h));
+}
+
+/* A single viewer at a time, the first one to connect */
+static void accept_viewer(struct remote *r)
+{
+    struct pollfd p;
+    int fd;
+
+    p.fd = r->listen_fd;
+    p.events = POLLIN;
+
+    if (poll(&p, 1, REMOTE_POLL_MSEC) <= 0)
+        return;
+
+    fd = accept(r->listen_fd, NULL, NULL);
+
+    if (fd < 0)
+        return;
+
+    if (send_header(r, fd) < 0) {
+        close(fd);
+        return;
+    }
+
+    pthread_mutex_lock(&r->lock);
+    r->viewer = fd;
+    r->keyframe = true;
+    pthread_mutex_unlock(&r->lock);
+}
+
+static void *remote_thread(void *arg)
+{
+    struct remote *r = (struct remote *)arg;
+    struct remote_frame *f;
+    struct timespec t;
+    int fd;
+
+    pthread_mutex_lock(&r->lock);
+
+    while (r->stop == false) {
+        if (r->viewer < 0) {
+            pthread_mutex_unlock(&r->lock);
+            accept_viewer(r);
+            pthread_mutex_lock(&r->lock);
+            continue;
+        }
+
+        if (NULL == r->first) {
+            clock_gettime(CLOCK_REALTIME, &t);
+            t.tv_nsec += REMOTE_POLL_MSEC * 1000000L;
+            t.tv_sec += t.tv_nsec / 1000000000L;
+            t.tv_nsec %= 1000000000L;
+            pthread_cond_timedwait(&r->cond, &r->lock, &t);
+            continue;
+        }
+
+        f = r->first;
+        r->first = f->next;
+
+        if (NULL == r->first)
+            r->last = NULL;
+
+        r->queued--;
+        fd = r->viewer;
+        pthread_mutex_unlock(&r->lock);
+
+        if (send_all(fd, f->data, f->size) < 0) {
+            pthread_mutex_lock(&r->lock);
+            close(r->viewer);
+            r->viewer = -1;
+            free_frames(r);
+            pthread_mutex_unlock(&r->lock);
+        }
+
+        free(f->data);
+        free(f);
+        pthread_mutex_lock(&r->lock);
+    }
+
+    pthread_mutex_unlock(&r->lock);
+
+    return NULL;
+}
+
+/*
+ *
+ * Internal API
+ *
+ */
+
+static int listen_socket(const char *path)
+{
+    struct sockaddr_un addr;
+    int fd;
+
+    if (strlen(path) >= sizeof(addr.sun_path))
+        return -1;
+
+    fd = socket(AF_UNIX, SOCK_STREAM, 0);
+
+    if (fd < 0)
+        return -1;
+
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    strcpy(addr.sun_path, path);
+
+    /* Left by a previous run */
+    unlink(path);
+
+    if ((bind(fd, (struct sockaddr *)&addr, sizeof(addr)) < 0) ||
+        (listen(fd, 1) < 0))
+    {
+        close(fd);
+        return -1;
+    }
+
+    return fd;
+}
+
+static void destroy_remote(struct remote *r)
+{
+    if (r->listen_fd >= 0) {
+        close(r->listen_fd);
+        unlink(r->path);
+    }
+
+    if (r->viewer >= 0)
+        close(r->viewer);
+
+    free_frames(r);
+
+    if (r->current != NULL)
+        destroy_bitmap(r->current);
+
+    if (r->previous != NULL)
+        destroy_bitmap(r->previous);
+
+    if (r->buffer != NULL)
+        free(r->buffer);
+
+    if (r->path != NULL)
+        free(r->path);
+
+    pthread_cond_destroy(&r->cond);
+    pthread_mutex_destroy(&r->lock);
+    free(r);
+}
+
+static struct remote *new_remote(struct grc_s *grc, const char *path)
+{
+    struct remote *r;
+    int w, h, depth;
+
+    r = calloc(1, sizeof(struct remote));
+
+    if (NULL == r) {
+        grc_set_errno(GRC_ERROR_MEMORY);
+        return NULL;
+    }
+
+    pthread_mutex_init(&r->lock, NULL);
+    pthread_cond_init(&r->cond, NULL);
+    r->listen_fd = -1;
+    r->viewer = -1;
+
+    w = info_get_value(grc->info, INFO_WIDTH);
+    h = info_get_value(grc->info, INFO_HEIGHT);
+    depth = info_color_depth(grc);
+    r->bpp = (depth + 7) / 8;
+    r->path = strdup(path);
+    r->current = create_bitmap_ex(depth, w, h);
+    r->previous = create_bitmap_ex(depth, w, h);
+
+    if ((NULL == r->path) || (NULL == r->current) || (NULL == r->previous)) {
+        grc_set_errno(GRC_ERROR_MEMORY);
+        goto error_block;
+    }
+
+    r->listen_fd = listen_socket(path);
+
+    if (r->listen_fd < 0) {
+        grc_set_errno(GRC_ERROR_REMOTE_SOCKET);
+        goto error_block;
+    }
+
+    return r;
+
+error_block:
+    destroy_remote(r);
+
+    return NULL;
+}
+
+/* Waits for a frame being encoded by the DIALOG thread */
+void remote_stop(struct grc_s *grc)
+{
+    struct remote *r;
+
+    session_gui_lock();
+    r = grc->remote;
+    grc->remote = NULL;
+    session_gui_unlock();
+
+    if (NULL == r)
+        return;
+
+    pthread_mutex_lock(&r->lock);
+    r->stop = true;
+    pthread_cond_signal(&r->cond);
+    pthread_mutex_unlock(&r->lock);
+
+    pthread_join(r->thread, NULL);
+    destroy_remote(r);
+}
+
+/*
+ *
+ * API
+ *
+ */
+
+int LIBEXPORT grc_remote_start(grc_t *grc, const char *socket_path)
+{
+    struct grc_s *g = (struct grc_s *)grc;
+    struct remote *r;
+
+    grc_errno_clear();
+
+    if ((NULL == grc) || (NULL == socket_path)) {
+        grc_set_errno(GRC_ERROR_NULL_ARG);
+        return -1;
+    }
+
+    if (g->remote != NULL) {
+        grc_set_errno(GRC_ERROR_REMOTE_RUNNING);
+        return -1;
+    }
+
+    r = new_remote(g, socket_path);
+
+    if (NULL == r)
+        return -1;
+
+    if (pthread_create(&r->thread, NULL, remote_thread, r) != 0) {
+        destroy_remote(r);
+        grc_set_errno(GRC_ERROR_MEMORY);
+        return -1;
+    }
+
+    /* Frames are only encoded from here on */
+    session_gui_lock();
+    g->remote = r;
+    session_gui_unlock();
+
+    return 0;
+}
+
+int LIBEXPORT grc_remote_stop(grc_t *grc)
+{
+    struct grc_s *g = (struct grc_s *)grc;
+
+    grc_errno_clear();
+
+    if (NULL == grc) {
+        grc_set_errno(GRC_ERROR_NULL_ARG);
+        return -1;
+    }
+
+    remote_stop(g);
+
+    return 0;
+}
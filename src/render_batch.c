@@ -0,0 +1,303 @@
+/*
+ * Description: Renders many GRCs into image files, using several threads.
+ *
+ * Author: Rodrigo Freitas
+ * Created at: Mon Oct 19 22:08:37 2026
+ * Project: libgrc
+ *
+ * Copyright (c) 2014 Rodrigo Freitas
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301
+ * USA
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <limits.h>
+
+#include <pthread.h>
+
+#include "libgrc.h"
+
+/* Rendered images are saved by Allegro, which chooses the format from it */
+#define RENDER_OUTPUT_EXT           ".bmp"
+
+/*
+ * GRCs still to be rendered by a worker, from @next to @end. The worker
+ * takes them from the front, while the others, once they have nothing left,
+ * steal from the back.
+ */
+struct render_queue {
+    pthread_mutex_t     lock;
+    unsigned int        next;
+    unsigned int        end;
+};
+
+struct render_batch {
+    const char          **paths;
+    const char          *out_dir;
+    unsigned int        n_workers;
+    struct render_queue *queues;
+
+    /* GRCs which could not be rendered */
+    pthread_mutex_t     lock;
+    unsigned int        failed;
+};
+
+struct render_worker {
+    pthread_t           thread;
+    unsigned int        id;
+    struct render_batch *batch;
+};
+
+static bool queue_pop(struct render_queue *q, unsigned int *index)
+{
+    bool ret = false;
+
+    pthread_mutex_lock(&q->lock);
+
+    if (q->next < q->end) {
+        *index = q->next++;
+        ret = true;
+    }
+
+    pthread_mutex_unlock(&q->lock);
+
+    return ret;
+}
+
+/*
+ * Moves the back half of the fullest queue to the empty one of worker @id.
+ * Returns false when there is nothing left to render.
+ */
+static bool queue_steal(struct render_batch *b, unsigned int id)
+{
+    struct render_queue *victim = NULL, *q;
+    unsigned int i, left, most = 0, start, end;
+
+    for (i = 0; i < b->n_workers; i++) {
+        if (i == id)
+            continue;
+
+        q = &b->queues[i];
+        pthread_mutex_lock(&q->lock);
+        left = q->end - q->next;
+        pthread_mutex_unlock(&q->lock);
+
+        if (left > most) {
+            most = left;
+            victim = q;
+        }
+    }
+
+    if (NULL == victim)
+        return false;
+
+    /* It may have been emptied since it was looked at */
+    pthread_mutex_lock(&victim->lock);
+    left = victim->end - victim->next;
+    end = victim->end;
+    start = end - (left + 1) / 2;
+    victim->end = start;
+    pthread_mutex_unlock(&victim->lock);
+
+    q = &b->queues[id];
+    pthread_mutex_lock(&q->lock);
+    q->next = start;
+    q->end = end;
+    pthread_mutex_unlock(&q->lock);
+
+    return true;
+}
+
+/* The output is the GRC file name, inside @out_dir, with the image extension */
+static int output_path(const char *path, const char *out_dir, char *output,
+    size_t size)
+{
+    const char *name, *ext;
+    int n, l;
+
+    name = strrchr(path, '/');
+    name = (name != NULL) ? name + 1 : path;
+    ext = strrchr(name, '.');
+    l = (ext != NULL) ? ext - name : (int)strlen(name);
+    n = snprintf(output, size, "%s/%.*s%s", out_dir, l, name,
+                 RENDER_OUTPUT_EXT);
+
+    if ((n < 0) || ((size_t)n >= size)) {
+        grc_set_errno(GRC_ERROR_RENDER_OUTPUT);
+        return -1;
+    }
+
+    return 0;
+}
+
+static int render_grc(const char *path, const char *out_dir)
+{
+    struct grc_s *grc;
+    char output[PATH_MAX];
+    int ret = -1;
+
+    if (output_path(path, out_dir, output, sizeof(output)) < 0)
+        return -1;
+
+    grc = grc_load_headless(path);
+
+    if (NULL == grc)
+        return -1;
+
+    if ((grc_prepare_dialog(grc) < 0) || (grc_render(grc) < 0))
+        goto end_block;
+
+    /*
+     * The framebuffer belongs to this GRC alone, so it is saved while the
+     * other workers are drawing.
+     */
+    if (save_bitmap(output, grc->framebuffer, NULL) != 0) {
+        grc_set_errno(GRC_ERROR_RENDER_OUTPUT);
+        goto end_block;
+    }
+
+    ret = 0;
+
+end_block:
+    destroy_grc(grc);
+
+    return ret;
+}
+
+static void *render_worker(void *arg)
+{
+    struct render_worker *w = (struct render_worker *)arg;
+    struct render_batch *b = w->batch;
+    unsigned int index, failed = 0;
+
+    do {
+        while (queue_pop(&b->queues[w->id], &index) == true)
+            if (render_grc(b->paths[index], b->out_dir) < 0)
+                failed++;
+    } while (queue_steal(b, w->id) == true);
+
+    pthread_mutex_lock(&b->lock);
+    b->failed += failed;
+    pthread_mutex_unlock(&b->lock);
+
+    return NULL;
+}
+
+static unsigned int online_cpus(void)
+{
+    long n;
+
+    n = sysconf(_SC_NPROCESSORS_ONLN);
+
+    return (n > 0) ? (unsigned int)n : 1;
+}
+
+/*
+ *
+ * API
+ *
+ */
+
+int LIBEXPORT grc_render_batch(const char **paths, unsigned int n,
+    const char *out_dir, unsigned int threads)
+{
+    struct render_batch b;
+    struct render_worker *workers = NULL;
+    unsigned int i, started = 0;
+    int ret = -1;
+
+    grc_errno_clear();
+
+    if ((NULL == paths) || (NULL == out_dir)) {
+        grc_set_errno(GRC_ERROR_NULL_ARG);
+        return -1;
+    }
+
+    if (n == 0)
+        return 0;
+
+    if (threads == 0)
+        threads = online_cpus();
+
+    if (threads > n)
+        threads = n;
+
+    memset(&b, 0, sizeof(b));
+    b.paths = paths;
+    b.out_dir = out_dir;
+    b.n_workers = threads;
+    b.queues = calloc(threads, sizeof(struct render_queue));
+    workers = calloc(threads, sizeof(struct render_worker));
+
+    if ((NULL == b.queues) || (NULL == workers)) {
+        grc_set_errno(GRC_ERROR_MEMORY);
+        goto end_block;
+    }
+
+    pthread_mutex_init(&b.lock, NULL);
+
+    /* Every worker starts with its own contiguous share of the GRCs */
+    for (i = 0; i < threads; i++) {
+        pthread_mutex_init(&b.queues[i].lock, NULL);
+        b.queues[i].next = (unsigned long long)n * i / threads;
+        b.queues[i].end = (unsigned long long)n * (i + 1) / threads;
+    }
+
+    /* Allegro and the loaded fonts are kept for the whole batch */
+    grc_session_begin();
+
+    for (i = 0; i < threads; i++) {
+        workers[i].id = i;
+        workers[i].batch = &b;
+
+        if (pthread_create(&workers[i].thread, NULL, render_worker,
+                           &workers[i]) != 0)
+        {
+            break;
+        }
+
+        started++;
+    }
+
+    /* Whatever is left to a worker not started is stolen by the others */
+    for (i = 0; i < started; i++)
+        pthread_join(workers[i].thread, NULL);
+
+    grc_session_end();
+
+    for (i = 0; i < threads; i++)
+        pthread_mutex_destroy(&b.queues[i].lock);
+
+    pthread_mutex_destroy(&b.lock);
+
+    if (started == 0) {
+        grc_set_errno(GRC_ERROR_MEMORY);
+        goto end_block;
+    }
+
+    ret = b.failed;
+
+end_block:
+    if (workers != NULL)
+        free(workers);
+
+    if (b.queues != NULL)
+        free(b.queues);
+
+    return ret;
+}
@@ -0,0 +1,97 @@
+/*
+ * Description: Functions to scale a GRC written for one resolution to the
+ *              resolution it really runs.
+ *
+ * Author: Rodrigo Freitas
+ * Created at: Mon Oct 19 18:47:15 2026
+ * Project: libgrc
+ *
+ * Copyright (c) 2014 Rodrigo Freitas
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301
+ * USA
+ */
+
+#include "libgrc.h"
+
+/*
+ * Everything is scaled only once, while the GRC is loaded or when an image
+ * is given to an object, so drawing costs the same at any resolution.
+ */
+
+bool scale_enabled(struct grc_s *grc)
+{
+    int dw, dh;
+
+    dw = info_get_value(grc->info, INFO_DESIGN_WIDTH);
+    dh = info_get_value(grc->info, INFO_DESIGN_HEIGHT);
+
+    if ((dw <= 0) || (dh <= 0))
+        return false;
+
+    return (dw != info_get_value(grc->info, INFO_WIDTH)) ||
+           (dh != info_get_value(grc->info, INFO_HEIGHT));
+}
+
+static int scale(int value, int real, int design)
+{
+    /* Unset positions and sizes stay unset */
+    if ((value < 0) || (design <= 0))
+        return value;
+
+    return (value * real + design / 2) / design;
+}
+
+int scale_x(struct grc_s *grc, int value)
+{
+    return scale(value, info_get_value(grc->info, INFO_WIDTH),
+                 info_get_value(grc->info, INFO_DESIGN_WIDTH));
+}
+
+int scale_y(struct grc_s *grc, int value)
+{
+    return scale(value, info_get_value(grc->info, INFO_HEIGHT),
+                 info_get_value(grc->info, INFO_DESIGN_HEIGHT));
+}
+
+/*
+ * Replaces @bmp by a scaled copy. It must be a bitmap owned by the library,
+ * since the original one is destroyed. If the copy can't be created @bmp is
+ * kept, and drawn at its own size.
+ */
+BITMAP *scale_image(struct grc_s *grc, BITMAP *bmp)
+{
+    BITMAP *s;
+    int w, h;
+
+    if ((NULL == bmp) || (scale_enabled(grc) == false))
+        return bmp;
+
+    w = scale_x(grc, bmp->w);
+    h = scale_y(grc, bmp->h);
+
+    if ((w <= 0) || (h <= 0) || ((w == bmp->w) && (h == bmp->h)))
+        return bmp;
+
+    s = create_bitmap_ex(bitmap_color_depth(bmp), w, h);
+
+    if (NULL == s)
+        return bmp;
+
+    stretch_blit(bmp, s, 0, 0, bmp->w, bmp->h, 0, 0, w, h);
+    destroy_bitmap(bmp);
+
+    return s;
+}
@@ -0,0 +1,326 @@
+/*
+ * Description: Saves the screen of a DIALOG, or a single object of it, to an
+ *              image file, without stopping the DIALOG.
+ *
+ * Author: Rodrigo Freitas
+ * Created at: Mon Oct 19 22:44:12 2026
+ * Project: libgrc
+ *
+ * Copyright (c) 2014 Rodrigo Freitas
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301
+ * USA
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <strings.h>
+
+#include <pthread.h>
+
+#include "libgrc.h"
+
+/* Screenshots copied but not saved yet, before new ones are refused */
+#define MAX_PENDING_SCREENSHOTS     16
+
+#define BMP_HEADER_SIZE             54
+
+struct screenshot {
+    struct screenshot   *next;
+    BITMAP              *bmp;
+    PALETTE             pal;
+    char                *path;
+};
+
+/*
+ * Only the copy of the screen is made by the caller. Screenshots are saved,
+ * in the order they were taken, by a thread started with the first one and
+ * stopped when Allegro is.
+ */
+static struct {
+    pthread_mutex_t     lock;
+    pthread_cond_t      cond;
+    pthread_t           thread;
+    bool                running;
+    bool                stop;
+    unsigned int        pending;
+    struct screenshot   *first;
+    struct screenshot   *last;
+} __screenshots = {
+    .lock = PTHREAD_MUTEX_INITIALIZER,
+    .cond = PTHREAD_COND_INITIALIZER,
+};
+
+static void destroy_screenshot(struct screenshot *s)
+{
+    if (s->bmp != NULL)
+        destroy_bitmap(s->bmp);
+
+    if (s->path != NULL)
+        free(s->path);
+
+    free(s);
+}
+
+static bool is_bmp(const char *path)
+{
+    const char *ext = strrchr(path, '.');
+
+    return (ext != NULL) && (strcasecmp(ext, ".bmp") == 0);
+}
+
+/*
+ * Allegro keeps 24 and 32 bit pixels in the same byte order as BMP files, so
+ * their lines are written as they are, instead of pixel by pixel like
+ * save_bitmap does.
+ */
+static int save_bmp_lines(const char *path, BITMAP *bmp)
+{
+    unsigned char h[BMP_HEADER_SIZE], pad[3] = { 0, 0, 0 };
+    unsigned int bpp, line, padding, image;
+    FILE *f;
+    int y, ret = 0;
+
+    bpp = bitmap_color_depth(bmp) / 8;
+    line = bmp->w * bpp;
+    padding = (4 - (line % 4)) % 4;
+    image = (line + padding) * bmp->h;
+
+    memset(h, 0, sizeof(h));
+    h[0] = 'B';
+    h[1] = 'M';
+    put_le32(h + 2, BMP_HEADER_SIZE + image);
+    put_le32(h + 10, BMP_HEADER_SIZE);
+    put_le32(h + 14, 40);
+    put_le32(h + 18, bmp->w);
+    put_le32(h + 22, bmp->h);
+    put_le16(h + 26, 1);
+    put_le16(h + 28, bpp * 8);
+    put_le32(h + 34, image);
+
+    f = fopen(path, "wb");
+
+    if (NULL == f)
+        return -1;
+
+    if (fwrite(h, sizeof(h), 1, f) != 1)
+        ret = -1;
+
+    /* Lines are stored from the bottom */
+    for (y = bmp->h - 1; (y >= 0) && (ret == 0); y--) {
+        if ((fwrite(bmp->line[y], 1, line, f) != line) ||
+            ((padding > 0) && (fwrite(pad, 1, padding, f) != padding)))
+        {
+            ret = -1;
+        }
+    }
+
+    if (fclose(f) != 0)
+        ret = -1;
+
+    return ret;
+}
+
+static void save_screenshot(struct screenshot *s)
+{
+    int depth = bitmap_color_depth(s->bmp);
+
+    if (is_bmp(s->path) && ((depth == 24) || (depth == 32)))
+        save_bmp_lines(s->path, s->bmp);
+    else
+        save_bitmap(s->path, s->bmp, s->pal);
+}
+
+static void *screenshot_thread(void *arg __attribute__((unused)))
+{
+    struct screenshot *s;
+
+    pthread_mutex_lock(&__screenshots.lock);
+
+    while (true) {
+        while ((NULL == __screenshots.first) && (__screenshots.stop == false))
+            pthread_cond_wait(&__screenshots.cond, &__screenshots.lock);
+
+        /* Whatever was taken is saved before it stops */
+        s = __screenshots.first;
+
+        if (NULL == s)
+            break;
+
+        __screenshots.first = s->next;
+
+        if (NULL == __screenshots.first)
+            __screenshots.last = NULL;
+
+        pthread_mutex_unlock(&__screenshots.lock);
+        save_screenshot(s);
+        destroy_screenshot(s);
+        pthread_mutex_lock(&__screenshots.lock);
+        __screenshots.pending--;
+    }
+
+    pthread_mutex_unlock(&__screenshots.lock);
+
+    return NULL;
+}
+
+static int queue_screenshot(struct screenshot *s)
+{
+    int ret = -1;
+
+    pthread_mutex_lock(&__screenshots.lock);
+
+    if (__screenshots.pending >= MAX_PENDING_SCREENSHOTS) {
+        grc_set_errno(GRC_ERROR_SCREENSHOT_QUEUE_FULL);
+        goto end_block;
+    }
+
+    if (__screenshots.running == false) {
+        __screenshots.stop = false;
+
+        if (pthread_create(&__screenshots.thread, NULL, screenshot_thread,
+                           NULL) != 0)
+        {
+            grc_set_errno(GRC_ERROR_MEMORY);
+            goto end_block;
+        }
+
+        __screenshots.running = true;
+    }
+
+    s->next = NULL;
+
+    if (__screenshots.last != NULL)
+        __screenshots.last->next = s;
+    else
+        __screenshots.first = s;
+
+    __screenshots.last = s;
+    __screenshots.pending++;
+    pthread_cond_signal(&__screenshots.cond);
+    ret = 0;
+
+end_block:
+    pthread_mutex_unlock(&__screenshots.lock);
+
+    return ret;
+}
+
+/*
+ * Waits until every screenshot is saved, since their bitmaps can't outlive
+ * Allegro.
+ */
+void screenshot_finish(void)
+{
+    pthread_mutex_lock(&__screenshots.lock);
+
+    if (__screenshots.running == false) {
+        pthread_mutex_unlock(&__screenshots.lock);
+        return;
+    }
+
+    __screenshots.stop = true;
+    pthread_cond_signal(&__screenshots.cond);
+    pthread_mutex_unlock(&__screenshots.lock);
+
+    pthread_join(__screenshots.thread, NULL);
+
+    pthread_mutex_lock(&__screenshots.lock);
+    __screenshots.running = false;
+    pthread_mutex_unlock(&__screenshots.lock);
+}
+
+/*
+ *
+ * API
+ *
+ */
+
+int LIBEXPORT grc_screenshot(grc_t *grc, const char *tag, const char *path)
+{
+    struct grc_s *g = (struct grc_s *)grc;
+    struct screenshot *s = NULL;
+    BITMAP *src;
+    DIALOG *d;
+    int x = 0, y = 0, w, h;
+
+    grc_errno_clear();
+
+    if ((NULL == grc) || (NULL == path)) {
+        grc_set_errno(GRC_ERROR_NULL_ARG);
+        return -1;
+    }
+
+    src = (g->framebuffer != NULL) ? g->framebuffer : gui_get_screen();
+
+    if (NULL == src) {
+        grc_set_errno(GRC_ERROR_UNSUPPORTED_BY_BACKEND);
+        return -1;
+    }
+
+    w = src->w;
+    h = src->h;
+
+    if (tag != NULL) {
+        d = grc_get_DIALOG_from_tag(grc, tag);
+
+        if (NULL == d)
+            return -1;
+
+        /* Only what is inside the screen */
+        x = MAX(d->x, 0);
+        y = MAX(d->y, 0);
+        w = MIN(d->x + d->w, src->w) - x;
+        h = MIN(d->y + d->h, src->h) - y;
+
+        if ((w <= 0) || (h <= 0)) {
+            grc_set_errno(GRC_ERROR_OBJECT_OFF_SCREEN);
+            return -1;
+        }
+    }
+
+    s = calloc(1, sizeof(struct screenshot));
+
+    if (NULL == s) {
+        grc_set_errno(GRC_ERROR_MEMORY);
+        return -1;
+    }
+
+    s->path = strdup(path);
+    s->bmp = create_bitmap_ex(bitmap_color_depth(src), w, h);
+
+    if ((NULL == s->path) || (NULL == s->bmp)) {
+        grc_set_errno(GRC_ERROR_MEMORY);
+        goto error_block;
+    }
+
+    /*
+     * A single blit, without waiting for the DIALOG. It may catch an object
+     * in the middle of being drawn.
+     */
+    blit(src, s->bmp, x, y, 0, 0, w, h);
+    get_palette(s->pal);
+
+    if (queue_screenshot(s) < 0)
+        goto error_block;
+
+    return 0;
+
+error_block:
+    destroy_screenshot(s);
+
+    return -1;
+}
@@ -0,0 +1,279 @@
+/*
+ * Description: Functions to share a single Allegro initialization, and its
+ *              graphic mode, between every DIALOG of a process.
+ *
+ * Author: Rodrigo Freitas
+ * Created at: Mon Oct 19 15:52:23 2026
+ * Project: libgrc
+ *
+ * Copyright (c) 2014 Rodrigo Freitas
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301
+ * USA
+ */
+
+#include <pthread.h>
+
+#include "libgrc.h"
+
+/*
+ * Allegro is initialized by the first DIALOG and only finished when nobody
+ * else uses it. Every loaded GRC holds a reference, as does the user between
+ * grc_session_begin and grc_session_end.
+ */
+struct session {
+    pthread_mutex_t     lock;
+    unsigned int        refs;
+    unsigned int        user_refs;  /** References from grc_session_begin */
+    bool                installed;
+    bool                mouse;
+    enum grc_backend    backend;
+
+    /* Current graphic mode, while @installed */
+    int                 width;
+    int                 height;
+    int                 color_depth;
+};
+
+static struct session __session = {
+    .lock = PTHREAD_MUTEX_INITIALIZER,
+};
+
+/*
+ * Allegro keeps the GUI state in globals (the font, the screen it draws to,
+ * the color depth, the active DIALOG...), so only one thread may use it at
+ * a time. It is recursive since callbacks run with it already held.
+ */
+static pthread_mutex_t __gui_lock = PTHREAD_RECURSIVE_MUTEX_INITIALIZER_NP;
+
+/*
+ * The memory backend needs no system driver, and works even without a
+ * keyboard, since its keys are injected.
+ */
+static int session_install(enum grc_backend backend)
+{
+    bool memory = (backend == GRC_BACKEND_MEMORY);
+
+    if (install_allegro(memory ? SYSTEM_NONE : SYSTEM_AUTODETECT, NULL,
+                        NULL))
+    {
+        grc_set_errno(GRC_ERROR_LIB_INIT);
+        return -1;
+    }
+
+    if (install_keyboard() && (memory == false)) {
+        allegro_exit();
+        grc_set_errno(GRC_ERROR_KEYBOARD_INIT);
+        return -1;
+    }
+
+    install_timer();
+    font_install();
+    latency_install();
+
+    if (memory == true)
+        headless_install();
+
+    __session.installed = true;
+    __session.backend = backend;
+    __session.mouse = false;
+    __session.width = 0;
+    __session.height = 0;
+    __session.color_depth = 0;
+
+    return 0;
+}
+
+/* Turn back to text mode */
+static void session_uninstall(void)
+{
+    screenshot_finish();
+    font_uninstall();
+
+    if (__session.backend == GRC_BACKEND_MEMORY)
+        headless_uninstall();
+    else {
+        cl_msleep(100);
+        set_gfx_mode(GFX_TEXT, 0, 0, 0, 0);
+    }
+
+    latency_uninstall();
+    remove_keyboard();
+    allegro_exit();
+    __session.installed = false;
+}
+
+/*
+ * Changes the graphic mode only if it is not the one already in use, which
+ * is what saves the time of a DIALOG opened after another one. The screen
+ * is shared, so it can't change while other DIALOGs are prepared, only
+ * when the session alone keeps Allegro.
+ */
+static int session_set_mode(struct grc_s *grc)
+{
+    int w, h, depth;
+
+    w = info_get_value(grc->info, INFO_WIDTH);
+    h = info_get_value(grc->info, INFO_HEIGHT);
+    depth = info_color_depth(grc);
+
+    if ((w == __session.width) && (h == __session.height) &&
+        (depth == __session.color_depth))
+    {
+        return 0;
+    }
+
+    /* Every DIALOG of the memory backend has its own framebuffer */
+    if ((__session.backend != GRC_BACKEND_MEMORY) &&
+        (__session.refs > __session.user_refs))
+    {
+        grc_set_errno(GRC_ERROR_GFX_MODE_IN_USE);
+        return -1;
+    }
+
+    set_color_depth(depth);
+
+    /*
+     * With the memory backend there is no graphic mode, every DIALOG has its
+     * own framebuffer, created by gui_init.
+     */
+    if (__session.backend == GRC_BACKEND_MEMORY)
+        goto end_block;
+
+    if (set_gfx_mode(GFX_XWINDOWS, w, h, 0, 0) != 0) {
+        if (set_gfx_mode(GFX_FBCON, w, h, 0, 0) != 0) {
+            __session.width = 0;
+            grc_set_errno(GRC_ERROR_SET_GFX_MODE);
+            return -1;
+        }
+    } else {
+        if ((info_get_value(grc->info, INFO_USE_MOUSE) == true) &&
+            (__session.mouse == false))
+        {
+            install_mouse();
+            latency_install_mouse();
+            gui_mouse_focus = FALSE;
+            __session.mouse = true;
+        }
+    }
+
+end_block:
+    __session.width = w;
+    __session.height = h;
+    __session.color_depth = depth;
+    font_flush_atlases();
+
+    return 0;
+}
+
+int session_acquire(struct grc_s *grc)
+{
+    enum grc_backend backend = info_get_value(grc->info, INFO_BACKEND);
+    int ret = 0;
+
+    pthread_mutex_lock(&__session.lock);
+
+    if ((__session.installed == false) && (session_install(backend) < 0)) {
+        ret = -1;
+        goto end_block;
+    }
+
+    /* Every DIALOG of a process must use the same backend */
+    if (backend != __session.backend) {
+        grc_set_errno(GRC_ERROR_BACKEND_IN_USE);
+        ret = -1;
+        goto end_block;
+    }
+
+    if (session_set_mode(grc) < 0) {
+        if (__session.refs == 0)
+            session_uninstall();
+
+        ret = -1;
+        goto end_block;
+    }
+
+    __session.refs++;
+
+end_block:
+    pthread_mutex_unlock(&__session.lock);
+
+    return ret;
+}
+
+void session_gui_lock(void)
+{
+    pthread_mutex_lock(&__gui_lock);
+}
+
+/* Returns -1 if another thread is using Allegro */
+int session_gui_trylock(void)
+{
+    return (pthread_mutex_trylock(&__gui_lock) == 0) ? 0 : -1;
+}
+
+void session_gui_unlock(void)
+{
+    pthread_mutex_unlock(&__gui_lock);
+}
+
+void session_release(void)
+{
+    pthread_mutex_lock(&__session.lock);
+
+    if (__session.refs > 0) {
+        __session.refs--;
+
+        if ((__session.refs == 0) && (__session.installed == true))
+            session_uninstall();
+    }
+
+    pthread_mutex_unlock(&__session.lock);
+}
+
+/*
+ *
+ * API
+ *
+ */
+
+int LIBEXPORT grc_session_begin(void)
+{
+    grc_errno_clear();
+    pthread_mutex_lock(&__session.lock);
+    __session.refs++;
+    __session.user_refs++;
+    pthread_mutex_unlock(&__session.lock);
+
+    return 0;
+}
+
+int LIBEXPORT grc_session_end(void)
+{
+    grc_errno_clear();
+    pthread_mutex_lock(&__session.lock);
+
+    if (__session.user_refs == 0) {
+        pthread_mutex_unlock(&__session.lock);
+        grc_set_errno(GRC_ERROR_SESSION_NOT_STARTED);
+        return -1;
+    }
+
+    __session.user_refs--;
+    pthread_mutex_unlock(&__session.lock);
+    session_release();
+
+    return 0;
+}
@@ -0,0 +1,453 @@
+/*
+ * Description: Functions to save the state of a running DIALOG into a binary
+ *              snapshot and restore it later.
+ *
+ * Author: Rodrigo Freitas
+ * Created at: Mon Oct 19 15:07:48 2026
+ * Project: libgrc
+ *
+ * Copyright (c) 2014 Rodrigo Freitas
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301
+ * USA
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+
+#include "libgrc.h"
+#include "gui/objects.h"
+
+/*
+ * A snapshot is a header followed by one record for each saved object:
+ *
+ *   header: "GRCS" | version (u32) | number of records (u32)
+ *   record: tag hash (u32) | kind (u8) | payload length (u32) | payload
+ *
+ * Every number is written in little-endian. Records of an unknown kind, or
+ * whose tag is not found, are skipped using their length, so a snapshot
+ * remains usable after objects are added to or removed from the GRC.
+ */
+#define STATE_MAGIC                 "GRCS"
+#define STATE_VERSION               1
+#define STATE_HEADER_SIZE           12
+#define STATE_RECORD_HEADER_SIZE    9
+
+/* Initial size of the buffers used to save and to load a snapshot */
+#define STATE_BUFFER_SIZE           4096
+
+enum state_kind {
+    STATE_SELECTED = 1,     /* 'check_box' and 'radio': u8 */
+    STATE_POSITION,         /* 'slider' and lists: d1 (i32) | d2 (i32) */
+    STATE_TEXT,             /* 'edit' and 'textbox': d2 (i32) | text */
+    STATE_LOG               /* 'messages_log_box': lines, each one as
+                               color (i32) | length (u32) | text */
+};
+
+struct state_buffer {
+    unsigned char   *p;
+    unsigned int    size;
+    unsigned int    used;
+    bool            failed;
+};
+
+static void buffer_put(struct state_buffer *b, const void *data,
+    unsigned int n)
+{
+    unsigned int size;
+    unsigned char *p;
+
+    if (b->failed == true)
+        return;
+
+    if (b->used + n > b->size) {
+        size = (b->size > 0) ? b->size * 2 : STATE_BUFFER_SIZE;
+
+        while (b->used + n > size)
+            size *= 2;
+
+        p = realloc(b->p, size);
+
+        if (NULL == p) {
+            b->failed = true;
+            return;
+        }
+
+        b->p = p;
+        b->size = size;
+    }
+
+    memcpy(b->p + b->used, data, n);
+    b->used += n;
+}
+
+static void buffer_put_u8(struct state_buffer *b, unsigned int value)
+{
+    unsigned char c = value;
+
+    buffer_put(b, &c, 1);
+}
+
+static void buffer_put_u32(struct state_buffer *b, unsigned int value)
+{
+    unsigned char c[4];
+
+    buffer_put(b, c, put_le32(c, value));
+}
+
+/* Changes a number previously written at @offset */
+static void buffer_set_u32(struct state_buffer *b, unsigned int offset,
+    unsigned int value)
+{
+    if (b->failed == true)
+        return;
+
+    put_le32(b->p + offset, value);
+}
+
+static enum state_kind object_state_kind(DIALOG *d)
+{
+    if ((gui_object_is(d, gui_d_check_proc) == true) ||
+        (gui_object_is(d, gui_d_radio_proc) == true))
+    {
+        return STATE_SELECTED;
+    }
+
+    if ((gui_object_is(d, gui_d_slider_proc) == true) ||
+        (gui_object_is(d, gui_d_list_proc) == true) ||
+        (gui_object_is(d, gui_d_virtual_list_proc) == true) ||
+        (gui_object_is(d, gui_d_table_proc) == true))
+    {
+        return STATE_POSITION;
+    }
+
+    if ((gui_object_is(d, gui_d_edit_proc) == true) ||
+        (gui_object_is(d, gui_d_password_proc) == true) ||
+        (gui_object_is(d, gui_d_textbox_proc) == true))
+    {
+        return STATE_TEXT;
+    }
+
+    if (gui_object_is(d, gui_messages_log_proc) == true)
+        return STATE_LOG;
+
+    return 0;
+}
+
+static void save_log_line(const char *line, int fg, void *arg)
+{
+    struct state_buffer *b = (struct state_buffer *)arg;
+    unsigned int n = strlen(line);
+
+    buffer_put_u32(b, fg);
+    buffer_put_u32(b, n);
+    buffer_put(b, line, n);
+}
+
+/* Adds the record of an object, returning if it was saved or not */
+static bool save_object(struct state_buffer *b, struct grc_object_s *o)
+{
+    enum state_kind kind;
+    unsigned int offset;
+    const char *text;
+    DIALOG *d;
+
+    d = grc_object_get_DIALOG(o);
+
+    if ((NULL == d) || (NULL == o->tag))
+        return false;
+
+    kind = object_state_kind(d);
+
+    if (kind == 0)
+        return false;
+
+    buffer_put_u32(b, tag_hash(o->tag));
+    buffer_put_u8(b, kind);
+
+    /* The payload length is only known at the end */
+    offset = b->used;
+    buffer_put_u32(b, 0);
+
+    switch (kind) {
+        case STATE_SELECTED:
+            buffer_put_u8(b, (d->flags & D_SELECTED) ? 1 : 0);
+            break;
+
+        case STATE_POSITION:
+            buffer_put_u32(b, d->d1);
+            buffer_put_u32(b, d->d2);
+            break;
+
+        case STATE_TEXT:
+            text = (gui_object_is(d, gui_d_textbox_proc) == true)
+                        ? d->dp : gui_edit_get_text(d);
+
+            buffer_put_u32(b, d->d2);
+
+            if (text != NULL)
+                buffer_put(b, text, strlen(text));
+
+            break;
+
+        case STATE_LOG:
+            gui_messages_foreach(d, save_log_line, b);
+            break;
+    }
+
+    buffer_set_u32(b, offset, b->used - offset - 4);
+
+    return true;
+}
+
+static int read_buffer(int fd, struct state_buffer *b)
+{
+    unsigned char tmp[STATE_BUFFER_SIZE];
+    ssize_t r;
+
+    while ((r = read(fd, tmp, sizeof(tmp))) != 0) {
+        if (r < 0) {
+            if (errno == EINTR)
+                continue;
+
+            return -1;
+        }
+
+        buffer_put(b, tmp, r);
+
+        if (b->failed == true)
+            return -1;
+    }
+
+    return 0;
+}
+
+static void restore_log(DIALOG *d, const unsigned char *p,
+    unsigned int length)
+{
+    unsigned int n;
+    int fg;
+
+    while (length >= 8) {
+        fg = get_le32(p);
+        n = get_le32(p + 4);
+        p += 8;
+        length -= 8;
+
+        if (n > length)
+            break;
+
+        gui_messages_restore(d, (const char *)p, n, fg);
+        p += n;
+        length -= n;
+    }
+}
+
+/*
+ * Applies a single record. Records which don't match the object that has
+ * their tag are ignored.
+ */
+static void restore_object(struct grc_object_s *o, enum state_kind kind,
+    const unsigned char *p, unsigned int length)
+{
+    DIALOG *d;
+
+    d = grc_object_get_DIALOG(o);
+
+    if ((NULL == d) || (object_state_kind(d) != kind))
+        return;
+
+    switch (kind) {
+        case STATE_SELECTED:
+            if (length < 1)
+                return;
+
+            if (p[0] != 0)
+                d->flags |= D_SELECTED;
+            else
+                d->flags &= ~D_SELECTED;
+
+            break;
+
+        case STATE_POSITION:
+            if (length < 8)
+                return;
+
+            d->d1 = get_le32(p);
+            d->d2 = get_le32(p + 4);
+            break;
+
+        case STATE_TEXT:
+            if (length < 4)
+                return;
+
+            if (gui_object_is(d, gui_d_textbox_proc) == true)
+                gui_textbox_set_text(d, (const char *)p + 4, length - 4);
+            else
+                gui_edit_set_text(d, (const char *)p + 4, length - 4);
+
+            d->d2 = get_le32(p);
+
+            /* The cursor may not be outside the text */
+            if ((gui_object_is(d, gui_d_textbox_proc) == false) &&
+                ((unsigned int)d->d2 > length - 4))
+            {
+                d->d2 = length - 4;
+            }
+
+            break;
+
+        case STATE_LOG:
+            restore_log(d, p, length);
+            break;
+    }
+}
+
+/*
+ *
+ * API
+ *
+ */
+
+int LIBEXPORT grc_state_save(grc_t *grc, int fd)
+{
+    struct grc_s *g = (struct grc_s *)grc;
+    struct state_buffer b;
+    struct grc_object_s *o;
+    unsigned int records = 0;
+    int ret = 0;
+
+    grc_errno_clear();
+
+    if ((NULL == grc) || (fd < 0)) {
+        grc_set_errno(GRC_ERROR_NULL_ARG);
+        return -1;
+    }
+
+    /* The objects may not be read while the DIALOG changes them */
+    if (session_gui_trylock() < 0) {
+        grc_set_errno(GRC_ERROR_GUI_BUSY);
+        return -1;
+    }
+
+    memset(&b, 0, sizeof(struct state_buffer));
+    buffer_put(&b, STATE_MAGIC, 4);
+    buffer_put_u32(&b, STATE_VERSION);
+    buffer_put_u32(&b, 0);
+
+    for (o = g->ui_objects; o; o = o->next)
+        if (save_object(&b, o) == true)
+            records++;
+
+    session_gui_unlock();
+    buffer_set_u32(&b, 8, records);
+
+    if (b.failed == true) {
+        grc_set_errno(GRC_ERROR_MEMORY);
+        ret = -1;
+    } else if (write_all(fd, b.p, b.used) < 0) {
+        grc_set_errno(GRC_ERROR_STATE_IO);
+        ret = -1;
+    }
+
+    if (b.p != NULL)
+        free(b.p);
+
+    return ret;
+}
+
+int LIBEXPORT grc_state_restore(grc_t *grc, int fd)
+{
+    struct grc_s *g = (struct grc_s *)grc;
+    struct state_buffer b;
+    struct grc_object_s *o;
+    const unsigned char *p;
+    unsigned int records, i, length, left;
+    enum state_kind kind;
+    int ret = 0;
+
+    grc_errno_clear();
+
+    if ((NULL == grc) || (fd < 0)) {
+        grc_set_errno(GRC_ERROR_NULL_ARG);
+        return -1;
+    }
+
+    memset(&b, 0, sizeof(struct state_buffer));
+
+    if (read_buffer(fd, &b) < 0) {
+        grc_set_errno(GRC_ERROR_STATE_IO);
+        ret = -1;
+        goto end_block;
+    }
+
+    if ((b.used < STATE_HEADER_SIZE) || memcmp(b.p, STATE_MAGIC, 4) ||
+        (get_le32(b.p + 4) != STATE_VERSION))
+    {
+        grc_set_errno(GRC_ERROR_INVALID_STATE);
+        ret = -1;
+        goto end_block;
+    }
+
+    if (session_gui_trylock() < 0) {
+        grc_set_errno(GRC_ERROR_GUI_BUSY);
+        ret = -1;
+        goto end_block;
+    }
+
+    records = get_le32(b.p + 8);
+    p = b.p + STATE_HEADER_SIZE;
+    left = b.used - STATE_HEADER_SIZE;
+
+    for (i = 0; i < records; i++) {
+        if (left < STATE_RECORD_HEADER_SIZE)
+            break;
+
+        kind = p[4];
+        length = get_le32(p + 5);
+        p += STATE_RECORD_HEADER_SIZE;
+        left -= STATE_RECORD_HEADER_SIZE;
+
+        if (length > left)
+            break;
+
+        o = tag_index_get_hash(g->tags, get_le32(p - STATE_RECORD_HEADER_SIZE));
+
+        if (o != NULL)
+            restore_object(o, kind, p, length);
+
+        p += length;
+        left -= length;
+    }
+
+    /* A truncated snapshot keeps everything restored before the damage */
+    if (i < records) {
+        grc_set_errno(GRC_ERROR_INVALID_STATE);
+        ret = -1;
+    }
+
+    if (info_get_value(g->info, INFO_ARE_WE_PREPARED) == true)
+        redraw_DIALOG(g);
+
+    session_gui_unlock();
+
+end_block:
+    if (b.p != NULL)
+        free(b.p);
+
+    return ret;
+}
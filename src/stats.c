@@ -0,0 +1,304 @@
+/*
+ * Description: Statistics of a running DIALOG published in a shared memory
+ *              segment, so they can be watched by another process.
+ *
+ * Author: Rodrigo Freitas
+ * Created at: Tue Oct 20 01:12:09 2026
+ * Project: libgrc
+ *
+ * Copyright (c) 2014 Rodrigo Freitas
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301
+ * USA
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <time.h>
+
+#include <sys/mman.h>
+
+#include "libgrc.h"
+
+/* How often the memory of the malloc arenas is read, in microseconds */
+#define ARENA_INTERVAL          1000000ULL
+
+/*
+ * The page is only written by the thread running the DIALOG, which holds
+ * Allegro while doing it. Callbacks and log lines may come from any thread,
+ * so their counters are atomic.
+ */
+struct stats {
+    char                *name;
+    struct grc_stats    *page;
+
+    unsigned long long  callbacks;
+    unsigned long long  log_lines_queued;
+    unsigned long long  log_lines_dropped;
+
+    unsigned long long  frames;
+    unsigned long long  frame_time;
+    unsigned long long  max_frame_time;
+    unsigned long long  redraw_area;
+
+    /* The frame being run */
+    unsigned long long  frame_start;
+    unsigned long long  frame_area;
+
+    unsigned long long  arena_memory;
+    unsigned long long  arena_read_at;
+};
+
+static unsigned long long arena_memory(struct stats *s,
+    unsigned long long now)
+{
+    if ((s->arena_read_at == 0) || (now - s->arena_read_at >= ARENA_INTERVAL))
+    {
+        s->arena_memory = memory_in_use();
+        s->arena_read_at = now;
+    }
+
+    return s->arena_memory;
+}
+
+static void write_page(struct grc_s *grc, struct stats *s)
+{
+    struct grc_stats *page = s->page;
+    unsigned int seq = page->sequence;
+
+    __atomic_store_n(&page->sequence, seq + 1, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+
+    page->objects = cl_dll_size(grc->ui_objects);
+    page->updated_at = usec_now(CLOCK_REALTIME);
+    page->frames = s->frames;
+    page->avg_frame_time = (s->frames > 0) ? s->frame_time / s->frames : 0;
+    page->max_frame_time = s->max_frame_time;
+    page->redraw_area = s->redraw_area;
+    page->callbacks = __atomic_load_n(&s->callbacks, __ATOMIC_RELAXED);
+    page->log_lines_queued = __atomic_load_n(&s->log_lines_queued,
+                                             __ATOMIC_RELAXED);
+
+    page->log_lines_dropped = __atomic_load_n(&s->log_lines_dropped,
+                                              __ATOMIC_RELAXED);
+
+    page->arena_memory = arena_memory(s, usec_now(CLOCK_MONOTONIC));
+
+    __atomic_store_n(&page->sequence, seq + 2, __ATOMIC_RELEASE);
+}
+
+static void close_page(struct stats *s)
+{
+    if (NULL == s->page)
+        return;
+
+    munmap(s->page, sizeof(struct grc_stats));
+    shm_unlink(s->name);
+    free(s->name);
+    s->page = NULL;
+    s->name = NULL;
+}
+
+static int open_page(struct stats *s, const char *name)
+{
+    int fd;
+
+    /* Shared memory names start with a slash */
+    if (asprintf(&s->name, "%s%s", (name[0] == '/') ? "" : "/", name) < 0) {
+        grc_set_errno(GRC_ERROR_MEMORY);
+        return -1;
+    }
+
+    fd = shm_open(s->name, O_CREAT | O_RDWR, 0644);
+
+    if (fd < 0)
+        goto error_block;
+
+    if (ftruncate(fd, sizeof(struct grc_stats)) < 0) {
+        close(fd);
+        shm_unlink(s->name);
+        goto error_block;
+    }
+
+    s->page = mmap(NULL, sizeof(struct grc_stats), PROT_READ | PROT_WRITE,
+                   MAP_SHARED, fd, 0);
+
+    close(fd);
+
+    if (MAP_FAILED == s->page) {
+        s->page = NULL;
+        shm_unlink(s->name);
+        goto error_block;
+    }
+
+    memset(s->page, 0, sizeof(struct grc_stats));
+    s->page->magic = GRC_STATS_MAGIC;
+    s->page->version = GRC_STATS_VERSION;
+    s->page->size = sizeof(struct grc_stats);
+    s->page->pid = getpid();
+
+    return 0;
+
+error_block:
+    free(s->name);
+    s->name = NULL;
+    grc_set_errno(GRC_ERROR_STATS_SHM);
+
+    return -1;
+}
+
+void stats_destroy(struct grc_s *grc)
+{
+    close_page(grc->stats);
+    free(grc->stats);
+    grc->stats = NULL;
+}
+
+/*
+ * Objects are redrawn by Allegro when they are dirty, so a frame redraws
+ * every one marked at its beginning, or all of them when @redraw is set.
+ */
+void stats_frame_begin(struct grc_s *grc, bool redraw)
+{
+    struct stats *s = grc->stats;
+    DIALOG *d;
+
+    if ((NULL == s) || (NULL == s->page))
+        return;
+
+    s->frame_area = 0;
+
+    for (d = grc->dlg; d->proc != NULL; d++) {
+        if (d->flags & D_HIDDEN)
+            continue;
+
+        if ((redraw == true) || (d->flags & D_DIRTY))
+            s->frame_area += (unsigned long long)d->w * d->h;
+    }
+
+    s->frame_start = usec_now(CLOCK_MONOTONIC);
+}
+
+void stats_frame_end(struct grc_s *grc)
+{
+    struct stats *s = grc->stats;
+    unsigned long long elapsed;
+
+    if ((NULL == s) || (NULL == s->page))
+        return;
+
+    /* Like the profiling, frames which drew nothing are not counted */
+    if (s->frame_area > 0) {
+        elapsed = usec_now(CLOCK_MONOTONIC) - s->frame_start;
+        s->frames++;
+        s->frame_time += elapsed;
+        s->max_frame_time = MAX(s->max_frame_time, elapsed);
+        s->redraw_area += s->frame_area;
+    }
+
+    write_page(grc, s);
+}
+
+void stats_callback(struct grc_s *grc)
+{
+    if ((NULL == grc) || (NULL == grc->stats))
+        return;
+
+    __atomic_fetch_add(&grc->stats->callbacks, 1, __ATOMIC_RELAXED);
+}
+
+void stats_log(struct grc_s *grc, unsigned int queued, unsigned int dropped)
+{
+    struct stats *s = grc->stats;
+
+    if (NULL == s)
+        return;
+
+    __atomic_fetch_add(&s->log_lines_queued, queued, __ATOMIC_RELAXED);
+    __atomic_fetch_add(&s->log_lines_dropped, dropped, __ATOMIC_RELAXED);
+}
+
+/*
+ *
+ * API
+ *
+ */
+
+int LIBEXPORT grc_stats_publish(grc_t *grc, const char *name)
+{
+    struct grc_s *g = (struct grc_s *)grc;
+    struct stats *s;
+    int ret = -1;
+
+    grc_errno_clear();
+
+    if ((NULL == grc) || (NULL == name)) {
+        grc_set_errno(GRC_ERROR_NULL_ARG);
+        return -1;
+    }
+
+    session_gui_lock();
+
+    /* Counters are kept between publications */
+    if (NULL == g->stats) {
+        g->stats = calloc(1, sizeof(struct stats));
+
+        if (NULL == g->stats) {
+            grc_set_errno(GRC_ERROR_MEMORY);
+            goto end_block;
+        }
+    }
+
+    s = g->stats;
+
+    if (s->page != NULL) {
+        grc_set_errno(GRC_ERROR_STATS_PUBLISHED);
+        goto end_block;
+    }
+
+    if (open_page(s, name) < 0)
+        goto end_block;
+
+    write_page(g, s);
+    ret = 0;
+
+end_block:
+    session_gui_unlock();
+
+    return ret;
+}
+
+int LIBEXPORT grc_stats_unpublish(grc_t *grc)
+{
+    struct grc_s *g = (struct grc_s *)grc;
+
+    grc_errno_clear();
+
+    if (NULL == grc) {
+        grc_set_errno(GRC_ERROR_NULL_ARG);
+        return -1;
+    }
+
+    if (NULL == g->stats)
+        return 0;
+
+    session_gui_lock();
+    close_page(g->stats);
+    session_gui_unlock();
+
+    return 0;
+}
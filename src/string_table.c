@@ -0,0 +1,82 @@
+/*
+ * Description: Strings kept together in a single block of memory.
+ *
+ * Author: Rodrigo Freitas
+ * Created at: Tue Oct 20 02:20:37 2026
+ * Project: libgrc
+ *
+ * Copyright (c) 2014 Rodrigo Freitas
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301
+ * USA
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "libgrc.h"
+
+/*
+ * The size of the table is known when it's created, so its strings are
+ * never moved.
+ */
+struct string_table {
+    size_t  size;
+    size_t  used;
+    char    data[];
+};
+
+struct string_table *new_string_table(size_t size)
+{
+    struct string_table *t;
+
+    t = malloc(sizeof(struct string_table) + size);
+
+    if (NULL == t) {
+        grc_set_errno(GRC_ERROR_MEMORY);
+        return NULL;
+    }
+
+    t->size = size;
+    t->used = 0;
+
+    return t;
+}
+
+void destroy_string_table(struct string_table *t)
+{
+    free(t);
+}
+
+/* Copies @s into the table, or returns NULL if it doesn't fit */
+const char *string_table_add(struct string_table *t, const char *s)
+{
+    size_t n = strlen(s) + 1;
+    char *p;
+
+    if (t->used + n > t->size)
+        return NULL;
+
+    p = t->data + t->used;
+    memcpy(p, s, n);
+    t->used += n;
+
+    return p;
+}
+
+size_t string_table_memory(const struct string_table *t)
+{
+    return sizeof(struct string_table) + t->size;
+}
@@ -0,0 +1,201 @@
+/*
+ * Description: Functions to manipulate a 'struct tag_index' structure, a
+ *              hash table mapping object tags to their internal objects.
+ *
+ * Author: Rodrigo Freitas
+ * Created at: Mon Oct 19 09:12:40 2026
+ * Project: libgrc
+ *
+ * Copyright (c) 2014 Rodrigo Freitas
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301
+ * USA
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "libgrc.h"
+
+/* Initial number of buckets. Must be a power of 2. */
+#define TAG_INDEX_INITIAL_SIZE      64
+
+struct tag_index {
+    unsigned int            size;       /** Number of buckets */
+    unsigned int            used;       /** Number of stored objects */
+    struct grc_object_s     **bucket;
+};
+
+/*
+ * FNV-1a hash of an object tag.
+ */
+unsigned int tag_hash(const char *tag)
+{
+    unsigned int h = 2166136261u;
+
+    while (*tag != '\0') {
+        h ^= (unsigned char)*tag++;
+        h *= 16777619u;
+    }
+
+    return h;
+}
+
+struct tag_index *new_tag_index(void)
+{
+    struct tag_index *t = NULL;
+
+    t = calloc(1, sizeof(struct tag_index));
+
+    if (NULL == t) {
+        grc_set_errno(GRC_ERROR_MEMORY);
+        return NULL;
+    }
+
+    t->size = TAG_INDEX_INITIAL_SIZE;
+    t->bucket = calloc(t->size, sizeof(struct grc_object_s *));
+
+    if (NULL == t->bucket) {
+        grc_set_errno(GRC_ERROR_MEMORY);
+        free(t);
+        return NULL;
+    }
+
+    return t;
+}
+
+void destroy_tag_index(struct tag_index *index)
+{
+    if (NULL == index)
+        return;
+
+    /* The objects belong to the 'struct grc_s' lists, not to us */
+    if (index->bucket != NULL)
+        free(index->bucket);
+
+    free(index);
+}
+
+static void tag_index_store(struct grc_object_s **bucket, unsigned int size,
+    struct grc_object_s *object)
+{
+    unsigned int i;
+
+    i = tag_hash(object->tag) & (size - 1);
+
+    /* Linear probing */
+    while (bucket[i] != NULL) {
+        /* A repeated tag replaces the older object */
+        if (strcmp(bucket[i]->tag, object->tag) == 0)
+            break;
+
+        i = (i + 1) & (size - 1);
+    }
+
+    bucket[i] = object;
+}
+
+static int tag_index_grow(struct tag_index *index)
+{
+    struct grc_object_s **bucket;
+    unsigned int i, size;
+
+    size = index->size * 2;
+    bucket = calloc(size, sizeof(struct grc_object_s *));
+
+    if (NULL == bucket) {
+        grc_set_errno(GRC_ERROR_MEMORY);
+        return -1;
+    }
+
+    for (i = 0; i < index->size; i++)
+        if (index->bucket[i] != NULL)
+            tag_index_store(bucket, size, index->bucket[i]);
+
+    free(index->bucket);
+    index->bucket = bucket;
+    index->size = size;
+
+    return 0;
+}
+
+int tag_index_add(struct tag_index *index, struct grc_object_s *object)
+{
+    if ((NULL == index) || (NULL == object) || (NULL == object->tag))
+        return -1;
+
+    /* Keeps the load factor under 70% so that probing stays short */
+    if ((index->used + 1) * 10 > index->size * 7)
+        if (tag_index_grow(index) < 0)
+            return -1;
+
+    if (tag_index_get(index, object->tag) == NULL)
+        index->used++;
+
+    tag_index_store(index->bucket, index->size, object);
+
+    return 0;
+}
+
+struct grc_object_s *tag_index_get(struct tag_index *index, const char *tag)
+{
+    unsigned int i;
+
+    if ((NULL == index) || (NULL == tag))
+        return NULL;
+
+    i = tag_hash(tag) & (index->size - 1);
+
+    while (index->bucket[i] != NULL) {
+        if (strcmp(index->bucket[i]->tag, tag) == 0)
+            return index->bucket[i];
+
+        i = (i + 1) & (index->size - 1);
+    }
+
+    return NULL;
+}
+
+/*
+ * Search an object knowing only the hash of its tag. If two tags have the
+ * same hash, the first one found is returned.
+ */
+struct grc_object_s *tag_index_get_hash(struct tag_index *index,
+    unsigned int hash)
+{
+    unsigned int i;
+
+    if (NULL == index)
+        return NULL;
+
+    i = hash & (index->size - 1);
+
+    while (index->bucket[i] != NULL) {
+        if (tag_hash(index->bucket[i]->tag) == hash)
+            return index->bucket[i];
+
+        i = (i + 1) & (index->size - 1);
+    }
+
+    return NULL;
+}
+
+unsigned int tag_index_size(struct tag_index *index)
+{
+    if (NULL == index)
+        return 0;
+
+    return index->used;
+}
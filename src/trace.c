@@ -0,0 +1,719 @@
+/*
+ * Description: Functions to record the input given to a running DIALOG and
+ *              to replay it later, measuring the time of each frame.
+ *
+ * Author: Rodrigo Freitas
+ * Created at: Mon Oct 19 19:12:38 2026
+ * Project: libgrc
+ *
+ * Copyright (c) 2014 Rodrigo Freitas
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301
+ * USA
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdarg.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <time.h>
+#include <pthread.h>
+
+#include "libgrc.h"
+
+/*
+ * A trace is a header followed by the events of every frame of a DIALOG:
+ *
+ *   header: "GRCT" | version (u32) | width (u32) | height (u32)
+ *   event:  type (u8) | payload
+ *
+ * The input of a frame (keys and mouse) and the callbacks it called come
+ * before the TRACE_FRAME event which closes it. Every number is written in
+ * little-endian and the mouse is only written when it changes.
+ */
+#define TRACE_MAGIC                 "GRCT"
+#define TRACE_VERSION               1
+#define TRACE_HEADER_SIZE           16
+
+/* Events are written to the file each time this much is buffered */
+#define TRACE_BUFFER_SIZE           4096
+
+/* Keys typed between two frames */
+#define TRACE_MAX_KEYS              64
+
+/* A replayed frame slower than this percent of the recorded one diverges */
+#define TRACE_SLOW_PERCENT          150
+
+enum trace_event {
+    TRACE_FRAME = 1,    /* tick (u32) | time spent (u32), both in usec */
+    TRACE_KEY,          /* unicode key (u32) | scancode (u8) */
+    TRACE_MOUSE,        /* x (u16) | y (u16) | z (u16) | buttons (u8) */
+    TRACE_CALLBACK      /* returned value (u32) */
+};
+
+enum trace_mode {
+    TRACE_OFF,
+    TRACE_RECORD,
+    TRACE_REPLAY
+};
+
+struct trace_mouse {
+    int     x;
+    int     y;
+    int     z;
+    int     b;
+};
+
+/*
+ * Only one DIALOG is traced at a time, since Allegro input is global too.
+ * Keys arrive from the Allegro keyboard thread and are protected by @lock,
+ * everything else is used only by the thread running the DIALOG.
+ */
+struct trace {
+    pthread_mutex_t     lock;
+    enum trace_mode     mode;
+    pthread_t           owner;
+    bool                injecting;
+
+    /* Keys typed since the last frame */
+    int                 keys[TRACE_MAX_KEYS];
+    int                 scancodes[TRACE_MAX_KEYS];
+    unsigned int        n_keys;
+
+    /* The mouse seen by the DIALOG during the current frame */
+    struct trace_mouse  mouse;
+
+    /* Callbacks called during the current frame */
+    unsigned int        callbacks;
+
+    /* Events not yet written to @fd, while recording */
+    int                 fd;
+    unsigned char       buffer[TRACE_BUFFER_SIZE];
+    unsigned int        used;
+    bool                failed;
+
+    /* What was replaced while tracing */
+    int                 (*ucallback)(int, int *);
+    int                 (*mouse_x)(void);
+    int                 (*mouse_y)(void);
+    int                 (*mouse_z)(void);
+    int                 (*mouse_b)(void);
+};
+
+static struct trace __trace = {
+    .lock = PTHREAD_MUTEX_INITIALIZER,
+    .mode = TRACE_OFF,
+};
+
+static void trace_flush(void)
+{
+    if ((__trace.failed == false) && (__trace.used > 0) &&
+        (write_all(__trace.fd, __trace.buffer, __trace.used) < 0))
+    {
+        __trace.failed = true;
+    }
+
+    __trace.used = 0;
+}
+
+static void trace_put(const unsigned char *data, unsigned int n)
+{
+    if (__trace.used + n > TRACE_BUFFER_SIZE)
+        trace_flush();
+
+    memcpy(__trace.buffer + __trace.used, data, n);
+    __trace.used += n;
+}
+
+static void record_frame(unsigned int tick, unsigned int usec)
+{
+    unsigned char e[9];
+
+    e[0] = TRACE_FRAME;
+    put_le32(e + 1, tick);
+    put_le32(e + 5, usec);
+    trace_put(e, sizeof(e));
+}
+
+static void record_key(int key, int scancode)
+{
+    unsigned char e[6];
+
+    e[0] = TRACE_KEY;
+    put_le32(e + 1, key);
+    e[5] = scancode;
+    trace_put(e, sizeof(e));
+}
+
+static void record_mouse(const struct trace_mouse *m)
+{
+    unsigned char e[8], *p = e + 1;
+
+    e[0] = TRACE_MOUSE;
+    p += put_le16(p, m->x);
+    p += put_le16(p, m->y);
+    p += put_le16(p, m->z);
+    *p = m->b;
+    trace_put(e, sizeof(e));
+}
+
+static void record_callback(int ret)
+{
+    unsigned char e[5];
+
+    e[0] = TRACE_CALLBACK;
+    put_le32(e + 1, ret);
+    trace_put(e, sizeof(e));
+}
+
+/*
+ * Real keys never reach the DIALOG directly. They are held until the next
+ * frame, when they are recorded and given to it with simulate_ukeypress.
+ * While replaying they are simply dropped.
+ */
+static int trace_keyboard_callback(int key, int *scancode)
+{
+    if ((__trace.injecting == true) &&
+        pthread_equal(pthread_self(), __trace.owner))
+    {
+        return key;
+    }
+
+    pthread_mutex_lock(&__trace.lock);
+
+    if ((__trace.mode == TRACE_RECORD) && (__trace.n_keys < TRACE_MAX_KEYS)) {
+        __trace.keys[__trace.n_keys] = key;
+        __trace.scancodes[__trace.n_keys] = *scancode;
+        __trace.n_keys++;
+    }
+
+    pthread_mutex_unlock(&__trace.lock);
+    *scancode = 0;
+
+    return 0;
+}
+
+static void inject_key(int key, int scancode)
+{
+    __trace.injecting = true;
+    simulate_ukeypress(key, scancode);
+    __trace.injecting = false;
+}
+
+/* The DIALOG sees the same mouse during a whole frame */
+static int trace_mouse_x(void)
+{
+    return __trace.mouse.x;
+}
+
+static int trace_mouse_y(void)
+{
+    return __trace.mouse.y;
+}
+
+static int trace_mouse_z(void)
+{
+    return __trace.mouse.z;
+}
+
+static int trace_mouse_b(void)
+{
+    return __trace.mouse.b;
+}
+
+static int trace_begin(enum trace_mode mode, int fd)
+{
+    pthread_mutex_lock(&__trace.lock);
+
+    if (__trace.mode != TRACE_OFF) {
+        pthread_mutex_unlock(&__trace.lock);
+        grc_set_errno(GRC_ERROR_TRACE_BUSY);
+        return -1;
+    }
+
+    __trace.mode = mode;
+    __trace.owner = pthread_self();
+    __trace.injecting = false;
+    __trace.n_keys = 0;
+    __trace.callbacks = 0;
+    __trace.fd = fd;
+    __trace.used = 0;
+    __trace.failed = false;
+    pthread_mutex_unlock(&__trace.lock);
+
+    __trace.mouse_x = gui_mouse_x;
+    __trace.mouse_y = gui_mouse_y;
+    __trace.mouse_z = gui_mouse_z;
+    __trace.mouse_b = gui_mouse_b;
+    __trace.mouse.x = gui_mouse_x();
+    __trace.mouse.y = gui_mouse_y();
+    __trace.mouse.z = gui_mouse_z();
+    __trace.mouse.b = gui_mouse_b();
+    gui_mouse_x = trace_mouse_x;
+    gui_mouse_y = trace_mouse_y;
+    gui_mouse_z = trace_mouse_z;
+    gui_mouse_b = trace_mouse_b;
+
+    __trace.ucallback = keyboard_ucallback;
+    keyboard_ucallback = trace_keyboard_callback;
+    clear_keybuf();
+
+    return 0;
+}
+
+static void trace_end(void)
+{
+    keyboard_ucallback = __trace.ucallback;
+    gui_mouse_x = __trace.mouse_x;
+    gui_mouse_y = __trace.mouse_y;
+    gui_mouse_z = __trace.mouse_z;
+    gui_mouse_b = __trace.mouse_b;
+
+    pthread_mutex_lock(&__trace.lock);
+    __trace.mode = TRACE_OFF;
+    pthread_mutex_unlock(&__trace.lock);
+}
+
+/* Gives the DIALOG what was typed and where the mouse is, recording both */
+static void record_input(void)
+{
+    int keys[TRACE_MAX_KEYS], scancodes[TRACE_MAX_KEYS];
+    struct trace_mouse m;
+    unsigned int i, n;
+
+    m.x = __trace.mouse_x();
+    m.y = __trace.mouse_y();
+    m.z = __trace.mouse_z();
+    m.b = __trace.mouse_b();
+
+    if (memcmp(&m, &__trace.mouse, sizeof(m)) != 0) {
+        __trace.mouse = m;
+        record_mouse(&m);
+    }
+
+    pthread_mutex_lock(&__trace.lock);
+    n = __trace.n_keys;
+    memcpy(keys, __trace.keys, n * sizeof(int));
+    memcpy(scancodes, __trace.scancodes, n * sizeof(int));
+    __trace.n_keys = 0;
+    pthread_mutex_unlock(&__trace.lock);
+
+    for (i = 0; i < n; i++) {
+        record_key(keys[i], scancodes[i]);
+        inject_key(keys[i], scancodes[i]);
+    }
+}
+
+/* Allegro is held until end_dialog, as in run_DIALOG */
+static DIALOG_PLAYER *start_dialog(struct grc_s *grc)
+{
+    DIALOG_PLAYER *player;
+
+    stop_render_DIALOG(grc);
+
+    if (info_get_value(grc->info, INFO_USE_GFX) == false)
+        centre_dialog(grc->dlg);
+
+    session_gui_lock();
+    headless_select(grc);
+    player = init_dialog(grc->dlg, -1);
+
+    if (NULL == player) {
+        session_gui_unlock();
+        grc_set_errno(GRC_ERROR_MEMORY);
+    }
+
+    return player;
+}
+
+static void end_dialog(DIALOG_PLAYER *player)
+{
+    shutdown_dialog(player);
+    session_gui_unlock();
+}
+
+static int write_header(struct grc_s *grc, int fd)
+{
+    unsigned char h[TRACE_HEADER_SIZE];
+
+    memcpy(h, TRACE_MAGIC, 4);
+    put_le32(h + 4, TRACE_VERSION);
+    put_le32(h + 8, info_get_value(grc->info, INFO_WIDTH));
+    put_le32(h + 12, info_get_value(grc->info, INFO_HEIGHT));
+
+    return write_all(fd, h, sizeof(h));
+}
+
+static int record(struct grc_s *grc)
+{
+    DIALOG_PLAYER *player;
+    unsigned long long start, frame;
+    bool running = true;
+
+    player = start_dialog(grc);
+
+    if (NULL == player)
+        return -1;
+
+    start = usec_now(CLOCK_MONOTONIC);
+
+    while (running == true) {
+        frame = usec_now(CLOCK_MONOTONIC);
+
+        /* Injected keys go through the keyboard callback, to be recorded */
+        running = dialog_frame(grc, player, record_input);
+        record_frame(usec_now(CLOCK_MONOTONIC) - start,
+                     usec_now(CLOCK_MONOTONIC) - frame);
+    }
+
+    end_dialog(player);
+    trace_flush();
+
+    if (__trace.failed == true) {
+        grc_set_errno(GRC_ERROR_TRACE_IO);
+        return -1;
+    }
+
+    return 0;
+}
+
+/*
+ * Replay
+ */
+
+struct replay {
+    const unsigned char *p;
+    const unsigned char *end;
+
+    /* What the next frame recorded */
+    unsigned int        callbacks;
+    unsigned int        usec;
+
+    /* Totals */
+    unsigned int        frames;
+    unsigned int        divergent;
+    unsigned long long  total_usec;
+    unsigned int        max_usec;
+};
+
+static int read_all(int fd, unsigned char **data, unsigned int *size)
+{
+    unsigned char *p = NULL, *tmp;
+    unsigned int used = 0, n = 0;
+    ssize_t r;
+
+    for (;;) {
+        if (used == n) {
+            n = (n > 0) ? n * 2 : TRACE_BUFFER_SIZE;
+            tmp = realloc(p, n);
+
+            if (NULL == tmp) {
+                free(p);
+                return -1;
+            }
+
+            p = tmp;
+        }
+
+        r = read(fd, p + used, n - used);
+
+        if (r < 0) {
+            if (errno == EINTR)
+                continue;
+
+            free(p);
+            return -1;
+        }
+
+        if (r == 0)
+            break;
+
+        used += r;
+    }
+
+    *data = p;
+    *size = used;
+
+    return 0;
+}
+
+/*
+ * Gives the DIALOG the input of the next recorded frame. Returns false when
+ * the trace has no more frames, or -1 if it is broken.
+ */
+static int replay_input(struct replay *r)
+{
+    const unsigned char *p = r->p;
+    unsigned int n;
+
+    r->callbacks = 0;
+
+    while (p < r->end) {
+        switch (*p) {
+            case TRACE_FRAME:
+                n = 9;
+                break;
+
+            case TRACE_KEY:
+                n = 6;
+                break;
+
+            case TRACE_MOUSE:
+                n = 8;
+                break;
+
+            case TRACE_CALLBACK:
+                n = 5;
+                break;
+
+            default:
+                return -1;
+        }
+
+        if (p + n > r->end)
+            return -1;
+
+        switch (*p) {
+            case TRACE_FRAME:
+                r->usec = get_le32(p + 5);
+                r->p = p + n;
+                return true;
+
+            case TRACE_KEY:
+                inject_key(get_le32(p + 1), p[5]);
+                break;
+
+            case TRACE_MOUSE:
+                __trace.mouse.x = get_le16(p + 1);
+                __trace.mouse.y = get_le16(p + 3);
+                __trace.mouse.z = (short)get_le16(p + 5);
+                __trace.mouse.b = p[7];
+                break;
+
+            case TRACE_CALLBACK:
+                r->callbacks++;
+                break;
+        }
+
+        p += n;
+    }
+
+    /* Events after the last frame are ignored */
+    r->p = r->end;
+
+    return false;
+}
+
+static void report(int fd, const char *fmt, ...)
+{
+    char line[256];
+    va_list ap;
+    int n;
+
+    if (fd < 0)
+        return;
+
+    va_start(ap, fmt);
+    n = vsnprintf(line, sizeof(line), fmt, ap);
+    va_end(ap);
+
+    if (n > 0)
+        write_all(fd, line, MIN((unsigned int)n, sizeof(line) - 1));
+}
+
+/*
+ * A frame diverges when it didn't call the same callbacks it called while
+ * recorded, or when it became much slower.
+ */
+static bool frame_diverges(struct replay *r, unsigned int usec)
+{
+    if (__trace.callbacks != r->callbacks)
+        return true;
+
+    return (r->usec > 0) &&
+           ((unsigned long long)usec * 100 >
+                (unsigned long long)r->usec * TRACE_SLOW_PERCENT);
+}
+
+static int replay(struct grc_s *grc, const unsigned char *data,
+    unsigned int size, int report_fd)
+{
+    DIALOG_PLAYER *player;
+    struct replay r;
+    unsigned long long frame;
+    unsigned int usec;
+    bool running = true, diverged;
+    int ret = 0;
+
+    memset(&r, 0, sizeof(r));
+    r.p = data + TRACE_HEADER_SIZE;
+    r.end = data + size;
+    player = start_dialog(grc);
+
+    if (NULL == player)
+        return -1;
+
+    while (running == true) {
+        ret = replay_input(&r);
+
+        if (ret <= 0)
+            break;
+
+        __trace.callbacks = 0;
+        frame = usec_now(CLOCK_MONOTONIC);
+
+        /* Only the recorded input is seen, injected keys are dropped */
+        running = dialog_frame(grc, player, NULL);
+        usec = usec_now(CLOCK_MONOTONIC) - frame;
+        diverged = frame_diverges(&r, usec);
+
+        if (diverged == true)
+            r.divergent++;
+
+        r.frames++;
+        r.total_usec += usec;
+        r.max_usec = MAX(r.max_usec, usec);
+        report(report_fd, "{\"frame\":%u,\"usec\":%u,\"recorded_usec\":%u,"
+                          "\"callbacks\":%u,\"diverged\":%s}\n",
+               r.frames, usec, r.usec, __trace.callbacks,
+               (diverged == true) ? "true" : "false");
+    }
+
+    end_dialog(player);
+
+    if (ret < 0) {
+        grc_set_errno(GRC_ERROR_INVALID_TRACE);
+        return -1;
+    }
+
+    /* The DIALOG closing before or after the trace ends is a divergence too */
+    if ((running == true) || (r.p != r.end))
+        r.divergent++;
+
+    report(report_fd, "{\"frames\":%u,\"total_usec\":%llu,\"max_usec\":%u,"
+                      "\"divergent_frames\":%u}\n",
+           r.frames, r.total_usec, r.max_usec, r.divergent);
+
+    return r.divergent;
+}
+
+static bool valid_header(struct grc_s *grc, const unsigned char *data,
+    unsigned int size)
+{
+    if ((size < TRACE_HEADER_SIZE) || memcmp(data, TRACE_MAGIC, 4) ||
+        (get_le32(data + 4) != TRACE_VERSION))
+    {
+        return false;
+    }
+
+    /* Mouse positions only make sense at the same resolution */
+    return ((int)get_le32(data + 8) == info_get_value(grc->info, INFO_WIDTH)) &&
+           ((int)get_le32(data + 12) == info_get_value(grc->info, INFO_HEIGHT));
+}
+
+/* Called by every callback of a DIALOG, with what it returned */
+void trace_callback(int ret)
+{
+    if (__trace.mode == TRACE_OFF)
+        return;
+
+    if (pthread_equal(pthread_self(), __trace.owner) == 0)
+        return;
+
+    __trace.callbacks++;
+
+    if (__trace.mode == TRACE_RECORD)
+        record_callback(ret);
+}
+
+/*
+ *
+ * API
+ *
+ */
+
+int LIBEXPORT grc_trace_record(grc_t *grc, int fd)
+{
+    struct grc_s *g = (struct grc_s *)grc;
+    int ret;
+
+    grc_errno_clear();
+
+    if ((NULL == grc) || (fd < 0)) {
+        grc_set_errno(GRC_ERROR_NULL_ARG);
+        return -1;
+    }
+
+    if (info_get_value(g->info, INFO_ARE_WE_PREPARED) == false) {
+        grc_set_errno(GRC_ERROR_NOT_PREPARED_YET);
+        return -1;
+    }
+
+    if (write_header(g, fd) < 0) {
+        grc_set_errno(GRC_ERROR_TRACE_IO);
+        return -1;
+    }
+
+    if (trace_begin(TRACE_RECORD, fd) < 0)
+        return -1;
+
+    ret = record(g);
+    trace_end();
+
+    return ret;
+}
+
+int LIBEXPORT grc_trace_replay(grc_t *grc, int trace_fd, int report_fd)
+{
+    struct grc_s *g = (struct grc_s *)grc;
+    unsigned char *data = NULL;
+    unsigned int size = 0;
+    int ret = -1;
+
+    grc_errno_clear();
+
+    if ((NULL == grc) || (trace_fd < 0)) {
+        grc_set_errno(GRC_ERROR_NULL_ARG);
+        return -1;
+    }
+
+    if (info_get_value(g->info, INFO_ARE_WE_PREPARED) == false) {
+        grc_set_errno(GRC_ERROR_NOT_PREPARED_YET);
+        return -1;
+    }
+
+    if (read_all(trace_fd, &data, &size) < 0) {
+        grc_set_errno(GRC_ERROR_TRACE_IO);
+        return -1;
+    }
+
+    if (valid_header(g, data, size) == false) {
+        grc_set_errno(GRC_ERROR_INVALID_TRACE);
+        goto end_block;
+    }
+
+    if (trace_begin(TRACE_REPLAY, -1) < 0)
+        goto end_block;
+
+    ret = replay(g, data, size, report_fd);
+    trace_end();
+
+end_block:
+    free(data);
+
+    return ret;
+}
@@ -0,0 +1,580 @@
+/*
+ * Description: Writes what the library does, as Chrome trace events, to be
+ *              seen with about:tracing or Perfetto.
+ *
+ * Author: Rodrigo Freitas
+ * Created at: Mon Oct 19 23:58:40 2026
+ * Project: libgrc
+ *
+ * Copyright (c) 2014 Rodrigo Freitas
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301
+ * USA
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/syscall.h>
+
+#include <pthread.h>
+
+#include "libgrc.h"
+
+/* The file is written to when this variable names it */
+#define TRACE_EVENTS_ENV            "GRC_TRACE_EVENTS"
+
+/* Events of each thread not written yet. Must be a power of two. */
+#define TRACE_RING_SIZE             8192
+
+/* How long written events may wait, in milliseconds */
+#define TRACE_FLUSH_INTERVAL        20
+
+#define TRACE_DETAIL_SIZE           32
+
+/*
+ * @name and @category must be constant strings, since events are written
+ * long after they happen. Anything else is copied to @detail.
+ */
+struct trace_event {
+    const char          *name;
+    const char          *category;
+    unsigned long long  start;
+    unsigned long long  duration;
+    char                detail[TRACE_DETAIL_SIZE];
+};
+
+/*
+ * Events of a single thread. Only the thread moves @head and only the
+ * writer moves @tail, so neither waits for the other.
+ */
+struct trace_ring {
+    struct trace_ring   *next;
+    pid_t               tid;
+    unsigned int        head;
+    unsigned int        tail;
+    unsigned int        dropped;
+    bool                finished;
+    struct trace_event  events[TRACE_RING_SIZE];
+};
+
+/*
+ * What was taken from the rings, to be written without holding the lock.
+ * An entry with @dropped is not an event, but how many the thread lost.
+ */
+struct drained_event {
+    pid_t               tid;
+    unsigned int        dropped;
+    struct trace_event  event;
+};
+
+static struct {
+    pthread_mutex_t     lock;
+    pthread_cond_t      cond;
+    pthread_once_t      once;
+    pthread_key_t       key;
+    pthread_t           thread;
+    bool                enabled;
+    bool                running;
+    bool                stop;
+    FILE                *f;
+    bool                first;
+    pid_t               pid;
+
+    /* Every thread which had an event */
+    struct trace_ring   *rings;
+
+    /* Only used by whoever drains the rings */
+    struct drained_event *drained;
+    unsigned int        drained_size;
+} __events = {
+    .lock = PTHREAD_MUTEX_INITIALIZER,
+    .cond = PTHREAD_COND_INITIALIZER,
+    .once = PTHREAD_ONCE_INIT,
+};
+
+static __thread struct trace_ring *__ring = NULL;
+
+/* Set once the ring of the thread is given back */
+static __thread bool __finished = false;
+
+static const char *__messages[] = {
+    "MSG_0",
+    "MSG_START",
+    "MSG_END",
+    "MSG_DRAW",
+    "MSG_CLICK",
+    "MSG_DCLICK",
+    "MSG_KEY",
+    "MSG_CHAR",
+    "MSG_UCHAR",
+    "MSG_XCHAR",
+    "MSG_WANTFOCUS",
+    "MSG_GOTFOCUS",
+    "MSG_LOSTFOCUS",
+    "MSG_GOTMOUSE",
+    "MSG_LOSTMOUSE",
+    "MSG_IDLE",
+    "MSG_RADIO",
+    "MSG_WHEEL",
+    "MSG_LPRESS",
+    "MSG_LRELEASE",
+    "MSG_MPRESS",
+    "MSG_MRELEASE",
+    "MSG_RPRESS",
+    "MSG_RRELEASE",
+    "MSG_WANTMOUSE",
+    "MSG_NEW_LOG_TEXT",
+    "MSG_CLEAR_LOG_TEXT",
+    "MSG_LOAD_IMAGE",
+    "MSG_UPDATE_CURSOR_POSITION",
+    "MSG_LIST_REFRESH",
+    "MSG_TABLE_REFRESH",
+};
+
+#define TRACE_MESSAGES              \
+    (int)(sizeof(__messages) / sizeof(__messages[0]))
+
+/*
+ * The ring of a finished thread is freed once everything in it is written.
+ * Destructors of other keys may still run after this one, so the thread
+ * forgets it and keeps no other event.
+ */
+static void thread_finished(void *arg)
+{
+    struct trace_ring *r = (struct trace_ring *)arg;
+
+    __ring = NULL;
+    __finished = true;
+    __atomic_store_n(&r->finished, true, __ATOMIC_RELEASE);
+}
+
+static struct trace_ring *thread_ring(void)
+{
+    struct trace_ring *r;
+
+    if (__ring != NULL)
+        return __ring;
+
+    if (__finished == true)
+        return NULL;
+
+    r = calloc(1, sizeof(struct trace_ring));
+
+    if (NULL == r)
+        return NULL;
+
+    r->tid = syscall(SYS_gettid);
+    pthread_setspecific(__events.key, r);
+
+    pthread_mutex_lock(&__events.lock);
+    r->next = __events.rings;
+    __events.rings = r;
+    pthread_mutex_unlock(&__events.lock);
+
+    __ring = r;
+
+    return r;
+}
+
+static void write_string(FILE *f, const char *s)
+{
+    fputc('"', f);
+
+    for (; *s != '\0'; s++) {
+        if ((*s == '"') || (*s == '\\'))
+            fprintf(f, "\\%c", *s);
+        else if ((unsigned char)*s < 0x20)
+            fprintf(f, "\\u%04x", *s);
+        else
+            fputc(*s, f);
+    }
+
+    fputc('"', f);
+}
+
+/* Complete events ('X'), with their times in microseconds */
+static void write_event(pid_t tid, const struct trace_event *e)
+{
+    FILE *f = __events.f;
+
+    fprintf(f, "%s{\"name\":\"%s\",\"cat\":\"%s\",\"ph\":\"X\",\"pid\":%d,"
+               "\"tid\":%d,\"ts\":%llu.%03llu,\"dur\":%llu.%03llu",
+            (__events.first == true) ? "" : ",\n", e->name, e->category,
+            __events.pid, tid, e->start / 1000, e->start % 1000,
+            e->duration / 1000, e->duration % 1000);
+
+    if (e->detail[0] != '\0') {
+        fprintf(f, ",\"args\":{\"object\":");
+        write_string(f, e->detail);
+        fputc('}', f);
+    }
+
+    fputc('}', f);
+    __events.first = false;
+}
+
+static void write_dropped(pid_t tid, unsigned int dropped)
+{
+    fprintf(__events.f, "%s{\"name\":\"dropped\",\"ph\":\"C\",\"pid\":%d,"
+                        "\"tid\":%d,\"ts\":%llu,\"args\":{\"events\":%u}}",
+            (__events.first == true) ? "" : ",\n", __events.pid, tid,
+            nsec_now(CLOCK_MONOTONIC) / 1000, dropped);
+
+    __events.first = false;
+}
+
+/* Makes room for @n more drained entries, besides the first @used */
+static bool drained_reserve(unsigned int used, unsigned int n)
+{
+    struct drained_event *p;
+    unsigned int size = MAX(__events.drained_size, TRACE_RING_SIZE);
+
+    if (used + n <= __events.drained_size)
+        return true;
+
+    while (size < used + n)
+        size *= 2;
+
+    p = realloc(__events.drained, size * sizeof(struct drained_event));
+
+    if (NULL == p)
+        return false;
+
+    __events.drained = p;
+    __events.drained_size = size;
+
+    return true;
+}
+
+/*
+ * Takes the events of a ring, as many as there is room for. The remaining
+ * ones stay there until the next time.
+ */
+static unsigned int drain_ring(struct trace_ring *r, unsigned int used)
+{
+    struct drained_event *de;
+    unsigned int head, tail, dropped;
+
+    head = __atomic_load_n(&r->head, __ATOMIC_ACQUIRE);
+    tail = r->tail;
+
+    if (drained_reserve(used, head - tail + 1) == false)
+        return used;
+
+    for (; tail != head; tail++) {
+        de = &__events.drained[used++];
+        de->tid = r->tid;
+        de->dropped = 0;
+        de->event = r->events[tail & (TRACE_RING_SIZE - 1)];
+    }
+
+    __atomic_store_n(&r->tail, tail, __ATOMIC_RELEASE);
+    dropped = __atomic_exchange_n(&r->dropped, 0, __ATOMIC_RELAXED);
+
+    if (dropped > 0) {
+        de = &__events.drained[used++];
+        de->tid = r->tid;
+        de->dropped = dropped;
+    }
+
+    return used;
+}
+
+/*
+ * Writes everything the threads left in their rings. The events are only
+ * copied while holding the lock, so new threads never wait for the file.
+ */
+static void drain_rings(void)
+{
+    struct trace_ring *r, **prev;
+    struct drained_event *de;
+    unsigned int i, used = 0;
+    bool finished;
+
+    pthread_mutex_lock(&__events.lock);
+    prev = &__events.rings;
+
+    while ((r = *prev) != NULL) {
+        finished = __atomic_load_n(&r->finished, __ATOMIC_ACQUIRE);
+        used = drain_ring(r, used);
+
+        /* Its events must be taken before it's gone */
+        if ((finished == true) &&
+            (r->tail == __atomic_load_n(&r->head, __ATOMIC_ACQUIRE)))
+        {
+            *prev = r->next;
+            free(r);
+        } else
+            prev = &r->next;
+    }
+
+    pthread_mutex_unlock(&__events.lock);
+
+    for (i = 0; i < used; i++) {
+        de = &__events.drained[i];
+
+        if (de->dropped > 0)
+            write_dropped(de->tid, de->dropped);
+        else
+            write_event(de->tid, &de->event);
+    }
+
+    fflush(__events.f);
+}
+
+static void *writer_thread(void *arg __attribute__((unused)))
+{
+    struct timespec t;
+
+    pthread_mutex_lock(&__events.lock);
+
+    while (__events.stop == false) {
+        clock_gettime(CLOCK_REALTIME, &t);
+        t.tv_nsec += TRACE_FLUSH_INTERVAL * 1000000L;
+
+        if (t.tv_nsec >= 1000000000L) {
+            t.tv_sec++;
+            t.tv_nsec -= 1000000000L;
+        }
+
+        pthread_cond_timedwait(&__events.cond, &__events.lock, &t);
+        pthread_mutex_unlock(&__events.lock);
+        drain_rings();
+        pthread_mutex_lock(&__events.lock);
+    }
+
+    pthread_mutex_unlock(&__events.lock);
+
+    return NULL;
+}
+
+static int events_start(const char *path)
+{
+    int ret = -1;
+
+    pthread_mutex_lock(&__events.lock);
+
+    if (__events.running == true) {
+        grc_set_errno(GRC_ERROR_TRACE_EVENTS_RUNNING);
+        goto end_block;
+    }
+
+    __events.f = fopen(path, "w");
+
+    if (NULL == __events.f) {
+        grc_set_errno(GRC_ERROR_TRACE_EVENTS_IO);
+        goto end_block;
+    }
+
+    /* A JSON array, which may be loaded even if it's never closed */
+    fprintf(__events.f, "[\n");
+    __events.first = true;
+    __events.pid = getpid();
+    __events.stop = false;
+
+    if (pthread_create(&__events.thread, NULL, writer_thread, NULL) != 0) {
+        fclose(__events.f);
+        __events.f = NULL;
+        grc_set_errno(GRC_ERROR_MEMORY);
+        goto end_block;
+    }
+
+    __events.running = true;
+    __atomic_store_n(&__events.enabled, true, __ATOMIC_RELEASE);
+    ret = 0;
+
+end_block:
+    pthread_mutex_unlock(&__events.lock);
+
+    return ret;
+}
+
+static void events_stop(void)
+{
+    pthread_mutex_lock(&__events.lock);
+
+    if (__events.running == false) {
+        pthread_mutex_unlock(&__events.lock);
+        return;
+    }
+
+    __atomic_store_n(&__events.enabled, false, __ATOMIC_RELEASE);
+    __events.stop = true;
+    pthread_cond_signal(&__events.cond);
+    pthread_mutex_unlock(&__events.lock);
+
+    pthread_join(__events.thread, NULL);
+
+    /* Whatever was left after the last flush */
+    drain_rings();
+
+    pthread_mutex_lock(&__events.lock);
+    fprintf(__events.f, "\n]\n");
+    fclose(__events.f);
+    __events.f = NULL;
+    free(__events.drained);
+    __events.drained = NULL;
+    __events.drained_size = 0;
+    __events.running = false;
+    pthread_mutex_unlock(&__events.lock);
+}
+
+static void events_init(void)
+{
+    const char *path;
+
+    pthread_key_create(&__events.key, thread_finished);
+
+    /* The file is only complete once it's closed */
+    atexit(events_stop);
+    path = getenv(TRACE_EVENTS_ENV);
+
+    if ((path != NULL) && (*path != '\0'))
+        events_start(path);
+}
+
+/*
+ * Starts writing events if the environment asks for it. Called by every
+ * DIALOG created, but only the first one looks at it.
+ */
+void trace_events_init(void)
+{
+    pthread_once(&__events.once, events_init);
+}
+
+bool trace_events_enabled(void)
+{
+    return __atomic_load_n(&__events.enabled, __ATOMIC_ACQUIRE);
+}
+
+/* Returns when an event starts, or 0 if nothing is being written */
+unsigned long long trace_event_begin(void)
+{
+    if (trace_events_enabled() == false)
+        return 0;
+
+    return nsec_now(CLOCK_MONOTONIC);
+}
+
+/*
+ * Keeps an event started by trace_event_begin. It is lost if the thread
+ * has too many events waiting to be written.
+ */
+void trace_event_end(unsigned long long start, const char *name,
+    const char *category, const char *detail)
+{
+    struct trace_ring *r;
+    struct trace_event *e;
+    unsigned int head;
+
+    if ((start == 0) || (trace_events_enabled() == false))
+        return;
+
+    r = thread_ring();
+
+    if (NULL == r)
+        return;
+
+    head = r->head;
+
+    if (head - __atomic_load_n(&r->tail, __ATOMIC_ACQUIRE) >= TRACE_RING_SIZE)
+    {
+        __atomic_add_fetch(&r->dropped, 1, __ATOMIC_RELAXED);
+        return;
+    }
+
+    e = &r->events[head & (TRACE_RING_SIZE - 1)];
+    e->name = name;
+    e->category = category;
+    e->start = start;
+    e->duration = nsec_now(CLOCK_MONOTONIC) - start;
+
+    if (detail != NULL)
+        snprintf(e->detail, sizeof(e->detail), "%s", detail);
+    else
+        e->detail[0] = '\0';
+
+    __atomic_store_n(&r->head, head + 1, __ATOMIC_RELEASE);
+}
+
+/* Every message an object receives is an event */
+int trace_events_object_proc(int msg, DIALOG *d, int c)
+{
+    struct callback_data *acd = d->dp3;
+    unsigned long long start;
+    int ret;
+
+    start = trace_event_begin();
+    ret = (callback_get_trace_proc(acd))(msg, d, c);
+    trace_event_end(start,
+                    ((msg >= 0) && (msg < TRACE_MESSAGES)) ? __messages[msg]
+                                                           : "MSG_USER",
+                    "message", callback_get_tag(acd));
+
+    return ret;
+}
+
+/*
+ * Replaces the procedure of every object with callback data, when the
+ * DIALOG is created while events are written.
+ */
+void trace_events_attach(struct grc_s *grc)
+{
+    struct grc_object_s *gobj;
+    DIALOG *d;
+
+    if (trace_events_enabled() == false)
+        return;
+
+    for (gobj = grc->ui_objects; gobj; gobj = gobj->next) {
+        if (NULL == gobj->cb_data)
+            continue;
+
+        d = grc_object_get_DIALOG(gobj);
+        callback_set_trace(gobj->cb_data, d->proc, gobj->tag);
+        d->proc = trace_events_object_proc;
+    }
+}
+
+/*
+ *
+ * API
+ *
+ */
+
+int LIBEXPORT grc_trace_events_start(const char *path)
+{
+    grc_errno_clear();
+
+    if (NULL == path) {
+        grc_set_errno(GRC_ERROR_NULL_ARG);
+        return -1;
+    }
+
+    pthread_once(&__events.once, events_init);
+
+    return events_start(path);
+}
+
+int LIBEXPORT grc_trace_events_stop(void)
+{
+    grc_errno_clear();
+    events_stop();
+
+    return 0;
+}
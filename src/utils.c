@@ -25,6 +25,10 @@
  */
 
 #include <ctype.h>
+#include <errno.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/socket.h>
 
 #include "libgrc.h"
 
@@ -54,7 +58,8 @@ static struct grc_dlg_object __dlg_objects [] = {
     { DLG_OBJ_MULTLIVE_IMAGE,   GRC_OBJECT_MULTLIVE_IMAGE       },
     { DLG_OBJ_VT_KEYBOARD,      GRC_OBJECT_VT_KEYBOARD          },
     { DLG_OBJ_ICON,             GRC_OBJECT_ICON                 },
-    { DLG_OBJ_TEXTBOX,          GRC_OBJECT_TEXTBOX              }
+    { DLG_OBJ_TEXTBOX,          GRC_OBJECT_TEXTBOX              },
+    { DLG_OBJ_TABLE,            GRC_OBJECT_TABLE                }
 };
 
 #define MAX_DLG_SUPPORTED_OBJECTS   \
@@ -72,6 +77,30 @@ static struct grc_dlg_object __dlg_objects [] = {
 #define POS_H_LEFT          "left"
 #define POS_H_RIGHT         "right"
 
+/* Layout types */
+#define LAYOUT_ROW          "row"
+#define LAYOUT_COLUMN       "column"
+
+/* Rendering backends */
+#define BACKEND_DISPLAY     "display"
+#define BACKEND_MEMORY      "memory"
+
+/* Anchors, in the same order of 'enum grc_anchor' */
+static const char *__anchors[] = {
+    "top_left",
+    "top",
+    "top_right",
+    "left",
+    "center",
+    "right",
+    "bottom_left",
+    "bottom",
+    "bottom_right"
+};
+
+#define MAX_ANCHORS                 \
+    (sizeof(__anchors) / sizeof(__anchors[0]))
+
 /*
  * This is an original Allegro function. We put it here because there it
  * is declared as static and we need it.
@@ -165,6 +194,56 @@ int tr_horizontal_position(const char *pos)
     return -1;
 }
 
+/*
+ * Translate a string to an object anchor. Objects without one return 0, and
+ * keep their absolute position.
+ */
+int tr_anchor(const char *anchor)
+{
+    unsigned int i;
+
+    if (NULL == anchor)
+        return 0;
+
+    for (i = 0; i < MAX_ANCHORS; i++)
+        if (!strcmp(anchor, __anchors[i]))
+            return GRC_ANCHOR_TOP_LEFT + i;
+
+    return -1;
+}
+
+/*
+ * Translate a string to the way an object places its children, 0 if they
+ * are not placed in sequence.
+ */
+int tr_layout(const char *layout)
+{
+    if (NULL == layout)
+        return 0;
+
+    if (!strcmp(layout, LAYOUT_ROW))
+        return GRC_LAYOUT_ROW;
+
+    if (!strcmp(layout, LAYOUT_COLUMN))
+        return GRC_LAYOUT_COLUMN;
+
+    return -1;
+}
+
+int tr_backend(const char *backend)
+{
+    if (NULL == backend)
+        return GRC_BACKEND_DISPLAY;
+
+    if (!strcmp(backend, BACKEND_DISPLAY))
+        return GRC_BACKEND_DISPLAY;
+
+    if (!strcmp(backend, BACKEND_MEMORY))
+        return GRC_BACKEND_MEMORY;
+
+    return -1;
+}
+
 const char *str_line_break(enum grc_line_break lbreak)
 {
     switch (lbreak) {
@@ -204,6 +283,27 @@ const char *str_horizontal_position(enum grc_horizontal_position hpos)
     return NULL;
 }
 
+const char *str_anchor(enum grc_anchor anchor)
+{
+    if ((anchor < GRC_ANCHOR_TOP_LEFT) || (anchor > GRC_ANCHOR_BOTTOM_RIGHT))
+        return NULL;
+
+    return __anchors[anchor - GRC_ANCHOR_TOP_LEFT];
+}
+
+const char *str_layout(enum grc_layout layout)
+{
+    switch (layout) {
+        case GRC_LAYOUT_ROW:
+            return LAYOUT_ROW;
+
+        case GRC_LAYOUT_COLUMN:
+            return LAYOUT_COLUMN;
+    }
+
+    return NULL;
+}
+
 const char *str_grc_obj_type(enum grc_object obj)
 {
     unsigned int i;
@@ -218,6 +318,18 @@ const char *str_grc_obj_type(enum grc_object obj)
     return n;
 }
 
+/*
+ * Gives the name of every supported object, one at a time, and NULL after
+ * the last one.
+ */
+const char *str_dlg_object(unsigned int index)
+{
+    if (index >= MAX_DLG_SUPPORTED_OBJECTS)
+        return NULL;
+
+    return __dlg_objects[index].name;
+}
+
 cl_json_t *grc_get_object(struct grc_s *grc, const char *object)
 {
     return cl_json_get_object_item(grc->jgrc, object);
@@ -296,3 +408,87 @@ end_block:
     return ret;
 }
 
+
+/*
+ * Little-endian numbers of the binary formats written by the library. The
+ * put functions return the number of bytes written.
+ */
+unsigned int put_le16(unsigned char *p, unsigned int value)
+{
+    p[0] = value & 0xff;
+    p[1] = (value >> 8) & 0xff;
+
+    return 2;
+}
+
+unsigned int put_le32(unsigned char *p, unsigned int value)
+{
+    p[0] = value & 0xff;
+    p[1] = (value >> 8) & 0xff;
+    p[2] = (value >> 16) & 0xff;
+    p[3] = (value >> 24) & 0xff;
+
+    return 4;
+}
+
+unsigned int get_le16(const unsigned char *p)
+{
+    return p[0] | (p[1] << 8);
+}
+
+unsigned int get_le32(const unsigned char *p)
+{
+    return p[0] | (p[1] << 8) | (p[2] << 16) | ((unsigned int)p[3] << 24);
+}
+
+static int write_loop(int fd, const void *data, size_t n, bool socket)
+{
+    const unsigned char *p = data;
+    ssize_t w;
+
+    while (n > 0) {
+        /* A peer which went away must not kill the application */
+        if (socket == true)
+            w = send(fd, p, n, MSG_NOSIGNAL);
+        else
+            w = write(fd, p, n);
+
+        if (w < 0) {
+            if (errno == EINTR)
+                continue;
+
+            return -1;
+        }
+
+        p += w;
+        n -= w;
+    }
+
+    return 0;
+}
+
+/* Writes all @n bytes, retrying short and interrupted writes */
+int write_all(int fd, const void *data, size_t n)
+{
+    return write_loop(fd, data, n, false);
+}
+
+/* The same as write_all, but for a socket, without raising SIGPIPE */
+int send_all(int fd, const void *data, size_t n)
+{
+    return write_loop(fd, data, n, true);
+}
+
+unsigned long long nsec_now(clockid_t clock)
+{
+    struct timespec t;
+
+    clock_gettime(clock, &t);
+
+    return (unsigned long long)t.tv_sec * 1000000000ULL + t.tv_nsec;
+}
+
+unsigned long long usec_now(clockid_t clock)
+{
+    return nsec_now(clock) / 1000;
+}
@@ -58,6 +58,39 @@ static struct writer_builder *new_writer_builder(void)
     return w;
 }
 
+/* How deep a streamed GRC must be for each writer function */
+#define STREAM_ROOT                     1
+#define STREAM_BLOCK                    2
+#define STREAM_OBJECT                   3
+
+/*
+ * Gets the stream of a GRC being written in streaming mode, NULL when it is
+ * being built in memory.
+ */
+static struct writer_stream *active_stream(grc_t *grc)
+{
+    struct grc_s *g = (struct grc_s *)grc;
+
+    if ((g->stream != NULL) && (writer_stream_depth(g->stream) > 0))
+        return g->stream;
+
+    return NULL;
+}
+
+/*
+ * Since nothing can be fixed after being written, writer functions called
+ * out of order are refused.
+ */
+static int stream_check_depth(struct writer_stream *s, unsigned int depth)
+{
+    if (writer_stream_depth(s) != depth) {
+        grc_set_errno(GRC_ERROR_INVALID_WRITER_STATE);
+        return -1;
+    }
+
+    return 0;
+}
+
 static int create_root_object(struct grc_s *grc)
 {
     cl_json_t *p = NULL;
@@ -82,6 +115,7 @@ int LIBEXPORT grc_GRC_create_colors(grc_t *grc,
     const char *foreground, const char *background)
 {
     cl_json_t *fg, *bg, *c, *root;
+    struct writer_stream *s;
 
     grc_errno_clear();
 
@@ -90,9 +124,6 @@ int LIBEXPORT grc_GRC_create_colors(grc_t *grc,
         return -1;
     }
 
-    if (create_root_object(grc) < 0)
-        return -1;
-
     /* Invalid colors? */
     if ((color_grc_to_al(OUT_GFX_COLOR_DEPTH, foreground) < 0) ||
         (color_grc_to_al(OUT_GFX_COLOR_DEPTH, background) < 0))
@@ -101,6 +132,23 @@ int LIBEXPORT grc_GRC_create_colors(grc_t *grc,
         return -1;
     }
 
+    s = active_stream(grc);
+
+    if (s != NULL) {
+        if ((stream_check_depth(s, STREAM_ROOT) < 0) ||
+            (writer_stream_open(s, OBJ_COLORS, '{') < 0) ||
+            (writer_stream_string(s, OBJ_FOREGROUND, foreground) < 0) ||
+            (writer_stream_string(s, OBJ_BACKGROUND, background) < 0))
+        {
+            return -1;
+        }
+
+        return writer_stream_close(s, '}');
+    }
+
+    if (create_root_object(grc) < 0)
+        return -1;
+
     fg = cl_json_create_string(foreground);
     bg = cl_json_create_string(background);
     c = cl_json_create_object();
@@ -126,6 +174,7 @@ int LIBEXPORT grc_GRC_create_info(grc_t *grc, unsigned int width,
     bool block_exit_keys, bool mouse, bool ignore_esc_key)
 {
     cl_json_t *c, *k, *m, *e, *w, *h, *i, *root;
+    struct writer_stream *s;
 
     grc_errno_clear();
 
@@ -134,6 +183,24 @@ int LIBEXPORT grc_GRC_create_info(grc_t *grc, unsigned int width,
         return -1;
     }
 
+    s = active_stream(grc);
+
+    if (s != NULL) {
+        if ((stream_check_depth(s, STREAM_ROOT) < 0) ||
+            (writer_stream_open(s, OBJ_INFO, '{') < 0) ||
+            (writer_stream_number(s, OBJ_WIDTH, width) < 0) ||
+            (writer_stream_number(s, OBJ_HEIGHT, height) < 0) ||
+            (writer_stream_number(s, OBJ_COLOR_DEPTH, color_depth) < 0) ||
+            (writer_stream_bool(s, OBJ_BLOCK_EXIT_KEYS, block_exit_keys) < 0) ||
+            (writer_stream_bool(s, OBJ_MOUSE, mouse) < 0) ||
+            (writer_stream_bool(s, OBJ_IGNORE_ESC_KEY, ignore_esc_key) < 0))
+        {
+            return -1;
+        }
+
+        return writer_stream_close(s, '}');
+    }
+
     if (create_root_object(grc) < 0)
         return -1;
 
@@ -208,8 +275,34 @@ static int create_tmp_array(grc_t *grc)
     return 0;
 }
 
+/* Opens the 'keys' or the 'objects' array of a streamed GRC */
+static int stream_open_array(grc_t *grc, const char *array_name)
+{
+    struct writer_stream *s = active_stream(grc);
+
+    if (stream_check_depth(s, STREAM_ROOT) < 0)
+        return -1;
+
+    return writer_stream_open(s, array_name, '[');
+}
+
+static int stream_close_array(grc_t *grc)
+{
+    struct writer_stream *s = active_stream(grc);
+
+    if (stream_check_depth(s, STREAM_BLOCK) < 0)
+        return -1;
+
+    return writer_stream_close(s, ']');
+}
+
 int LIBEXPORT grc_GRC_keys_start(grc_t *grc)
 {
+    if ((grc != NULL) && (active_stream(grc) != NULL)) {
+        grc_errno_clear();
+        return stream_open_array(grc, OBJ_KEYS);
+    }
+
     return create_tmp_array(grc);
 }
 
@@ -218,6 +311,7 @@ int LIBEXPORT grc_GRC_add_key(grc_t *grc, const char *key,
 {
     cl_json_t *k, *n = NULL, *p;
     struct writer_builder *wb = NULL;
+    struct writer_stream *s;
 
     grc_errno_clear();
 
@@ -226,6 +320,22 @@ int LIBEXPORT grc_GRC_add_key(grc_t *grc, const char *key,
         return -1;
     }
 
+    s = active_stream(grc);
+
+    if (s != NULL) {
+        if ((stream_check_depth(s, STREAM_BLOCK) < 0) ||
+            (writer_stream_open(s, NULL, '{') < 0) ||
+            (writer_stream_string(s, OBJ_KEY, key) < 0))
+        {
+            return -1;
+        }
+
+        if ((name != NULL) && (writer_stream_string(s, OBJ_TAG, name) < 0))
+            return -1;
+
+        return writer_stream_close(s, '}');
+    }
+
     wb = (struct writer_builder *)grc_get_internal_data(grc);
     k = cl_json_create_string(key);
 
@@ -272,17 +382,93 @@ static int add_tmp_array(grc_t *grc, const char *array_name)
 
 int LIBEXPORT grc_GRC_keys_finish(grc_t *grc)
 {
+    if ((grc != NULL) && (active_stream(grc) != NULL)) {
+        grc_errno_clear();
+        return stream_close_array(grc);
+    }
+
     return add_tmp_array(grc, OBJ_KEYS);
 }
 
+int LIBEXPORT grc_GRC_fonts_start(grc_t *grc)
+{
+    if ((grc != NULL) && (active_stream(grc) != NULL)) {
+        grc_errno_clear();
+        return stream_open_array(grc, OBJ_FONTS);
+    }
+
+    return create_tmp_array(grc);
+}
+
+int LIBEXPORT grc_GRC_add_font(grc_t *grc, const char *name,
+    const char *file)
+{
+    cl_json_t *n, *f, *p;
+    struct writer_builder *wb = NULL;
+    struct writer_stream *s;
+
+    grc_errno_clear();
+
+    if ((NULL == grc) || (NULL == name) || (NULL == file)) {
+        grc_set_errno(GRC_ERROR_NULL_ARG);
+        return -1;
+    }
+
+    s = active_stream(grc);
+
+    if (s != NULL) {
+        if ((stream_check_depth(s, STREAM_BLOCK) < 0) ||
+            (writer_stream_open(s, NULL, '{') < 0) ||
+            (writer_stream_string(s, OBJ_NAME, name) < 0) ||
+            (writer_stream_string(s, OBJ_FILE, file) < 0))
+        {
+            return -1;
+        }
+
+        return writer_stream_close(s, '}');
+    }
+
+    wb = (struct writer_builder *)grc_get_internal_data(grc);
+    n = cl_json_create_string(name);
+    f = cl_json_create_string(file);
+    p = cl_json_create_object();
+
+    if ((NULL == n) || (NULL == f) || (NULL == p)) {
+        grc_set_errno(GRC_ERROR_MEMORY);
+        return -1;
+    }
+
+    cl_json_add_item_to_object(p, OBJ_NAME, n);
+    cl_json_add_item_to_object(p, OBJ_FILE, f);
+    cl_json_add_item_to_array(wb->array, p);
+
+    return 0;
+}
+
+int LIBEXPORT grc_GRC_fonts_finish(grc_t *grc)
+{
+    if ((grc != NULL) && (active_stream(grc) != NULL)) {
+        grc_errno_clear();
+        return stream_close_array(grc);
+    }
+
+    return add_tmp_array(grc, OBJ_FONTS);
+}
+
 int LIBEXPORT grc_GRC_objects_start(grc_t *grc)
 {
+    if ((grc != NULL) && (active_stream(grc) != NULL)) {
+        grc_errno_clear();
+        return stream_open_array(grc, OBJ_OBJECTS);
+    }
+
     return create_tmp_array(grc);
 }
 
 int LIBEXPORT grc_GRC_create_object(grc_t *grc)
 {
     struct writer_builder *wb = NULL;
+    struct writer_stream *s;
 
     grc_errno_clear();
 
@@ -291,10 +477,19 @@ int LIBEXPORT grc_GRC_create_object(grc_t *grc)
         return -1;
     }
 
+    s = active_stream(grc);
+
+    if (s != NULL) {
+        if (stream_check_depth(s, STREAM_BLOCK) < 0)
+            return -1;
+
+        return writer_stream_open(s, NULL, '{');
+    }
+
     wb = (struct writer_builder *)grc_get_internal_data(grc);
 
     if (NULL == wb) {
-        /* FIXME: set error code */
+        grc_set_errno(GRC_ERROR_INVALID_WRITER_STATE);
         return -1;
     }
 
@@ -311,6 +506,7 @@ int LIBEXPORT grc_GRC_create_object(grc_t *grc)
 int LIBEXPORT grc_GRC_finish_object(grc_t *grc)
 {
     struct writer_builder *wb = NULL;
+    struct writer_stream *s;
 
     grc_errno_clear();
 
@@ -319,6 +515,15 @@ int LIBEXPORT grc_GRC_finish_object(grc_t *grc)
         return -1;
     }
 
+    s = active_stream(grc);
+
+    if (s != NULL) {
+        if (stream_check_depth(s, STREAM_OBJECT) < 0)
+            return -1;
+
+        return writer_stream_close(s, '}');
+    }
+
     wb = (struct writer_builder *)grc_get_internal_data(grc);
     cl_json_add_item_to_array(wb->array, wb->object);
 
@@ -329,6 +534,7 @@ int LIBEXPORT grc_GRC_set_object_property(grc_t *grc,
     enum grc_object_property prop, ...)
 {
     struct writer_builder *wb = NULL;
+    struct writer_stream *stream;
     va_list ap;
     enum grc_entry_type_value grc_value;
     const char *jkey = NULL;
@@ -343,7 +549,7 @@ int LIBEXPORT grc_GRC_set_object_property(grc_t *grc,
         return -1;
     }
 
-    va_start(ap, NULL);
+    va_start(ap, prop);
 
     switch (prop) {
         case GRC_PROPERTY_WIDTH:
@@ -363,6 +569,7 @@ int LIBEXPORT grc_GRC_set_object_property(grc_t *grc,
             s = va_arg(ap, char *);
 
             if (color_grc_to_al(DEFAULT_COLOR_DEPTH, s) < 0) {
+                va_end(ap);
                 grc_set_errno(GRC_ERROR_UNSUPPORTED_COLOR_DEPTH);
                 return -1;
             }
@@ -377,6 +584,7 @@ int LIBEXPORT grc_GRC_set_object_property(grc_t *grc,
             s = (char *)str_grc_obj_type(i);
 
             if (NULL == s) {
+                va_end(ap);
                 grc_set_errno(GRC_ERROR_UNKNOWN_OBJECT_TYPE);
                 return -1;
             }
@@ -458,47 +666,138 @@ int LIBEXPORT grc_GRC_set_object_property(grc_t *grc,
             s = (char *)str_horizontal_position(i);
             break;
 
+        case GRC_PROPERTY_VIRTUAL:
+            jkey = OBJ_VIRTUAL;
+            i = va_arg(ap, int);
+            grc_value = GRC_BOOL;
+            break;
+
+        case GRC_PROPERTY_COLUMNS:
+            jkey = OBJ_COLUMNS;
+            s = va_arg(ap, char *);
+            grc_value = GRC_STRING;
+            break;
+
+        case GRC_PROPERTY_MULTILINE:
+            jkey = OBJ_MULTILINE;
+            i = va_arg(ap, int);
+            grc_value = GRC_BOOL;
+            break;
+
+        case GRC_PROPERTY_FONT:
+            jkey = OBJ_FONT;
+            s = va_arg(ap, char *);
+            grc_value = GRC_STRING;
+            break;
+
+        case GRC_PROPERTY_ANCHOR:
+            jkey = OBJ_ANCHOR;
+            i = va_arg(ap, int);
+            grc_value = GRC_STRING;
+            s = (char *)str_anchor(i);
+            break;
+
+        case GRC_PROPERTY_LAYOUT:
+            jkey = OBJ_LAYOUT;
+            i = va_arg(ap, int);
+            grc_value = GRC_STRING;
+            s = (char *)str_layout(i);
+            break;
+
+        case GRC_PROPERTY_PADDING:
+            jkey = OBJ_PADDING;
+            i = va_arg(ap, int);
+            grc_value = GRC_NUMBER;
+            break;
+
+        case GRC_PROPERTY_WIDTH_PERCENT:
+            jkey = OBJ_WIDTH_PERCENT;
+            i = va_arg(ap, int);
+            grc_value = GRC_NUMBER;
+            break;
+
+        case GRC_PROPERTY_HEIGHT_PERCENT:
+            jkey = OBJ_HEIGHT_PERCENT;
+            i = va_arg(ap, int);
+            grc_value = GRC_NUMBER;
+            break;
+
         default:
+            va_end(ap);
             grc_set_errno(GRC_ERROR_UNKNOWN_PROPERTY);
             return -1;
     }
 
-    /* Only supported properties are inserted */
-    if (jkey != NULL) {
+    va_end(ap);
+
+    /*
+     * The value must be written the way the parser expects to read it, so
+     * we check it against the supported properties list.
+     */
+    if (propery_detail_type(get_property_detail(prop)) != grc_value) {
+        grc_set_errno(GRC_ERROR_UNSUPPORTED_DATA_TYPE);
+        return -1;
+    }
+
+    if ((grc_value == GRC_STRING) && (NULL == s)) {
+        grc_set_errno(GRC_ERROR_NULL_ARG);
+        return -1;
+    }
+
+    stream = active_stream(grc);
+
+    if (stream != NULL) {
+        if (stream_check_depth(stream, STREAM_OBJECT) < 0)
+            return -1;
+
         switch (grc_value) {
             case GRC_NUMBER:
-                c = cl_json_create_number(i);
-                break;
+                return writer_stream_number(stream, jkey, i);
 
             case GRC_STRING:
-                c = cl_json_create_string(s);
-                break;
+                return writer_stream_string(stream, jkey, s);
 
             case GRC_BOOL:
-                if (i == false)
-                    c = cl_json_create_false();
-                else
-                    c = cl_json_create_true();
-
-                break;
+                return writer_stream_bool(stream, jkey, i);
         }
+    }
 
-        if (NULL == c) {
-            grc_set_errno(GRC_ERROR_MEMORY);
-            return -1;
-        }
+    switch (grc_value) {
+        case GRC_NUMBER:
+            c = cl_json_create_number(i);
+            break;
+
+        case GRC_STRING:
+            c = cl_json_create_string(s);
+            break;
 
-        wb = (struct writer_builder *)grc_get_internal_data(grc);
-        cl_json_add_item_to_object(wb->object, jkey, c);
+        case GRC_BOOL:
+            if (i == false)
+                c = cl_json_create_false();
+            else
+                c = cl_json_create_true();
+
+            break;
     }
 
-    va_end(ap);
+    if (NULL == c) {
+        grc_set_errno(GRC_ERROR_MEMORY);
+        return -1;
+    }
+
+    wb = (struct writer_builder *)grc_get_internal_data(grc);
+    cl_json_add_item_to_object(wb->object, jkey, c);
 
     return 0;
 }
 
 int LIBEXPORT grc_GRC_objects_finish(grc_t *grc)
 {
+    if ((grc != NULL) && (active_stream(grc) != NULL)) {
+        grc_errno_clear();
+        return stream_close_array(grc);
+    }
+
     return add_tmp_array(grc, OBJ_OBJECTS);
 }
 
@@ -0,0 +1,428 @@
+/*
+ * Description: Functions to write a GRC file directly to a file descriptor
+ *              or to a memory buffer, without building its JSON tree.
+ *
+ * Author: Rodrigo Freitas
+ * Created at: Mon Oct 19 14:21:36 2026
+ * Project: libgrc
+ *
+ * Copyright (c) 2014 Rodrigo Freitas
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301
+ * USA
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "libgrc.h"
+
+/*
+ * Size of the internal buffer. When writing to a file descriptor this is all
+ * the memory we use, no matter the size of the GRC.
+ */
+#define WRITER_STREAM_CHUNK_SIZE        4096
+
+/* A GRC never nests deeper than root -> array -> object */
+#define WRITER_STREAM_MAX_DEPTH         8
+
+struct writer_stream {
+    int             fd;         /** Destination, -1 to keep it in @buf */
+    char            *buf;
+    unsigned int    size;
+    unsigned int    used;
+    bool            failed;
+
+    /* Opened objects and arrays, and if they already have a member */
+    unsigned int    depth;
+    bool            has_member[WRITER_STREAM_MAX_DEPTH];
+};
+
+struct writer_stream *new_writer_stream(void)
+{
+    struct writer_stream *s = NULL;
+
+    s = calloc(1, sizeof(struct writer_stream));
+
+    if (NULL == s) {
+        grc_set_errno(GRC_ERROR_MEMORY);
+        return NULL;
+    }
+
+    s->size = WRITER_STREAM_CHUNK_SIZE;
+    s->buf = malloc(s->size);
+
+    if (NULL == s->buf) {
+        grc_set_errno(GRC_ERROR_MEMORY);
+        free(s);
+        return NULL;
+    }
+
+    s->fd = -1;
+
+    return s;
+}
+
+void destroy_writer_stream(struct writer_stream *s)
+{
+    if (NULL == s)
+        return;
+
+    if (s->buf != NULL)
+        free(s->buf);
+
+    free(s);
+}
+
+/*
+ * Prepares @s to write a new GRC. The buffer is kept, so that generating
+ * several files in a row does not need to allocate memory again.
+ */
+void writer_stream_reset(struct writer_stream *s, int fd)
+{
+    s->fd = fd;
+    s->used = 0;
+    s->depth = 0;
+    s->failed = false;
+}
+
+unsigned int writer_stream_depth(const struct writer_stream *s)
+{
+    return s->depth;
+}
+
+int writer_stream_flush(struct writer_stream *s)
+{
+    if (s->failed == true) {
+        grc_set_errno(GRC_ERROR_STREAM_WRITE);
+        return -1;
+    }
+
+    if (s->fd < 0)
+        return 0;
+
+    if (write_all(s->fd, s->buf, s->used) < 0) {
+        s->failed = true;
+        grc_set_errno(GRC_ERROR_STREAM_WRITE);
+        return -1;
+    }
+
+    s->used = 0;
+
+    return 0;
+}
+
+static int writer_stream_put(struct writer_stream *s, const char *p,
+    unsigned int n)
+{
+    unsigned int size, chunk;
+    char *b;
+
+    if (s->failed == true) {
+        grc_set_errno(GRC_ERROR_STREAM_WRITE);
+        return -1;
+    }
+
+    /* Leaves room for the string terminator */
+    if ((s->fd < 0) && (s->used + n >= s->size)) {
+        size = s->size * 2;
+
+        while (s->used + n >= size)
+            size *= 2;
+
+        b = realloc(s->buf, size);
+
+        if (NULL == b) {
+            s->failed = true;
+            grc_set_errno(GRC_ERROR_MEMORY);
+            return -1;
+        }
+
+        s->buf = b;
+        s->size = size;
+    }
+
+    while (n > 0) {
+        if (s->used == s->size)
+            if (writer_stream_flush(s) < 0)
+                return -1;
+
+        chunk = s->size - s->used;
+
+        if (chunk > n)
+            chunk = n;
+
+        memcpy(s->buf + s->used, p, chunk);
+        s->used += chunk;
+        p += chunk;
+        n -= chunk;
+    }
+
+    return 0;
+}
+
+static int writer_stream_put_string(struct writer_stream *s, const char *str)
+{
+    const char *p = str;
+    char esc[8];
+
+    if (writer_stream_put(s, "\"", 1) < 0)
+        return -1;
+
+    while (*p != '\0') {
+        if ((*p != '"') && (*p != '\\') && ((unsigned char)*p >= 0x20)) {
+            p++;
+            continue;
+        }
+
+        /* Writes everything that does not need to be escaped at once */
+        if (writer_stream_put(s, str, p - str) < 0)
+            return -1;
+
+        switch (*p) {
+            case '"':
+                strcpy(esc, "\\\"");
+                break;
+
+            case '\\':
+                strcpy(esc, "\\\\");
+                break;
+
+            case '\n':
+                strcpy(esc, "\\n");
+                break;
+
+            case '\t':
+                strcpy(esc, "\\t");
+                break;
+
+            default:
+                snprintf(esc, sizeof(esc), "\\u%04x", (unsigned char)*p);
+                break;
+        }
+
+        if (writer_stream_put(s, esc, strlen(esc)) < 0)
+            return -1;
+
+        str = ++p;
+    }
+
+    if (writer_stream_put(s, str, p - str) < 0)
+        return -1;
+
+    return writer_stream_put(s, "\"", 1);
+}
+
+/* Writes the separator and the name of a new member of the current block */
+static int writer_stream_member(struct writer_stream *s, const char *key)
+{
+    if (s->depth > 0) {
+        if (s->has_member[s->depth - 1] == true)
+            if (writer_stream_put(s, ",", 1) < 0)
+                return -1;
+
+        s->has_member[s->depth - 1] = true;
+    }
+
+    if (NULL == key)
+        return 0;
+
+    if (writer_stream_put_string(s, key) < 0)
+        return -1;
+
+    return writer_stream_put(s, ":", 1);
+}
+
+/*
+ * Opens an object, if @c is '{', or an array, if it is '['. @key must be NULL
+ * for the root object and for array members.
+ */
+int writer_stream_open(struct writer_stream *s, const char *key, char c)
+{
+    if (s->depth == WRITER_STREAM_MAX_DEPTH) {
+        grc_set_errno(GRC_ERROR_INVALID_WRITER_STATE);
+        return -1;
+    }
+
+    if ((writer_stream_member(s, key) < 0) || (writer_stream_put(s, &c, 1) < 0))
+        return -1;
+
+    s->has_member[s->depth++] = false;
+
+    return 0;
+}
+
+int writer_stream_close(struct writer_stream *s, char c)
+{
+    if (s->depth == 0) {
+        grc_set_errno(GRC_ERROR_INVALID_WRITER_STATE);
+        return -1;
+    }
+
+    s->depth--;
+
+    return writer_stream_put(s, &c, 1);
+}
+
+int writer_stream_string(struct writer_stream *s, const char *key,
+    const char *value)
+{
+    if (writer_stream_member(s, key) < 0)
+        return -1;
+
+    return writer_stream_put_string(s, value);
+}
+
+int writer_stream_number(struct writer_stream *s, const char *key, int value)
+{
+    char tmp[32];
+
+    if (writer_stream_member(s, key) < 0)
+        return -1;
+
+    snprintf(tmp, sizeof(tmp), "%d", value);
+
+    return writer_stream_put(s, tmp, strlen(tmp));
+}
+
+int writer_stream_bool(struct writer_stream *s, const char *key, bool value)
+{
+    if (writer_stream_member(s, key) < 0)
+        return -1;
+
+    if (value == false)
+        return writer_stream_put(s, "false", 5);
+
+    return writer_stream_put(s, "true", 4);
+}
+
+/*
+ * Gets what was written to memory, as a regular string. Always NULL for a
+ * stream writing to a file descriptor.
+ */
+const char *writer_stream_data(struct writer_stream *s, unsigned int *size)
+{
+    if (s->fd >= 0)
+        return NULL;
+
+    s->buf[s->used] = '\0';
+
+    if (size != NULL)
+        *size = s->used;
+
+    return s->buf;
+}
+
+/*
+ *
+ * API
+ *
+ */
+
+static int stream_start(grc_t *grc, int fd)
+{
+    struct grc_s *g = (struct grc_s *)grc;
+
+    if ((g->stream != NULL) && (writer_stream_depth(g->stream) > 0)) {
+        grc_set_errno(GRC_ERROR_INVALID_WRITER_STATE);
+        return -1;
+    }
+
+    if (NULL == g->stream) {
+        g->stream = new_writer_stream();
+
+        if (NULL == g->stream)
+            return -1;
+    }
+
+    writer_stream_reset(g->stream, fd);
+
+    /* The root object */
+    return writer_stream_open(g->stream, NULL, '{');
+}
+
+int LIBEXPORT grc_GRC_stream_to_fd(grc_t *grc, int fd)
+{
+    grc_errno_clear();
+
+    if ((NULL == grc) || (fd < 0)) {
+        grc_set_errno(GRC_ERROR_NULL_ARG);
+        return -1;
+    }
+
+    return stream_start(grc, fd);
+}
+
+int LIBEXPORT grc_GRC_stream_to_buffer(grc_t *grc)
+{
+    grc_errno_clear();
+
+    if (NULL == grc) {
+        grc_set_errno(GRC_ERROR_NULL_ARG);
+        return -1;
+    }
+
+    return stream_start(grc, -1);
+}
+
+int LIBEXPORT grc_GRC_stream_finish(grc_t *grc)
+{
+    struct grc_s *g = (struct grc_s *)grc;
+
+    grc_errno_clear();
+
+    if (NULL == grc) {
+        grc_set_errno(GRC_ERROR_NULL_ARG);
+        return -1;
+    }
+
+    /* Every block must have been finished, leaving only the root object */
+    if ((NULL == g->stream) || (writer_stream_depth(g->stream) != 1)) {
+        grc_set_errno(GRC_ERROR_INVALID_WRITER_STATE);
+        return -1;
+    }
+
+    if (writer_stream_close(g->stream, '}') < 0)
+        return -1;
+
+    return writer_stream_flush(g->stream);
+}
+
+const char LIBEXPORT *grc_GRC_stream_buffer(grc_t *grc, unsigned int *size)
+{
+    struct grc_s *g = (struct grc_s *)grc;
+    const char *p;
+
+    grc_errno_clear();
+
+    if (NULL == grc) {
+        grc_set_errno(GRC_ERROR_NULL_ARG);
+        return NULL;
+    }
+
+    if ((NULL == g->stream) || (writer_stream_depth(g->stream) > 0)) {
+        grc_set_errno(GRC_ERROR_INVALID_WRITER_STATE);
+        return NULL;
+    }
+
+    p = writer_stream_data(g->stream, size);
+
+    if (NULL == p)
+        grc_set_errno(GRC_ERROR_INVALID_WRITER_STATE);
+
+    return p;
+}